@@ -867,7 +867,8 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
 
    }
 
-   cheat_st->num_matches = (cheat_st->total_memory_size * 8) / (1 << cheat_st->search_bit_size);
+   cheat_st->num_matches = (unsigned)cheat_search_num_items(
+         cheat_st->total_memory_size, cheat_st->search_bit_size);
 
 #if 0
    /* Ensure we're aligned on 4-byte boundary */
@@ -898,8 +899,8 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
          cheat_st->matches = NULL;
       }
 
-      cheat_st->matches = (uint8_t*)calloc(
-            cheat_st->total_memory_size, sizeof(uint8_t));
+      cheat_st->matches = (uint8_t*)malloc(cheat_search_matches_size(
+               cheat_st->num_matches));
 
       if (!cheat_st->matches)
       {
@@ -909,7 +910,8 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
          return 0;
       }
 
-      memset(cheat_st->matches, 0xFF, cheat_st->total_memory_size);
+      cheat_search_reset(cheat_st->matches, cheat_st->num_matches);
+      cheat_st->match_bit_size = cheat_st->search_bit_size;
 
       offset = 0;
 
@@ -998,25 +1000,76 @@ static void cheat_manager_setup_search_meta(
    }
 }
 
+/* The candidate set is sized for the item size the search
+ * was started with, start over if it was changed since */
+static bool cheat_manager_fit_matches(cheat_manager_t *cheat_st)
+{
+   uint8_t *matches;
+   size_t num_items;
+
+   if (cheat_st->match_bit_size == cheat_st->search_bit_size)
+      return true;
+
+   num_items = cheat_search_num_items(cheat_st->total_memory_size,
+         cheat_st->search_bit_size);
+   if (!(matches = (uint8_t*)realloc(cheat_st->matches,
+               cheat_search_matches_size(num_items))))
+      return false;
+
+   cheat_search_reset(matches, num_items);
+   cheat_st->matches        = matches;
+   cheat_st->num_matches    = (unsigned)num_items;
+   cheat_st->match_bit_size = cheat_st->search_bit_size;
+   return true;
+}
+
+/* Maps a search item to its address and, for items
+ * smaller than a byte, the bits it takes in there */
+static void cheat_manager_match_address(size_t item,
+      unsigned bytes_per_item, unsigned bits, unsigned mask,
+      unsigned *address, unsigned *address_mask)
+{
+   unsigned per_byte  = 8 / bits;
+   unsigned byte_part = (unsigned)(item % per_byte);
+
+   *address           = (unsigned)(item / per_byte) * bytes_per_item;
+   *address_mask      = (bits < 8) ? (mask << (byte_part * bits)) : 0xFF;
+}
+
+static unsigned cheat_manager_item_value(const unsigned char *s,
+      unsigned bytes_per_item, bool big_endian)
+{
+   switch (bytes_per_item)
+   {
+      case 2:
+         return big_endian
+            ? (s[0] << 8) | s[1]
+            : s[0] | (s[1] << 8);
+      case 4:
+         return big_endian
+            ? ((unsigned)s[0] << 24) | (s[1] << 16) | (s[2] << 8) | s[3]
+            : s[0] | (s[1] << 8) | (s[2] << 16) | ((unsigned)s[3] << 24);
+      default:
+         break;
+   }
+   return s[0];
+}
+
 static int cheat_manager_search(enum cheat_search_type search_type)
 {
    char msg[100];
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char *curr         = cheat_st->curr_memory_buf;
-   unsigned char *prev         = cheat_st->prev_memory_buf;
-   unsigned int idx            = 0;
-   unsigned int curr_val       = 0;
-   unsigned int prev_val       = 0;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
+   unsigned int value          = 0;
    unsigned int offset         = 0;
    unsigned int i              = 0;
 #ifdef HAVE_MENU
    struct menu_state *menu_st  = menu_state_get_ptr();
 #endif
 
-   if (cheat_st->num_memory_buffers == 0 || !prev || !cheat_st->matches)
+   if (     cheat_st->num_memory_buffers == 0
+         || !cheat_st->prev_memory_buf
+         || !cheat_st->matches
+         || !cheat_manager_fit_matches(cheat_st))
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED),
             1, 180, true, NULL,
@@ -1024,100 +1077,26 @@ static int cheat_manager_search(enum cheat_search_type search_type)
       return 0;
    }
 
-   cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
-
-   /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   switch (search_type)
    {
-      unsigned byte_part;
-
-      offset = translate_address(idx, &curr);
-
-      switch (bytes_per_item)
-      {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256) + *(prev + idx + 1) :
-               *(prev + idx) + (*(prev + idx + 1) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            prev_val = *(prev + idx);
-            break;
-      }
-
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
-      {
-         unsigned int curr_subval = (curr_val >> (byte_part * bits)) & mask;
-         unsigned int prev_subval = (prev_val >> (byte_part * bits)) & mask;
-         unsigned int prev_match;
-
-         if (bits < 8)
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-         else
-            prev_match = *(cheat_st->matches + idx);
-
-         if (prev_match > 0)
-         {
-            bool match = false;
-            switch (search_type)
-            {
-               case CHEAT_SEARCH_TYPE_EXACT:
-                  match = (curr_subval == cheat_st->search_exact_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_LT:
-                  match = (curr_subval < prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GT:
-                  match = (curr_subval > prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE:
-                  match = (curr_subval <= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE:
-                  match = (curr_subval >= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ:
-                  match = (curr_subval == prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ:
-                  match = (curr_subval != prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS:
-                  match = (curr_subval == prev_subval + cheat_st->search_eqplus_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS:
-                  match = (curr_subval == prev_subval - cheat_st->search_eqminus_value);
-                  break;
-            }
-
-            if (!match)
-            {
-               if (bits < 8)
-                  *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                     ((~(mask << (byte_part * bits))) & 0xFF);
-               else
-                  memset(cheat_st->matches + idx, 0, bytes_per_item);
-               if (cheat_st->num_matches > 0)
-                  cheat_st->num_matches--;
-            }
-         }
-      }
+      case CHEAT_SEARCH_TYPE_EXACT:
+         value = cheat_st->search_exact_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         value = cheat_st->search_eqplus_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         value = cheat_st->search_eqminus_value;
+         break;
+      default:
+         break;
    }
 
-   offset = 0;
+   cheat_st->num_matches = (unsigned)cheat_search_refine(cheat_st->matches,
+         cheat_st->memory_buf_list, cheat_st->memory_size_list,
+         cheat_st->num_memory_buffers, cheat_st->prev_memory_buf,
+         cheat_st->search_bit_size, cheat_st->big_endian,
+         search_type, value);
 
    for (i = 0; i < cheat_st->num_memory_buffers; i++)
    {
@@ -1210,19 +1189,19 @@ int cheat_manager_add_matches(const char *path,
       const char *label, unsigned type, size_t menuidx, size_t entry_idx)
 {
    char msg[100];
-   unsigned          byte_part = 0;
-   unsigned            int idx = 0;
-   unsigned           int mask = 0;
+   size_t item                 = 0;
+   size_t num_items            = 0;
+   unsigned int mask           = 0;
    unsigned int bytes_per_item = 1;
-   unsigned           int bits = 8;
-   unsigned       int curr_val = 0;
-   unsigned         int offset = 0;
-   cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char         *curr = cheat_st->curr_memory_buf;
+   unsigned int bits           = 8;
+   cheat_manager_t *cheat_st   = &cheat_manager_state;
 #ifdef HAVE_MENU
    struct menu_state *menu_st  = menu_state_get_ptr();
 #endif
 
+   if (!cheat_st->matches || !cheat_manager_fit_matches(cheat_st))
+      return 0;
+
    if (cheat_st->num_matches + cheat_st->size > 100)
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_TOO_MANY), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
@@ -1230,58 +1209,27 @@ int cheat_manager_add_matches(const char *path,
    }
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   num_items = cheat_search_num_items(cheat_st->total_memory_size,
+         cheat_st->search_bit_size);
+
+   for (  item  = cheat_search_next_match(cheat_st->matches, num_items, 0);
+          item  < num_items;
+          item  = cheat_search_next_match(cheat_st->matches, num_items, item + 1))
    {
+      unsigned idx, address_mask, offset;
+      unsigned char *curr = cheat_st->curr_memory_buf;
+
+      cheat_manager_match_address(item, bytes_per_item, bits, mask,
+            &idx, &address_mask);
       offset = translate_address(idx, &curr);
 
-      switch (bytes_per_item)
+      if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx,
+               address_mask, cheat_st->big_endian,
+               cheat_manager_item_value(curr + idx - offset,
+                  bytes_per_item, cheat_st->big_endian)))
       {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            break;
-      }
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
-      {
-         unsigned int prev_match;
-
-         if (bits < 8)
-         {
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, (mask << (byte_part * bits)),
-                        cheat_st->big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                  return 0;
-               }
-            }
-         }
-         else
-         {
-            prev_match = *(cheat_st->matches + idx);
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, 0xFF,
-                        cheat_st->big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                  return 0;
-               }
-            }
-         }
-
+         runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         return 0;
       }
    }
 
@@ -1584,19 +1532,19 @@ void cheat_manager_apply_retro_cheats(void)
 void cheat_manager_match_action(enum cheat_match_action_type match_action, unsigned int target_match_idx, unsigned int *address, unsigned int *address_mask,
       unsigned int *prev_value, unsigned int *curr_value)
 {
-   unsigned int byte_part;
+   size_t item;
+   size_t num_items;
    unsigned int idx;
-   unsigned int start_idx;
    unsigned int           mask = 0;
    unsigned int bytes_per_item = 1;
    unsigned int           bits = 8;
+   unsigned int      item_mask = 0;
    unsigned int       curr_val = 0;
    unsigned int       prev_val = 0;
    unsigned int         offset = 0;
    cheat_manager_t   *cheat_st = &cheat_manager_state;
    unsigned char         *curr = cheat_st->curr_memory_buf;
    unsigned char         *prev = cheat_st->prev_memory_buf;
-   unsigned int curr_match_idx = 0;
 
    if (target_match_idx > cheat_st->num_matches - 1)
       return;
@@ -1607,137 +1555,60 @@ void cheat_manager_match_action(enum cheat_match_action_type match_action, unsig
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
    if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      start_idx = *address;
-   else
-      start_idx = 0;
-
-   for (idx = start_idx; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
    {
-      offset = translate_address(idx, &curr);
+      idx = *address;
+      if (idx >= cheat_st->total_memory_size)
+         return;
 
-      switch (bytes_per_item)
-      {
-      case 2:
-         curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-         if (prev)
-            prev_val = cheat_st->big_endian ?
-                  (*(prev + idx) * 256) + *(prev + idx + 1) :
-                  *(prev + idx) + (*(prev + idx + 1) * 256);
-         break;
-      case 4:
-         curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-         if (prev)
-            prev_val = cheat_st->big_endian ?
-                  (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-                  *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-         break;
-      case 1:
-      default:
-         curr_val = *(curr + idx - offset);
-         if (prev)
-            prev_val = *(prev + idx);
-         break;
-      }
+      offset      = translate_address(idx, &curr);
+      *curr_value = cheat_manager_item_value(curr + idx - offset,
+            bytes_per_item, cheat_st->big_endian);
+      *prev_value = prev ? cheat_manager_item_value(prev + idx,
+            bytes_per_item, cheat_st->big_endian) : 0;
+      return;
+   }
 
-      if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      {
-         *curr_value = curr_val;
-         *prev_value = prev_val;
-         return;
-      }
+   if (!prev || !cheat_st->matches || !cheat_manager_fit_matches(cheat_st))
+      return;
 
-      if (!prev)
-         return;
+   num_items = cheat_search_num_items(cheat_st->total_memory_size,
+         cheat_st->search_bit_size);
 
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
-      {
-         unsigned int prev_match;
+   if ((item = cheat_search_nth_match(cheat_st->matches, num_items,
+               target_match_idx)) >= num_items)
+      return;
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                  case CHEAT_MATCH_ACTION_TYPE_BROWSE:
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_VIEW:
-                     *address = idx;
-                     *address_mask = (mask << (byte_part * bits));
-                     *curr_value = curr_val;
-                     *prev_value = prev_val;
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_COPY:
-                     if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, (mask << (byte_part * bits)),
-                           cheat_st->big_endian, curr_val))
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     else
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_DELETE:
-                     if (bits < 8)
-                        *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                              ((~(mask << (byte_part * bits))) & 0xFF);
-                     else
-                        memset(cheat_st->matches + idx, 0, bytes_per_item);
-                     if (cheat_st->num_matches > 0)
-                        cheat_st->num_matches--;
-                     runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  }
-                  return;
-               }
-               curr_match_idx++;
-            }
-         }
-         else
-         {
-            prev_match = *(cheat_st->matches + idx);
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                  case CHEAT_MATCH_ACTION_TYPE_BROWSE:
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_VIEW:
-                     *address = idx;
-                     *address_mask = 0xFF;
-                     *curr_value = curr_val;
-                     *prev_value = prev_val;
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_COPY:
-                     if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, 0xFF,
-                           cheat_st->big_endian, curr_val))
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     else
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_DELETE:
-                     if (bits < 8)
-                        *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                              ((~(mask << (byte_part * bits))) & 0xFF);
-                     else
-                        memset(cheat_st->matches + idx, 0, bytes_per_item);
-                     if (cheat_st->num_matches > 0)
-                        cheat_st->num_matches--;
-                     runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  }
-               }
+   cheat_manager_match_address(item, bytes_per_item, bits, mask,
+         &idx, &item_mask);
+   offset   = translate_address(idx, &curr);
+   curr_val = cheat_manager_item_value(curr + idx - offset,
+         bytes_per_item, cheat_st->big_endian);
+   prev_val = cheat_manager_item_value(prev + idx,
+         bytes_per_item, cheat_st->big_endian);
 
-               curr_match_idx++;
-            }
-         }
-      }
+   switch (match_action)
+   {
+      case CHEAT_MATCH_ACTION_TYPE_VIEW:
+         *address      = idx;
+         *address_mask = item_mask;
+         *curr_value   = curr_val;
+         *prev_value   = prev_val;
+         break;
+      case CHEAT_MATCH_ACTION_TYPE_COPY:
+         if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, item_mask,
+                  cheat_st->big_endian, curr_val))
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         else
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         break;
+      case CHEAT_MATCH_ACTION_TYPE_DELETE:
+         cheat_search_clear_match(cheat_st->matches, item);
+         if (cheat_st->num_matches > 0)
+            cheat_st->num_matches--;
+         runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         break;
+      case CHEAT_MATCH_ACTION_TYPE_BROWSE:
+         break;
    }
 }
 
@@ -21,6 +21,7 @@
 #include <retro_common_api.h>
 
 #include "../setting_list.h"
+#include "cheat_search.h"
 
 RETRO_BEGIN_DECLS
 
@@ -43,19 +44,6 @@ enum cheat_type
    CHEAT_TYPE_RUN_NEXT_IF_GT
 };
 
-enum cheat_search_type
-{
-   CHEAT_SEARCH_TYPE_EXACT = 0,
-   CHEAT_SEARCH_TYPE_LT,
-   CHEAT_SEARCH_TYPE_LTE,
-   CHEAT_SEARCH_TYPE_GT,
-   CHEAT_SEARCH_TYPE_GTE,
-   CHEAT_SEARCH_TYPE_EQ,
-   CHEAT_SEARCH_TYPE_NEQ,
-   CHEAT_SEARCH_TYPE_EQPLUS,
-   CHEAT_SEARCH_TYPE_EQMINUS
-};
-
 enum cheat_match_action_type
 {
    CHEAT_MATCH_ACTION_TYPE_VIEW = 0,
@@ -161,7 +149,7 @@ struct cheat_manager
    struct item_cheat *cheats;
    uint8_t *curr_memory_buf;
    uint8_t *prev_memory_buf;
-   uint8_t *matches;
+   uint8_t *matches; /* Search candidates, see cheat_search.h */
    uint8_t **memory_buf_list;
    unsigned *memory_size_list;
    unsigned int delete_state;
@@ -175,6 +163,7 @@ struct cheat_manager
    unsigned match_idx;
    unsigned match_action;
    unsigned search_bit_size;
+   unsigned match_bit_size;
    unsigned dummy;
    unsigned search_exact_value;
    unsigned search_eqplus_value;
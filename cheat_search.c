@@ -0,0 +1,1197 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STDC_CONSTANT_MACROS
+#define __STDC_CONSTANT_MACROS
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+
+#include "cheat_search.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* AVX2 kernels are built regardless of compiler flags
+ * and picked at runtime */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define HAVE_CHEAT_SEARCH_AVX2
+#define CHEAT_SEARCH_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* NEON is always there on aarch64, the kernels
+ * assume a little-endian host */
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(MSB_FIRST)
+#include <arm_neon.h>
+#define HAVE_CHEAT_SEARCH_NEON
+#endif
+
+/* Items compared per kernel call, one 64-bit word of the set */
+#define CHEAT_SEARCH_BLOCK_ITEMS     64
+/* Bytes covered by a block of 32-bit items */
+#define CHEAT_SEARCH_BLOCK_MAX_SIZE  (CHEAT_SEARCH_BLOCK_ITEMS * 4)
+/* Searches over less memory stay on the calling thread */
+#define CHEAT_SEARCH_THREAD_MIN_SIZE (1 << 20)
+#define CHEAT_SEARCH_MAX_THREADS     8
+
+/* Every search type comes down to one of these on
+ * a = current value, b = previous value (or swapped),
+ * optionally inverted */
+enum cheat_search_op
+{
+   CHEAT_SEARCH_OP_NONE = 0,  /* Nothing can match */
+   CHEAT_SEARCH_OP_EQ_VALUE,  /* a == value */
+   CHEAT_SEARCH_OP_EQ,        /* a == b */
+   CHEAT_SEARCH_OP_GT,        /* a > b */
+   CHEAT_SEARCH_OP_DIFF       /* a - b == value, see borrow */
+};
+
+typedef struct cheat_search_plan
+{
+   uint64_t low_bits;        /* Lowest bit of every item in a word */
+   uint64_t high_bits;       /* Highest bit of every item in a word */
+   enum cheat_search_op op;
+   uint32_t value;           /* Reduced to the item width */
+   unsigned width;           /* Item width in bits */
+   int borrow;               /* OP_DIFF: -1 any, 0 a >= b, 1 a < b */
+   bool swap;                /* a is the previous value */
+   bool invert;
+   bool big_endian;
+} cheat_search_plan_t;
+
+/* Compares CHEAT_SEARCH_BLOCK_ITEMS items, bit n
+ * of the result is set if item n matches */
+typedef uint64_t (*cheat_search_block_t)(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev);
+
+typedef struct cheat_search_ctx
+{
+   cheat_search_plan_t plan;
+   cheat_search_block_t block;
+   uint8_t *matches;
+   uint8_t *const *bufs;
+   const unsigned *sizes;
+   const uint8_t *prev;
+   size_t num_items;
+   unsigned num_bufs;
+} cheat_search_ctx_t;
+
+typedef struct cheat_search_job
+{
+   const cheat_search_ctx_t *ctx;
+   size_t first_block;
+   size_t last_block;
+   size_t matches;
+} cheat_search_job_t;
+
+static void cheat_search_plan_init(cheat_search_plan_t *plan,
+      unsigned bit_size, bool big_endian,
+      enum cheat_search_type type, unsigned value)
+{
+   unsigned width   = 1 << bit_size;
+   uint32_t mask    = (width < 32) ? ((1U << width) - 1) : 0xFFFFFFFF;
+   uint32_t high    = (width < 32) ? (value >> width)    : 0;
+
+   plan->low_bits   = UINT64_C(0xFFFFFFFFFFFFFFFF)
+      / ((UINT64_C(1) << width) - 1);
+   plan->high_bits  = plan->low_bits << (width - 1);
+   plan->op         = CHEAT_SEARCH_OP_NONE;
+   plan->value      = 0;
+   plan->width      = width;
+   plan->borrow     = -1;
+   plan->swap       = false;
+   plan->invert     = false;
+   plan->big_endian = big_endian;
+
+   switch (type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         if (value <= mask)
+         {
+            plan->op    = CHEAT_SEARCH_OP_EQ_VALUE;
+            plan->value = value;
+         }
+         break;
+      case CHEAT_SEARCH_TYPE_LT:
+         plan->op     = CHEAT_SEARCH_OP_GT;
+         plan->swap   = true;
+         break;
+      case CHEAT_SEARCH_TYPE_LTE:
+         plan->op     = CHEAT_SEARCH_OP_GT;
+         plan->invert = true;
+         break;
+      case CHEAT_SEARCH_TYPE_GT:
+         plan->op     = CHEAT_SEARCH_OP_GT;
+         break;
+      case CHEAT_SEARCH_TYPE_GTE:
+         plan->op     = CHEAT_SEARCH_OP_GT;
+         plan->swap   = true;
+         plan->invert = true;
+         break;
+      case CHEAT_SEARCH_TYPE_EQ:
+         plan->op     = CHEAT_SEARCH_OP_EQ;
+         break;
+      case CHEAT_SEARCH_TYPE_NEQ:
+         plan->op     = CHEAT_SEARCH_OP_EQ;
+         plan->invert = true;
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         plan->swap   = true;
+         /* fall-through */
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         /* curr == prev +/- value wraps at 32 bits rather than
+          * at the item width, the bits of value above the item
+          * tell whether the difference has to borrow or not */
+         plan->value  = value & mask;
+         if (width == 32)
+            plan->op  = CHEAT_SEARCH_OP_DIFF;
+         else if (!high)
+         {
+            plan->op     = CHEAT_SEARCH_OP_DIFF;
+            plan->borrow = 0;
+         }
+         else if (high == (0xFFFFFFFF >> width))
+         {
+            plan->op     = CHEAT_SEARCH_OP_DIFF;
+            plan->borrow = 1;
+         }
+         break;
+   }
+}
+
+static INLINE unsigned cheat_search_popcount(uint64_t x)
+{
+#if defined(__GNUC__)
+   return (unsigned)__builtin_popcountll(x);
+#else
+   x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+   x = (x & UINT64_C(0x3333333333333333))
+      + ((x >> 2) & UINT64_C(0x3333333333333333));
+   x = (x + (x >> 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+   return (unsigned)((x * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+/* Generic kernel, compares all the items packed
+ * in a 64-bit word at once (SWAR). Results are
+ * left in the highest bit of every item. */
+
+/* Sets the highest bit of every item of x that isn't zero */
+static INLINE uint64_t cheat_search_swar_nonzero(uint64_t x, uint64_t h)
+{
+   return (((x & ~h) + ~h) | x) & h;
+}
+
+/* a - b for every item, the highest bits are
+ * set aside so that no item borrows from the next */
+static INLINE uint64_t cheat_search_swar_sub(uint64_t a, uint64_t b,
+      uint64_t h)
+{
+   return ((a | h) - (b & ~h)) ^ ((a ^ ~b) & h);
+}
+
+/* Sets the highest bit of every item where a < b,
+ * d being cheat_search_swar_sub(a, b) */
+static INLINE uint64_t cheat_search_swar_lt(uint64_t a, uint64_t b,
+      uint64_t d, uint64_t h)
+{
+   return ((~a & b) | (~(a ^ b) & d)) & h;
+}
+
+static INLINE uint64_t cheat_search_swar_swap(uint64_t x, unsigned width)
+{
+   x = ((x >> 8) & UINT64_C(0x00FF00FF00FF00FF))
+     | ((x & UINT64_C(0x00FF00FF00FF00FF)) << 8);
+   if (width == 32)
+      x = ((x >> 16) & UINT64_C(0x0000FFFF0000FFFF))
+        | ((x & UINT64_C(0x0000FFFF0000FFFF)) << 16);
+   return x;
+}
+
+/* Gathers the highest bit of every item into the low bits */
+static INLINE uint64_t cheat_search_swar_pack(uint64_t r, unsigned width)
+{
+   uint64_t x;
+
+   switch (width)
+   {
+      case 2:
+         x = (r >> 1)       & UINT64_C(0x5555555555555555);
+         x = (x | (x >> 1)) & UINT64_C(0x3333333333333333);
+         x = (x | (x >> 2)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+         x = (x | (x >> 4)) & UINT64_C(0x00FF00FF00FF00FF);
+         x = (x | (x >> 8)) & UINT64_C(0x0000FFFF0000FFFF);
+         return (x | (x >> 16)) & UINT64_C(0xFFFFFFFF);
+      case 4:
+         x = (r >> 3)        & UINT64_C(0x1111111111111111);
+         x = (x | (x >> 3))  & UINT64_C(0x0303030303030303);
+         x = (x | (x >> 6))  & UINT64_C(0x000F000F000F000F);
+         x = (x | (x >> 12)) & UINT64_C(0x000000FF000000FF);
+         return (x | (x >> 24)) & UINT64_C(0xFFFF);
+      case 8:
+         x = (r >> 7)        & UINT64_C(0x0101010101010101);
+         x = (x | (x >> 7))  & UINT64_C(0x0003000300030003);
+         x = (x | (x >> 14)) & UINT64_C(0x0000000F0000000F);
+         return (x | (x >> 28)) & UINT64_C(0xFF);
+      case 16:
+         x = (r >> 15)       & UINT64_C(0x0001000100010001);
+         x = (x | (x >> 15)) & UINT64_C(0x0000000300000003);
+         return (x | (x >> 30)) & UINT64_C(0xF);
+      case 32:
+         x = (r >> 31)       & UINT64_C(0x0000000100000001);
+         return (x | (x >> 31)) & UINT64_C(0x3);
+      default:
+         break;
+   }
+
+   return r;
+}
+
+static uint64_t cheat_search_swar_word(const cheat_search_plan_t *plan,
+      uint64_t c, uint64_t p)
+{
+   uint64_t h = plan->high_bits;
+   uint64_t a = plan->swap ? p : c;
+   uint64_t b = plan->swap ? c : p;
+   uint64_t r = 0;
+
+   switch (plan->op)
+   {
+      case CHEAT_SEARCH_OP_EQ_VALUE:
+         r = ~cheat_search_swar_nonzero(
+               a ^ (plan->value * plan->low_bits), h) & h;
+         break;
+      case CHEAT_SEARCH_OP_EQ:
+         r = ~cheat_search_swar_nonzero(a ^ b, h) & h;
+         break;
+      case CHEAT_SEARCH_OP_GT:
+         r = cheat_search_swar_lt(b, a,
+               cheat_search_swar_sub(b, a, h), h);
+         break;
+      case CHEAT_SEARCH_OP_DIFF:
+         {
+            uint64_t d = cheat_search_swar_sub(a, b, h);
+            r = ~cheat_search_swar_nonzero(
+                  d ^ (plan->value * plan->low_bits), h) & h;
+            if (plan->borrow == 0)
+               r &= ~cheat_search_swar_lt(a, b, d, h);
+            else if (plan->borrow == 1)
+               r &=  cheat_search_swar_lt(a, b, d, h);
+         }
+         break;
+      case CHEAT_SEARCH_OP_NONE:
+         break;
+   }
+
+   if (plan->invert)
+      r ^= h;
+   return r;
+}
+
+static uint64_t cheat_search_block_swar(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   unsigned i;
+   uint64_t bits     = 0;
+   unsigned width    = plan->width;
+   unsigned per_word = 64 / width;
+   bool swap         = plan->big_endian && width >= 16;
+
+   /* A block of 64 items is always 'width' words */
+   for (i = 0; i < width; i++)
+   {
+      uint64_t c, p;
+      memcpy(&c, curr + i * 8, sizeof(c));
+      memcpy(&p, prev + i * 8, sizeof(p));
+      c = retro_le_to_cpu64(c);
+      p = retro_le_to_cpu64(p);
+      if (swap)
+      {
+         c = cheat_search_swar_swap(c, width);
+         p = cheat_search_swar_swap(p, width);
+      }
+      bits |= cheat_search_swar_pack(
+            cheat_search_swar_word(plan, c, p), width) << (i * per_word);
+   }
+
+   return bits;
+}
+
+#if defined(__SSE2__)
+/* Unsigned compares flip the sign bit first, SSE2
+ * only compares signed integers */
+static INLINE __m128i cheat_search_sse2_set1(uint32_t v, unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm_set1_epi8((char)v);
+      case 16:
+         return _mm_set1_epi16((short)v);
+      default:
+         break;
+   }
+   return _mm_set1_epi32((int)v);
+}
+
+static INLINE __m128i cheat_search_sse2_eq(__m128i a, __m128i b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm_cmpeq_epi8(a, b);
+      case 16:
+         return _mm_cmpeq_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_cmpeq_epi32(a, b);
+}
+
+static INLINE __m128i cheat_search_sse2_gt(__m128i a, __m128i b,
+      unsigned width)
+{
+   __m128i bias = cheat_search_sse2_set1(1U << (width - 1), width);
+   a            = _mm_xor_si128(a, bias);
+   b            = _mm_xor_si128(b, bias);
+   switch (width)
+   {
+      case 8:
+         return _mm_cmpgt_epi8(a, b);
+      case 16:
+         return _mm_cmpgt_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_cmpgt_epi32(a, b);
+}
+
+static INLINE __m128i cheat_search_sse2_sub(__m128i a, __m128i b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm_sub_epi8(a, b);
+      case 16:
+         return _mm_sub_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_sub_epi32(a, b);
+}
+
+static INLINE __m128i cheat_search_sse2_load(const cheat_search_plan_t *plan,
+      const uint8_t *s, unsigned width)
+{
+   __m128i v = _mm_loadu_si128((const __m128i*)s);
+
+   if (width > 8 && plan->big_endian)
+   {
+      if (width == 32)
+         v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v,
+                  _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+   }
+   return v;
+}
+
+static INLINE __m128i cheat_search_sse2_match(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   __m128i c = cheat_search_sse2_load(plan, curr, width);
+   __m128i p = cheat_search_sse2_load(plan, prev, width);
+   __m128i a = plan->swap ? p : c;
+   __m128i b = plan->swap ? c : p;
+   __m128i r = _mm_setzero_si128();
+
+   switch (plan->op)
+   {
+      case CHEAT_SEARCH_OP_EQ_VALUE:
+         r = cheat_search_sse2_eq(a,
+               cheat_search_sse2_set1(plan->value, width), width);
+         break;
+      case CHEAT_SEARCH_OP_EQ:
+         r = cheat_search_sse2_eq(a, b, width);
+         break;
+      case CHEAT_SEARCH_OP_GT:
+         r = cheat_search_sse2_gt(a, b, width);
+         break;
+      case CHEAT_SEARCH_OP_DIFF:
+         r = cheat_search_sse2_eq(cheat_search_sse2_sub(a, b, width),
+               cheat_search_sse2_set1(plan->value, width), width);
+         if (plan->borrow == 0)
+            r = _mm_andnot_si128(cheat_search_sse2_gt(b, a, width), r);
+         else if (plan->borrow == 1)
+            r = _mm_and_si128(cheat_search_sse2_gt(b, a, width), r);
+         break;
+      case CHEAT_SEARCH_OP_NONE:
+         break;
+   }
+
+   if (plan->invert)
+      r = _mm_xor_si128(r, _mm_set1_epi32(-1));
+   return r;
+}
+
+/* Compares 16 items */
+static INLINE unsigned cheat_search_sse2_step(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   __m128i m;
+
+   switch (width)
+   {
+      case 8:
+         m = cheat_search_sse2_match(plan, curr, prev, 8);
+         break;
+      case 16:
+         m = _mm_packs_epi16(
+               cheat_search_sse2_match(plan, curr,      prev,      16),
+               cheat_search_sse2_match(plan, curr + 16, prev + 16, 16));
+         break;
+      default:
+         m = _mm_packs_epi16(
+               _mm_packs_epi32(
+                  cheat_search_sse2_match(plan, curr,      prev,      32),
+                  cheat_search_sse2_match(plan, curr + 16, prev + 16, 32)),
+               _mm_packs_epi32(
+                  cheat_search_sse2_match(plan, curr + 32, prev + 32, 32),
+                  cheat_search_sse2_match(plan, curr + 48, prev + 48, 32)));
+         break;
+   }
+
+   return (unsigned)_mm_movemask_epi8(m);
+}
+
+static INLINE uint64_t cheat_search_block_sse2(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   unsigned i;
+   uint64_t bits = 0;
+
+   for (i = 0; i < 4; i++)
+      bits |= (uint64_t)cheat_search_sse2_step(plan,
+            curr + i * 2 * width, prev + i * 2 * width, width) << (i * 16);
+   return bits;
+}
+
+static uint64_t cheat_search_block_sse2_8(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_sse2(plan, curr, prev, 8);
+}
+
+static uint64_t cheat_search_block_sse2_16(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_sse2(plan, curr, prev, 16);
+}
+
+static uint64_t cheat_search_block_sse2_32(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_sse2(plan, curr, prev, 32);
+}
+#endif
+
+#ifdef HAVE_CHEAT_SEARCH_AVX2
+CHEAT_SEARCH_AVX2
+static INLINE __m256i cheat_search_avx2_set1(uint32_t v, unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm256_set1_epi8((char)v);
+      case 16:
+         return _mm256_set1_epi16((short)v);
+      default:
+         break;
+   }
+   return _mm256_set1_epi32((int)v);
+}
+
+CHEAT_SEARCH_AVX2
+static INLINE __m256i cheat_search_avx2_eq(__m256i a, __m256i b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm256_cmpeq_epi8(a, b);
+      case 16:
+         return _mm256_cmpeq_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm256_cmpeq_epi32(a, b);
+}
+
+CHEAT_SEARCH_AVX2
+static INLINE __m256i cheat_search_avx2_gt(__m256i a, __m256i b,
+      unsigned width)
+{
+   __m256i bias = cheat_search_avx2_set1(1U << (width - 1), width);
+   a            = _mm256_xor_si256(a, bias);
+   b            = _mm256_xor_si256(b, bias);
+   switch (width)
+   {
+      case 8:
+         return _mm256_cmpgt_epi8(a, b);
+      case 16:
+         return _mm256_cmpgt_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm256_cmpgt_epi32(a, b);
+}
+
+CHEAT_SEARCH_AVX2
+static INLINE __m256i cheat_search_avx2_sub(__m256i a, __m256i b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm256_sub_epi8(a, b);
+      case 16:
+         return _mm256_sub_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm256_sub_epi32(a, b);
+}
+
+CHEAT_SEARCH_AVX2
+static INLINE __m256i cheat_search_avx2_load(const cheat_search_plan_t *plan,
+      const uint8_t *s, unsigned width)
+{
+   __m256i v = _mm256_loadu_si256((const __m256i*)s);
+
+   if (width > 8 && plan->big_endian)
+   {
+      if (width == 16)
+         v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+                  1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                  1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+      else
+         v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+                  3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                  3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+   }
+   return v;
+}
+
+CHEAT_SEARCH_AVX2
+static INLINE __m256i cheat_search_avx2_match(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   __m256i c = cheat_search_avx2_load(plan, curr, width);
+   __m256i p = cheat_search_avx2_load(plan, prev, width);
+   __m256i a = plan->swap ? p : c;
+   __m256i b = plan->swap ? c : p;
+   __m256i r = _mm256_setzero_si256();
+
+   switch (plan->op)
+   {
+      case CHEAT_SEARCH_OP_EQ_VALUE:
+         r = cheat_search_avx2_eq(a,
+               cheat_search_avx2_set1(plan->value, width), width);
+         break;
+      case CHEAT_SEARCH_OP_EQ:
+         r = cheat_search_avx2_eq(a, b, width);
+         break;
+      case CHEAT_SEARCH_OP_GT:
+         r = cheat_search_avx2_gt(a, b, width);
+         break;
+      case CHEAT_SEARCH_OP_DIFF:
+         r = cheat_search_avx2_eq(cheat_search_avx2_sub(a, b, width),
+               cheat_search_avx2_set1(plan->value, width), width);
+         if (plan->borrow == 0)
+            r = _mm256_andnot_si256(cheat_search_avx2_gt(b, a, width), r);
+         else if (plan->borrow == 1)
+            r = _mm256_and_si256(cheat_search_avx2_gt(b, a, width), r);
+         break;
+      case CHEAT_SEARCH_OP_NONE:
+         break;
+   }
+
+   if (plan->invert)
+      r = _mm256_xor_si256(r, _mm256_set1_epi32(-1));
+   return r;
+}
+
+/* Compares 32 items. The packs work within 128-bit
+ * lanes, the permutes put the items back in order. */
+CHEAT_SEARCH_AVX2
+static INLINE uint32_t cheat_search_avx2_step(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   __m256i m;
+
+   switch (width)
+   {
+      case 8:
+         m = cheat_search_avx2_match(plan, curr, prev, 8);
+         break;
+      case 16:
+         m = _mm256_permute4x64_epi64(_mm256_packs_epi16(
+                  cheat_search_avx2_match(plan, curr,      prev,      16),
+                  cheat_search_avx2_match(plan, curr + 32, prev + 32, 16)),
+               _MM_SHUFFLE(3, 1, 2, 0));
+         break;
+      default:
+         {
+            __m256i lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+                     cheat_search_avx2_match(plan, curr,      prev,      32),
+                     cheat_search_avx2_match(plan, curr + 32, prev + 32, 32)),
+                  _MM_SHUFFLE(3, 1, 2, 0));
+            __m256i hi = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+                     cheat_search_avx2_match(plan, curr + 64, prev + 64, 32),
+                     cheat_search_avx2_match(plan, curr + 96, prev + 96, 32)),
+                  _MM_SHUFFLE(3, 1, 2, 0));
+            m = _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi),
+                  _MM_SHUFFLE(3, 1, 2, 0));
+         }
+         break;
+   }
+
+   return (uint32_t)_mm256_movemask_epi8(m);
+}
+
+CHEAT_SEARCH_AVX2
+static INLINE uint64_t cheat_search_block_avx2(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   return (uint64_t)cheat_search_avx2_step(plan, curr, prev, width)
+      | ((uint64_t)cheat_search_avx2_step(plan,
+               curr + 4 * width, prev + 4 * width, width) << 32);
+}
+
+CHEAT_SEARCH_AVX2
+static uint64_t cheat_search_block_avx2_8(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_avx2(plan, curr, prev, 8);
+}
+
+CHEAT_SEARCH_AVX2
+static uint64_t cheat_search_block_avx2_16(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_avx2(plan, curr, prev, 16);
+}
+
+CHEAT_SEARCH_AVX2
+static uint64_t cheat_search_block_avx2_32(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_avx2(plan, curr, prev, 32);
+}
+#endif
+
+#ifdef HAVE_CHEAT_SEARCH_NEON
+/* NEON compares unsigned integers directly, the lanes
+ * are kept as bytes and reinterpreted per width */
+static INLINE uint8x16_t cheat_search_neon_set1(uint32_t v, unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return vdupq_n_u8((uint8_t)v);
+      case 16:
+         return vreinterpretq_u8_u16(vdupq_n_u16((uint16_t)v));
+      default:
+         break;
+   }
+   return vreinterpretq_u8_u32(vdupq_n_u32(v));
+}
+
+static INLINE uint8x16_t cheat_search_neon_eq(uint8x16_t a, uint8x16_t b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return vceqq_u8(a, b);
+      case 16:
+         return vreinterpretq_u8_u16(vceqq_u16(
+                  vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+      default:
+         break;
+   }
+   return vreinterpretq_u8_u32(vceqq_u32(
+            vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+}
+
+static INLINE uint8x16_t cheat_search_neon_gt(uint8x16_t a, uint8x16_t b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return vcgtq_u8(a, b);
+      case 16:
+         return vreinterpretq_u8_u16(vcgtq_u16(
+                  vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+      default:
+         break;
+   }
+   return vreinterpretq_u8_u32(vcgtq_u32(
+            vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+}
+
+static INLINE uint8x16_t cheat_search_neon_sub(uint8x16_t a, uint8x16_t b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return vsubq_u8(a, b);
+      case 16:
+         return vreinterpretq_u8_u16(vsubq_u16(
+                  vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+      default:
+         break;
+   }
+   return vreinterpretq_u8_u32(vsubq_u32(
+            vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+}
+
+static INLINE uint8x16_t cheat_search_neon_load(const cheat_search_plan_t *plan,
+      const uint8_t *s, unsigned width)
+{
+   uint8x16_t v = vld1q_u8(s);
+
+   if (width > 8 && plan->big_endian)
+      v = (width == 16) ? vrev16q_u8(v) : vrev32q_u8(v);
+   return v;
+}
+
+static INLINE uint8x16_t cheat_search_neon_match(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   uint8x16_t c = cheat_search_neon_load(plan, curr, width);
+   uint8x16_t p = cheat_search_neon_load(plan, prev, width);
+   uint8x16_t a = plan->swap ? p : c;
+   uint8x16_t b = plan->swap ? c : p;
+   uint8x16_t r = vdupq_n_u8(0);
+
+   switch (plan->op)
+   {
+      case CHEAT_SEARCH_OP_EQ_VALUE:
+         r = cheat_search_neon_eq(a,
+               cheat_search_neon_set1(plan->value, width), width);
+         break;
+      case CHEAT_SEARCH_OP_EQ:
+         r = cheat_search_neon_eq(a, b, width);
+         break;
+      case CHEAT_SEARCH_OP_GT:
+         r = cheat_search_neon_gt(a, b, width);
+         break;
+      case CHEAT_SEARCH_OP_DIFF:
+         r = cheat_search_neon_eq(cheat_search_neon_sub(a, b, width),
+               cheat_search_neon_set1(plan->value, width), width);
+         if (plan->borrow == 0)
+            r = vbicq_u8(r, cheat_search_neon_gt(b, a, width));
+         else if (plan->borrow == 1)
+            r = vandq_u8(r, cheat_search_neon_gt(b, a, width));
+         break;
+      case CHEAT_SEARCH_OP_NONE:
+         break;
+   }
+
+   if (plan->invert)
+      r = vmvnq_u8(r);
+   return r;
+}
+
+/* Narrows 8 items of 16 or 4 items of 32 bits to bytes */
+static INLINE uint8x8_t cheat_search_neon_narrow(uint8x16_t m,
+      unsigned width)
+{
+   return (width == 16)
+      ? vmovn_u16(vreinterpretq_u16_u8(m))
+      : vmovn_u16(vcombine_u16(vmovn_u32(vreinterpretq_u32_u8(m)),
+               vdup_n_u16(0)));
+}
+
+/* Compares 16 items */
+static INLINE unsigned cheat_search_neon_step(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   static const uint8_t weights[16] = {
+      1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+   uint8x16_t m;
+
+   switch (width)
+   {
+      case 8:
+         m = cheat_search_neon_match(plan, curr, prev, 8);
+         break;
+      case 16:
+         m = vcombine_u8(
+               cheat_search_neon_narrow(cheat_search_neon_match(
+                     plan, curr,      prev,      16), 16),
+               cheat_search_neon_narrow(cheat_search_neon_match(
+                     plan, curr + 16, prev + 16, 16), 16));
+         break;
+      default:
+         {
+            uint8x8_t m0 = cheat_search_neon_narrow(cheat_search_neon_match(
+                     plan, curr,      prev,      32), 32);
+            uint8x8_t m1 = cheat_search_neon_narrow(cheat_search_neon_match(
+                     plan, curr + 16, prev + 16, 32), 32);
+            uint8x8_t m2 = cheat_search_neon_narrow(cheat_search_neon_match(
+                     plan, curr + 32, prev + 32, 32), 32);
+            uint8x8_t m3 = cheat_search_neon_narrow(cheat_search_neon_match(
+                     plan, curr + 48, prev + 48, 32), 32);
+            /* Each holds 4 items in its low half */
+            m = vcombine_u8(
+                  vreinterpret_u8_u32(vzip1_u32(
+                        vreinterpret_u32_u8(m0), vreinterpret_u32_u8(m1))),
+                  vreinterpret_u8_u32(vzip1_u32(
+                        vreinterpret_u32_u8(m2), vreinterpret_u32_u8(m3))));
+         }
+         break;
+   }
+
+   m = vandq_u8(m, vld1q_u8(weights));
+   return (unsigned)vaddv_u8(vget_low_u8(m))
+      | ((unsigned)vaddv_u8(vget_high_u8(m)) << 8);
+}
+
+static INLINE uint64_t cheat_search_block_neon(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev, unsigned width)
+{
+   unsigned i;
+   uint64_t bits = 0;
+
+   for (i = 0; i < 4; i++)
+      bits |= (uint64_t)cheat_search_neon_step(plan,
+            curr + i * 2 * width, prev + i * 2 * width, width) << (i * 16);
+   return bits;
+}
+
+static uint64_t cheat_search_block_neon_8(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_neon(plan, curr, prev, 8);
+}
+
+static uint64_t cheat_search_block_neon_16(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_neon(plan, curr, prev, 16);
+}
+
+static uint64_t cheat_search_block_neon_32(const cheat_search_plan_t *plan,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_search_block_neon(plan, curr, prev, 32);
+}
+#endif
+
+/* Items below a byte are always left to the SWAR
+ * kernel, it already handles 8 to 64 per word */
+static cheat_search_block_t cheat_search_get_block(unsigned width)
+{
+#ifdef HAVE_CHEAT_SEARCH_AVX2
+   uint64_t cpu = cpu_features_get();
+#endif
+
+   if (width < 8)
+      return cheat_search_block_swar;
+
+#ifdef HAVE_CHEAT_SEARCH_AVX2
+   /* AVX2 is reported even when the OS doesn't save the
+    * upper halves of the registers, check for AVX too */
+   if ((cpu & RETRO_SIMD_AVX) && (cpu & RETRO_SIMD_AVX2))
+      return (width == 8)  ? cheat_search_block_avx2_8
+           : (width == 16) ? cheat_search_block_avx2_16
+           :                 cheat_search_block_avx2_32;
+#endif
+#if defined(__SSE2__)
+   return (width == 8)  ? cheat_search_block_sse2_8
+        : (width == 16) ? cheat_search_block_sse2_16
+        :                 cheat_search_block_sse2_32;
+#elif defined(HAVE_CHEAT_SEARCH_NEON)
+   return (width == 8)  ? cheat_search_block_neon_8
+        : (width == 16) ? cheat_search_block_neon_16
+        :                 cheat_search_block_neon_32;
+#else
+   return cheat_search_block_swar;
+#endif
+}
+
+static INLINE uint64_t cheat_search_load_bits(const uint8_t *s, size_t len)
+{
+   uint64_t v = 0;
+   memcpy(&v, s, len);
+   return retro_le_to_cpu64(v);
+}
+
+static INLINE void cheat_search_store_bits(uint8_t *s, size_t len,
+      uint64_t bits)
+{
+   uint64_t v = retro_cpu_to_le64(bits);
+   memcpy(s, &v, len);
+}
+
+/* Compares a block that doesn't sit in one region or
+ * is cut short by the end of memory, from a padded copy */
+static uint64_t cheat_search_gather_block(const cheat_search_ctx_t *ctx,
+      size_t start, size_t len, unsigned region, size_t region_start)
+{
+   uint8_t curr[CHEAT_SEARCH_BLOCK_MAX_SIZE];
+   uint8_t prev[CHEAT_SEARCH_BLOCK_MAX_SIZE];
+   size_t copied = 0;
+
+   memset(curr, 0, sizeof(curr));
+   memset(prev, 0, sizeof(prev));
+   memcpy(prev, ctx->prev + start, len);
+
+   for (; copied < len && region < ctx->num_bufs; region++)
+   {
+      size_t pos   = start + copied;
+      size_t chunk = region_start + ctx->sizes[region] - pos;
+      if (chunk > len - copied)
+         chunk = len - copied;
+      memcpy(curr + copied,
+            ctx->bufs[region] + (pos - region_start), chunk);
+      copied       += chunk;
+      region_start += ctx->sizes[region];
+   }
+
+   return ctx->block(&ctx->plan, curr, prev);
+}
+
+static void cheat_search_run(void *data)
+{
+   size_t block;
+   cheat_search_job_t      *job = (cheat_search_job_t*)data;
+   const cheat_search_ctx_t *ctx = job->ctx;
+   unsigned width               = ctx->plan.width;
+   unsigned region              = 0;
+   size_t region_start          = 0;
+   size_t matches               = 0;
+
+   for (block = job->first_block; block < job->last_block; block++)
+   {
+      uint64_t bits;
+      size_t item   = block * CHEAT_SEARCH_BLOCK_ITEMS;
+      size_t n      = MIN(CHEAT_SEARCH_BLOCK_ITEMS, ctx->num_items - item);
+      size_t start  = (item / 8) * width;
+      size_t len    = (n * width + 7) / 8;
+      size_t nbytes = (n + 7) / 8;
+      uint8_t *set  = ctx->matches + item / 8;
+      uint64_t old  = cheat_search_load_bits(set, nbytes);
+
+      if (n < CHEAT_SEARCH_BLOCK_ITEMS)
+         old &= (UINT64_C(1) << n) - 1;
+
+      /* Later steps mostly skip over memory that
+       * has no candidates left */
+      if (!old)
+         continue;
+
+      while (     region < ctx->num_bufs
+            && start >= region_start + ctx->sizes[region])
+         region_start += ctx->sizes[region++];
+
+      if (     n == CHEAT_SEARCH_BLOCK_ITEMS
+            && start + len <= region_start + ctx->sizes[region])
+         bits = ctx->block(&ctx->plan,
+               ctx->bufs[region] + (start - region_start),
+               ctx->prev + start);
+      else
+         bits = cheat_search_gather_block(ctx, start, len,
+               region, region_start);
+
+      bits &= old;
+      if (bits != old)
+         cheat_search_store_bits(set, nbytes, bits);
+      matches += cheat_search_popcount(bits);
+   }
+
+   job->matches = matches;
+}
+
+size_t cheat_search_num_items(size_t memory_size, unsigned bit_size)
+{
+   if (bit_size > 5)
+      return 0;
+   return (memory_size * 8) >> bit_size;
+}
+
+size_t cheat_search_matches_size(size_t num_items)
+{
+   return (num_items + 7) / 8;
+}
+
+void cheat_search_reset(uint8_t *matches, size_t num_items)
+{
+   memset(matches, 0xFF, num_items / 8);
+   if (num_items & 7)
+      matches[num_items / 8] = (uint8_t)((1 << (num_items & 7)) - 1);
+}
+
+void cheat_search_clear_match(uint8_t *matches, size_t item)
+{
+   matches[item / 8] &= (uint8_t)~(1 << (item & 7));
+}
+
+size_t cheat_search_next_match(const uint8_t *matches,
+      size_t num_items, size_t item)
+{
+   while (item < num_items)
+   {
+      unsigned bits = matches[item / 8] >> (item & 7);
+
+      if (bits)
+      {
+         item += compat_ctz(bits);
+         return (item < num_items) ? item : num_items;
+      }
+
+      item = (item | 7) + 1;
+   }
+
+   return num_items;
+}
+
+size_t cheat_search_nth_match(const uint8_t *matches,
+      size_t num_items, size_t n)
+{
+   size_t item = 0;
+
+   /* Skip whole words of the set while n is past them */
+   while (item + 64 <= num_items)
+   {
+      unsigned count = cheat_search_popcount(
+            cheat_search_load_bits(matches + item / 8, 8));
+      if (n < count)
+         break;
+      n    -= count;
+      item += 64;
+   }
+
+   for (  item = cheat_search_next_match(matches, num_items, item);
+          item < num_items;
+          item = cheat_search_next_match(matches, num_items, item + 1))
+      if (!n--)
+         break;
+
+   return item;
+}
+
+size_t cheat_search_refine(uint8_t *matches,
+      uint8_t *const *bufs, const unsigned *sizes, unsigned num_bufs,
+      const uint8_t *prev, unsigned bit_size, bool big_endian,
+      enum cheat_search_type type, unsigned value)
+{
+   unsigned i;
+   cheat_search_ctx_t ctx;
+   cheat_search_job_t jobs[CHEAT_SEARCH_MAX_THREADS];
+   size_t num_blocks;
+   size_t total_size = 0;
+   size_t matched    = 0;
+   unsigned num_jobs = 1;
+
+   for (i = 0; i < num_bufs; i++)
+      total_size    += sizes[i];
+
+   if (!(ctx.num_items = cheat_search_num_items(total_size, bit_size)))
+      return 0;
+
+   cheat_search_plan_init(&ctx.plan, bit_size, big_endian, type, value);
+
+   if (ctx.plan.op == CHEAT_SEARCH_OP_NONE)
+   {
+      memset(matches, 0, cheat_search_matches_size(ctx.num_items));
+      return 0;
+   }
+
+   ctx.block         = cheat_search_get_block(ctx.plan.width);
+   ctx.matches       = matches;
+   ctx.bufs          = bufs;
+   ctx.sizes         = sizes;
+   ctx.num_bufs      = num_bufs;
+   ctx.prev          = prev;
+   num_blocks        = (ctx.num_items + CHEAT_SEARCH_BLOCK_ITEMS - 1)
+      / CHEAT_SEARCH_BLOCK_ITEMS;
+
+#ifdef HAVE_THREADS
+   if (total_size >= CHEAT_SEARCH_THREAD_MIN_SIZE)
+   {
+      num_jobs = cpu_features_get_core_amount();
+      if (num_jobs > CHEAT_SEARCH_MAX_THREADS)
+         num_jobs = CHEAT_SEARCH_MAX_THREADS;
+      else if (num_jobs < 1)
+         num_jobs = 1;
+   }
+#endif
+
+   /* Jobs cover whole blocks, so they never
+    * write to the same bytes of the set */
+   for (i = 0; i < num_jobs; i++)
+   {
+      jobs[i].ctx         = &ctx;
+      jobs[i].first_block = num_blocks *  i      / num_jobs;
+      jobs[i].last_block  = num_blocks * (i + 1) / num_jobs;
+      jobs[i].matches     = 0;
+   }
+
+#ifdef HAVE_THREADS
+   if (num_jobs > 1)
+   {
+      tpool_t *pool = tpool_create(num_jobs - 1);
+
+      if (pool)
+      {
+         /* The calling thread takes the first job */
+         for (i = 1; i < num_jobs; i++)
+            if (!tpool_add_work(pool, cheat_search_run, &jobs[i]))
+               cheat_search_run(&jobs[i]);
+         cheat_search_run(&jobs[0]);
+         tpool_wait(pool);
+         tpool_destroy(pool);
+
+         for (i = 0; i < num_jobs; i++)
+            matched += jobs[i].matches;
+         return matched;
+      }
+
+      jobs[0].last_block = num_blocks;
+   }
+#endif
+
+   cheat_search_run(&jobs[0]);
+   return jobs[0].matches;
+}
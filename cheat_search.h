@@ -0,0 +1,131 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CHEAT_SEARCH_H
+#define __CHEAT_SEARCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+enum cheat_search_type
+{
+   CHEAT_SEARCH_TYPE_EXACT = 0,
+   CHEAT_SEARCH_TYPE_LT,
+   CHEAT_SEARCH_TYPE_LTE,
+   CHEAT_SEARCH_TYPE_GT,
+   CHEAT_SEARCH_TYPE_GTE,
+   CHEAT_SEARCH_TYPE_EQ,
+   CHEAT_SEARCH_TYPE_NEQ,
+   CHEAT_SEARCH_TYPE_EQPLUS,
+   CHEAT_SEARCH_TYPE_EQMINUS
+};
+
+/* The candidates of a cheat search are a bitset with one bit
+ * per item of (1 << bit_size) bits, in address order. Items
+ * smaller than a byte start at its lowest bits, so with a
+ * bit_size of 2 item 5 is bits 2-3 of the second byte.
+ * Bit n of the set is bit (n & 7) of byte (n >> 3). */
+
+/**
+ * cheat_search_num_items:
+ * @memory_size         : Size of the searched memory in bytes.
+ * @bit_size            : Item size, 0 (1 bit) to 5 (32 bits).
+ *
+ * Returns: number of items in @memory_size bytes. A partial
+ * item at the end of the memory is not searched.
+ **/
+size_t cheat_search_num_items(size_t memory_size, unsigned bit_size);
+
+/**
+ * cheat_search_matches_size:
+ * @num_items           : Number of items.
+ *
+ * Returns: size in bytes of a candidate set of @num_items.
+ **/
+size_t cheat_search_matches_size(size_t num_items);
+
+/**
+ * cheat_search_reset:
+ * @matches             : Candidate set.
+ * @num_items           : Number of items.
+ *
+ * Makes every item a candidate again.
+ **/
+void cheat_search_reset(uint8_t *matches, size_t num_items);
+
+/**
+ * cheat_search_clear_match:
+ * @matches             : Candidate set.
+ * @item                : Item to remove.
+ **/
+void cheat_search_clear_match(uint8_t *matches, size_t item);
+
+/**
+ * cheat_search_next_match:
+ * @matches             : Candidate set.
+ * @num_items           : Number of items.
+ * @item                : First item to look at.
+ *
+ * Returns: the first candidate at or after @item,
+ * or @num_items if there is none.
+ **/
+size_t cheat_search_next_match(const uint8_t *matches,
+      size_t num_items, size_t item);
+
+/**
+ * cheat_search_nth_match:
+ * @matches             : Candidate set.
+ * @num_items           : Number of items.
+ * @n                   : Index among the candidates, from 0.
+ *
+ * Returns: the @n-th candidate, or @num_items
+ * if there are fewer candidates.
+ **/
+size_t cheat_search_nth_match(const uint8_t *matches,
+      size_t num_items, size_t n);
+
+/**
+ * cheat_search_refine:
+ * @matches             : Candidate set to refine.
+ * @bufs                : Memory regions, searched as one
+ *                        contiguous address space.
+ * @sizes               : Size of each region.
+ * @num_bufs            : Number of regions.
+ * @prev                : Copy of all regions from the last step.
+ * @bit_size            : Item size, 0 (1 bit) to 5 (32 bits).
+ * @big_endian          : Whether 16 and 32-bit items are big endian.
+ * @type                : Comparison to keep candidates by.
+ * @value               : Value for CHEAT_SEARCH_TYPE_EXACT,
+ *                        _EQPLUS and _EQMINUS.
+ *
+ * Removes every candidate whose current value doesn't
+ * compare to its previous value (or @value) as @type asks.
+ * Large searches are split across threads.
+ *
+ * Returns: number of candidates left.
+ **/
+size_t cheat_search_refine(uint8_t *matches,
+      uint8_t *const *bufs, const unsigned *sizes, unsigned num_bufs,
+      const uint8_t *prev, unsigned bit_size, bool big_endian,
+      enum cheat_search_type type, unsigned value);
+
+RETRO_END_DECLS
+
+#endif
@@ -484,6 +484,11 @@
 #define DEFAULT_SHADER_ENABLE false
 #endif
 
+/* Should the network video driver send deflated
+ * tile deltas instead of raw frames? Off by default,
+ * receivers of the raw protocol can't read the stream. */
+#define DEFAULT_VIDEO_NETWORK_STREAM false
+
 /* Should we enable hdr when its supported*/
 #define DEFAULT_VIDEO_HDR_ENABLE false
 
@@ -949,6 +954,10 @@
 
 #define DEFAULT_LOG_TO_FILE_TIMESTAMP false
 
+/* Write log messages on a separate thread, so
+ * logging doesn't stall the thread that logs. */
+#define DEFAULT_LOG_ASYNC false
+
 /* Crop overscanned frames. */
 #define DEFAULT_CROP_OVERSCAN true
 
@@ -1269,6 +1278,10 @@
 #define DEFAULT_REWIND_GRANULARITY 1
 #endif
 
+/* Keeps older rewind history compressed in half of the
+ * rewind buffer instead of discarding it. */
+#define DEFAULT_REWIND_COMPRESS_HISTORY true
+
 /* Pause gameplay when window loses focus. */
 #if defined(EMSCRIPTEN)
 #define DEFAULT_PAUSE_NONACTIVE false
@@ -1397,6 +1410,11 @@
 #define DEFAULT_SAVESTATE_FILE_COMPRESSION true
 #endif
 
+/* When compressing save state files, use zstd
+ * instead of zlib. Off by default: builds without
+ * zstd can't load the resulting files */
+#define DEFAULT_SAVESTATE_FILE_COMPRESSION_ZSTD false
+
 /* Slowmotion ratio. */
 #define DEFAULT_SLOWMOTION_RATIO 3.0f
 
@@ -1450,6 +1468,10 @@
 #define DEFAULT_NETWORK_ON_DEMAND_THUMBNAILS false
 #endif
 
+/* Number of thumbnails fetched at once when
+ * downloading the thumbnails of a playlist */
+#define DEFAULT_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS 4
+
 /* Number of entries that will be kept in content history playlist file. */
 #define DEFAULT_CONTENT_HISTORY_SIZE 200
 
@@ -1466,6 +1488,10 @@
 /* When creating/updating playlists, compress written data */
 #define DEFAULT_PLAYLIST_COMPRESSION false
 
+/* Keep a binary copy of each playlist next to it,
+ * which loads faster than the playlist itself */
+#define DEFAULT_PLAYLIST_BINARY_CACHE false
+
 #ifdef HAVE_MENU
 /* Specify when to display 'core name' inline on playlist entries */
 #define DEFAULT_PLAYLIST_SHOW_INLINE_CORE_NAME PLAYLIST_INLINE_CORE_DISPLAY_HIST_FAV
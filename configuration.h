@@ -351,6 +351,7 @@ typedef struct settings
       unsigned ai_service_source_lang;
 
       unsigned core_updater_auto_backup_history_size;
+      unsigned network_concurrent_thumbnail_downloads;
       unsigned video_black_frame_insertion;
       unsigned video_bfi_dark_frames;
       unsigned video_shader_subframes;
@@ -618,6 +619,7 @@ typedef struct settings
       bool video_post_filter_record;
       bool video_gpu_record;
       bool video_gpu_screenshot;
+      bool video_network_stream;
       bool video_allow_rotate;
       bool video_shared_context;
       bool video_force_srgb_disable;
@@ -963,6 +965,7 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_compress_history;
       bool fastforward_frameskip;
       bool vrr_runloop_enable;
       bool menu_throttle_framerate;
@@ -983,6 +986,7 @@ typedef struct settings
       bool savestate_thumbnail_enable;
       bool save_file_compression;
       bool savestate_file_compression;
+      bool savestate_file_compression_zstd;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
       bool keymapper_enable;
@@ -1035,6 +1039,7 @@ typedef struct settings
       bool sustained_performance_mode;
       bool playlist_use_old_format;
       bool playlist_compression;
+      bool playlist_binary_cache;
       bool content_runtime_log;
       bool content_runtime_log_aggregate;
 
@@ -1055,6 +1060,7 @@ typedef struct settings
 
       bool log_to_file;
       bool log_to_file_timestamp;
+      bool log_async;
 
       bool scan_without_core_match;
       bool scan_serial_and_crc;
@@ -2517,6 +2517,14 @@ VALGRIND_PRINTF_BACKTRACE("SIGINT");
    if (unix_sighandler_quit >= 3) abort();
 }
 
+/* Writes out queued log messages, then dies of
+ * the signal as it would have without the handler */
+static void frontend_unix_crash_sighandler(int sig)
+{
+   verbosity_flush();
+   raise(sig);
+}
+
 static void frontend_unix_install_signal_handlers(void)
 {
    struct sigaction sa;
@@ -2527,6 +2535,14 @@ static void frontend_unix_install_signal_handlers(void)
    sigemptyset(&sa.sa_mask);
    sigaction(SIGINT, &sa, NULL);
    sigaction(SIGTERM, &sa, NULL);
+
+   sa.sa_handler   = frontend_unix_crash_sighandler;
+   sa.sa_flags     = SA_RESETHAND | SA_NODEFER;
+   sigaction(SIGABRT, &sa, NULL);
+   sigaction(SIGBUS,  &sa, NULL);
+   sigaction(SIGFPE,  &sa, NULL);
+   sigaction(SIGILL,  &sa, NULL);
+   sigaction(SIGSEGV, &sa, NULL);
 }
 
 static int frontend_unix_get_signal_handler_state(void)
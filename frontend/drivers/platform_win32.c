@@ -426,6 +426,14 @@ static void frontend_win32_get_os(char *s, size_t len, int *major, int *minor)
    }
 }
 
+/* Writes out queued log messages before the
+ * crash is handled as it would have been */
+static LONG WINAPI frontend_win32_crash_filter(EXCEPTION_POINTERS *info)
+{
+   verbosity_flush();
+   return EXCEPTION_CONTINUE_SEARCH;
+}
+
 static void frontend_win32_init(void *data)
 {
    typedef BOOL (WINAPI *isProcessDPIAwareProc)();
@@ -446,6 +454,8 @@ static void frontend_win32_init(void *data)
       if (!isDPIAwareProc())
          if (setDPIAwareProc)
             setDPIAwareProc();
+
+   SetUnhandledExceptionFilter(frontend_win32_crash_filter);
 }
 
 
@@ -19,7 +19,43 @@
 #include "../../config.h"
 #endif
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <glsym/glsym.h>
+#include <retro_miscellaneous.h>
+
+#include "gl_common.h"
+#include "../drivers_shader/shader_cache.h"
+#include "../../configuration.h"
+
+#if (defined(HAVE_OPENGL) || defined(HAVE_OPENGL_CORE)) && (defined(HAVE_GLSL) || defined(HAVE_SLANG))
+#if defined(HAVE_OPENGLES2)
+#ifdef GL_PROGRAM_BINARY_LENGTH_OES
+#define HAVE_GL_PROGRAM_CACHE
+#define GL_PROGRAM_CACHE_LOOKUP_SYMBOLS
+#define gl_program_cache_get_binary   glGetProgramBinaryOES
+#define gl_program_cache_binary       glProgramBinaryOES
+#define GL_PROGRAM_CACHE_LENGTH       GL_PROGRAM_BINARY_LENGTH_OES
+#define GL_PROGRAM_CACHE_NUM_FORMATS  GL_NUM_PROGRAM_BINARY_FORMATS_OES
+#endif
+#elif !defined(HAVE_PSGL)
+#ifdef GL_PROGRAM_BINARY_LENGTH
+#define HAVE_GL_PROGRAM_CACHE
+#ifndef HAVE_OPENGLES3
+#define GL_PROGRAM_CACHE_LOOKUP_SYMBOLS
+#endif
+#define gl_program_cache_get_binary   glGetProgramBinary
+#define gl_program_cache_binary       glProgramBinary
+#define GL_PROGRAM_CACHE_LENGTH       GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_CACHE_NUM_FORMATS  GL_NUM_PROGRAM_BINARY_FORMATS
+#endif
+#endif
+#endif
+
+/* Size limit of the program binary cache */
+#define GL_PROGRAM_CACHE_MAX_SIZE (64 * 1024 * 1024)
 
 void gl_flush(void)
 {
@@ -47,3 +83,153 @@ void gl_finish(void)
 {
    glFinish();
 }
+
+#ifdef HAVE_GL_PROGRAM_CACHE
+static bool gl_program_cache_dir(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+   return shader_cache_dir(s, len,
+         settings->paths.directory_cache, "gl");
+}
+#endif
+
+bool gl_program_cache_key(char *key, const char **sources, size_t count)
+{
+#ifdef HAVE_GL_PROGRAM_CACHE
+   char salt[1024];
+   size_t i;
+   size_t len           = 0;
+   size_t pos           = 0;
+   GLint formats        = 0;
+   char *data           = NULL;
+   settings_t *settings = config_get_ptr();
+   const char *vendor   = (const char*)glGetString(GL_VENDOR);
+   const char *renderer = (const char*)glGetString(GL_RENDERER);
+   const char *version  = (const char*)glGetString(GL_VERSION);
+
+   if (!settings || !*settings->paths.directory_cache)
+      return false;
+
+#ifdef GL_PROGRAM_CACHE_LOOKUP_SYMBOLS
+   if (!gl_program_cache_get_binary || !gl_program_cache_binary)
+      return false;
+#endif
+
+   /* Older contexts do not know the enum and leave
+    * formats alone, which means no binaries either */
+   glGetIntegerv(GL_PROGRAM_CACHE_NUM_FORMATS, &formats);
+   if (formats <= 0)
+   {
+      glGetError();
+      return false;
+   }
+
+   snprintf(salt, sizeof(salt), "%s\n%s\n%s",
+         vendor   ? vendor   : "",
+         renderer ? renderer : "",
+         version  ? version  : "");
+
+   /* Keep the terminators, so that the sources
+    * cannot run into each other */
+   for (i = 0; i < count; i++)
+      len += strlen(sources[i]) + 1;
+
+   if (!(data = (char*)malloc(len + 1)))
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      size_t _len = strlen(sources[i]) + 1;
+      memcpy(data + pos, sources[i], _len);
+      pos        += _len;
+   }
+
+   shader_cache_key(key, salt, data, len);
+   free(data);
+   return *key != '\0';
+#else
+   return false;
+#endif
+}
+
+bool gl_program_cache_load(unsigned prog, const char *key)
+{
+#ifdef HAVE_GL_PROGRAM_CACHE
+   char dir[PATH_MAX_LENGTH];
+   GLenum format;
+   GLint status = GL_FALSE;
+   size_t len   = 0;
+   void *blob   = NULL;
+
+   if (     !gl_program_cache_dir(dir, sizeof(dir))
+         || !(blob = shader_cache_load(dir, key, &len)))
+      return false;
+
+   /* Blobs are the binary format followed by the binary */
+   if (len > sizeof(uint32_t))
+   {
+      uint32_t _format;
+      memcpy(&_format, blob, sizeof(_format));
+      format = (GLenum)_format;
+
+      gl_program_cache_binary((GLuint)prog, format,
+            (const uint8_t*)blob + sizeof(uint32_t),
+            (GLsizei)(len - sizeof(uint32_t)));
+      glGetProgramiv((GLuint)prog, GL_LINK_STATUS, &status);
+
+      /* A driver update can invalidate binaries without
+       * changing the version string, just recompile */
+      if (status != GL_TRUE)
+         glGetError();
+   }
+
+   free(blob);
+   return status == GL_TRUE;
+#else
+   return false;
+#endif
+}
+
+void gl_program_cache_set_retrievable(unsigned prog)
+{
+#if defined(HAVE_GL_PROGRAM_CACHE) && defined(GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+#ifdef GL_PROGRAM_CACHE_LOOKUP_SYMBOLS
+   if (!glProgramParameteri)
+      return;
+#endif
+   glProgramParameteri((GLuint)prog,
+         GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+}
+
+void gl_program_cache_store(unsigned prog, const char *key)
+{
+#ifdef HAVE_GL_PROGRAM_CACHE
+   char dir[PATH_MAX_LENGTH];
+   uint32_t _format;
+   GLenum format    = 0;
+   GLsizei written  = 0;
+   GLint len        = 0;
+   uint8_t *blob    = NULL;
+
+   glGetProgramiv((GLuint)prog, GL_PROGRAM_CACHE_LENGTH, &len);
+
+   if (     len <= 0
+         || !gl_program_cache_dir(dir, sizeof(dir))
+         || !(blob = (uint8_t*)malloc(sizeof(uint32_t) + len)))
+      return;
+
+   gl_program_cache_get_binary((GLuint)prog, len, &written,
+         &format, blob + sizeof(uint32_t));
+
+   if (written > 0)
+   {
+      _format = (uint32_t)format;
+      memcpy(blob, &_format, sizeof(_format));
+      if (shader_cache_store(dir, key, blob, sizeof(uint32_t) + written))
+         shader_cache_trim(dir, GL_PROGRAM_CACHE_MAX_SIZE);
+   }
+
+   free(blob);
+#endif
+}
@@ -17,6 +17,13 @@
 #ifndef __GL_COMMON_H
 #define __GL_COMMON_H
 
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
 void gl_clear(void);
 
 void gl_enable(unsigned cap);
@@ -27,4 +34,25 @@ void gl_finish(void);
 
 void gl_flush(void);
 
+/* Program binary cache.
+ *
+ * gl_program_cache_key() hashes the sources of a program
+ * together with the GL vendor, renderer and version strings.
+ * It returns false if the context cannot hand out program
+ * binaries or no cache directory is set, in which case the
+ * program has to be compiled as usual. Otherwise,
+ * gl_program_cache_load() tries to restore the program
+ * from disk. If that fails, compile it, call
+ * gl_program_cache_set_retrievable() before linking and
+ * gl_program_cache_store() once it is linked. */
+bool gl_program_cache_key(char *key, const char **sources, size_t count);
+
+bool gl_program_cache_load(unsigned prog, const char *key);
+
+void gl_program_cache_set_retrievable(unsigned prog);
+
+void gl_program_cache_store(unsigned prog, const char *key);
+
+RETRO_END_DECLS
+
 #endif
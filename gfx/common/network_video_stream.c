@@ -0,0 +1,496 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_endianness.h>
+#include <encodings/crc32.h>
+#include <net/net_socket.h>
+#include <streams/trans_stream.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "network_video_stream.h"
+
+#include "../../verbosity.h"
+
+/* Frames waiting for the sender thread. Any more and
+ * the stream lags behind the emulation for no benefit */
+#define NETWORK_VIDEO_STREAM_QUEUE_SIZE 3
+/* Fast beats small here, the tiles are the real saving */
+#define NETWORK_VIDEO_STREAM_LEVEL      1
+#define NETWORK_VIDEO_STREAM_TIMEOUT    5000
+
+typedef struct network_video_stream_frame
+{
+   uint32_t *pixels;
+   size_t capacity;
+   unsigned width;
+   unsigned height;
+   unsigned number;
+} network_video_stream_frame_t;
+
+struct network_video_stream
+{
+   const struct trans_stream_backend *backend;
+   void *deflate;
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+#endif
+   uint32_t *reference;                  /* Last frame sent */
+   uint8_t *payload;
+   uint8_t *packet;
+   size_t payload_size;
+   size_t packet_size;
+   uint64_t raw_bytes;
+   uint64_t sent_bytes;
+   network_video_stream_frame_t queue[NETWORK_VIDEO_STREAM_QUEUE_SIZE];
+   network_video_stream_frame_t current; /* Owned by the sender */
+   int fd;
+   unsigned head;
+   unsigned count;
+   unsigned pushed;
+   unsigned sent_frames;
+   unsigned dropped;
+   unsigned ref_width;
+   unsigned ref_height;
+   bool failed;
+   bool quit;
+};
+
+static void network_video_stream_write_u16(uint8_t *s, uint16_t v)
+{
+   v = retro_cpu_to_le16(v);
+   memcpy(s, &v, sizeof(v));
+}
+
+static void network_video_stream_write_u32(uint8_t *s, uint32_t v)
+{
+   v = retro_cpu_to_le32(v);
+   memcpy(s, &v, sizeof(v));
+}
+
+static bool network_video_stream_reserve(uint8_t **buf, size_t *size,
+      size_t needed)
+{
+   uint8_t *tmp;
+   if (*size >= needed)
+      return true;
+   if (!(tmp = (uint8_t*)realloc(*buf, needed)))
+      return false;
+   *buf  = tmp;
+   *size = needed;
+   return true;
+}
+
+static bool network_video_stream_copy_frame(
+      network_video_stream_frame_t *frame, const uint32_t *pixels,
+      unsigned width, unsigned height)
+{
+   size_t len = (size_t)width * height;
+
+   if (frame->capacity < len)
+   {
+      uint32_t *tmp = (uint32_t*)realloc(frame->pixels,
+            len * sizeof(uint32_t));
+      if (!tmp)
+         return false;
+      frame->pixels   = tmp;
+      frame->capacity = len;
+   }
+
+   memcpy(frame->pixels, pixels, len * sizeof(uint32_t));
+   frame->width  = width;
+   frame->height = height;
+   return true;
+}
+
+/* Appends every tile of @frame that differs from the reference
+ * to the payload and updates the reference to match.
+ * Returns the number of tiles appended. */
+static uint32_t network_video_stream_diff(network_video_stream_t *stream,
+      const network_video_stream_frame_t *frame, bool keyframe,
+      size_t *payload_len)
+{
+   unsigned tx, ty;
+   unsigned width   = frame->width;
+   unsigned height  = frame->height;
+   unsigned tiles_x = (width  + NETWORK_VIDEO_STREAM_TILE_SIZE - 1)
+      / NETWORK_VIDEO_STREAM_TILE_SIZE;
+   unsigned tiles_y = (height + NETWORK_VIDEO_STREAM_TILE_SIZE - 1)
+      / NETWORK_VIDEO_STREAM_TILE_SIZE;
+   uint8_t *out     = stream->payload;
+   uint32_t tiles   = 0;
+
+   for (ty = 0; ty < tiles_y; ty++)
+   {
+      unsigned y0 = ty * NETWORK_VIDEO_STREAM_TILE_SIZE;
+      unsigned th = MIN(NETWORK_VIDEO_STREAM_TILE_SIZE, height - y0);
+
+      for (tx = 0; tx < tiles_x; tx++)
+      {
+         unsigned y;
+         unsigned x0      = tx * NETWORK_VIDEO_STREAM_TILE_SIZE;
+         unsigned tw      = MIN(NETWORK_VIDEO_STREAM_TILE_SIZE, width - x0);
+         size_t row_len   = tw * sizeof(uint32_t);
+         size_t ofs       = (size_t)y0 * width + x0;
+         bool changed     = keyframe;
+
+         for (y = 0; !changed && y < th; y++)
+            changed = memcmp(frame->pixels + ofs + (size_t)y * width,
+                  stream->reference + ofs + (size_t)y * width, row_len) != 0;
+
+         if (!changed)
+            continue;
+
+         network_video_stream_write_u32(out, ty * tiles_x + tx);
+         out += 4;
+
+         for (y = 0; y < th; y++)
+         {
+            const uint32_t *src = frame->pixels + ofs + (size_t)y * width;
+            memcpy(stream->reference + ofs + (size_t)y * width, src, row_len);
+#ifdef MSB_FIRST
+            {
+               unsigned x;
+               for (x = 0; x < tw; x++)
+                  network_video_stream_write_u32(out + x * 4, src[x]);
+            }
+#else
+            memcpy(out, src, row_len);
+#endif
+            out += row_len;
+         }
+
+         tiles++;
+      }
+   }
+
+   *payload_len = out - stream->payload;
+   return tiles;
+}
+
+static bool network_video_stream_send(network_video_stream_t *stream,
+      const network_video_stream_frame_t *frame, size_t *sent)
+{
+   uint32_t tiles;
+   uint32_t crc;
+   size_t max_payload;
+   size_t payload_len  = 0;
+   uint32_t packed_len = 0;
+   size_t frame_len    = (size_t)frame->width * frame->height;
+   bool keyframe       = !stream->reference
+      || stream->ref_width  != frame->width
+      || stream->ref_height != frame->height;
+
+   if (keyframe)
+   {
+      uint32_t *tmp = (uint32_t*)realloc(stream->reference,
+            frame_len * sizeof(uint32_t));
+      if (!tmp)
+         return false;
+      stream->reference  = tmp;
+      stream->ref_width  = frame->width;
+      stream->ref_height = frame->height;
+   }
+
+   /* Every tile changed, plus a tile index for each */
+   max_payload = frame_len * sizeof(uint32_t) + ((frame->width
+            / NETWORK_VIDEO_STREAM_TILE_SIZE + 1) * (frame->height
+            / NETWORK_VIDEO_STREAM_TILE_SIZE + 1)) * 4;
+
+   if (     !network_video_stream_reserve(&stream->payload,
+            &stream->payload_size, max_payload)
+         || !network_video_stream_reserve(&stream->packet,
+            &stream->packet_size, NETWORK_VIDEO_STREAM_HEADER_SIZE
+            + max_payload + max_payload / 1000 + 64))
+      return false;
+
+   tiles = network_video_stream_diff(stream, frame, keyframe, &payload_len);
+#ifdef MSB_FIRST
+   {
+      size_t i;
+      crc = 0;
+      for (i = 0; i < frame_len; i++)
+      {
+         uint8_t px[4];
+         network_video_stream_write_u32(px, stream->reference[i]);
+         crc = encoding_crc32(crc, px, sizeof(px));
+      }
+   }
+#else
+   crc   = encoding_crc32(0, (const uint8_t*)stream->reference,
+         frame_len * sizeof(uint32_t));
+#endif
+
+   if (payload_len)
+   {
+      uint32_t rd                 = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+      stream->backend->set_in(stream->deflate,
+            stream->payload, (uint32_t)payload_len);
+      stream->backend->set_out(stream->deflate,
+            stream->packet + NETWORK_VIDEO_STREAM_HEADER_SIZE,
+            (uint32_t)(stream->packet_size
+               - NETWORK_VIDEO_STREAM_HEADER_SIZE));
+
+      if (     !stream->backend->trans(stream->deflate, true,
+               &rd, &packed_len, &err)
+            || rd != payload_len
+            || err != TRANS_STREAM_ERROR_NONE)
+      {
+         RARCH_ERR("[Network]: Could not compress frame.\n");
+         return false;
+      }
+   }
+
+   network_video_stream_write_u32(stream->packet +  0, packed_len);
+   network_video_stream_write_u32(stream->packet +  4, (uint32_t)payload_len);
+   network_video_stream_write_u16(stream->packet +  8, (uint16_t)frame->width);
+   network_video_stream_write_u16(stream->packet + 10, (uint16_t)frame->height);
+   network_video_stream_write_u16(stream->packet + 12,
+         NETWORK_VIDEO_STREAM_TILE_SIZE);
+   network_video_stream_write_u16(stream->packet + 14,
+         keyframe ? NETWORK_VIDEO_STREAM_FLAG_KEYFRAME : 0);
+   network_video_stream_write_u32(stream->packet + 16, tiles);
+   network_video_stream_write_u32(stream->packet + 20, frame->number);
+   network_video_stream_write_u32(stream->packet + 24, crc);
+
+   if (!socket_send_all_blocking_with_timeout(stream->fd, stream->packet,
+            NETWORK_VIDEO_STREAM_HEADER_SIZE + packed_len,
+            NETWORK_VIDEO_STREAM_TIMEOUT, true))
+   {
+      RARCH_ERR("[Network]: Connection to host lost.\n");
+      return false;
+   }
+
+   *sent = NETWORK_VIDEO_STREAM_HEADER_SIZE + packed_len;
+   return true;
+}
+
+static void network_video_stream_sent(network_video_stream_t *stream,
+      const network_video_stream_frame_t *frame, size_t sent)
+{
+   stream->raw_bytes  += (uint64_t)frame->width
+      * frame->height * sizeof(uint32_t);
+   stream->sent_bytes += sent;
+   stream->sent_frames++;
+}
+
+#ifdef HAVE_THREADS
+static void network_video_stream_thread(void *data)
+{
+   network_video_stream_t *stream = (network_video_stream_t*)data;
+
+   for (;;)
+   {
+      network_video_stream_frame_t tmp;
+      size_t sent = 0;
+      bool ok;
+
+      slock_lock(stream->lock);
+      while (!stream->count && !stream->quit)
+         scond_wait(stream->cond, stream->lock);
+
+      if (!stream->count)
+      {
+         slock_unlock(stream->lock);
+         break;
+      }
+
+      /* Swap the buffers instead of copying, so that
+       * the frame can be sent without holding the lock */
+      tmp                            = stream->current;
+      stream->current                = stream->queue[stream->head];
+      stream->queue[stream->head]    = tmp;
+      stream->head                   = (stream->head + 1)
+         % NETWORK_VIDEO_STREAM_QUEUE_SIZE;
+      stream->count--;
+      slock_unlock(stream->lock);
+
+      ok = network_video_stream_send(stream, &stream->current, &sent);
+
+      slock_lock(stream->lock);
+      if (ok)
+         network_video_stream_sent(stream, &stream->current, sent);
+      else
+      {
+         stream->failed = true;
+         stream->count  = 0;
+      }
+      slock_unlock(stream->lock);
+
+      if (!ok)
+         break;
+   }
+}
+#endif
+
+network_video_stream_t *network_video_stream_new(int fd)
+{
+   uint8_t header[8];
+   network_video_stream_t *stream = (network_video_stream_t*)
+      calloc(1, sizeof(*stream));
+
+   if (!stream)
+      return NULL;
+
+   stream->fd      = fd;
+   stream->backend = trans_stream_get_zlib_deflate_backend();
+
+   if (!(stream->deflate = stream->backend->stream_new()))
+      goto error;
+   stream->backend->define(stream->deflate,
+         "level", NETWORK_VIDEO_STREAM_LEVEL);
+
+#ifdef HAVE_THREADS
+   if (     !(stream->lock   = slock_new())
+         || !(stream->cond   = scond_new())
+         || !(stream->thread = sthread_create(
+               network_video_stream_thread, stream)))
+      goto error;
+#endif
+
+   /* Nothing is written to the socket before this point,
+    * so the caller can still send raw frames on failure */
+   socket_set_block(fd, false);
+
+   memcpy(header, NETWORK_VIDEO_STREAM_MAGIC, 4);
+   network_video_stream_write_u32(header + 4, NETWORK_VIDEO_STREAM_VERSION);
+   if (!socket_send_all_blocking_with_timeout(fd, header, sizeof(header),
+            NETWORK_VIDEO_STREAM_TIMEOUT, true))
+   {
+      socket_set_block(fd, true);
+      goto error;
+   }
+
+   return stream;
+
+error:
+   network_video_stream_free(stream);
+   return NULL;
+}
+
+bool network_video_stream_push(network_video_stream_t *stream,
+      const uint32_t *pixels, unsigned width, unsigned height)
+{
+   bool ret = true;
+
+   if (!stream || !pixels || !width || !height)
+      return stream && !stream->failed;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+
+   if (stream->failed)
+      ret = false;
+   else
+   {
+      unsigned tail;
+
+      /* Drop the oldest frame, the newest one is the one
+       * that should reach the receiver */
+      if (stream->count == NETWORK_VIDEO_STREAM_QUEUE_SIZE)
+      {
+         stream->head = (stream->head + 1) % NETWORK_VIDEO_STREAM_QUEUE_SIZE;
+         stream->count--;
+         stream->dropped++;
+      }
+
+      tail = (stream->head + stream->count) % NETWORK_VIDEO_STREAM_QUEUE_SIZE;
+
+      if (network_video_stream_copy_frame(&stream->queue[tail],
+               pixels, width, height))
+      {
+         stream->queue[tail].number = stream->pushed;
+         stream->count++;
+         scond_signal(stream->cond);
+      }
+      else
+         stream->dropped++;
+   }
+
+   stream->pushed++;
+   slock_unlock(stream->lock);
+#else
+   if (stream->failed)
+      return false;
+
+   if (network_video_stream_copy_frame(&stream->current,
+            pixels, width, height))
+   {
+      size_t sent            = 0;
+      stream->current.number = stream->pushed;
+      if (network_video_stream_send(stream, &stream->current, &sent))
+         network_video_stream_sent(stream, &stream->current, sent);
+      else
+         stream->failed = true;
+   }
+   else
+      stream->dropped++;
+
+   stream->pushed++;
+   ret = !stream->failed;
+#endif
+
+   return ret;
+}
+
+void network_video_stream_free(network_video_stream_t *stream)
+{
+   unsigned i;
+
+   if (!stream)
+      return;
+
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_signal(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->thread);
+   }
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   if (stream->sent_frames)
+      RARCH_LOG("[Network]: Sent %u frames (%u dropped), "
+            "%.1f MB instead of %.1f MB.\n",
+            stream->sent_frames, stream->dropped,
+            stream->sent_bytes / 1000000.0,
+            stream->raw_bytes  / 1000000.0);
+
+   if (stream->deflate)
+      stream->backend->stream_free(stream->deflate);
+
+   for (i = 0; i < NETWORK_VIDEO_STREAM_QUEUE_SIZE; i++)
+      free(stream->queue[i].pixels);
+   free(stream->current.pixels);
+   free(stream->reference);
+   free(stream->payload);
+   free(stream->packet);
+   free(stream);
+}
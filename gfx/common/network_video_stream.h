@@ -0,0 +1,102 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __NETWORK_VIDEO_STREAM_H
+#define __NETWORK_VIDEO_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Streaming protocol of the network video driver.
+ *
+ * Instead of sending every frame as raw pixels, the stream
+ * only sends the tiles that changed since the last frame the
+ * receiver got, deflated with zlib. All values are little endian.
+ *
+ * The stream starts with NETWORK_VIDEO_STREAM_MAGIC and a u32
+ * NETWORK_VIDEO_STREAM_VERSION. Every frame then is a header of
+ * NETWORK_VIDEO_STREAM_HEADER_SIZE bytes:
+ *
+ *   u32 size of the deflated payload that follows
+ *   u32 size of the inflated payload
+ *   u16 width, u16 height
+ *   u16 tile size, u16 flags
+ *   u32 number of tiles in the payload
+ *   u32 frame number, counting the frames that were dropped
+ *   u32 crc32 of the whole frame once the tiles are applied
+ *
+ * The inflated payload is a list of tiles, each a u32 tile index
+ * (row major, tiles_x * tile_y + tile_x) followed by its pixels,
+ * row by row. Tiles on the right and bottom edges are cut to the
+ * frame size. Pixels are 32-bit XRGB8888, like in the raw mode.
+ *
+ * A keyframe (NETWORK_VIDEO_STREAM_FLAG_KEYFRAME) carries every
+ * tile and is sent first and whenever the frame size changes.
+ * A frame without changes has no payload at all. */
+
+#define NETWORK_VIDEO_STREAM_MAGIC          "RANV"
+#define NETWORK_VIDEO_STREAM_VERSION        1
+#define NETWORK_VIDEO_STREAM_HEADER_SIZE    28
+#define NETWORK_VIDEO_STREAM_TILE_SIZE      32
+#define NETWORK_VIDEO_STREAM_FLAG_KEYFRAME  (1 << 0)
+
+typedef struct network_video_stream network_video_stream_t;
+
+/**
+ * network_video_stream_new:
+ * @fd                  : Connected stream socket.
+ *
+ * Starts a stream on @fd and, if threads are available,
+ * the thread that encodes and sends the frames. The socket
+ * is made non-blocking, a receiver that stops reading for
+ * too long ends the stream rather than stalling it.
+ *
+ * Returns: the stream, or NULL if it could not be started,
+ * in which case @fd is left blocking and usable for raw frames.
+ **/
+network_video_stream_t *network_video_stream_new(int fd);
+
+/**
+ * network_video_stream_push:
+ * @stream              : Stream.
+ * @pixels              : XRGB8888 frame, without padding.
+ * @width               : Width of @pixels.
+ * @height              : Height of @pixels.
+ *
+ * Queues a copy of @pixels to be sent. If the sender thread
+ * falls behind, the oldest queued frame is dropped.
+ *
+ * Returns: false once the connection is lost.
+ **/
+bool network_video_stream_push(network_video_stream_t *stream,
+      const uint32_t *pixels, unsigned width, unsigned height);
+
+/**
+ * network_video_stream_free:
+ * @stream              : Stream.
+ *
+ * Sends the frames still queued, stops the stream and
+ * logs how much it sent. Does not close the socket.
+ **/
+void network_video_stream_free(network_video_stream_t *stream);
+
+RETRO_END_DECLS
+
+#endif
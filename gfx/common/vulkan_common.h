@@ -612,6 +612,7 @@ typedef struct vk
       VkDescriptorSetLayout set_layout;
       VkPipelineLayout layout;
       VkPipelineCache cache;
+      size_t cache_size; /* As last loaded from or saved to disk */
    } pipelines;
 
    struct
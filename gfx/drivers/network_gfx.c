@@ -33,6 +33,10 @@
 #include "../../menu/menu_driver.h"
 #endif
 
+#ifdef HAVE_NETWORK_VIDEO_STREAM
+#include "../common/network_video_stream.h"
+#endif
+
 #include "../font_driver.h"
 
 #include "../../driver.h"
@@ -52,6 +56,9 @@ enum
 
 typedef struct network
 {
+#ifdef HAVE_NETWORK_VIDEO_STREAM
+   network_video_stream_t *stream;
+#endif
    int fd;
    unsigned video_width;
    unsigned video_height;
@@ -154,6 +161,14 @@ try_connect:
       goto try_connect;
    }
 
+#ifdef HAVE_NETWORK_VIDEO_STREAM
+   if (settings->bools.video_network_stream)
+   {
+      if (!(network->stream = network_video_stream_new(network->fd)))
+         RARCH_WARN("[Network]: Could not start stream, sending raw frames.\n");
+   }
+#endif
+
    RARCH_LOG("[Network]: Init complete.\n");
 
    return network;
@@ -328,6 +343,26 @@ static bool network_gfx_frame(void *data, const void *frame,
 
    if (draw && network->screen_width > 0 && network->screen_height > 0)
    {
+#ifdef HAVE_NETWORK_VIDEO_STREAM
+      /* Only changed tiles are sent, from another thread */
+      if (network->stream)
+      {
+         if (     frame_to_copy == network_video_temp_buf
+               && !network_video_stream_push(network->stream,
+                  (const uint32_t*)frame_to_copy,
+                  network->screen_width, network->screen_height))
+         {
+            /* The receiver expects the stream from here on,
+             * raw frames can't follow on this connection */
+            RARCH_ERR("[Network]: Stream lost, closing connection.\n");
+            network_video_stream_free(network->stream);
+            network->stream = NULL;
+            socket_close(network->fd);
+            network->fd     = -1;
+         }
+      }
+      else
+#endif
       if (network->fd > 0)
          socket_send_all_blocking(network->fd, frame_to_copy, network->screen_width * network->screen_height * 4, true);
    }
@@ -375,6 +410,10 @@ static void network_gfx_free(void *data)
 
    font_driver_free_osd();
 
+#ifdef HAVE_NETWORK_VIDEO_STREAM
+   network_video_stream_free(network->stream);
+#endif
+
    if (network->fd >= 0)
       socket_close(network->fd);
 
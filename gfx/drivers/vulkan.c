@@ -27,6 +27,7 @@
 #include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <retro_math.h>
+#include <retro_endianness.h>
 #include <string/stdstring.h>
 #include <libretro.h>
 
@@ -43,6 +44,7 @@
 
 #include "../font_driver.h"
 #include "../video_driver.h"
+#include "../drivers_shader/shader_cache.h"
 
 #include "../common/vulkan_common.h"
 
@@ -55,6 +57,9 @@
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 
+/* Size limit of the stored pipeline caches, across all GPUs */
+#define VULKAN_PIPELINE_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
 #define VK_REMAP_TO_TEXFMT(fmt) ((fmt == VK_FORMAT_R5G6B5_UNORM_PACK16) ? VK_FORMAT_R8G8B8A8_UNORM : fmt)
 
 typedef struct
@@ -2991,22 +2996,140 @@ static bool vulkan_init_filter_chain(vk_t *vk)
    return true;
 }
 
-static void vulkan_init_static_resources(vk_t *vk)
+/* The pipeline cache of every GPU and driver
+ * version gets its own file in the cache directory */
+static bool vulkan_pipeline_cache_path(vk_t *vk,
+      char *dir, size_t len, char *key)
 {
-   int i;
-   uint32_t blank[4 * 4];
-   VkCommandPoolCreateInfo pool_info;
+   uint8_t ids[3 * sizeof(uint32_t) + VK_UUID_SIZE];
+   const VkPhysicalDeviceProperties *props =
+      &vk->context->gpu_properties;
+   settings_t *settings                    = config_get_ptr();
+
+   if (!shader_cache_dir(dir, len,
+            settings->paths.directory_cache, "vulkan"))
+      return false;
+
+   memcpy(ids,      &props->vendorID,      sizeof(uint32_t));
+   memcpy(ids + 4,  &props->deviceID,      sizeof(uint32_t));
+   memcpy(ids + 8,  &props->driverVersion, sizeof(uint32_t));
+   memcpy(ids + 12, props->pipelineCacheUUID, VK_UUID_SIZE);
+   shader_cache_key(key, "VkPipelineCache", ids, sizeof(ids));
+   return true;
+}
+
+/* Some drivers do not cope well with a cache from another
+ * device or driver, so check the header ourselves. Its
+ * fields are always stored least significant byte first. */
+static bool vulkan_pipeline_cache_is_valid(vk_t *vk,
+      const uint8_t *data, size_t len)
+{
+   uint32_t header[4];
+   const VkPhysicalDeviceProperties *props =
+      &vk->context->gpu_properties;
+
+   if (len < sizeof(header) + VK_UUID_SIZE)
+      return false;
+
+   memcpy(header, data, sizeof(header));
+
+   return retro_le_to_cpu32(header[0]) >= sizeof(header) + VK_UUID_SIZE
+       && retro_le_to_cpu32(header[1]) == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+       && retro_le_to_cpu32(header[2]) == props->vendorID
+       && retro_le_to_cpu32(header[3]) == props->deviceID
+       && !memcmp(data + sizeof(header), props->pipelineCacheUUID,
+             VK_UUID_SIZE);
+}
+
+static void vulkan_init_pipeline_cache(vk_t *vk)
+{
+   char dir[PATH_MAX_LENGTH];
+   char key[SHADER_CACHE_KEY_SIZE];
    VkPipelineCacheCreateInfo cache;
+   size_t len = 0;
+   void *data = NULL;
 
-   /* Create the pipeline cache. */
    cache.sType                = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
    cache.pNext                = NULL;
    cache.flags                = 0;
    cache.initialDataSize      = 0;
    cache.pInitialData         = NULL;
 
-   vkCreatePipelineCache(vk->context->device,
-         &cache, NULL, &vk->pipelines.cache);
+   if (     vulkan_pipeline_cache_path(vk, dir, sizeof(dir), key)
+         && (data = shader_cache_load(dir, key, &len)))
+   {
+      if (vulkan_pipeline_cache_is_valid(vk, (const uint8_t*)data, len))
+      {
+         cache.initialDataSize = len;
+         cache.pInitialData    = data;
+      }
+      else
+         RARCH_WARN("[Vulkan]: Ignoring pipeline cache of another GPU or driver.\n");
+   }
+
+   if (     vkCreatePipelineCache(vk->context->device,
+               &cache, NULL, &vk->pipelines.cache) != VK_SUCCESS
+         && cache.initialDataSize)
+   {
+      /* Start over without the stored data */
+      cache.initialDataSize   = 0;
+      cache.pInitialData      = NULL;
+      if (vkCreatePipelineCache(vk->context->device,
+               &cache, NULL, &vk->pipelines.cache) != VK_SUCCESS)
+         vk->pipelines.cache  = VK_NULL_HANDLE;
+   }
+
+   /* Drivers don't necessarily hand the stored data back as is
+    * (SwiftShader wraps it in a new header every time), so compare
+    * against what this driver makes of it rather than the file */
+   vk->pipelines.cache_size   = cache.initialDataSize;
+   if (vk->pipelines.cache != VK_NULL_HANDLE)
+   {
+      size_t cache_size       = 0;
+      if (vkGetPipelineCacheData(vk->context->device,
+               vk->pipelines.cache, &cache_size, NULL) == VK_SUCCESS)
+         vk->pipelines.cache_size = cache_size;
+   }
+   free(data);
+}
+
+/* Writes the pipeline cache to disk if pipelines
+ * were added to it since it was loaded or last saved */
+static void vulkan_save_pipeline_cache(vk_t *vk)
+{
+   char dir[PATH_MAX_LENGTH];
+   char key[SHADER_CACHE_KEY_SIZE];
+   size_t len = 0;
+   void *data = NULL;
+
+   if (     vk->pipelines.cache == VK_NULL_HANDLE
+         || vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &len, NULL) != VK_SUCCESS
+         || len == vk->pipelines.cache_size
+         || !vulkan_pipeline_cache_path(vk, dir, sizeof(dir), key))
+      return;
+
+   if (!(data = malloc(len)))
+      return;
+
+   if (     vkGetPipelineCacheData(vk->context->device,
+               vk->pipelines.cache, &len, data) == VK_SUCCESS
+         && shader_cache_store(dir, key, data, len))
+   {
+      vk->pipelines.cache_size = len;
+      shader_cache_trim(dir, VULKAN_PIPELINE_CACHE_MAX_SIZE);
+   }
+
+   free(data);
+}
+
+static void vulkan_init_static_resources(vk_t *vk)
+{
+   int i;
+   uint32_t blank[4 * 4];
+   VkCommandPoolCreateInfo pool_info;
+
+   vulkan_init_pipeline_cache(vk);
 
    pool_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
    pool_info.pNext            = NULL;
@@ -3027,6 +3150,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    int i;
+   vulkan_save_pipeline_cache(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -3735,6 +3859,10 @@ static bool vulkan_set_shader(void *data,
       return false;
    }
 
+   /* Keep the pipelines of the new preset,
+    * in case we never get to shut down cleanly */
+   vulkan_save_pipeline_cache(vk);
+
    return true;
 }
 
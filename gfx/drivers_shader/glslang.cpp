@@ -457,3 +457,12 @@ bool glslang::compile_spirv(const string &source, Stage stage,
    GlslangToSpv(*program.getIntermediate(language), *spirv);
    return true;
 }
+
+const char *glslang::compiler_version(void)
+{
+   /* Bump the trailing revision whenever the way
+    * compile_spirv() drives glslang changes */
+   static const std::string version =
+      std::string(GetGlslVersionString()) + " (RetroArch slang 1)";
+   return version.c_str();
+}
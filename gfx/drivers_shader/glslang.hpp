@@ -18,6 +18,10 @@ namespace glslang
     };
 
     bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
+
+    /* Identifies the compiler and the options compile_spirv()
+     * uses, cached SPIR-V is only valid for the same string. */
+    const char *compiler_version(void);
 }
 
 #endif
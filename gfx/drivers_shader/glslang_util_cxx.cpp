@@ -33,8 +33,14 @@
 #if defined(HAVE_GLSLANG)
 #include "glslang.hpp"
 #endif
+#include "shader_cache.h"
+#include "../../configuration.h"
 #include "../../verbosity.h"
 
+/* Size limit of the SPIR-V cache, a few full
+ * preset collections worth of passes */
+#define SPIRV_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
 static std::string build_stage_source(
       const struct string_list *lines, const char *stage)
 {
@@ -210,10 +216,62 @@ bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta)
    return true;
 }
 
+#if defined(HAVE_GLSLANG)
+static bool glslang_compile_stage(const std::string &source,
+      glslang::Stage stage, std::vector<uint32_t> *spirv,
+      const char *cache_dir, bool *cache_stored)
+{
+   char key[SHADER_CACHE_KEY_SIZE];
+
+   key[0] = '\0';
+
+   if (*cache_dir)
+   {
+      char salt[256];
+      size_t len = 0;
+      void *blob = NULL;
+
+      snprintf(salt, sizeof(salt), "%s stage %d",
+            glslang::compiler_version(), (int)stage);
+      shader_cache_key(key, salt, source.data(), source.size());
+
+      if ((blob = shader_cache_load(cache_dir, key, &len)))
+      {
+         const uint32_t *words = (const uint32_t*)blob;
+
+         /* Anything without the SPIR-V magic number
+          * is not worth handing to the driver */
+         if (     len >= 5 * sizeof(uint32_t)
+               && !(len & 3)
+               && words[0] == 0x07230203)
+         {
+            spirv->assign(words, words + len / sizeof(uint32_t));
+            free(blob);
+            return true;
+         }
+
+         free(blob);
+      }
+   }
+
+   if (!glslang::compile_spirv(source, stage, spirv))
+      return false;
+
+   if (*key && shader_cache_store(cache_dir, key,
+            spirv->data(), spirv->size() * sizeof(uint32_t)))
+      *cache_stored = true;
+
+   return true;
+}
+#endif
+
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
 #if defined(HAVE_GLSLANG)
+   char cache_dir[PATH_MAX_LENGTH];
    struct string_list lines;
+   settings_t *settings = config_get_ptr();
+   bool cache_stored    = false;
    
    if (!string_list_initialize(&lines))
       return false;
@@ -226,20 +284,28 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
    if (!glslang_parse_meta(&lines, &output->meta))
       goto error;
 
-   if (!glslang::compile_spirv(build_stage_source(&lines, "vertex"),
-            glslang::StageVertex, &output->vertex))
+   shader_cache_dir(cache_dir, sizeof(cache_dir),
+         settings ? settings->paths.directory_cache : NULL, "spirv");
+
+   if (!glslang_compile_stage(build_stage_source(&lines, "vertex"),
+            glslang::StageVertex, &output->vertex,
+            cache_dir, &cache_stored))
    {
       RARCH_ERR("[slang]: Failed to compile vertex shader stage.\n");
       goto error;
    }
 
-   if (!glslang::compile_spirv(build_stage_source(&lines, "fragment"),
-            glslang::StageFragment, &output->fragment))
+   if (!glslang_compile_stage(build_stage_source(&lines, "fragment"),
+            glslang::StageFragment, &output->fragment,
+            cache_dir, &cache_stored))
    {
       RARCH_ERR("[slang]: Failed to compile fragment shader stage.\n");
       goto error;
    }
 
+   if (cache_stored)
+      shader_cache_trim(cache_dir, SPIRV_CACHE_MAX_SIZE);
+
    string_list_deinitialize(&lines);
 
    return true;
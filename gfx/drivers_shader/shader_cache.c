@@ -0,0 +1,310 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <lists/string_list.h>
+#include <lrc_hash.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "shader_cache.h"
+
+#define SHADER_CACHE_MAGIC          "RASC"
+#define SHADER_CACHE_VERSION        1
+#define SHADER_CACHE_EXT            "bin"
+
+/* magic, version, blob size, blob crc32, last used */
+#define SHADER_CACHE_HEADER_SIZE    24
+#define SHADER_CACHE_LAST_USED_OFS  16
+
+/* Entries hit more often than this are not
+ * rewritten to bump their last used time */
+#define SHADER_CACHE_TOUCH_INTERVAL (60 * 60)
+
+typedef struct
+{
+   char *path;
+   uint64_t last_used;
+   int64_t size;
+} shader_cache_entry_t;
+
+static void shader_cache_write_u32(uint8_t *s, uint32_t v)
+{
+   memcpy(s, &v, sizeof(v));
+}
+
+static uint32_t shader_cache_read_u32(const uint8_t *s)
+{
+   uint32_t v;
+   memcpy(&v, s, sizeof(v));
+   return v;
+}
+
+static uint64_t shader_cache_read_u64(const uint8_t *s)
+{
+   uint64_t v;
+   memcpy(&v, s, sizeof(v));
+   return v;
+}
+
+static size_t shader_cache_entry_path(char *s, size_t len,
+      const char *dir, const char *key)
+{
+   size_t _len = fill_pathname_join(s, dir, key, len);
+   _len       += strlcpy(s + _len, "." SHADER_CACHE_EXT, len - _len);
+   return _len;
+}
+
+bool shader_cache_dir(char *s, size_t len,
+      const char *cache_root, const char *type)
+{
+   char dir[PATH_MAX_LENGTH];
+
+   *s = '\0';
+
+   if (string_is_empty(cache_root))
+      return false;
+
+   fill_pathname_join(dir, cache_root, "shaders", sizeof(dir));
+   fill_pathname_join(s, dir, type, len);
+
+   if (!path_is_directory(s) && !path_mkdir(s))
+   {
+      *s = '\0';
+      return false;
+   }
+
+   return true;
+}
+
+void shader_cache_key(char *s, const char *salt,
+      const void *data, size_t len)
+{
+   size_t salt_len = salt ? strlen(salt) + 1 : 0;
+   uint8_t *buf    = (uint8_t*)malloc(salt_len + len);
+
+   if (!buf)
+   {
+      *s = '\0';
+      return;
+   }
+
+   /* Keep the terminator, so that the salt
+    * cannot run into the data */
+   if (salt_len)
+      memcpy(buf, salt, salt_len);
+   memcpy(buf + salt_len, data, len);
+
+   sha256_hash(s, buf, salt_len + len);
+   free(buf);
+}
+
+void *shader_cache_load(const char *dir, const char *key, size_t *len)
+{
+   char path[PATH_MAX_LENGTH];
+   uint32_t size;
+   uint64_t last_used;
+   time_t now;
+   void *buf        = NULL;
+   int64_t file_len = 0;
+   uint8_t *data    = NULL;
+   void *blob       = NULL;
+
+   if (string_is_empty(dir) || string_is_empty(key))
+      return NULL;
+
+   shader_cache_entry_path(path, sizeof(path), dir, key);
+
+   if (!path_is_valid(path))
+      return NULL;
+
+   if (!filestream_read_file(path, &buf, &file_len))
+      return NULL;
+
+   data = (uint8_t*)buf;
+
+   if (     file_len < SHADER_CACHE_HEADER_SIZE
+         || memcmp(data, SHADER_CACHE_MAGIC, 4)
+         || shader_cache_read_u32(data + 4) != SHADER_CACHE_VERSION)
+      goto invalid;
+
+   size = shader_cache_read_u32(data + 8);
+
+   if (     (int64_t)size != file_len - SHADER_CACHE_HEADER_SIZE
+         || encoding_crc32(0, data + SHADER_CACHE_HEADER_SIZE, size)
+            != shader_cache_read_u32(data + 12))
+      goto invalid;
+
+   if (!(blob = malloc(size ? size : 1)))
+      goto end;
+   memcpy(blob, data + SHADER_CACHE_HEADER_SIZE, size);
+   *len      = size;
+
+   /* Bump the last used time, in place */
+   now       = time(NULL);
+   last_used = shader_cache_read_u64(data + SHADER_CACHE_LAST_USED_OFS);
+   if ((uint64_t)now > last_used + SHADER_CACHE_TOUCH_INTERVAL)
+   {
+      RFILE *file = filestream_open(path,
+            RETRO_VFS_FILE_ACCESS_READ_WRITE
+            | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (file)
+      {
+         last_used = (uint64_t)now;
+         if (filestream_seek(file, SHADER_CACHE_LAST_USED_OFS,
+                  RETRO_VFS_SEEK_POSITION_START) == 0)
+            filestream_write(file, &last_used, sizeof(last_used));
+         filestream_close(file);
+      }
+   }
+
+   goto end;
+
+invalid:
+   filestream_delete(path);
+end:
+   free(buf);
+   return blob;
+}
+
+bool shader_cache_store(const char *dir, const char *key,
+      const void *data, size_t len)
+{
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   size_t _len;
+   uint64_t last_used;
+   bool ret     = false;
+   uint8_t *buf = NULL;
+
+   if (     string_is_empty(dir)
+         || string_is_empty(key)
+         || len > 0xFFFFFFFF - SHADER_CACHE_HEADER_SIZE)
+      return false;
+
+   if (!(buf = (uint8_t*)malloc(SHADER_CACHE_HEADER_SIZE + len)))
+      return false;
+
+   last_used = (uint64_t)time(NULL);
+   memcpy(buf, SHADER_CACHE_MAGIC, 4);
+   shader_cache_write_u32(buf + 4,  SHADER_CACHE_VERSION);
+   shader_cache_write_u32(buf + 8,  (uint32_t)len);
+   shader_cache_write_u32(buf + 12,
+         encoding_crc32(0, (const uint8_t*)data, len));
+   memcpy(buf + SHADER_CACHE_LAST_USED_OFS, &last_used, sizeof(last_used));
+   memcpy(buf + SHADER_CACHE_HEADER_SIZE, data, len);
+
+   /* Write to a temporary file first, so that an interrupted
+    * write never leaves a half written entry behind */
+   _len = shader_cache_entry_path(path, sizeof(path), dir, key);
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcpy(tmp_path + _len, ".tmp", sizeof(tmp_path) - _len);
+
+   if (filestream_write_file(tmp_path, buf,
+            SHADER_CACHE_HEADER_SIZE + len))
+   {
+      /* Renaming over an existing file fails on Windows */
+      if (path_is_valid(path))
+         filestream_delete(path);
+      if (!(ret = (filestream_rename(tmp_path, path) == 0)))
+         filestream_delete(tmp_path);
+   }
+
+   free(buf);
+   return ret;
+}
+
+static int shader_cache_entry_cmp(const void *a, const void *b)
+{
+   const shader_cache_entry_t *ea = (const shader_cache_entry_t*)a;
+   const shader_cache_entry_t *eb = (const shader_cache_entry_t*)b;
+   if (ea->last_used != eb->last_used)
+      return (ea->last_used < eb->last_used) ? -1 : 1;
+   return 0;
+}
+
+void shader_cache_trim(const char *dir, uint64_t max_size)
+{
+   size_t i;
+   struct string_list *list       = NULL;
+   shader_cache_entry_t *entries  = NULL;
+   size_t count                   = 0;
+   uint64_t total                 = 0;
+
+   if (string_is_empty(dir))
+      return;
+
+   if (!(list = dir_list_new(dir, SHADER_CACHE_EXT,
+               false, false, false, false)))
+      return;
+
+   if (!(entries = (shader_cache_entry_t*)
+            calloc(list->size + 1, sizeof(*entries))))
+      goto end;
+
+   for (i = 0; i < list->size; i++)
+   {
+      uint8_t header[SHADER_CACHE_HEADER_SIZE];
+      shader_cache_entry_t *entry = &entries[count];
+      RFILE *file                 = NULL;
+
+      entry->path      = list->elems[i].data;
+      entry->size      = path_get_size(entry->path);
+      entry->last_used = 0;
+
+      if (entry->size < 0)
+         continue;
+
+      /* Entries with an unreadable header go first */
+      if ((file = filestream_open(entry->path,
+                  RETRO_VFS_FILE_ACCESS_READ,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      {
+         if (filestream_read(file, header, sizeof(header))
+               == sizeof(header)
+               && !memcmp(header, SHADER_CACHE_MAGIC, 4))
+            entry->last_used = shader_cache_read_u64(
+                  header + SHADER_CACHE_LAST_USED_OFS);
+         filestream_close(file);
+      }
+
+      total += (uint64_t)entry->size;
+      count++;
+   }
+
+   if (total <= max_size)
+      goto end;
+
+   qsort(entries, count, sizeof(*entries), shader_cache_entry_cmp);
+
+   for (i = 0; i < count && total > max_size; i++)
+   {
+      if (filestream_delete(entries[i].path) == 0)
+         total -= (uint64_t)entries[i].size;
+   }
+
+end:
+   free(entries);
+   string_list_free(list);
+}
@@ -0,0 +1,105 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SHADER_CACHE_H
+#define __SHADER_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Content-addressed cache of compiled shader blobs.
+ *
+ * Every kind of blob gets its own subdirectory of the
+ * cache directory, where each entry is stored under the
+ * (hex) key it was looked up with. Entries carry a checksum,
+ * so a truncated or corrupted entry is a miss rather than
+ * garbage handed to a driver, and the time they were last
+ * used, so shader_cache_trim() can drop the stalest ones. */
+
+#define SHADER_CACHE_KEY_SIZE 65
+
+/**
+ * shader_cache_dir:
+ * @s                   : Output path.
+ * @len                 : Size of @s.
+ * @cache_root          : Cache directory, usually
+ *                        settings->paths.directory_cache.
+ * @type                : Name of the subdirectory, e.g. "spirv".
+ *
+ * Builds the path of the cache subdirectory for @type and
+ * creates it if needed.
+ *
+ * Returns: false if caching is not available, in which case
+ * @s is left empty.
+ **/
+bool shader_cache_dir(char *s, size_t len,
+      const char *cache_root, const char *type);
+
+/**
+ * shader_cache_key:
+ * @s                   : Output, SHADER_CACHE_KEY_SIZE bytes.
+ * @salt                : Anything besides @data the blob depends
+ *                        on, e.g. the compiler version. Can be NULL.
+ * @data                : Source the blob is compiled from.
+ * @len                 : Size of @data.
+ *
+ * Hashes @salt and @data (SHA-256) into a cache key.
+ **/
+void shader_cache_key(char *s, const char *salt,
+      const void *data, size_t len);
+
+/**
+ * shader_cache_load:
+ * @dir                 : Cache subdirectory, see shader_cache_dir().
+ * @key                 : Cache key.
+ * @len                 : Size of the returned blob.
+ *
+ * Returns: the blob stored under @key, to be freed by the caller,
+ * or NULL if there is no valid entry for it.
+ **/
+void *shader_cache_load(const char *dir, const char *key, size_t *len);
+
+/**
+ * shader_cache_store:
+ * @dir                 : Cache subdirectory, see shader_cache_dir().
+ * @key                 : Cache key.
+ * @data                : Blob to store.
+ * @len                 : Size of @data.
+ *
+ * Stores @data under @key, replacing any previous entry.
+ *
+ * Returns: true if successful.
+ **/
+bool shader_cache_store(const char *dir, const char *key,
+      const void *data, size_t len);
+
+/**
+ * shader_cache_trim:
+ * @dir                 : Cache subdirectory, see shader_cache_dir().
+ * @max_size            : Size limit of the subdirectory, in bytes.
+ *
+ * Deletes the least recently used entries of @dir until
+ * it fits in @max_size.
+ **/
+void shader_cache_trim(const char *dir, uint64_t max_size);
+
+RETRO_END_DECLS
+
+#endif
@@ -33,6 +33,8 @@
 #include "spirv_glsl.hpp"
 
 #include "../common/gl3_defines.h"
+#include "../common/gl_common.h"
+#include "shader_cache.h"
 
 #include "../../retroarch.h"
 #include "../../verbosity.h"
@@ -374,40 +376,58 @@ GLuint gl3_cross_compile_program(
 
       auto vertex_source     = vertex_compiler.compile();
       auto fragment_source   = fragment_compiler.compile();
-      GLuint vertex_shader   = gl3_compile_shader(GL_VERTEX_SHADER, vertex_source.c_str());
-      GLuint fragment_shader = gl3_compile_shader(GL_FRAGMENT_SHADER, fragment_source.c_str());
+      char key[SHADER_CACHE_KEY_SIZE];
+      const char *sources[2] = { vertex_source.c_str(), fragment_source.c_str() };
+      bool cacheable         = gl_program_cache_key(key, sources, 2);
+      GLint status           = GL_FALSE;
+
+      program                = glCreateProgram();
+
+      /* The attribute bindings below follow from the
+       * names in the sources, so they are part of the key */
+      if (cacheable && gl_program_cache_load(program, key))
+         status = GL_TRUE;
+      else
+      {
+         GLuint vertex_shader   = gl3_compile_shader(GL_VERTEX_SHADER, vertex_source.c_str());
+         GLuint fragment_shader = gl3_compile_shader(GL_FRAGMENT_SHADER, fragment_source.c_str());
 
 #if 0
-      RARCH_LOG("[GLCore]: Vertex shader:\n========\n%s\n=======\n", vertex_source.c_str());
-      RARCH_LOG("[GLCore]: Fragment shader:\n========\n%s\n=======\n", fragment_source.c_str());
+         RARCH_LOG("[GLCore]: Vertex shader:\n========\n%s\n=======\n", vertex_source.c_str());
+         RARCH_LOG("[GLCore]: Fragment shader:\n========\n%s\n=======\n", fragment_source.c_str());
 #endif
 
-      if (!vertex_shader || !fragment_shader)
-      {
-         RARCH_ERR("[GLCore]: One or more shaders failed to compile.\n");
-         if (vertex_shader)
-            glDeleteShader(vertex_shader);
-         if (fragment_shader)
-            glDeleteShader(fragment_shader);
-         return 0;
-      }
+         if (!vertex_shader || !fragment_shader)
+         {
+            RARCH_ERR("[GLCore]: One or more shaders failed to compile.\n");
+            if (vertex_shader)
+               glDeleteShader(vertex_shader);
+            if (fragment_shader)
+               glDeleteShader(fragment_shader);
+            glDeleteProgram(program);
+            return 0;
+         }
 
-      program = glCreateProgram();
-      glAttachShader(program, vertex_shader);
-      glAttachShader(program, fragment_shader);
-      for (auto &res : vertex_resources.stage_inputs)
-      {
-         char loc_buf[64];
-         uint32_t _loc = vertex_compiler.get_decoration(res.id, spv::DecorationLocation);
-         snprintf(loc_buf, sizeof(loc_buf), "RARCH_ATTRIBUTE_%d", _loc);
-         glBindAttribLocation(program, _loc, loc_buf);
+         glAttachShader(program, vertex_shader);
+         glAttachShader(program, fragment_shader);
+         for (auto &res : vertex_resources.stage_inputs)
+         {
+            char loc_buf[64];
+            uint32_t _loc = vertex_compiler.get_decoration(res.id, spv::DecorationLocation);
+            snprintf(loc_buf, sizeof(loc_buf), "RARCH_ATTRIBUTE_%d", _loc);
+            glBindAttribLocation(program, _loc, loc_buf);
+         }
+         if (cacheable)
+            gl_program_cache_set_retrievable(program);
+         glLinkProgram(program);
+         glDeleteShader(vertex_shader);
+         glDeleteShader(fragment_shader);
+
+         glGetProgramiv(program, GL_LINK_STATUS, &status);
+         if (status && cacheable)
+            gl_program_cache_store(program, key);
       }
-      glLinkProgram(program);
-      glDeleteShader(vertex_shader);
-      glDeleteShader(fragment_shader);
 
-      GLint status;
-      glGetProgramiv(program, GL_LINK_STATUS, &status);
       if (!status)
       {
          GLint length;
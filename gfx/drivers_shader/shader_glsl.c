@@ -33,6 +33,8 @@
 #endif
 
 #include "shader_glsl.h"
+#include "shader_cache.h"
+#include "../common/gl_common.h"
 #ifdef HAVE_REWIND
 #include "../../state_manager.h"
 #endif
@@ -46,6 +48,9 @@
 
 #define PREV_TEXTURES (GFX_MAX_TEXTURES - 1)
 
+/* #version, stage define, alias define, program */
+#define GLSL_SOURCE_STRINGS 4
+
 /* Cache the VBO. */
 struct cache_vbo
 {
@@ -348,13 +353,12 @@ static void gl_glsl_dump_shader(GLuint shader, char *save_path)
 #endif
 #endif
 
-static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
-      GLuint shader,
+/* Fills in the strings making up the source of a
+ * shader stage, @version has to outlive @source */
+static void gl_glsl_shader_source(glsl_shader_data_t *glsl,
+      const char **source, char *version, size_t version_len,
       const char *define, const char *program)
 {
-   GLint status;
-   const char *source[4];
-   char version[32];
    const char *existing_version = strstr(program, "#version");
 
    version[0]                   = '\0';
@@ -375,7 +379,7 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
       }
 #endif
       snprintf(version,
-            sizeof(version), "#version %u%s\n", version_no, version_extra);
+            version_len, "#version %u%s\n", version_no, version_extra);
       RARCH_LOG("[GLSL]: Using GLSL version %u%s.\n", version_no, version_extra);
    }
    else if (glsl_core)
@@ -399,7 +403,7 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
             break;
       }
 
-      snprintf(version, sizeof(version), "#version %u\n", version_no);
+      snprintf(version, version_len, "#version %u\n", version_no);
       RARCH_LOG("[GLSL]: Using GLSL version %u.\n", version_no);
    }
 
@@ -407,12 +411,17 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
    source[1] = define;
    source[2] = glsl->alias_define;
    source[3] = program;
+}
+
+static bool gl_glsl_compile_shader(GLuint shader, const char **source)
+{
+   GLint status;
 
 #if defined(ORBIS) 
    {
       char save_path[250];
       XXH64_hash_t const hash = 
-         gl_glsl_hash_shader(source, ARRAY_SIZE(source));
+         gl_glsl_hash_shader(source, GLSL_SOURCE_STRINGS);
       snprintf(save_path, sizeof(save_path),
             "/data/retroarch/temp/%lx.sb", hash);
       if (gl_glsl_load_binary_shader(shader, save_path))
@@ -420,7 +429,7 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
    }
 #endif
 
-   glShaderSource(shader, ARRAY_SIZE(source), source, NULL);
+   glShaderSource(shader, GLSL_SOURCE_STRINGS, source, NULL);
    glCompileShader(shader);
 
    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
@@ -458,6 +467,15 @@ static bool gl_glsl_compile_program(
       void *program_data,
       struct shader_program_info *program_info)
 {
+   char vertex_version[32];
+   char fragment_version[32];
+   char key[SHADER_CACHE_KEY_SIZE];
+   const char *sources[2 * GLSL_SOURCE_STRINGS];
+   const char **vertex_source               = sources;
+   const char **fragment_source             = sources + GLSL_SOURCE_STRINGS;
+   size_t num_sources                       = 0;
+   bool cached                              = false;
+   bool cacheable                           = false;
    glsl_shader_data_t                 *glsl = (glsl_shader_data_t*)data;
    struct shader_program_glsl_data *program = 
       (struct shader_program_glsl_data*)program_data;
@@ -472,12 +490,42 @@ static bool gl_glsl_compile_program(
    if (program_info->vertex)
    {
       RARCH_LOG("[GLSL]: Found GLSL vertex shader.\n");
+      gl_glsl_shader_source(glsl, vertex_source,
+            vertex_version, sizeof(vertex_version),
+            "#define VERTEX\n#define PARAMETER_UNIFORM\n",
+            program_info->vertex);
+      num_sources  += GLSL_SOURCE_STRINGS;
+   }
+   else
+      vertex_source = NULL;
+
+   if (program_info->fragment)
+   {
+      RARCH_LOG("[GLSL]: Found GLSL fragment shader.\n");
+      /* Keep the sources contiguous for the cache key */
+      fragment_source = sources + num_sources;
+      gl_glsl_shader_source(glsl, fragment_source,
+            fragment_version, sizeof(fragment_version),
+            "#define FRAGMENT\n#define PARAMETER_UNIFORM\n",
+            program_info->fragment);
+      num_sources  += GLSL_SOURCE_STRINGS;
+   }
+   else
+      fragment_source = NULL;
+
+   if (num_sources)
+   {
+      if ((cacheable = gl_program_cache_key(key, sources, num_sources)))
+         cached      = gl_program_cache_load(prog, key);
+      if (cached)
+         RARCH_LOG("[GLSL]: Loaded program binary from cache.\n");
+   }
+
+   if (vertex_source && !cached)
+   {
       program->vprg = glCreateShader(GL_VERTEX_SHADER);
 
-      if (!gl_glsl_compile_shader(
-               glsl,
-               program->vprg,
-               "#define VERTEX\n#define PARAMETER_UNIFORM\n", program_info->vertex))
+      if (!gl_glsl_compile_shader(program->vprg, vertex_source))
       {
          RARCH_ERR("Failed to compile vertex shader #%u\n", idx);
          goto error;
@@ -486,13 +534,10 @@ static bool gl_glsl_compile_program(
       glAttachShader(prog, program->vprg);
    }
 
-   if (program_info->fragment)
+   if (fragment_source && !cached)
    {
-      RARCH_LOG("[GLSL]: Found GLSL fragment shader.\n");
       program->fprg = glCreateShader(GL_FRAGMENT_SHADER);
-      if (!gl_glsl_compile_shader(glsl, program->fprg,
-               "#define FRAGMENT\n#define PARAMETER_UNIFORM\n",
-               program_info->fragment))
+      if (!gl_glsl_compile_shader(program->fprg, fragment_source))
       {
          RARCH_ERR("Failed to compile fragment shader #%u\n", idx);
          goto error;
@@ -501,11 +546,18 @@ static bool gl_glsl_compile_program(
       glAttachShader(prog, program->fprg);
    }
 
-   if (program_info->vertex || program_info->fragment)
+   if (num_sources)
    {
-      RARCH_LOG("[GLSL]: Linking GLSL program.\n");
-      if (!gl_glsl_link_program(prog))
-         goto error;
+      if (!cached)
+      {
+         RARCH_LOG("[GLSL]: Linking GLSL program.\n");
+         if (cacheable)
+            gl_program_cache_set_retrievable(prog);
+         if (!gl_glsl_link_program(prog))
+            goto error;
+         if (cacheable)
+            gl_program_cache_store(prog, key);
+      }
 
       /* Clean up dead memory. We're not going to relink the program.
        * Detaching first seems to kill some mobile drivers
@@ -3768,8 +3768,9 @@ void video_driver_frame(const void *data, unsigned width,
    {
       audio_statistics_t audio_stats;
       char throttle_stats[128];
-      char latency_stats[128];
-      char tmp[128];
+      char latency_stats[192];
+      char rewind_stats[160];
+      char tmp[192];
       size_t len;
       double stddev                          = 0.0;
       float font_size_scale                  = video_info.font_size / 100;
@@ -3817,6 +3818,7 @@ void video_driver_frame(const void *data, unsigned width,
 
       throttle_stats[0] = '\0';
       latency_stats[0]  = '\0';
+      rewind_stats[0]   = '\0';
       tmp[0]            = '\0';
       len               = 0;
 
@@ -3861,6 +3863,22 @@ void video_driver_frame(const void *data, unsigned width,
                " - Preemptive Frames\n",
                video_info.runahead_frames);
 
+#ifdef HAVE_RUNAHEAD
+      {
+         runahead_state_stats_t runahead;
+
+         /* Save state bytes changed per frame */
+         if (video_info.runahead && runahead_get_state_stats(&runahead))
+         {
+            size_t _len = strlen(tmp);
+            len         = _len + snprintf(tmp + _len, sizeof(tmp) - _len,
+                  " - Dirty:     %5.1f / %.1f KB\n",
+                  runahead.dirty_bytes / (1024.0f * runahead.frames),
+                  runahead.total_bytes / (1024.0f * runahead.frames));
+         }
+      }
+#endif
+
       if (len)
       {
          /* TODO/FIXME - localize */
@@ -3868,6 +3886,36 @@ void video_driver_frame(const void *data, unsigned width,
          strlcpy(latency_stats + _len, tmp, sizeof(latency_stats) - _len);
       }
 
+#ifdef HAVE_REWIND
+      {
+         state_manager_stats_t rewind;
+
+         /* TODO/FIXME - localize */
+         if (state_manager_get_stats(&runloop_st->rewind_st, &rewind))
+         {
+            len = snprintf(rewind_stats, sizeof(rewind_stats),
+                  "REWIND\n"
+                  " Entries:     %5u\n"
+                  " Buffer:      %5.1f / %.1f MB\n",
+                  rewind.entries,
+                  rewind.hot_size  / (1024.0f * 1024.0f),
+                  rewind.hot_capacity / (1024.0f * 1024.0f));
+
+            if (rewind.cold_capacity && len < sizeof(rewind_stats))
+               snprintf(rewind_stats + len, sizeof(rewind_stats) - len,
+                     " Compressed:  %5.1f / %.1f MB\n"
+                     " - Entries:   %5u\n"
+                     " - Ratio:     %5.2f x\n",
+                     rewind.cold_size / (1024.0f * 1024.0f),
+                     rewind.cold_capacity / (1024.0f * 1024.0f),
+                     rewind.cold_entries,
+                     rewind.cold_size
+                     ? (float)rewind.cold_raw_size / rewind.cold_size
+                     : 0.0f);
+         }
+      }
+#endif
+
       /* TODO/FIXME - localize */
       snprintf(video_info.stat_text,
             sizeof(video_info.stat_text),
@@ -3891,6 +3939,7 @@ void video_driver_frame(const void *data, unsigned width,
             " Blocking:    %5.2f %%\n"
             " Samples:     %5d\n"
             "%s"
+            "%s"
             "%s",
             av_info->geometry.base_width,
             av_info->geometry.base_height,
@@ -3914,7 +3963,8 @@ void video_driver_frame(const void *data, unsigned width,
             audio_stats.close_to_blocking,
             audio_stats.samples,
             throttle_stats,
-            latency_stats);
+            latency_stats,
+            rewind_stats);
 
       /* TODO/FIXME - add OSD chat text here */
    }
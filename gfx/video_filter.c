@@ -36,6 +36,11 @@
 #include "video_filter.h"
 #include "video_filters/softfilter.h"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
+
 struct rarch_soft_plug
 {
 #ifdef HAVE_DYLIB
@@ -58,50 +63,40 @@ struct rarch_softfilter
    enum retro_pixel_format pix_fmt, out_pix_fmt;
 
    struct softfilter_work_packet *packets;
+   unsigned num_packets;
    unsigned threads;
 
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   tpool_t *pool;
+   slock_t *lock;
+   unsigned next_packet;
 #endif
 };
 
 #ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
-
-struct filter_thread_data
-{
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
-
-static void filter_thread_loop(void *data)
+/* Row tiles to ask a filter for per thread, so that
+ * threads done early take over rows from slower ones */
+#define SOFTFILTER_TILES_PER_THREAD 4
+/* Fewest rows of a full size frame to give a tile */
+#define SOFTFILTER_MIN_TILE_ROWS    8
+
+/* Runs packets until there are none left */
+static void softfilter_work(void *data)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   rarch_softfilter_t *filt = (rarch_softfilter_t*)data;
 
    for (;;)
    {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
+      unsigned i;
+      slock_lock(filt->lock);
+      i = filt->next_packet++;
+      slock_unlock(filt->lock);
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+      if (i >= filt->num_packets)
+         break;
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+      if (filt->packets[i].work)
+         filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
    }
 }
 #endif
@@ -136,7 +131,7 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       softfilter_simd_mask_t cpu_features,
       unsigned threads)
 {
-   unsigned input_fmts, input_fmt, output_fmts;
+   unsigned input_fmts, input_fmt, output_fmts, packets;
    struct config_file_userdata userdata;
    char key[64], name[64];
    name[0] = '\0';
@@ -204,29 +199,43 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+
+   packets = 1;
+#ifdef HAVE_THREADS
+   /* Ask for several row tiles per thread, but
+    * not so many that tiles get only a few rows */
+   if (threads > 1)
+   {
+      unsigned max_packets = max_height / SOFTFILTER_MIN_TILE_ROWS;
+      packets              = threads * SOFTFILTER_TILES_PER_THREAD;
+      if (packets > max_packets)
+         packets           = MAX(max_packets, threads);
+   }
+#endif
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         packets, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
       return false;
    }
 
-   threads = filt->impl->query_num_threads(filt->impl_data);
-   if (!threads)
+   packets = filt->impl->query_num_threads(filt->impl_data);
+   if (!packets)
    {
       RARCH_ERR("Invalid number of threads.\n");
       return false;
    }
 
-   filt->threads = threads;
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   filt->num_packets = packets;
+   filt->threads     = MIN(threads, packets);
 
    filt->packets = (struct softfilter_work_packet*)
-      calloc(threads, sizeof(*filt->packets));
+      calloc(packets, sizeof(*filt->packets));
    if (!filt->packets)
    {
       RARCH_ERR("Failed to allocate softfilter packets.\n");
@@ -236,29 +245,19 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
-      unsigned i;
-      if (!(filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data))))
+      /* Created once with the filter, the thread calling
+       * rarch_softfilter_process() works alongside */
+      if (!(filt->lock = slock_new()))
+         return false;
+      if (!(filt->pool = tpool_create(filt->threads - 1)))
          return false;
-
-      for (i = 0; i < threads; i++)
-      {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
-
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
-               filter_thread_loop, &filt->thread_data[i]);
-         if (!filt->thread_data[i].thread)
-            return false;
-      }
    }
+   else
 #endif
+      filt->threads = 1;
+
+   RARCH_LOG("Using %u threads for softfilter (%u row tiles).\n",
+         filt->threads, packets);
 
    return true;
 }
@@ -493,26 +492,14 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
       if (filt->plugs[i].lib)
          dylib_close(filt->plugs[i].lib);
    }
-   free(filt->plugs);
 #endif
+   free(filt->plugs);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
+   if (filt->pool)
+      tpool_destroy(filt->pool);
+   if (filt->lock)
+      slock_free(filt->lock);
 #endif
 
    if (filt->conf)
@@ -560,34 +547,15 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
-
-      /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      filt->next_packet = 0;
+      for (i = 1; i < filt->threads; i++)
+         tpool_add_work(filt->pool, softfilter_work, filt);
+      softfilter_work(filt);
+      tpool_wait(filt->pool);
       return;
    }
 #endif
 
-   for (i = 0; i < filt->threads; i++)
+   for (i = 0; i < filt->num_packets; i++)
       filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
 }
@@ -104,14 +104,12 @@ static void *dot_matrix_3x_generic_create(const struct softfilter_config *config
       return NULL;
 
    if (!(filt->workers = (struct softfilter_thread_data*)
-            calloc(1, sizeof(struct softfilter_thread_data))))
+            calloc(threads, sizeof(struct softfilter_thread_data))))
    {
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
 
    /* Initialise colour lookup tables */
@@ -286,25 +284,31 @@ static void dot_matrix_3x_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code */
-   struct filter_data *filt           = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data                      = (uint8_t*)output;
-   thr->in_data                       = (const uint8_t*)input;
-   thr->out_pitch                     = output_stride;
-   thr->in_pitch                      = input_stride;
-   thr->width                         = width;
-   thr->height                        = height;
-
-   if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-      packets[0].work                 = dot_matrix_3x_work_cb_rgb565;
-   else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-      packets[0].work                 = dot_matrix_3x_work_cb_xrgb8888;
+   unsigned i;
+   struct filter_data *filt = (struct filter_data*)data;
 
-   packets[0].thread_data             = thr;
+   for (i = 0; i < filt->threads; i++)
+   {
+      struct softfilter_thread_data *thr =
+         (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start                   = SOFTFILTER_TILE_Y_START(i,
+            filt->threads, height, 1);
+      unsigned y_end                     = SOFTFILTER_TILE_Y_END(i,
+            filt->threads, height, 1);
+
+      thr->out_data                      = (uint8_t*)output + y_start * 3 * output_stride;
+      thr->in_data                       = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch                     = output_stride;
+      thr->in_pitch                      = input_stride;
+      thr->width                         = width;
+      thr->height                        = y_end - y_start;
+
+      if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
+         packets[i].work                 = dot_matrix_3x_work_cb_rgb565;
+      else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
+         packets[i].work                 = dot_matrix_3x_work_cb_xrgb8888;
+      packets[i].thread_data             = thr;
+   }
 }
 
 static const struct softfilter_implementation dot_matrix_3x_generic = {
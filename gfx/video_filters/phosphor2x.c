@@ -242,9 +242,7 @@ static void *phosphor2x_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->threads        = 1;
+   filt->threads        = threads;
    filt->in_fmt         = in_fmt;
 
    filt->phosphor_bleed = 0.78;
@@ -132,7 +132,11 @@ struct softfilter_work_packet
  * maximum possible input size.
  *
  * Input sizes can very per call to softfilter_process_t, but they
- * will never be larger than the maximum. */
+ * will never be larger than the maximum.
+ *
+ * threads is the number of work packets the host would like per
+ * frame. The host may ask for more packets than it has threads,
+ * and hands them out to whichever worker thread is free. */
 typedef void *(*softfilter_create_t)(const struct softfilter_config *config,
       unsigned in_fmt, unsigned out_fmt,
       unsigned max_width, unsigned max_height,
@@ -164,6 +168,17 @@ typedef void (*softfilter_get_work_packets_t)(void *data,
  * compared to the value passed to create(). */
 typedef unsigned (*softfilter_query_num_threads_t)(void *data);
 
+/* First and one past the last row of packet index out of num,
+ * for filters that split a frame of height rows into horizontal
+ * tiles. Tile boundaries fall on multiples of align rows and the
+ * last tile takes what is left; a tile is empty when there are
+ * more packets than rows. */
+#define SOFTFILTER_TILE_Y_START(index, num, height, align) \
+   ((((height) / (align)) * (index) / (num)) * (align))
+#define SOFTFILTER_TILE_Y_END(index, num, height, align) \
+   (((index) + 1 == (num)) ? (height) \
+    : SOFTFILTER_TILE_Y_START((index) + 1, num, height, align))
+
 struct softfilter_implementation
 {
    softfilter_query_input_formats_t query_input_formats;
@@ -20,6 +20,7 @@
 #include <math.h>
 
 #include <compat/strl.h>
+#include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
 #include <string/stdstring.h>
 
@@ -421,7 +422,17 @@ static void video_thread_loop(void *data)
       while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
          scond_wait(thr->cond_thread, thr->lock);
 
-      updated = thr->frame.updated;
+      /* Take the newest completed frame, the slot we were
+       * rendering becomes free for the core thread again. */
+      if ((updated = thr->frame.updated))
+      {
+         unsigned read      = thr->frame.read;
+         thr->frame.read    = thr->frame.ready;
+         thr->frame.ready   = read;
+         thr->frame.updated = false;
+         thr->frame.busy    = true;
+         scond_signal(thr->cond_cmd);
+      }
 
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
@@ -456,15 +467,24 @@ static void video_thread_loop(void *data)
             {
                video_frame_info_t video_info;
                bool               ret;
+               /* Only this thread changes 'read' */
+               unsigned           read = thr->frame.read;
 
                /* TODO/FIXME - not thread-safe - should get
                 * rid of this */
                video_driver_build_info(&video_info);
 
+               /* Dupes are passed on as NULL, the driver keeps
+                * showing what it uploaded last */
                ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count, thr->frame.pitch,
-                  *thr->frame.msg ? thr->frame.msg : NULL,
+                  thr->frame.slots[read].dupe
+                  ? NULL : thr->frame.slots[read].buffer,
+                  thr->frame.slots[read].width,
+                  thr->frame.slots[read].height,
+                  thr->frame.slots[read].count,
+                  thr->frame.slots[read].pitch,
+                  *thr->frame.slots[read].msg
+                  ? thr->frame.slots[read].msg : NULL,
                   &video_info);
 
                slock_unlock(thr->frame.lock);
@@ -493,7 +513,7 @@ static void video_thread_loop(void *data)
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
          thr->vp            = vp;
-         thr->frame.updated = false;
+         thr->frame.busy    = false;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -617,48 +637,79 @@ static bool video_thread_frame(void *data, const void *frame_,
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   /* Dupes don't replace a frame the thread hasn't picked up yet */
+   if (!frame_ && thr->frame.updated)
+   {
+      thr->miss_count++;
+      slock_unlock(thr->lock);
+      thr->last_time = cpu_features_get_time_usec();
+      return true;
+   }
+
+   slock_unlock(thr->lock);
+
+   /* The write slot belongs to this thread, fill it without
+    * holding the lock. If the core rendered straight into it
+    * through get_current_software_framebuffer, there is
+    * nothing to copy. */
    {
       const uint8_t *src   = (const uint8_t*)frame_;
-      uint8_t       *dst   = thr->frame.buffer;
       unsigned copy_stride = width *
          (thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t));
+      unsigned write       = thr->frame.write;
+      uint8_t *dst         = thr->frame.slots[write].buffer;
 
-      if (src)
+      if (src && src != dst)
       {
-         int i; /* TODO/FIXME - increment counter never meaningfully used */
-         for (i = 0; i < (int)height; i++, src += pitch, dst += copy_stride)
-            memcpy(dst, src, copy_stride);
+         if (pitch == copy_stride)
+            memcpy(dst, src, copy_stride * height);
+         else
+         {
+            unsigned i;
+            for (i = 0; i < height; i++, src += pitch, dst += copy_stride)
+               memcpy(dst, src, copy_stride);
+         }
+         pitch = copy_stride;
       }
 
-      thr->frame.updated = true;
-      thr->frame.width   = width;
-      thr->frame.height  = height;
-      thr->frame.count   = frame_count;
-      thr->frame.pitch   = copy_stride;
+      thr->frame.slots[write].dupe   = !src;
+      thr->frame.slots[write].width  = width;
+      thr->frame.slots[write].height = height;
+      thr->frame.slots[write].count  = frame_count;
+      thr->frame.slots[write].pitch  = pitch;
 
       if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
+         strlcpy(thr->frame.slots[write].msg, msg,
+               sizeof(thr->frame.slots[write].msg));
       else
-         *thr->frame.msg = '\0';
+         *thr->frame.slots[write].msg = '\0';
+   }
+
+   slock_lock(thr->lock);
+
+   /* Publish the slot. If the thread hasn't picked up the
+    * previous frame yet, that one is dropped in favour of
+    * the newer frame. */
+   if (thr->frame.updated)
+      thr->miss_count++;
+
+   {
+      unsigned ready     = thr->frame.ready;
+      thr->frame.ready   = thr->frame.write;
+      thr->frame.write   = ready;
+   }
+   thr->frame.updated    = true;
 
-      scond_signal(thr->cond_thread);
+   scond_signal(thr->cond_thread);
 
 #ifdef HAVE_MENU
-      if (thr->texture.enable)
-      {
-         do
-         {
-            scond_wait(thr->cond_cmd, thr->lock);
-         } while (thr->frame.updated);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      while (thr->frame.updated || thr->frame.busy)
+         scond_wait(thr->cond_cmd, thr->lock);
    }
-   else
-      thr->miss_count++;
+#endif
+   thr->hit_count++;
 
    slock_unlock(thr->lock);
 
@@ -695,20 +746,29 @@ static bool video_thread_init(thread_video_t *thr,
       return false;
 
    {
+      unsigned i;
       size_t max_size        = info.input_scale * RARCH_SCALE_BASE;
       max_size              *= max_size;
       max_size              *= info.rgb32 ?
          sizeof(uint32_t) : sizeof(uint16_t);
 
+      for (i = 0; i < ARRAY_SIZE(thr->frame.slots); i++)
+      {
 #ifdef _3DS
-      thr->frame.buffer      = linearMemAlign(max_size, 0x80);
+         thr->frame.slots[i].buffer = linearMemAlign(max_size, 0x80);
 #else
-      thr->frame.buffer      = (uint8_t*)malloc(max_size);
+         thr->frame.slots[i].buffer = (uint8_t*)malloc(max_size);
 #endif
-      if (!thr->frame.buffer)
-         return false;
+         if (!thr->frame.slots[i].buffer)
+            return false;
+
+         memset(thr->frame.slots[i].buffer, 0x80, max_size);
+      }
 
-      memset(thr->frame.buffer, 0x80, max_size);
+      thr->frame.size        = max_size;
+      thr->frame.write       = 0;
+      thr->frame.ready       = 1;
+      thr->frame.read        = 2;
    }
 
    thr->input                = input;
@@ -822,6 +882,8 @@ static void video_thread_free(void *data)
 
    if (thr)
    {
+      unsigned i;
+
       if (thr->thread)
       {
          thread_packet_t pkt;
@@ -840,11 +902,14 @@ static void video_thread_free(void *data)
       }
 
       free(thr->texture.frame);
+      for (i = 0; i < ARRAY_SIZE(thr->frame.slots); i++)
+      {
 #ifdef _3DS
-      linearFree(thr->frame.buffer);
+         linearFree(thr->frame.slots[i].buffer);
 #else
-      free(thr->frame.buffer);
+         free(thr->frame.slots[i].buffer);
 #endif
+      }
       free(thr->alpha_mod);
 
       slock_free(thr->frame.lock);
@@ -1258,6 +1323,39 @@ static uint32_t thread_get_flags(void *data)
    return 0;
 }
 
+/* Lets the core render straight into the slot the next
+ * video_thread_frame() call publishes, saving a copy per frame.
+ * 0RGB1555 is converted before it reaches the wrapper, so such
+ * cores keep rendering into their own buffer. */
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   size_t pitch;
+   thread_video_t *thr            = (thread_video_t*)data;
+   video_driver_state_t *video_st = video_state_get_ptr();
+
+   if (   !thr
+       || !framebuffer
+       || thr->frame.within_thread
+       || video_st->pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555)
+      return false;
+
+   pitch = framebuffer->width *
+      (video_st->pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888
+       ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (!pitch || pitch * framebuffer->height > thr->frame.size)
+      return false;
+
+   /* Only the core thread changes 'write' */
+   framebuffer->data         = thr->frame.slots[thr->frame.write].buffer;
+   framebuffer->pitch        = pitch;
+   framebuffer->format       = video_st->pix_fmt;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_get_flags,
    thread_load_texture,
@@ -1278,7 +1376,7 @@ static const video_poke_interface_t thread_poke = {
    thread_show_mouse,
    thread_grab_mouse_toggle,
    thread_get_current_shader,
-   NULL, /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL, /* get_hw_render_interface */
    thread_set_hdr_max_nits,
    thread_set_hdr_paper_white_nits,
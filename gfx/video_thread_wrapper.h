@@ -220,14 +220,28 @@ typedef struct thread_video
 
    struct
    {
-      uint64_t count;
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[NAME_MAX_LENGTH];
-      bool updated;
+      /* Triple buffered: 'write' is filled by the core thread
+       * (or handed to the core as its software framebuffer),
+       * 'ready' holds the newest completed frame and 'read' is
+       * the one being rendered. Indices are swapped under
+       * thr->lock, the buffers themselves are never shared. */
+      struct
+      {
+         uint64_t count;
+         uint8_t *buffer;
+         unsigned width;
+         unsigned height;
+         unsigned pitch;
+         char msg[NAME_MAX_LENGTH];
+         bool dupe;
+      } slots[3];
+      size_t size;
+      unsigned write;
+      unsigned ready;
+      unsigned read;
+      bool updated; /* 'ready' has not been picked up yet */
+      bool busy;    /* 'read' is being rendered */
       bool within_thread;
    } frame;
 
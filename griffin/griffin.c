@@ -146,6 +146,10 @@ COMPRESSION
 #include "../libretro-common/streams/rzip_stream.c"
 #endif
 
+#ifdef HAVE_ZSTD
+#include "../libretro-common/streams/trans_stream_zstd.c"
+#endif
+
 /*============================================================
 ENCODINGS
 ============================================================ */
@@ -240,6 +244,7 @@ CHEATS
 ============================================================ */
 #ifdef HAVE_CHEATS
 #include "../cheat_manager.c"
+#include "../cheat_search.c"
 #endif
 #include "../libretro-common/hash/lrc_hash.c"
 
@@ -372,6 +377,7 @@ VIDEO SHADERS
 ============================================================ */
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_HLSL) || defined(HAVE_SLANG)
 #include "../gfx/video_shader_parse.c"
+#include "../gfx/drivers_shader/shader_cache.c"
 #endif
 
 #ifdef HAVE_SLANG
@@ -565,6 +571,13 @@ VIDEO DRIVER
 #endif
 #endif
 
+#ifdef HAVE_NETWORK_VIDEO
+#include "../gfx/drivers/network_gfx.c"
+#ifdef HAVE_NETWORK_VIDEO_STREAM
+#include "../gfx/common/network_video_stream.c"
+#endif
+#endif
+
 #include "../deps/ibxm/ibxm.c"
 
 /*============================================================
@@ -785,6 +798,8 @@ INPUT (HID)
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_queue.c"
+#include "../libretro-common/queues/mpsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -1227,6 +1242,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1513,6 +1529,7 @@ XML
 #include "../libretro-db/rmsgpack.c"
 #include "../libretro-db/rmsgpack_dom.c"
 #include "../libretro-db/query.c"
+#include "../libretro-db/rdb_index.c"
 #include "../database_info.c"
 #endif
 
@@ -2330,6 +2330,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_LOG_TO_FILE_TIMESTAMP,
    "log_to_file_timestamp"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_LOG_ASYNC,
+   "log_async"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MAIN_MENU,
    "main_menu"
@@ -2628,6 +2632,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_NETWORK_ON_DEMAND_THUMBNAILS,
    "network_on_demand_thumbnails"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS,
+   "network_concurrent_thumbnail_downloads"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SUBSYSTEM_SETTINGS,
    "subsystem_settings"
@@ -3430,6 +3438,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_COMPRESS_HISTORY,
+   "rewind_compress_history"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_SETTINGS,
    "rewind_settings"
@@ -3540,6 +3552,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,
    "savestate_file_compression"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION_ZSTD,
+   "savestate_file_compression_zstd"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,
    "savestate_auto_save"
@@ -6058,6 +6074,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_PLAYLIST_COMPRESSION,
    "playlist_compression"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_PLAYLIST_BINARY_CACHE,
+   "playlist_binary_cache"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_SOUND_OK,
    "menu_sound_ok"
@@ -4759,6 +4759,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION,
    "Write save state files in an archived format. Dramatically reduces file size at the expense of increased saving/loading times."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SAVESTATE_FILE_COMPRESSION_ZSTD,
+   "Compress Save States with zstd"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION_ZSTD,
+   "Use zstd instead of zlib for compressed save state files. Saving and loading are faster, but builds of RetroArch without zstd support can't load these save states."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SORT_SCREENSHOTS_BY_CONTENT_ENABLE,
    "Sort Screenshots into Folders by Content Directory"
@@ -4878,6 +4886,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_LOG_TO_FILE_TIMESTAMP,
    "When logging to file, redirect the output from each RetroArch session to a new timestamped file. If disabled, log is overwritten each time RetroArch is restarted."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_LOG_ASYNC,
+   "Asynchronous Logging"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_LOG_ASYNC,
+   "Write log messages on a separate thread, in batches. Reduces stutter when logging a lot. Errors are still written immediately, but messages are dropped if they come in faster than they can be written."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PERFCNT_ENABLE,
    "Performance Counters"
@@ -5011,6 +5027,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_COMPRESS_HISTORY,
+   "Compress Older History"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_COMPRESS_HISTORY,
+   "Compress older rewind history into half of the rewind buffer instead of discarding it. Allows rewinding much further back with the same amount of memory."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -7585,6 +7609,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_NETWORK_ON_DEMAND_THUMBNAILS,
    "Automatically download missing thumbnails while browsing playlists. Has a severe performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS,
+   "Concurrent Thumbnail Downloads"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS,
+   "Number of thumbnails fetched at once when downloading the thumbnails of a playlist. Higher values are faster on slow connections."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_UPDATER_SETTINGS,
    "Updater Settings"
@@ -7711,6 +7743,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_PLAYLIST_COMPRESSION,
    "Archive playlist data when writing to disk. Reduces file size and loading times at the expense of (negligibly) increased CPU usage. May be used with either old or new format playlists."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_PLAYLIST_BINARY_CACHE,
+   "Cache Playlists"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_PLAYLIST_BINARY_CACHE,
+   "Keep a binary copy of each playlist next to it, which loads faster than the playlist itself. The copy is updated whenever the playlist changes."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PLAYLIST_SHOW_INLINE_CORE_NAME,
    "Show Associated Cores in Playlists"
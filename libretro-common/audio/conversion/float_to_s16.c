@@ -28,6 +28,15 @@
 #include <altivec.h>
 #endif
 
+/* The AVX2 kernel is built with a target attribute and
+ * only picked at runtime, see convert_float_to_s16_init_simd() */
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define HAVE_FLOAT_TO_S16_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
 #include <features/features_cpu.h>
 #include <audio/conversion/float_to_s16.h>
 
@@ -91,11 +100,19 @@ void convert_float_to_s16_init_simd(void)
       float_to_s16_neon_enabled = true;
 }
 #else
-void convert_float_to_s16(int16_t *out,
+
+#if defined(__SSE2__) || defined(HAVE_FLOAT_TO_S16_AVX2)
+/* Converts as many samples as the kernel handles at once,
+ * returns how many were converted */
+typedef size_t (*float_to_s16_simd_t)(int16_t *out,
+      const float *in, size_t samples);
+#endif
+
+#if defined(__SSE2__)
+static size_t convert_float_to_s16_sse2(int16_t *out,
       const float *in, size_t samples)
 {
    size_t i          = 0;
-#if defined(__SSE2__)
    __m128 factor     = _mm_set1_ps((float)0x8000);
    /* Initialize a 4D vector with 32768.0 for its elements */
 
@@ -112,8 +129,68 @@ void convert_float_to_s16(int16_t *out,
       _mm_storeu_si128((__m128i *)out, packed); /* Then put the result in the output array */
    }
 
-   samples           = samples - i;
-   i                 = 0;
+   return i;
+}
+#endif
+
+#ifdef HAVE_FLOAT_TO_S16_AVX2
+static __attribute__((target("avx2"))) size_t convert_float_to_s16_avx2(
+      int16_t *out, const float *in, size_t samples)
+{
+   size_t i          = 0;
+   __m256 factor     = _mm256_set1_ps((float)0x8000);
+
+   for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+   {
+      __m256i ints_a = _mm256_cvtps_epi32(
+            _mm256_mul_ps(_mm256_loadu_ps(in + 0), factor));
+      __m256i ints_b = _mm256_cvtps_epi32(
+            _mm256_mul_ps(_mm256_loadu_ps(in + 8), factor));
+      /* packs works within 128-bit lanes, put the quadwords
+       * back in order afterwards */
+      __m256i packed = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(ints_a, ints_b), _MM_SHUFFLE(3, 1, 2, 0));
+
+      _mm256_storeu_si256((__m256i *)out, packed);
+   }
+
+   /* Same rounding as the SSE2 kernel for the last 8 samples,
+    * the scalar tail truncates instead */
+   if (i + 8 <= samples)
+   {
+      __m128 factor_128 = _mm256_castps256_ps128(factor);
+      __m128i ints_a    = _mm_cvtps_epi32(
+            _mm_mul_ps(_mm_loadu_ps(in + 0), factor_128));
+      __m128i ints_b    = _mm_cvtps_epi32(
+            _mm_mul_ps(_mm_loadu_ps(in + 4), factor_128));
+
+      _mm_storeu_si128((__m128i *)out, _mm_packs_epi32(ints_a, ints_b));
+      i                += 8;
+   }
+
+   return i;
+}
+#endif
+
+#if defined(__SSE2__)
+static float_to_s16_simd_t float_to_s16_simd = convert_float_to_s16_sse2;
+#elif defined(HAVE_FLOAT_TO_S16_AVX2)
+static float_to_s16_simd_t float_to_s16_simd = NULL;
+#endif
+
+void convert_float_to_s16(int16_t *out,
+      const float *in, size_t samples)
+{
+   size_t i          = 0;
+#if defined(__SSE2__) || defined(HAVE_FLOAT_TO_S16_AVX2)
+   if (float_to_s16_simd)
+   {
+      i              = float_to_s16_simd(out, in, samples);
+      in            += i;
+      out           += i;
+      samples        = samples - i;
+      i              = 0;
+   }
    /* If there are any stray samples at the end, we need to convert them
     * (maybe the original array didn't contain a multiple of 8 samples) */
 #elif defined(__ALTIVEC__)
@@ -179,5 +256,15 @@ void convert_float_to_s16(int16_t *out,
    }
 }
 
-void convert_float_to_s16_init_simd(void) { }
+void convert_float_to_s16_init_simd(void)
+{
+#ifdef HAVE_FLOAT_TO_S16_AVX2
+   uint64_t cpu = cpu_features_get();
+
+   /* AVX2 is reported even when the OS doesn't save the
+    * YMM registers, AVX isn't */
+   if ((cpu & RETRO_SIMD_AVX) && (cpu & RETRO_SIMD_AVX2))
+      float_to_s16_simd = convert_float_to_s16_avx2;
+#endif
+}
 #endif
@@ -25,6 +25,15 @@
 #include <altivec.h>
 #endif
 
+/* The AVX2 kernel is built with a target attribute and
+ * only picked at runtime, see convert_s16_to_float_init_simd() */
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define HAVE_S16_TO_FLOAT_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
 #include <boolean.h>
 #include <features/features_cpu.h>
 #include <audio/conversion/s16_to_float.h>
@@ -90,12 +99,19 @@ void convert_s16_to_float_init_simd(void)
       s16_to_float_neon_enabled = true;
 }
 #else
-void convert_s16_to_float(float *out,
-      const int16_t *in, size_t samples, float gain)
-{
-   unsigned i      = 0;
+
+#if defined(__SSE2__) || defined(HAVE_S16_TO_FLOAT_AVX2)
+/* Converts as many samples as the kernel handles at once,
+ * returns how many were converted */
+typedef size_t (*s16_to_float_simd_t)(float *out,
+      const int16_t *in, size_t samples, float gain);
+#endif
 
 #if defined(__SSE2__)
+static size_t convert_s16_to_float_sse2(float *out,
+      const int16_t *in, size_t samples, float gain)
+{
+   size_t i      = 0;
    float fgain   = gain / UINT32_C(0x80000000);
    __m128 factor = _mm_set1_ps(fgain);
 
@@ -111,8 +127,54 @@ void convert_s16_to_float(float *out,
       _mm_storeu_ps(out + 4, output_r);
    }
 
-   samples = samples - i;
-   i       = 0;
+   return i;
+}
+#endif
+
+#ifdef HAVE_S16_TO_FLOAT_AVX2
+static __attribute__((target("avx2"))) size_t convert_s16_to_float_avx2(
+      float *out, const int16_t *in, size_t samples, float gain)
+{
+   size_t i      = 0;
+   __m256 factor = _mm256_set1_ps(gain / 0x8000);
+
+   for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+   {
+      __m256i input   = _mm256_loadu_si256((const __m256i *)in);
+      __m256i regs_l  = _mm256_cvtepi16_epi32(
+            _mm256_castsi256_si128(input));
+      __m256i regs_r  = _mm256_cvtepi16_epi32(
+            _mm256_extracti128_si256(input, 1));
+
+      _mm256_storeu_ps(out + 0,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(regs_l), factor));
+      _mm256_storeu_ps(out + 8,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(regs_r), factor));
+   }
+
+   return i;
+}
+#endif
+
+#if defined(__SSE2__)
+static s16_to_float_simd_t s16_to_float_simd = convert_s16_to_float_sse2;
+#elif defined(HAVE_S16_TO_FLOAT_AVX2)
+static s16_to_float_simd_t s16_to_float_simd = NULL;
+#endif
+
+void convert_s16_to_float(float *out,
+      const int16_t *in, size_t samples, float gain)
+{
+   unsigned i      = 0;
+
+#if defined(__SSE2__) || defined(HAVE_S16_TO_FLOAT_AVX2)
+   if (s16_to_float_simd)
+   {
+      size_t done  = s16_to_float_simd(out, in, samples, gain);
+      in          += done;
+      out         += done;
+      samples      = samples - done;
+   }
 #elif defined(__ALTIVEC__)
    size_t samples_in = samples;
 
@@ -200,6 +262,16 @@ void convert_s16_to_float(float *out,
       out[i] = (float)in[i] * gain;
 }
 
-void convert_s16_to_float_init_simd(void) { }
+void convert_s16_to_float_init_simd(void)
+{
+#ifdef HAVE_S16_TO_FLOAT_AVX2
+   uint64_t cpu = cpu_features_get();
+
+   /* AVX2 is reported even when the OS doesn't save the
+    * YMM registers, AVX isn't */
+   if ((cpu & RETRO_SIMD_AVX) && (cpu & RETRO_SIMD_AVX2))
+      s16_to_float_simd = convert_s16_to_float_avx2;
+#endif
+}
 #endif
 
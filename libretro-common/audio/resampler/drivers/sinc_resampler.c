@@ -35,13 +35,45 @@
 #include <audio/audio_resampler.h>
 #include <filters.h>
 
+/* On x86, the SIMD kernels are built with per-function target
+ * attributes and picked in resampler_sinc_new() from the CPU
+ * features, so generic builds still get the AVX and AVX2/FMA
+ * paths. Other compilers only get what they were built for. */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define HAVE_SINC_X86_DISPATCH
+#define SINC_TARGET_SSE __attribute__((target("sse")))
+#define SINC_TARGET_AVX __attribute__((target("avx")))
+#define SINC_TARGET_FMA __attribute__((target("avx2,fma")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1800
+#define HAVE_SINC_X86_DISPATCH
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef HAVE_SINC_X86_DISPATCH
+#define HAVE_SINC_SSE
+#define HAVE_SINC_AVX
+#define HAVE_SINC_FMA
+#else
 #ifdef __SSE__
+#define HAVE_SINC_SSE
 #include <xmmintrin.h>
 #endif
-
 #if defined(__AVX__)
+#define HAVE_SINC_AVX
 #include <immintrin.h>
 #endif
+#endif
+
+#ifndef SINC_TARGET_SSE
+#define SINC_TARGET_SSE
+#define SINC_TARGET_AVX
+#define SINC_TARGET_FMA
+#endif
 
 /* Rough SNR values for upsampling:
  * LOWEST: 40 dB
@@ -240,8 +272,9 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__AVX__)
-static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *data)
+#ifdef HAVE_SINC_AVX
+static SINC_TARGET_AVX void resampler_sinc_process_avx_kaiser(
+      void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -326,7 +359,8 @@ static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *
    data->output_frames = out_frames;
 }
 
-static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
+static SINC_TARGET_AVX void resampler_sinc_process_avx(
+      void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -364,7 +398,6 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
             while (resamp->time < phases)
             {
                int i;
-               __m256 delta;
                unsigned phase           = resamp->time >> resamp->subphase_bits;
                float *phase_table       = resamp->phase_table + phase * taps;
 
@@ -407,8 +440,178 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__SSE__)
-static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *data)
+#ifdef HAVE_SINC_FMA
+/* Same as the AVX kernels, with the multiply-adds fused */
+static SINC_TARGET_FMA void resampler_sinc_process_fma_kaiser(
+      void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+   unsigned taps                  = resamp->taps;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + taps] =
+            resamp->buffer_l[resamp->ptr]     = *input++;
+
+         resamp->buffer_r[resamp->ptr + taps] =
+            resamp->buffer_r[resamp->ptr]     = *input++;
+
+         resamp->time                        -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         while (resamp->time < phases)
+         {
+            int i;
+            __m256 res_l, res_r;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+            float *phase_table       = resamp->phase_table + phase * taps * 2;
+            float *delta_table       = phase_table + taps;
+            __m256 delta             = _mm256_set1_ps((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+            __m256 sum_l             = _mm256_setzero_ps();
+            __m256 sum_r             = _mm256_setzero_ps();
+
+            for (i = 0; i < (int)taps; i += 8)
+            {
+               __m256 sinc   = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i), delta,
+                     _mm256_load_ps((const float*)phase_table + i));
+               sum_l         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+
+            res_l        = _mm256_hadd_ps(sum_l, sum_l);
+            res_r        = _mm256_hadd_ps(sum_r, sum_r);
+            res_l        = _mm256_hadd_ps(res_l, res_l);
+            res_r        = _mm256_hadd_ps(res_r, res_r);
+            res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+            res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+            _mm_store_ss(output + 0, _mm256_castps256_ps128(res_l));
+            _mm_store_ss(output + 1, _mm256_castps256_ps128(res_r));
+
+            output += 2;
+            out_frames++;
+            resamp->time += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static SINC_TARGET_FMA void resampler_sinc_process_fma(
+      void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+   unsigned taps                  = resamp->taps;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + taps] =
+            resamp->buffer_l[resamp->ptr]     = *input++;
+
+         resamp->buffer_r[resamp->ptr + taps] =
+            resamp->buffer_r[resamp->ptr]     = *input++;
+
+         resamp->time                        -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         while (resamp->time < phases)
+         {
+            int i;
+            __m256 res_l, res_r;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+            float *phase_table       = resamp->phase_table + phase * taps;
+            __m256 sum_l             = _mm256_setzero_ps();
+            __m256 sum_r             = _mm256_setzero_ps();
+
+            for (i = 0; i < (int)taps; i += 8)
+            {
+               __m256 sinc   = _mm256_load_ps((const float*)phase_table + i);
+               sum_l         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+
+            res_l        = _mm256_hadd_ps(sum_l, sum_l);
+            res_r        = _mm256_hadd_ps(sum_r, sum_r);
+            res_l        = _mm256_hadd_ps(res_l, res_l);
+            res_r        = _mm256_hadd_ps(res_r, res_r);
+            res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+            res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+            _mm_store_ss(output + 0, _mm256_castps256_ps128(res_l));
+            _mm_store_ss(output + 1, _mm256_castps256_ps128(res_r));
+
+            output += 2;
+            out_frames++;
+            resamp->time += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+/* AVX2 doesn't imply FMA, check for it separately */
+static bool resampler_sinc_has_fma(void)
+{
+#if defined(_MSC_VER)
+   int regs[4];
+   __cpuid(regs, 1);
+   return (regs[2] & (1 << 12)) != 0;
+#else
+   unsigned eax, ebx, ecx, edx;
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+   return (ecx & (1 << 12)) != 0;
+#endif
+}
+#endif
+
+#ifdef HAVE_SINC_SSE
+static SINC_TARGET_SSE void resampler_sinc_process_sse_kaiser(
+      void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -503,7 +706,8 @@ static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *
    data->output_frames = out_frames;
 }
 
-static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
+static SINC_TARGET_SSE void resampler_sinc_process_sse(
+      void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -866,6 +1070,8 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    size_t phase_elems             = 0;
    size_t elems                   = 0;
    unsigned enable_avx            = 0;
+   bool use_avx                   = false;
+   bool use_fma                   = false;
    unsigned sidelobes             = 0;
    enum sinc_window window_type   = SINC_WINDOW_NONE;
    rarch_sinc_resampler_t *re     = (rarch_sinc_resampler_t*)
@@ -931,12 +1137,18 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
+#ifdef HAVE_SINC_AVX
+   use_avx = enable_avx && (mask & RESAMPLER_SIMD_AVX);
+#endif
+#ifdef HAVE_SINC_FMA
+   use_fma = use_avx && (mask & RESAMPLER_SIMD_AVX2)
+      && resampler_sinc_has_fma();
+#endif
+
    /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (enable_avx)
+   if (use_avx)
       re->taps  = (re->taps + 7) & ~7;
    else
-#endif
    {
 #if (defined(__ARM_NEON__) || defined(HAVE_NEON))
       re->taps     = (re->taps + 7) & ~7;
@@ -978,23 +1190,34 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    if (window_type == SINC_WINDOW_KAISER)
       sinc_resampler.process    = resampler_sinc_process_c_kaiser;
 
-   if (mask & RESAMPLER_SIMD_AVX && enable_avx)
+#ifdef HAVE_SINC_FMA
+   if (use_fma)
+   {
+      sinc_resampler.process    = resampler_sinc_process_fma;
+      if (window_type == SINC_WINDOW_KAISER)
+         sinc_resampler.process = resampler_sinc_process_fma_kaiser;
+   }
+   else
+#endif
+#ifdef HAVE_SINC_AVX
+   if (use_avx)
    {
-#if defined(__AVX__)
       sinc_resampler.process    = resampler_sinc_process_avx;
       if (window_type == SINC_WINDOW_KAISER)
          sinc_resampler.process = resampler_sinc_process_avx_kaiser;
-#endif
    }
-   else if (mask & RESAMPLER_SIMD_SSE)
+   else
+#endif
+#ifdef HAVE_SINC_SSE
+   if (mask & RESAMPLER_SIMD_SSE)
    {
-#if defined(__SSE__)
       sinc_resampler.process = resampler_sinc_process_sse;
       if (window_type == SINC_WINDOW_KAISER)
          sinc_resampler.process = resampler_sinc_process_sse_kaiser;
-#endif
    }
-   else if (mask & RESAMPLER_SIMD_NEON)
+   else
+#endif
+   if (mask & RESAMPLER_SIMD_NEON)
    {
 #if (defined(__ARM_NEON__) || defined(HAVE_NEON))
 #ifdef HAVE_ARM_NEON_ASM_OPTIMIZATIONS
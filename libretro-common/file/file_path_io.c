@@ -33,6 +33,7 @@
 #include <compat/posix_string.h>
 #include <retro_miscellaneous.h>
 #include <string/stdstring.h>
+#include <encodings/utf.h>
 #define VFS_FRONTEND
 #include <vfs/vfs_implementation.h>
 
@@ -98,6 +99,50 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the time @path was last modified. The VFS
+ * interface can't tell, so this always goes to the
+ * host file system.
+ *
+ * @return seconds since the epoch, or 0 if unknown.
+ */
+int64_t path_get_mtime(const char *path)
+{
+#if defined(VITA) || defined(__PSL1GHT__) || defined(__PS3__) || defined(_XBOX)
+   return 0;
+#elif defined(_WIN32)
+   struct _stat stat_buf;
+   int ret;
+#if defined(LEGACY_WIN32)
+   char *path_local    = utf8_to_local_string_alloc(path);
+
+   if (!path_local)
+      return 0;
+   ret                 = _stat(path_local, &stat_buf);
+   free(path_local);
+#else
+   wchar_t *path_wide  = utf8_to_utf16_string_alloc(path);
+
+   if (!path_wide)
+      return 0;
+   ret                 = _wstat(path_wide, &stat_buf);
+   free(path_wide);
+#endif
+   if (ret < 0)
+      return 0;
+   return (int64_t)stat_buf.st_mtime;
+#else
+   struct stat stat_buf;
+
+   if (!path || !*path || stat(path, &stat_buf) < 0)
+      return 0;
+   return (int64_t)stat_buf.st_mtime;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
@@ -125,6 +125,24 @@ uint8_t* net_http_data(struct http_t *state, size_t* len, bool accept_error);
  **/
 void net_http_delete(struct http_t *state);
 
+/**
+ * net_http_pool_init:
+ *
+ * Keeps connections open after their request is done,
+ * for later requests to the same host to reuse. Idle
+ * connections are closed after a few seconds.
+ * Without it, every request opens a new connection.
+ **/
+void net_http_pool_init(void);
+
+/**
+ * net_http_pool_deinit:
+ *
+ * Closes all idle connections. Requests still in
+ * flight close theirs once they are deleted.
+ **/
+void net_http_pool_deinit(void);
+
 /**
  * net_http_urlencode:
  *
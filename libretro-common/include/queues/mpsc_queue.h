@@ -0,0 +1,110 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (mpsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_MPSC_QUEUE_H
+#define __LIBRETRO_SDK_MPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+/**
+ * A bounded multiple-producer/single-consumer message queue.
+ *
+ * Any number of threads may write messages to it at once,
+ * without locks where the compiler provides atomics. Each
+ * message is written whole or not at all, and messages are
+ * read back as one stream of bytes, in the order they were
+ * queued. Messages that don't fit are dropped and counted.
+ *
+ * Only one thread may read at a time; callers that read
+ * from several threads must serialize the reads themselves.
+ */
+typedef struct mpsc_queue mpsc_queue_t;
+
+/**
+ * Creates a new queue that can hold about \c size bytes.
+ * Must be freed with \c mpsc_queue_free.
+ *
+ * @param size The capacity of the queue, in bytes.
+ * @return The new queue if successful, \c NULL otherwise.
+ */
+mpsc_queue_t *mpsc_queue_new(size_t size);
+
+/**
+ * Releases \c queue and its contents.
+ * No thread may be using it anymore.
+ *
+ * @param queue The queue to free.
+ * If \c NULL, this function will do nothing.
+ */
+void mpsc_queue_free(mpsc_queue_t *queue);
+
+/**
+ * Queues a message. May be called by any thread.
+ *
+ * @param queue The queue to write to.
+ * @param in_buf The message.
+ * @param size The length of \c in_buf, in bytes.
+ * @return \c true if the message was queued, \c false if
+ * there wasn't room for it and it was dropped.
+ */
+bool mpsc_queue_write(mpsc_queue_t *queue,
+      const void *in_buf, size_t size);
+
+/**
+ * Reads up to \c size bytes of queued messages.
+ * A message may be split across reads.
+ *
+ * @param queue The queue to read from.
+ * @param out_buf The buffer to store the read bytes in.
+ * @param size The length of \c out_buf, in bytes.
+ * @return The number of bytes read, 0 if the queue is empty
+ * or the next message is still being written.
+ */
+size_t mpsc_queue_read(mpsc_queue_t *queue, void *out_buf, size_t size);
+
+/**
+ * Tells whether at least half of the queue is waiting
+ * to be read. Producers can use this to wake the
+ * consumer before messages start being dropped.
+ *
+ * @param queue The queue to check.
+ * @return \c true if the queue is at least half full.
+ */
+bool mpsc_queue_half_full(mpsc_queue_t *queue);
+
+/**
+ * Returns the number of messages dropped since the last
+ * call, and resets the count.
+ *
+ * @param queue The queue to check.
+ */
+size_t mpsc_queue_take_dropped(mpsc_queue_t *queue);
+
+RETRO_END_DECLS
+
+#endif
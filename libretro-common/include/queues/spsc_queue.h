@@ -0,0 +1,114 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+/**
+ * A bounded single-producer/single-consumer byte queue.
+ *
+ * Unlike \c fifo_buffer_t, one thread may write to it while
+ * another one reads from it without any further synchronization.
+ * Both sides only ever touch their own end of the queue,
+ * using atomics where the compiler provides them
+ * (or a short internal lock around the indices otherwise),
+ * so neither side ever waits for the other one.
+ *
+ * Callers that need to sleep until there is data or room
+ * still need their own condition variable.
+ */
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * Creates a new queue that can hold up to \c size bytes.
+ * Must be freed with \c spsc_queue_free.
+ *
+ * @param size The capacity of the queue, in bytes.
+ * @return The new queue if successful, \c NULL otherwise.
+ */
+spsc_queue_t *spsc_queue_new(size_t size);
+
+/**
+ * Releases \c queue and its contents.
+ * Neither side may be using it anymore.
+ *
+ * @param queue The queue to free.
+ * If \c NULL, this function will do nothing.
+ */
+void spsc_queue_free(spsc_queue_t *queue);
+
+/**
+ * Returns how many bytes can be read from \c queue.
+ *
+ * Exact when called by the consumer, a lower bound otherwise,
+ * as the producer may add more at any time.
+ *
+ * @param queue The queue to check.
+ */
+size_t spsc_queue_read_avail(spsc_queue_t *queue);
+
+/**
+ * Returns how many bytes can be written to \c queue.
+ *
+ * Exact when called by the producer, a lower bound otherwise,
+ * as the consumer may free up more at any time.
+ *
+ * @param queue The queue to check.
+ */
+size_t spsc_queue_write_avail(spsc_queue_t *queue);
+
+/**
+ * Writes up to \c size bytes to \c queue.
+ * Must only be called by the producer.
+ *
+ * @param queue The queue to write to.
+ * @param in_buf The buffer to read bytes from.
+ * @param size The length of \c in_buf, in bytes.
+ * @return The number of bytes written,
+ * less than \c size if the queue is (nearly) full.
+ */
+size_t spsc_queue_write(spsc_queue_t *queue,
+      const void *in_buf, size_t size);
+
+/**
+ * Reads up to \c size bytes from \c queue.
+ * Must only be called by the consumer.
+ *
+ * @param queue The queue to read from.
+ * @param out_buf The buffer to store the read bytes in.
+ * @param size The length of \c out_buf, in bytes.
+ * @return The number of bytes read,
+ * less than \c size if the queue is (nearly) empty.
+ */
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size);
+
+RETRO_END_DECLS
+
+#endif
@@ -46,6 +46,29 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/**
+ * The scheduling class of a task.
+ * Only meaningful when the task queue is threaded;
+ * idle workers always pick up the most urgent runnable task first.
+ */
+enum task_priority
+{
+   /** Work the user is actively waiting on (e.g. savestates, screenshots). */
+   TASK_PRIORITY_INTERACTIVE = 0,
+
+   /** Regular I/O bound work. The default for new tasks. */
+   TASK_PRIORITY_IO,
+
+   /**
+    * Long-running bulk work (e.g. database scans, thumbnail downloads).
+    * Background tasks are never allowed to occupy every worker at once,
+    * so more urgent tasks can always start immediately.
+    */
+   TASK_PRIORITY_BACKGROUND,
+
+   TASK_PRIORITY_COUNT
+};
+
 enum task_style
 {
    TASK_STYLE_NONE,
@@ -245,6 +268,13 @@ struct retro_task
    enum task_type type;
    enum task_style style;
 
+   /**
+    * The scheduling class of this task.
+    * Defaults to \c TASK_PRIORITY_IO.
+    * Set by the caller before the task is pushed.
+    */
+   enum task_priority priority;
+
    /**
     * If \c true, the frontend should use some alternative means
     * of displaying this task's progress or messages.
@@ -610,6 +640,28 @@ void task_queue_unset_threaded(void);
  */
 bool task_queue_is_threaded(void);
 
+/**
+ * Sets the number of worker threads used by the threaded task queue.
+ *
+ * If the task queue is already running in threaded mode,
+ * it will be recreated with the new number of workers
+ * next time \c task_queue_check is called.
+ *
+ * @param num The number of workers,
+ * or 0 to pick one based on the number of CPU cores.
+ * @see task_queue_get_num_workers
+ */
+void task_queue_set_num_workers(unsigned num);
+
+/**
+ * Returns the number of worker threads
+ * the threaded task queue runs (or will run) with.
+ *
+ * @return The number of workers.
+ * @see task_queue_set_num_workers
+ */
+unsigned task_queue_get_num_workers(void);
+
 /**
  * Calls the function given in \c find_data for each task
  * until it returns \c true for one of them,
@@ -653,7 +705,8 @@ void task_queue_check(void);
  *
  * @param task The task to schedule.
  * @return \c true unless \c task's type is \c TASK_TYPE_BLOCKING
- * and there's already a blocking task in the queue.
+ * and there's already a blocking task in the queue,
+ * or there was no memory left to queue it.
  */
 bool task_queue_push(retro_task_t *task);
 
@@ -715,11 +768,12 @@ void task_queue_deinit(void);
  * Must be called before any other task_queue_* function,
  * and must only be called from the main thread.
  *
- * @param threaded \c true if tasks should run on a separate thread,
+ * @param threaded \c true if tasks should run on a pool of worker threads,
  * \c false if they should remain on the calling thread.
- * All tasks run in sequence on a single thread.
- * If you want to scale a task to multiple threads,
- * you must do so within the task itself.
+ * In threaded mode, tasks are spread across the workers
+ * (see \c task_queue_set_num_workers) and scheduled by \c retro_task::priority.
+ * A task's handler never runs on two threads at once,
+ * and two tasks sharing the same handler never run concurrently.
  * @param msg_push The task system will call this function to output messages.
  * If \c NULL, no messages will be output.
  * @note Calling this function while the task system is already initialized
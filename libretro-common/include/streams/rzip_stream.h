@@ -33,7 +33,7 @@
 RETRO_BEGIN_DECLS
 
 /* Rudimentary interface for streaming data to/from a
- * zlib-compressed chunk-based RZIP archive file.
+ * zlib (or zstd) compressed chunk-based RZIP archive file.
  * 
  * This is somewhat less efficient than using regular
  * gzip code, but this is by design - the intention here
@@ -51,6 +51,11 @@ RETRO_BEGIN_DECLS
  * is handled automatically. File type (compressed/
  * uncompressed) is detected via the RZIP header.
  * 
+ * Chunks are compressed independently, so when
+ * threads are available several are compressed at
+ * once, and the next chunk is decoded while the
+ * current one is being read.
+ * 
  * ## RZIP file format:
  * 
  * <file id header>:                8 bytes
@@ -59,10 +64,14 @@ RETRO_BEGIN_DECLS
  *                                  - nominal (maximum) size of each uncompressed
  *                                    chunk, in bytes
  * <total uncompressed data size>:  8 bytes, little endian order
+ * <chunk codec>:                   4 bytes, little endian order
+ *                                  - file format version 2 only (version 1
+ *                                    files always use zlib): 0 for zlib,
+ *                                    1 for zstd
  * <size of next compressed chunk>: 4 bytes, little endian order
  *                                  - size on-disk of next compressed data
  *                                    chunk, in bytes
- * <next compressed chunk>:         n bytes of zlib compressed data
+ * <next compressed chunk>:         n bytes of zlib (or zstd) compressed data
  * ...
  * <size of next compressed chunk> : repeated until end of file
  * <next compressed chunk>         :
@@ -72,6 +81,29 @@ RETRO_BEGIN_DECLS
 /* Prevent direct access to rzipstream_t members */
 typedef struct rzipstream rzipstream_t;
 
+/* Codecs compressing RZIP chunks */
+enum rzip_codec
+{
+   RZIP_CODEC_ZLIB = 0,
+   /* Requires HAVE_ZSTD; files using it can
+    * only be read by builds that have it */
+   RZIP_CODEC_ZSTD
+};
+
+/* Thread Pool */
+
+/* Creates the threads that all streams compress
+ * (or decode ahead) chunks on, one less than there
+ * are cores
+ * > Must not be called while a stream is open
+ * > Without it, streams do everything on the
+ *   calling thread */
+void rzipstream_init_pool(void);
+
+/* Stops the threads created by rzipstream_init_pool()
+ * > Must not be called while a stream is open */
+void rzipstream_deinit_pool(void);
+
 /* File Open */
 
 /* Opens a new or existing RZIP file
@@ -84,6 +116,16 @@ typedef struct rzipstream rzipstream_t;
  * is invalid or an IO error occurs */
 rzipstream_t* rzipstream_open(const char *path, unsigned mode);
 
+/* Opens a new or existing RZIP file, writing
+ * chunks compressed with 'codec'
+ * > When reading, 'codec' is ignored: it is
+ *   taken from the file header
+ * Returns NULL if arguments are invalid, file
+ * is invalid, the codec isn't available or an
+ * IO error occurs */
+rzipstream_t* rzipstream_open_codec(const char *path, unsigned mode,
+      enum rzip_codec codec);
+
 /* File Read */
 
 /* Reads (a maximum of) 'len' bytes from an RZIP file.
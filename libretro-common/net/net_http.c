@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <net/net_http.h>
 #include <net/net_compat.h>
@@ -36,6 +37,18 @@
 #include <lists/string_list.h>
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Idle connections kept open by the pool */
+#define HTTP_POOL_SIZE         8
+/* Seconds an idle connection is kept, below the
+ * keep-alive timeout of common servers */
+#define HTTP_POOL_IDLE_TIMEOUT 4
+/* Request bodies up to this size are sent along
+ * with the headers, in a single write */
+#define HTTP_REQUEST_INLINE    65536
 
 enum
 {
@@ -43,6 +56,7 @@ enum
    P_HEADER,
    P_BODY,
    P_BODY_CHUNKLEN,
+   P_BODY_CHUNKEND,
    P_DONE,
    P_ERROR
 };
@@ -65,14 +79,38 @@ struct http_t
 {
    char *data;
    struct string_list *headers;
+   char *domain;
+   /* kept until the response starts, to be sent
+    * again if a reused connection turns out dead */
+   char *request;
    struct http_socket_state_t sock_state; /* ptr alignment */
    size_t pos;
    size_t len;
    size_t buflen;
+   size_t request_len;
    int status;
+   int port;
    char part;
    char bodytype;
    bool error;
+   bool keep_alive;
+   bool reused;
+};
+
+struct http_pool_entry_t
+{
+   char *domain;
+   struct http_socket_state_t sock_state; /* ptr alignment */
+   time_t idle_since;
+   int port;
+};
+
+struct http_request_t
+{
+   char *data;
+   size_t len;
+   size_t size;
+   bool error;
 };
 
 struct http_connection_t
@@ -91,6 +129,18 @@ struct http_connection_t
    int port;
 };
 
+static struct http_pool_entry_t http_pool[HTTP_POOL_SIZE];
+static size_t http_pool_size  = 0;
+static bool http_pool_enabled = false;
+#ifdef HAVE_THREADS
+static slock_t *http_pool_lock = NULL;
+#define HTTP_POOL_LOCK()   slock_lock(http_pool_lock)
+#define HTTP_POOL_UNLOCK() slock_unlock(http_pool_lock)
+#else
+#define HTTP_POOL_LOCK()
+#define HTTP_POOL_UNLOCK()
+#endif
+
 /**
  * net_http_urlencode:
  *
@@ -425,18 +475,19 @@ void net_http_urlencode_full(char *dest,
    free(tmp);
 }
 
-static int net_http_new_socket(struct http_connection_t *conn)
+static int net_http_new_socket(struct http_socket_state_t *sock_state,
+      const char *domain, int port)
 {
    struct addrinfo *addr = NULL, *next_addr = NULL;
    int fd                = socket_init(
-         (void**)&addr, conn->port, conn->domain, SOCKET_TYPE_STREAM, 0);
+         (void**)&addr, port, domain, SOCKET_TYPE_STREAM, 0);
 #ifdef HAVE_SSL
-   if (conn->sock_state.ssl)
+   if (sock_state->ssl)
    {
       if (fd < 0)
          goto done;
 
-      if (!(conn->sock_state.ssl_ctx = ssl_socket_init(fd, conn->domain)))
+      if (!(sock_state->ssl_ctx = ssl_socket_init(fd, domain)))
       {
          socket_close(fd);
          fd = -1;
@@ -450,11 +501,11 @@ static int net_http_new_socket(struct http_connection_t *conn)
       /* Temp fix, don't use new timeout/poll code for cheevos http requests */
          bool timeout = true;
 #ifdef __WIN32
-      if (!strcmp(conn->domain, "retroachievements.org"))
+      if (!strcmp(domain, "retroachievements.org"))
          timeout = false;
 #endif
 
-      if (ssl_socket_connect(conn->sock_state.ssl_ctx, addr, timeout, true)
+      if (ssl_socket_connect(sock_state->ssl_ctx, addr, timeout, true)
             < 0)
       {
          fd = -1;
@@ -477,11 +528,218 @@ done:
    if (addr)
       freeaddrinfo_retro(addr);
 
-   conn->sock_state.fd = fd;
+   sock_state->fd = fd;
 
    return fd;
 }
 
+static void net_http_close_socket(struct http_socket_state_t *sock_state)
+{
+#ifdef HAVE_SSL
+   if (sock_state->ssl && sock_state->ssl_ctx)
+   {
+      ssl_socket_close(sock_state->ssl_ctx);
+      ssl_socket_free(sock_state->ssl_ctx);
+      sock_state->ssl_ctx = NULL;
+   }
+   else
+#endif
+   if (sock_state->fd >= 0)
+      socket_close(sock_state->fd);
+   sock_state->fd = -1;
+}
+
+/**
+ * net_http_pool_take:
+ *
+ * Takes an idle connection to the host of @conn out of
+ * the pool, closing those that have been idle too long.
+ *
+ * @return true if @conn was given a connection.
+ **/
+static bool net_http_pool_take(struct http_connection_t *conn)
+{
+   size_t i;
+   bool found = false;
+   time_t now = time(NULL);
+
+   HTTP_POOL_LOCK();
+   for (i = http_pool_size; i-- > 0; )
+   {
+      struct http_pool_entry_t *entry = &http_pool[i];
+      bool expired = (now - entry->idle_since >= HTTP_POOL_IDLE_TIMEOUT);
+
+      if (     !found
+            && !expired
+            &&  entry->port           == conn->port
+            &&  entry->sock_state.ssl == conn->sock_state.ssl
+            &&  string_is_equal(entry->domain, conn->domain))
+      {
+         conn->sock_state = entry->sock_state;
+         found            = true;
+      }
+      else if (expired)
+         net_http_close_socket(&entry->sock_state);
+      else
+         continue;
+
+      free(entry->domain);
+      http_pool[i] = http_pool[--http_pool_size];
+   }
+   HTTP_POOL_UNLOCK();
+
+   if (found)
+   {
+      /* An idle connection has nothing to read,
+       * unless the server closed it meanwhile */
+      bool readable = true;
+      if (     !socket_wait(conn->sock_state.fd, &readable, NULL, 0)
+            || readable)
+      {
+         net_http_close_socket(&conn->sock_state);
+         return false;
+      }
+   }
+
+   return found;
+}
+
+/**
+ * net_http_pool_put:
+ *
+ * Hands the connection of a finished request to the
+ * pool, or closes it if the pool is disabled.
+ **/
+static void net_http_pool_put(struct http_t *state)
+{
+   bool put = false;
+
+#ifdef HAVE_THREADS
+   if (!http_pool_lock)
+   {
+      net_http_close_socket(&state->sock_state);
+      return;
+   }
+#endif
+
+   HTTP_POOL_LOCK();
+   if (http_pool_enabled)
+   {
+      struct http_pool_entry_t *entry = NULL;
+
+      if (http_pool_size < HTTP_POOL_SIZE)
+         entry = &http_pool[http_pool_size++];
+      else
+      {
+         /* Make room by closing the longest idle */
+         size_t i;
+         entry = &http_pool[0];
+         for (i = 1; i < http_pool_size; i++)
+            if (http_pool[i].idle_since < entry->idle_since)
+               entry = &http_pool[i];
+         net_http_close_socket(&entry->sock_state);
+         free(entry->domain);
+      }
+
+      entry->domain     = state->domain;
+      entry->sock_state = state->sock_state;
+      entry->idle_since = time(NULL);
+      entry->port       = state->port;
+      state->domain     = NULL;
+      put               = true;
+   }
+   HTTP_POOL_UNLOCK();
+
+   if (!put)
+      net_http_close_socket(&state->sock_state);
+}
+
+/**
+ * net_http_pool_init:
+ *
+ * Keeps connections open after their request is done,
+ * for later requests to the same host to reuse.
+ **/
+void net_http_pool_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!http_pool_lock)
+      http_pool_lock = slock_new();
+   if (!http_pool_lock)
+      return;
+#endif
+   HTTP_POOL_LOCK();
+   http_pool_enabled = true;
+   HTTP_POOL_UNLOCK();
+}
+
+/**
+ * net_http_pool_deinit:
+ *
+ * Closes all idle connections. Requests still in
+ * flight close theirs once they are deleted.
+ **/
+void net_http_pool_deinit(void)
+{
+   size_t i;
+
+#ifdef HAVE_THREADS
+   if (!http_pool_lock)
+      return;
+#endif
+
+   HTTP_POOL_LOCK();
+   for (i = 0; i < http_pool_size; i++)
+   {
+      net_http_close_socket(&http_pool[i].sock_state);
+      free(http_pool[i].domain);
+   }
+   http_pool_size    = 0;
+   http_pool_enabled = false;
+   HTTP_POOL_UNLOCK();
+
+#ifdef HAVE_THREADS
+   slock_free(http_pool_lock);
+   http_pool_lock = NULL;
+#endif
+}
+
+static bool net_http_pool_is_enabled(void)
+{
+   bool enabled;
+#ifdef HAVE_THREADS
+   if (!http_pool_lock)
+      return false;
+#endif
+   HTTP_POOL_LOCK();
+   enabled = http_pool_enabled;
+   HTTP_POOL_UNLOCK();
+   return enabled;
+}
+
+static void net_http_request_append(struct http_request_t *request,
+      const char *text, size_t text_size)
+{
+   if (request->error)
+      return;
+
+   if (request->len + text_size > request->size)
+   {
+      size_t size = MAX(request->size * 2, request->len + text_size);
+      char  *data = (char*)realloc(request->data, size);
+      if (!data)
+      {
+         request->error = true;
+         return;
+      }
+      request->data = data;
+      request->size = size;
+   }
+
+   memcpy(request->data + request->len, text, text_size);
+   request->len += text_size;
+}
+
 static void net_http_send_str(
       struct http_socket_state_t *sock_state, bool *error,
       const char *text, size_t text_size)
@@ -740,38 +998,58 @@ const char* net_http_connection_method(struct http_connection_t* conn)
 
 struct http_t *net_http_new(struct http_connection_t *conn)
 {
+   struct http_request_t request;
    bool error            = false;
-#ifdef HAVE_SSL
-   if (!conn || (net_http_new_socket(conn)) < 0)
+   bool reused           = false;
+   bool keep_alive       = false;
+   struct http_t *state  = NULL;
+
+   if (!conn)
       return NULL;
-#else
-   int fd                = -1;
-   if (!conn || (fd = net_http_new_socket(conn)) < 0)
+
+   /* A request on a pooled connection is sent again if
+    * that connection turns out dead, by which time the
+    * server may have acted on it. Only requests that can
+    * safely be repeated use pooled connections. */
+   keep_alive = net_http_pool_is_enabled();
+   if (     keep_alive
+         && (     !conn->methodcopy
+               || string_is_equal(conn->methodcopy, "GET")
+               || string_is_equal(conn->methodcopy, "HEAD")))
+      reused = net_http_pool_take(conn);
+   if (!reused && net_http_new_socket(&conn->sock_state,
+            conn->domain, conn->port) < 0)
       return NULL;
-#endif
+
+   request.data  = NULL;
+   request.len   = 0;
+   request.size  = 512;
+   request.error = false;
+   if (!(request.data = (char*)malloc(request.size)))
+      goto err;
 
    /* This is a bit lazy, but it works. */
    if (conn->methodcopy)
    {
-      net_http_send_str(&conn->sock_state, &error, conn->methodcopy,
+      net_http_request_append(&request, conn->methodcopy,
             strlen(conn->methodcopy));
-      net_http_send_str(&conn->sock_state, &error, " /",
+      net_http_request_append(&request, " /",
             STRLEN_CONST(" /"));
    }
    else
    {
-      net_http_send_str(&conn->sock_state, &error, "GET /",
+      net_http_request_append(&request, "GET /",
             STRLEN_CONST("GET /"));
    }
 
-   net_http_send_str(&conn->sock_state, &error, conn->location,
+   net_http_request_append(&request, conn->location,
          strlen(conn->location));
-   net_http_send_str(&conn->sock_state, &error, " HTTP/1.1\r\n",
+   net_http_request_append(&request, " HTTP/1.1\r\n",
          STRLEN_CONST(" HTTP/1.1\r\n"));
 
-   net_http_send_str(&conn->sock_state, &error, "Host: ",
+   net_http_request_append(&request, "Host: ",
          STRLEN_CONST("Host: "));
-   net_http_send_str(&conn->sock_state, &error, conn->domain,
+   net_http_request_append(&request, conn->domain,
          strlen(conn->domain));
 
    if (conn->port)
@@ -782,23 +1060,23 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       portstr[++_len] = '\0';
       _len           += snprintf(portstr + _len, sizeof(portstr) - _len,
             "%i", conn->port);
-      net_http_send_str(&conn->sock_state, &error, portstr, _len);
+      net_http_request_append(&request, portstr, _len);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "\r\n",
+   net_http_request_append(&request, "\r\n",
          STRLEN_CONST("\r\n"));
 
    /* Pre-formatted headers */
    if (conn->headerscopy)
-      net_http_send_str(&conn->sock_state, &error, conn->headerscopy,
+      net_http_request_append(&request, conn->headerscopy,
             strlen(conn->headerscopy));
    if (conn->contenttypecopy)
    {
-      net_http_send_str(&conn->sock_state, &error, "Content-Type: ",
+      net_http_request_append(&request, "Content-Type: ",
             STRLEN_CONST("Content-Type: "));
-      net_http_send_str(&conn->sock_state, &error,
+      net_http_request_append(&request,
             conn->contenttypecopy, strlen(conn->contenttypecopy));
-      net_http_send_str(&conn->sock_state, &error, "\r\n",
+      net_http_request_append(&request, "\r\n",
             STRLEN_CONST("\r\n"));
    }
 
@@ -813,14 +1091,14 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       if (!conn->headerscopy)
       {
          if (!conn->contenttypecopy)
-            net_http_send_str(&conn->sock_state, &error,
+            net_http_request_append(&request,
                   "Content-Type: application/x-www-form-urlencoded\r\n",
                   STRLEN_CONST(
                      "Content-Type: application/x-www-form-urlencoded\r\n"
                      ));
       }
 
-      net_http_send_str(&conn->sock_state, &error, "Content-Length: ",
+      net_http_request_append(&request, "Content-Length: ",
             STRLEN_CONST("Content-Length: "));
 
       post_len = conn->contentlength;
@@ -836,84 +1114,139 @@ struct http_t *net_http_new(struct http_connection_t *conn)
 
       len_str[len] = '\0';
 
-      net_http_send_str(&conn->sock_state, &error, len_str,
+      net_http_request_append(&request, len_str,
             strlen(len_str));
-      net_http_send_str(&conn->sock_state, &error, "\r\n",
+      net_http_request_append(&request, "\r\n",
             STRLEN_CONST("\r\n"));
 
       free(len_str);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "User-Agent: ",
+   net_http_request_append(&request, "User-Agent: ",
          STRLEN_CONST("User-Agent: "));
    if (conn->useragentcopy)
-      net_http_send_str(&conn->sock_state, &error,
+      net_http_request_append(&request,
             conn->useragentcopy, strlen(conn->useragentcopy));
    else
-      net_http_send_str(&conn->sock_state, &error, "libretro",
+      net_http_request_append(&request, "libretro",
             STRLEN_CONST("libretro"));
-   net_http_send_str(&conn->sock_state, &error, "\r\n",
+   net_http_request_append(&request, "\r\n",
          STRLEN_CONST("\r\n"));
 
-   net_http_send_str(&conn->sock_state, &error,
-         "Connection: close\r\n", STRLEN_CONST("Connection: close\r\n"));
-   net_http_send_str(&conn->sock_state, &error, "\r\n",
+   /* HTTP/1.1 connections are persistent unless told otherwise */
+   if (!keep_alive)
+      net_http_request_append(&request,
+            "Connection: close\r\n", STRLEN_CONST("Connection: close\r\n"));
+   net_http_request_append(&request, "\r\n",
          STRLEN_CONST("\r\n"));
 
+   /* A small body goes out with the headers, so that
+    * the request isn't split across two writes */
+   if (     conn->postdatacopy
+         && conn->contentlength
+         && conn->contentlength <= HTTP_REQUEST_INLINE)
+   {
+      net_http_request_append(&request, (const char*)conn->postdatacopy,
+            conn->contentlength);
+      free(conn->postdatacopy);
+      conn->postdatacopy = NULL;
+   }
+
+   if (request.error)
+      goto err;
+
+   net_http_send_str(&conn->sock_state, &error, request.data, request.len);
    if (conn->postdatacopy && conn->contentlength)
       net_http_send_str(&conn->sock_state, &error, conn->postdatacopy,
             conn->contentlength);
 
-   if (!error)
+   if (!error && (state = (struct http_t*)malloc(sizeof(struct http_t))))
    {
-      struct http_t *state = (struct http_t*)malloc(sizeof(struct http_t));
-      state->sock_state    = conn->sock_state;
-      state->status        = -1;
-      state->data          = NULL;
-      state->part          = P_HEADER_TOP;
-      state->bodytype      = T_FULL;
-      state->error         = false;
-      state->pos           = 0;
-      state->len           = 0;
-      state->buflen        = 512;
-
-      if ((state->data = (char*)malloc(state->buflen)))
+      state->sock_state       = conn->sock_state;
+      state->status           = -1;
+      state->data             = NULL;
+      state->headers          = NULL;
+      state->domain           = strdup(conn->domain);
+      state->request          = NULL;
+      state->request_len      = 0;
+      state->port             = conn->port;
+      state->part             = P_HEADER_TOP;
+      state->bodytype         = T_FULL;
+      state->error            = false;
+      state->keep_alive       = false;
+      state->reused           = reused;
+      state->pos              = 0;
+      state->len              = 0;
+      state->buflen           = 512;
+
+      if (reused)
+      {
+         state->request          = request.data;
+         state->request_len      = request.len;
+         request.data            = NULL;
+      }
+      free(request.data);
+
+      if (     state->domain
+            && (state->data = (char*)malloc(state->buflen)))
       {
-         if ((state->headers = string_list_new()) &&
-             string_list_initialize(state->headers))
+         if ((state->headers = string_list_new()))
             return state;
-         string_list_free(state->headers);
       }
+      free(state->data);
+      free(state->domain);
+      free(state->request);
       free(state);
+      request.data = NULL;
    }
 
 err:
-   if (conn)
-   {
-      if (conn->methodcopy)
-         free(conn->methodcopy);
-      if (conn->contenttypecopy)
-         free(conn->contenttypecopy);
-      if (conn->postdatacopy)
-         free(conn->postdatacopy);
-      conn->methodcopy           = NULL;
-      conn->contenttypecopy      = NULL;
-      conn->postdatacopy         = NULL;
+   free(request.data);
+   if (conn->methodcopy)
+      free(conn->methodcopy);
+   if (conn->contenttypecopy)
+      free(conn->contenttypecopy);
+   if (conn->postdatacopy)
+      free(conn->postdatacopy);
+   conn->methodcopy           = NULL;
+   conn->contenttypecopy      = NULL;
+   conn->postdatacopy         = NULL;
 
-#ifdef HAVE_SSL
-      if (conn->sock_state.ssl_ctx)
-      {
-         ssl_socket_close(conn->sock_state.ssl_ctx);
-         ssl_socket_free(conn->sock_state.ssl_ctx);
-         conn->sock_state.ssl_ctx = NULL;
-      }
-#endif
+   net_http_close_socket(&conn->sock_state);
+   return NULL;
+}
+
+static void net_http_release_request(struct http_t *state)
+{
+   free(state->request);
+   state->request          = NULL;
+   state->request_len      = 0;
+   state->reused           = false;
+}
+
+/**
+ * net_http_resend:
+ *
+ * Sends the request again on a new connection, after
+ * a reused one was closed before any response came.
+ **/
+static bool net_http_resend(struct http_t *state)
+{
+   bool error = false;
+
+   net_http_close_socket(&state->sock_state);
+   if (net_http_new_socket(&state->sock_state,
+            state->domain, state->port) >= 0)
+   {
+      net_http_send_str(&state->sock_state, &error,
+            state->request, state->request_len);
    }
+   else
+      error = true;
 
-#ifndef HAVE_SSL
-   socket_close(fd);
-#endif
-   return NULL;
+   net_http_release_request(state);
+   state->error = error;
+   return !error;
 }
 
 /**
@@ -963,10 +1296,18 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 
          if (newlen < 0)
          {
+            if (     state->reused
+                  && state->part == P_HEADER_TOP
+                  && state->pos  == 0
+                  && net_http_resend(state))
+               return false;
             state->error  = true;
             goto error;
          }
 
+         if (newlen > 0 && state->reused)
+            net_http_release_request(state);
+
          if (state->pos + newlen >= state->buflen - 64)
          {
             state->buflen *= 2;
@@ -994,9 +1335,10 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                   state->error  = true;
                   goto error;
                }
-               state->status    = (int)strtoul(state->data 
+               state->status     = (int)strtoul(state->data 
                      + STRLEN_CONST("HTTP/1.1 "), NULL, 10);
-               state->part      = P_HEADER;
+               state->keep_alive = (state->data[STRLEN_CONST("HTTP/1.")] == '1');
+               state->part       = P_HEADER;
             }
             else
             {
@@ -1011,6 +1353,10 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                }
                if (string_is_equal_case_insensitive(state->data, "Transfer-Encoding: chunked"))
                   state->bodytype = T_CHUNK;
+               if (string_is_equal_case_insensitive(state->data, "Connection: close"))
+                  state->keep_alive = false;
+               else if (string_is_equal_case_insensitive(state->data, "Connection: keep-alive"))
+                  state->keep_alive = true;
 
                if (state->data[0]=='\0')
                {
@@ -1050,7 +1396,7 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
          {
             if (state->error)
                newlen = -1;
-            else if (state->len)
+            else if (state->len || state->part == P_BODY_CHUNKEND)
             {
 #ifdef HAVE_SSL
                if (state->sock_state.ssl && state->sock_state.ssl_ctx)
@@ -1070,7 +1416,17 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 
             if (newlen < 0)
             {
-               if (state->bodytype != T_FULL)
+               /* The body is complete, only the connection
+                * can't be reused */
+               if (state->part == P_BODY_CHUNKEND)
+               {
+                  state->keep_alive = false;
+                  state->pos        = state->len;
+                  state->part       = P_DONE;
+                  state->data       = (char*)realloc(state->data, state->len);
+                  newlen            = 0;
+               }
+               else if (state->bodytype != T_FULL)
                {
                   state->error  = true;
                   goto error;
@@ -1125,14 +1481,32 @@ parse_again:
                      state->part = P_BODY;
                      if (state->len == 0)
                      {
-                        state->part = P_DONE;
+                        state->part = P_BODY_CHUNKEND;
                         state->len  = state->pos;
-                        state->data = (char*)realloc(state->data, state->len);
                      }
                      goto parse_again;
                   }
                }
             }
+            else if (state->part == P_BODY_CHUNKEND)
+            {
+               /* Read the empty line ending the response, so
+                * nothing is left on a connection that's reused.
+                * Trailers aren't parsed, the connection is
+                * closed instead. */
+               state->pos += newlen;
+
+               if (state->pos - state->len >= 2)
+               {
+                  if (     state->pos - state->len > 2
+                        || state->data[state->len]     != '\r'
+                        || state->data[state->len + 1] != '\n')
+                     state->keep_alive = false;
+                  state->pos  = state->len;
+                  state->part = P_DONE;
+                  state->data = (char*)realloc(state->data, state->len);
+               }
+            }
             else if (state->part == P_BODY)
             {
                if ((size_t)newlen >= state->len)
@@ -1260,17 +1634,20 @@ void net_http_delete(struct http_t *state)
 
    if (state->sock_state.fd >= 0)
    {
-#ifdef HAVE_SSL
-      if (state->sock_state.ssl && state->sock_state.ssl_ctx)
-      {
-         ssl_socket_close(state->sock_state.ssl_ctx);
-         ssl_socket_free(state->sock_state.ssl_ctx);
-         state->sock_state.ssl_ctx = NULL;
-      }
+      /* The connection can take another request once the
+       * whole response is read, which needs its length
+       * to be known (no length means no body for these) */
+      if (     state->part == P_DONE
+            && state->keep_alive
+            && (     state->bodytype != T_FULL
+                  || state->status   == 204
+                  || state->status   == 304))
+         net_http_pool_put(state);
       else
-#endif
-      socket_close(state->sock_state.fd);
+         net_http_close_socket(&state->sock_state);
    }
+   net_http_release_request(state);
+   free(state->domain);
    free(state);
 }
 
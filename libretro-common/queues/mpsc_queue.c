@@ -0,0 +1,339 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (mpsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <boolean.h>
+
+#include <queues/mpsc_queue.h>
+
+/* Producers claim slots by moving the shared head index
+ * forward with a compare-and-swap, then publish each slot
+ * through its own sequence number, as in Dmitry Vyukov's
+ * bounded queue. The consumer index is private to it. */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define MPSC_QUEUE_C11
+typedef atomic_size_t mpsc_index_t;
+#elif defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define MPSC_QUEUE_GNUC
+typedef size_t mpsc_index_t;
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+/* x86 loads and stores already have acquire/release semantics,
+ * only the compiler needs to be kept from reordering them */
+#include <intrin.h>
+#define MPSC_QUEUE_MSVC_X86
+typedef volatile size_t mpsc_index_t;
+#elif defined(HAVE_THREADS)
+#include <rthreads/rthreads.h>
+#define MPSC_QUEUE_LOCKED
+typedef size_t mpsc_index_t;
+#else
+typedef size_t mpsc_index_t;
+#endif
+
+#define MPSC_QUEUE_CACHE_LINE 64
+/* Bytes of message per slot; with the sequence
+ * number and length a slot is 128 bytes on 64-bit */
+#define MPSC_QUEUE_SLOT_SIZE  112
+
+struct mpsc_queue_slot
+{
+   /* Equal to the position of the slot while it is free,
+    * one more once a message has been written to it */
+   mpsc_index_t seq;
+   size_t len;
+   uint8_t data[MPSC_QUEUE_SLOT_SIZE];
+};
+
+struct mpsc_queue
+{
+   struct mpsc_queue_slot *slots;
+   size_t num_slots;
+   size_t mask;
+#ifdef MPSC_QUEUE_LOCKED
+   slock_t *lock;
+#endif
+   char pad0[MPSC_QUEUE_CACHE_LINE];
+   mpsc_index_t head;    /* Next position to claim */
+   mpsc_index_t dropped;
+   char pad1[MPSC_QUEUE_CACHE_LINE];
+   size_t tail;          /* Next position to read */
+   size_t offset;        /* Bytes of it already read */
+   char pad2[MPSC_QUEUE_CACHE_LINE];
+};
+
+static INLINE size_t mpsc_queue_load(mpsc_queue_t *queue,
+      mpsc_index_t *index)
+{
+#if defined(MPSC_QUEUE_C11)
+   return atomic_load_explicit(index, memory_order_acquire);
+#elif defined(MPSC_QUEUE_GNUC)
+   return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#elif defined(MPSC_QUEUE_MSVC_X86)
+   size_t val = *index;
+   _ReadWriteBarrier();
+   return val;
+#elif defined(MPSC_QUEUE_LOCKED)
+   size_t val;
+   slock_lock(queue->lock);
+   val        = *index;
+   slock_unlock(queue->lock);
+   return val;
+#else
+   return *index;
+#endif
+}
+
+static INLINE void mpsc_queue_store(mpsc_queue_t *queue,
+      mpsc_index_t *index, size_t val)
+{
+#if defined(MPSC_QUEUE_C11)
+   atomic_store_explicit(index, val, memory_order_release);
+#elif defined(MPSC_QUEUE_GNUC)
+   __atomic_store_n(index, val, __ATOMIC_RELEASE);
+#elif defined(MPSC_QUEUE_MSVC_X86)
+   _ReadWriteBarrier();
+   *index = val;
+#elif defined(MPSC_QUEUE_LOCKED)
+   slock_lock(queue->lock);
+   *index = val;
+   slock_unlock(queue->lock);
+#else
+   *index = val;
+#endif
+}
+
+/* Sets *index to val if it still holds *expected.
+ * Otherwise stores its current value in *expected. */
+static INLINE bool mpsc_queue_cas(mpsc_queue_t *queue,
+      mpsc_index_t *index, size_t *expected, size_t val)
+{
+#if defined(MPSC_QUEUE_C11)
+   return atomic_compare_exchange_weak_explicit(index, expected, val,
+         memory_order_acq_rel, memory_order_acquire);
+#elif defined(MPSC_QUEUE_GNUC)
+   return __atomic_compare_exchange_n(index, expected, val, true,
+         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#elif defined(MPSC_QUEUE_MSVC_X86)
+#ifdef _M_X64
+   size_t prev = (size_t)_InterlockedCompareExchange64(
+         (volatile __int64*)index, (__int64)val, (__int64)*expected);
+#else
+   size_t prev = (size_t)_InterlockedCompareExchange(
+         (volatile long*)index, (long)val, (long)*expected);
+#endif
+   bool ok     = prev == *expected;
+   *expected   = prev;
+   return ok;
+#else
+   bool ok;
+#ifdef MPSC_QUEUE_LOCKED
+   slock_lock(queue->lock);
+#endif
+   ok          = *index == *expected;
+   if (ok)
+      *index   = val;
+   else
+      *expected = *index;
+#ifdef MPSC_QUEUE_LOCKED
+   slock_unlock(queue->lock);
+#endif
+   return ok;
+#endif
+}
+
+mpsc_queue_t *mpsc_queue_new(size_t size)
+{
+   size_t i;
+   size_t num_slots    = 1;
+   mpsc_queue_t *queue = NULL;
+
+   if (!size)
+      return NULL;
+
+   /* A power of two, so that positions can keep
+    * wrapping around at SIZE_MAX */
+   while (num_slots * MPSC_QUEUE_SLOT_SIZE < size)
+      num_slots <<= 1;
+
+   if (!(queue = (mpsc_queue_t*)calloc(1, sizeof(*queue))))
+      return NULL;
+
+   if (!(queue->slots = (struct mpsc_queue_slot*)
+            calloc(num_slots, sizeof(*queue->slots))))
+   {
+      free(queue);
+      return NULL;
+   }
+
+#ifdef MPSC_QUEUE_LOCKED
+   if (!(queue->lock = slock_new()))
+   {
+      free(queue->slots);
+      free(queue);
+      return NULL;
+   }
+#endif
+
+   queue->num_slots    = num_slots;
+   queue->mask         = num_slots - 1;
+
+   for (i = 0; i < num_slots; i++)
+   {
+#ifdef MPSC_QUEUE_C11
+      atomic_init(&queue->slots[i].seq, i);
+#else
+      queue->slots[i].seq = i;
+#endif
+   }
+#ifdef MPSC_QUEUE_C11
+   atomic_init(&queue->head, 0);
+   atomic_init(&queue->dropped, 0);
+#endif
+
+   return queue;
+}
+
+void mpsc_queue_free(mpsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+#ifdef MPSC_QUEUE_LOCKED
+   slock_free(queue->lock);
+#endif
+   free(queue->slots);
+   free(queue);
+}
+
+bool mpsc_queue_write(mpsc_queue_t *queue,
+      const void *in_buf, size_t size)
+{
+   size_t i, pos, dropped;
+   const uint8_t *in = (const uint8_t*)in_buf;
+   size_t count      = (size + MPSC_QUEUE_SLOT_SIZE - 1)
+      / MPSC_QUEUE_SLOT_SIZE;
+
+   if (!size)
+      return true;
+
+   if (count <= queue->num_slots)
+   {
+      pos = mpsc_queue_load(queue, &queue->head);
+
+      for (;;)
+      {
+         /* The consumer frees slots in order, so when the
+          * last slot of the message is free, all of them are */
+         size_t last = pos + count - 1;
+         size_t seq  = mpsc_queue_load(queue,
+               &queue->slots[last & queue->mask].seq);
+
+         if (seq == last)
+         {
+            if (mpsc_queue_cas(queue, &queue->head, &pos, pos + count))
+               goto claimed;
+         }
+         /* Not read yet since the last time around */
+         else if ((ptrdiff_t)(seq - last) < 0)
+            break;
+         /* Claimed by another producer */
+         else
+            pos = mpsc_queue_load(queue, &queue->head);
+      }
+   }
+
+   dropped = mpsc_queue_load(queue, &queue->dropped);
+   while (!mpsc_queue_cas(queue, &queue->dropped, &dropped, dropped + 1));
+   return false;
+
+claimed:
+   for (i = 0; i < count; i++)
+   {
+      struct mpsc_queue_slot *slot = &queue->slots[(pos + i) & queue->mask];
+
+      slot->len  = MIN(size, MPSC_QUEUE_SLOT_SIZE);
+      memcpy(slot->data, in, slot->len);
+      in        += slot->len;
+      size      -= slot->len;
+
+      /* Publishes the slot to the consumer */
+      mpsc_queue_store(queue, &slot->seq, pos + i + 1);
+   }
+
+   return true;
+}
+
+size_t mpsc_queue_read(mpsc_queue_t *queue, void *out_buf, size_t size)
+{
+   size_t read = 0;
+
+   while (read < size)
+   {
+      size_t len;
+      struct mpsc_queue_slot *slot = &queue->slots[
+         queue->tail & queue->mask];
+
+      if (mpsc_queue_load(queue, &slot->seq) != queue->tail + 1)
+         break;
+
+      len            = MIN(slot->len - queue->offset, size - read);
+      memcpy((uint8_t*)out_buf + read, slot->data + queue->offset, len);
+      read          += len;
+      queue->offset += len;
+
+      if (queue->offset == slot->len)
+      {
+         /* Hands the slot back to the producers
+          * for the next time around */
+         mpsc_queue_store(queue, &slot->seq,
+               queue->tail + queue->num_slots);
+         queue->tail++;
+         queue->offset = 0;
+      }
+   }
+
+   return read;
+}
+
+bool mpsc_queue_half_full(mpsc_queue_t *queue)
+{
+   /* A slot half the queue ahead is only free
+    * once the consumer has caught up that far */
+   size_t pos = mpsc_queue_load(queue, &queue->head)
+      + queue->num_slots / 2;
+   size_t seq = mpsc_queue_load(queue,
+         &queue->slots[pos & queue->mask].seq);
+   return (ptrdiff_t)(seq - pos) < 0;
+}
+
+size_t mpsc_queue_take_dropped(mpsc_queue_t *queue)
+{
+   size_t dropped = mpsc_queue_load(queue, &queue->dropped);
+   while (!mpsc_queue_cas(queue, &queue->dropped, &dropped, 0));
+   return dropped;
+}
@@ -0,0 +1,228 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <boolean.h>
+
+#include <queues/spsc_queue.h>
+
+/* The head and tail indices only ever grow (wrapping around
+ * at SIZE_MAX), each one is written by a single side and read
+ * by the other, which only needs acquire/release ordering. */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define SPSC_QUEUE_C11
+typedef atomic_size_t spsc_index_t;
+#elif defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define SPSC_QUEUE_GNUC
+typedef size_t spsc_index_t;
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+/* x86 loads and stores already have acquire/release semantics,
+ * only the compiler needs to be kept from reordering them */
+#include <intrin.h>
+#define SPSC_QUEUE_MSVC_X86
+typedef volatile size_t spsc_index_t;
+#elif defined(HAVE_THREADS)
+#include <rthreads/rthreads.h>
+#define SPSC_QUEUE_LOCKED
+typedef size_t spsc_index_t;
+#else
+typedef size_t spsc_index_t;
+#endif
+
+/* Keeps the two indices on different cache lines, so the
+ * producer and the consumer don't keep invalidating each
+ * other's copy on every access */
+#define SPSC_QUEUE_CACHE_LINE 64
+
+struct spsc_queue
+{
+   uint8_t *buffer;
+   size_t capacity;
+   size_t mask;
+#ifdef SPSC_QUEUE_LOCKED
+   slock_t *lock;
+#endif
+   char pad0[SPSC_QUEUE_CACHE_LINE];
+   spsc_index_t head; /* Only written by the producer */
+   char pad1[SPSC_QUEUE_CACHE_LINE];
+   spsc_index_t tail; /* Only written by the consumer */
+   char pad2[SPSC_QUEUE_CACHE_LINE];
+};
+
+static INLINE size_t spsc_queue_load(spsc_queue_t *queue,
+      spsc_index_t *index)
+{
+#if defined(SPSC_QUEUE_C11)
+   return atomic_load_explicit(index, memory_order_acquire);
+#elif defined(SPSC_QUEUE_GNUC)
+   return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#elif defined(SPSC_QUEUE_MSVC_X86)
+   size_t val = *index;
+   _ReadWriteBarrier();
+   return val;
+#elif defined(SPSC_QUEUE_LOCKED)
+   size_t val;
+   slock_lock(queue->lock);
+   val        = *index;
+   slock_unlock(queue->lock);
+   return val;
+#else
+   return *index;
+#endif
+}
+
+static INLINE void spsc_queue_store(spsc_queue_t *queue,
+      spsc_index_t *index, size_t val)
+{
+#if defined(SPSC_QUEUE_C11)
+   atomic_store_explicit(index, val, memory_order_release);
+#elif defined(SPSC_QUEUE_GNUC)
+   __atomic_store_n(index, val, __ATOMIC_RELEASE);
+#elif defined(SPSC_QUEUE_MSVC_X86)
+   _ReadWriteBarrier();
+   *index = val;
+#elif defined(SPSC_QUEUE_LOCKED)
+   slock_lock(queue->lock);
+   *index = val;
+   slock_unlock(queue->lock);
+#else
+   *index = val;
+#endif
+}
+
+spsc_queue_t *spsc_queue_new(size_t size)
+{
+   size_t buf_size     = 1;
+   spsc_queue_t *queue = NULL;
+
+   if (!size)
+      return NULL;
+
+   /* A power of two, so that the indices can keep
+    * wrapping around at SIZE_MAX */
+   while (buf_size < size)
+      buf_size <<= 1;
+
+   if (!(queue = (spsc_queue_t*)calloc(1, sizeof(*queue))))
+      return NULL;
+
+   if (!(queue->buffer = (uint8_t*)calloc(1, buf_size)))
+   {
+      free(queue);
+      return NULL;
+   }
+
+#ifdef SPSC_QUEUE_LOCKED
+   if (!(queue->lock = slock_new()))
+   {
+      free(queue->buffer);
+      free(queue);
+      return NULL;
+   }
+#endif
+
+   queue->capacity     = size;
+   queue->mask         = buf_size - 1;
+#ifdef SPSC_QUEUE_C11
+   atomic_init(&queue->head, 0);
+   atomic_init(&queue->tail, 0);
+#endif
+
+   return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+#ifdef SPSC_QUEUE_LOCKED
+   slock_free(queue->lock);
+#endif
+   free(queue->buffer);
+   free(queue);
+}
+
+size_t spsc_queue_read_avail(spsc_queue_t *queue)
+{
+   size_t tail = spsc_queue_load(queue, &queue->tail);
+   size_t head = spsc_queue_load(queue, &queue->head);
+   return head - tail;
+}
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue)
+{
+   size_t head = spsc_queue_load(queue, &queue->head);
+   size_t tail = spsc_queue_load(queue, &queue->tail);
+   return queue->capacity - (head - tail);
+}
+
+size_t spsc_queue_write(spsc_queue_t *queue,
+      const void *in_buf, size_t size)
+{
+   size_t pos, first_write;
+   size_t head = spsc_queue_load(queue, &queue->head);
+   size_t tail = spsc_queue_load(queue, &queue->tail);
+
+   size        = MIN(size, queue->capacity - (head - tail));
+   if (!size)
+      return 0;
+
+   pos         = head & queue->mask;
+   first_write = MIN(size, queue->mask + 1 - pos);
+
+   memcpy(queue->buffer + pos, in_buf, first_write);
+   memcpy(queue->buffer, (const uint8_t*)in_buf + first_write,
+         size - first_write);
+
+   /* Publishes the data to the consumer */
+   spsc_queue_store(queue, &queue->head, head + size);
+   return size;
+}
+
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size)
+{
+   size_t pos, first_read;
+   size_t tail = spsc_queue_load(queue, &queue->tail);
+   size_t head = spsc_queue_load(queue, &queue->head);
+
+   size        = MIN(size, head - tail);
+   if (!size)
+      return 0;
+
+   pos         = tail & queue->mask;
+   first_read  = MIN(size, queue->mask + 1 - pos);
+
+   memcpy(out_buf, queue->buffer + pos, first_read);
+   memcpy((uint8_t*)out_buf + first_read, queue->buffer,
+         size - first_read);
+
+   /* Hands the space back to the producer */
+   spsc_queue_store(queue, &queue->tail, tail + size);
+   return size;
+}
@@ -41,7 +41,7 @@ typedef struct
 struct retro_task_impl
 {
    retro_task_queue_msg_t msg_push;
-   void (*push_running)(retro_task_t *);
+   bool (*push_running)(retro_task_t *);
    void (*cancel)(void *);
    void (*reset)(void);
    void (*wait)(retro_task_condition_fn_t, void *);
@@ -60,16 +60,58 @@ static task_queue_t tasks_finished          = {NULL, NULL};
 static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
 
+static unsigned task_num_workers            = 0;
+
 #ifdef HAVE_THREADS
+/* Upper bound for the worker pool */
+#define TASK_QUEUE_MAX_WORKERS 8
+/* Upper bound when the worker count is picked automatically */
+#define TASK_QUEUE_AUTO_MAX_WORKERS 4
+/* Every Nth pick, a worker looks at the least urgent
+ * classes first so that they can't be starved */
+#define TASK_QUEUE_AGING_PERIOD 8
+
+/* Growable ring buffer of task pointers.
+ * The owning worker takes tasks from the front,
+ * other workers steal from the back. */
+typedef struct
+{
+   retro_task_t **data;
+   size_t head;
+   size_t size;
+   size_t capacity;
+} task_deque_t;
+
+typedef struct
+{
+   task_deque_t deques[TASK_PRIORITY_COUNT]; /* use 'lock' when touching it */
+   slock_t *lock;
+   sthread_t *thread;
+   retro_task_handler_t active_handler;      /* use handler_lock when touching it */
+   unsigned index;
+   unsigned picks;
+} task_worker_t;
+
 static uintptr_t main_thread_id             = 0;
 static slock_t *running_lock                = NULL;
 static slock_t *finished_lock               = NULL;
 static slock_t *property_lock               = NULL;
 static slock_t *queue_lock                  = NULL;
+static slock_t *handler_lock                = NULL;
 static scond_t *worker_cond                 = NULL;
-static sthread_t *worker_thread             = NULL;
+static task_worker_t task_workers[TASK_QUEUE_MAX_WORKERS];
+static unsigned task_workers_count          = 0;
+/* use running_lock when touching these */
 static bool worker_continue                 = true;
-/* use running_lock when touching it */
+static unsigned worker_generation           = 0;
+static unsigned task_workers_next           = 0;
+/* use handler_lock when touching it */
+static bool claim_blocked                   = false;
+/* Tasks a worker deque had no room for. It always has
+ * room for every running task, so pushing can't fail.
+ * use global_lock when touching it */
+static task_deque_t tasks_global;
+static slock_t *global_lock                 = NULL;
 #endif
 
 static void task_queue_msg_push(retro_task_t *task,
@@ -197,9 +239,10 @@ static void retro_task_internal_gather(void)
    }
 }
 
-static void retro_task_regular_push_running(retro_task_t *task)
+static bool retro_task_regular_push_running(retro_task_t *task)
 {
    task_queue_put(&tasks_running, task);
+   return true;
 }
 
 static void retro_task_regular_cancel(void *task)
@@ -371,14 +414,279 @@ static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
    }
 }
 
-static void retro_task_threaded_push_running(retro_task_t *task)
+static unsigned task_queue_resolve_num_workers(void)
 {
+   unsigned num = task_num_workers;
+
+   if (!num)
+   {
+      num = cpu_features_get_core_amount();
+      if (num > TASK_QUEUE_AUTO_MAX_WORKERS)
+         num = TASK_QUEUE_AUTO_MAX_WORKERS;
+      /* Always keep one worker free of background work */
+      if (num < 2)
+         num = 2;
+   }
+
+   if (num > TASK_QUEUE_MAX_WORKERS)
+      num = TASK_QUEUE_MAX_WORKERS;
+
+   return num;
+}
+
+/* Makes room for at least 'count' tasks.
+ * Returns false if out of memory */
+static bool task_deque_reserve(task_deque_t *deque, size_t count)
+{
+   size_t i;
+   retro_task_t **data = NULL;
+   size_t capacity     = deque->capacity ? deque->capacity : 16;
+
+   if (count <= deque->capacity)
+      return true;
+
+   while (capacity < count)
+      capacity *= 2;
+
+   if (!(data = (retro_task_t**)malloc(capacity * sizeof(*data))))
+      return false;
+
+   for (i = 0; i < deque->size; i++)
+      data[i] = deque->data[(deque->head + i) % deque->capacity];
+
+   free(deque->data);
+   deque->data     = data;
+   deque->head     = 0;
+   deque->capacity = capacity;
+   return true;
+}
+
+/* Returns false if the deque couldn't grow */
+static bool task_deque_push(task_deque_t *deque, retro_task_t *task)
+{
+   if (!task_deque_reserve(deque, deque->size + 1))
+      return false;
+
+   deque->data[(deque->head + deque->size) % deque->capacity] = task;
+   deque->size++;
+   return true;
+}
+
+static void task_deque_remove_at(task_deque_t *deque, size_t i)
+{
+   if (i == 0)
+      deque->head = (deque->head + 1) % deque->capacity;
+   else
+   {
+      /* Close the gap by shifting the tail forward */
+      for (; i + 1 < deque->size; i++)
+         deque->data[(deque->head + i) % deque->capacity] =
+            deque->data[(deque->head + i + 1) % deque->capacity];
+   }
+
+   deque->size--;
+}
+
+static void task_deque_free(task_deque_t *deque)
+{
+   free(deque->data);
+   deque->data     = NULL;
+   deque->head     = 0;
+   deque->size     = 0;
+   deque->capacity = 0;
+}
+
+/* 'running_lock' must be held for the duration of this function */
+static void task_queue_wake_workers(void)
+{
+   worker_generation++;
+   scond_broadcast(worker_cond);
+}
+
+/* Reserves 'task' for 'self'.
+ * Two tasks sharing a handler never run at the same time,
+ * as handlers were written against a single task thread.
+ * Different handlers may run at once. The handlers in
+ * tasks/ were audited for that: file scope state is only
+ * shared between one handler and main thread callbacks
+ * (e.g. the undo buffers of task_save.c), which already
+ * ran concurrently with the single task thread. */
+static bool task_worker_claim(task_worker_t *self, retro_task_t *task)
+{
+   unsigned i;
+
+   slock_lock(handler_lock);
+
+   for (i = 0; i < task_workers_count; i++)
+   {
+      if (task_workers[i].active_handler == task->handler)
+      {
+         claim_blocked = true;
+         slock_unlock(handler_lock);
+         return false;
+      }
+   }
+
+   self->active_handler = task->handler;
+
+   slock_unlock(handler_lock);
+   return true;
+}
+
+/* Returns true if another worker was turned away
+ * while 'self' held its claim */
+static bool task_worker_release(task_worker_t *self)
+{
+   bool wake = false;
+
+   slock_lock(handler_lock);
+   self->active_handler = NULL;
+   wake                 = claim_blocked;
+   claim_blocked        = false;
+   slock_unlock(handler_lock);
+
+   return wake;
+}
+
+/* Takes the first runnable task out of 'deque', guarded
+ * by 'lock', scanning from the back if 'from_back' is set.
+ * Tasks scheduled for later are skipped, and the earliest
+ * of their start times is reported through 'next_when'. */
+static retro_task_t *task_deque_take(task_worker_t *self,
+      task_deque_t *deque, slock_t *lock, bool from_back,
+      retro_time_t now, retro_time_t *next_when)
+{
+   size_t k;
+   retro_task_t *task  = NULL;
+
+   slock_lock(lock);
+
+   for (k = 0; k < deque->size; k++)
+   {
+      size_t i        = from_back ? deque->size - 1 - k : k;
+      retro_task_t *t = deque->data[(deque->head + i) % deque->capacity];
+
+      if (t->when && t->when > now)
+      {
+         if (!*next_when || t->when < *next_when)
+            *next_when = t->when;
+         continue;
+      }
+
+      if (task_worker_claim(self, t))
+      {
+         task_deque_remove_at(deque, i);
+         task = t;
+         break;
+      }
+   }
+
+   slock_unlock(lock);
+
+   return task;
+}
+
+/* Takes the first runnable task of class 'prio' out of 'victim'.
+ * The owner scans its deque from the front, thieves from the back. */
+static retro_task_t *task_worker_take(task_worker_t *self,
+      task_worker_t *victim, enum task_priority prio,
+      retro_time_t now, retro_time_t *next_when)
+{
+   return task_deque_take(self, &victim->deques[prio], victim->lock,
+         self != victim, now, next_when);
+}
+
+/* Queues 'task' on 'worker', or on the global deque
+ * if the worker's one can't grow */
+static void task_worker_push(task_worker_t *worker, retro_task_t *task)
+{
+   bool queued;
+
+   slock_lock(worker->lock);
+   queued = task_deque_push(&worker->deques[task->priority], task);
+   slock_unlock(worker->lock);
+
+   if (!queued)
+   {
+      slock_lock(global_lock);
+      task_deque_push(&tasks_global, task);
+      slock_unlock(global_lock);
+   }
+}
+
+/* Looks for work in every class, most urgent first:
+ * our own deque, then the other workers' ones.
+ * The first worker never runs background tasks,
+ * so that urgent ones can always start right away. */
+static retro_task_t *task_worker_pick(task_worker_t *self,
+      retro_time_t *next_when)
+{
+   unsigned k;
+   retro_time_t now = cpu_features_get_time_usec();
+   bool aging       = (++self->picks % TASK_QUEUE_AGING_PERIOD) == 0;
+
+   for (k = 0; k < TASK_PRIORITY_COUNT; k++)
+   {
+      unsigned i;
+      retro_task_t *task = NULL;
+      unsigned prio      = aging ? TASK_PRIORITY_COUNT - 1 - k : k;
+
+      if (     prio == TASK_PRIORITY_BACKGROUND
+            && self->index == 0
+            && task_workers_count > 1)
+         continue;
+
+      if ((task = task_worker_take(self, self,
+            (enum task_priority)prio, now, next_when)))
+         return task;
+
+      for (i = 1; i < task_workers_count; i++)
+      {
+         task_worker_t *victim = &task_workers[
+            (self->index + i) % task_workers_count];
+
+         if ((task = task_worker_take(self, victim,
+               (enum task_priority)prio, now, next_when)))
+            return task;
+      }
+   }
+
+   return task_deque_take(self, &tasks_global, global_lock, false,
+         now, next_when);
+}
+
+/* Returns false if there is no memory left to queue 'task' */
+static bool retro_task_threaded_push_running(retro_task_t *task)
+{
+   bool reserved;
+   retro_task_t *t       = NULL;
+   size_t count          = 1;
+
    slock_lock(running_lock);
-   slock_lock(queue_lock);
-   task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
-   slock_unlock(queue_lock);
+
+   /* Make sure the task can always fall back
+    * to the global deque before taking it */
+   for (t = tasks_running.front; t; t = t->next)
+      count++;
+
+   slock_lock(global_lock);
+   reserved = task_deque_reserve(&tasks_global, count);
+   slock_unlock(global_lock);
+
+   if (reserved)
+   {
+      slock_lock(queue_lock);
+      task_queue_put(&tasks_running, task);
+      slock_unlock(queue_lock);
+
+      task_worker_push(&task_workers[
+            task_workers_next++ % task_workers_count], task);
+
+      task_queue_wake_workers();
+   }
+
    slock_unlock(running_lock);
+   return reserved;
 }
 
 static void retro_task_threaded_cancel(void *task)
@@ -476,62 +784,62 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
 
 static void threaded_worker(void *userdata)
 {
+   task_worker_t *self = (task_worker_t*)userdata;
+
    for (;;)
    {
-      retro_task_t *task  = NULL;
-      bool       finished = false;
-
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
+      retro_task_t *task     = NULL;
+      retro_time_t next_when = 0;
+      unsigned generation    = 0;
+      bool finished          = false;
+      bool wake              = false;
 
       slock_lock(running_lock);
-
-      /* Get first task to run */
-      if (!(task = tasks_running.front))
+      if (!worker_continue)
       {
-         scond_wait(worker_cond, running_lock);
+         /* should we keep running until all tasks finished? */
          slock_unlock(running_lock);
-         continue;
+         break;
       }
+      generation = worker_generation;
+      slock_unlock(running_lock);
 
-      if (task->when)
+      if (!(task = task_worker_pick(self, &next_when)))
       {
-         retro_time_t now   = cpu_features_get_time_usec();
-         retro_time_t delay = task->when - now - 500; /* allow half a millisecond for context switching */
-         if (delay > 0)
+         slock_lock(running_lock);
+
+         /* Only go to sleep if nothing was pushed
+          * or released while we were looking */
+         if (worker_continue && generation == worker_generation)
          {
-            scond_wait_timeout(worker_cond, running_lock, delay);
-            slock_unlock(running_lock);
-            continue;
+            if (next_when)
+            {
+               /* allow half a millisecond for context switching */
+               retro_time_t delay = next_when
+                  - cpu_features_get_time_usec() - 500;
+               if (delay > 0)
+                  scond_wait_timeout(worker_cond, running_lock, delay);
+            }
+            else
+               scond_wait(worker_cond, running_lock);
          }
-      }
 
-      slock_unlock(running_lock);
+         slock_unlock(running_lock);
+         continue;
+      }
 
       task->handler(task);
 
+      wake = task_worker_release(self);
+
       slock_lock(property_lock);
       finished = task->finished;
       slock_unlock(property_lock);
 
-      /* Update queue */
       if (!finished)
       {
-         /* Move the task to the back of the queue */
-         /* mimics retro_task_threaded_push_running,
-          * but also includes a task_queue_remove */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-
-         /* do nothing if only item in queue */
-         if (task->next)
-         {
-            task_queue_remove(&tasks_running, task);
-            task_queue_put(&tasks_running, task);
-            scond_signal(worker_cond);
-         }
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
+         /* Move the task to the back of our own deque */
+         task_worker_push(self, task);
       }
       else
       {
@@ -547,45 +855,114 @@ static void threaded_worker(void *userdata)
          task_queue_put(&tasks_finished, task);
          slock_unlock(finished_lock);
       }
+
+      if (wake)
+      {
+         slock_lock(running_lock);
+         task_queue_wake_workers();
+         slock_unlock(running_lock);
+      }
    }
 }
 
 static void retro_task_threaded_init(void)
 {
-   running_lock    = slock_new();
-   finished_lock   = slock_new();
-   property_lock   = slock_new();
-   queue_lock      = slock_new();
-   worker_cond     = scond_new();
+   unsigned i;
+   size_t count       = 0;
+   retro_task_t *task = NULL;
+
+   running_lock       = slock_new();
+   finished_lock      = slock_new();
+   property_lock      = slock_new();
+   queue_lock         = slock_new();
+   handler_lock       = slock_new();
+   global_lock        = slock_new();
+   worker_cond        = scond_new();
+
+   task_workers_count = task_queue_resolve_num_workers();
+   claim_blocked      = false;
+
+   for (i = 0; i < task_workers_count; i++)
+   {
+      task_worker_t *worker  = &task_workers[i];
+      unsigned prio;
+
+      for (prio = 0; prio < TASK_PRIORITY_COUNT; prio++)
+      {
+         worker->deques[prio].data     = NULL;
+         worker->deques[prio].head     = 0;
+         worker->deques[prio].size     = 0;
+         worker->deques[prio].capacity = 0;
+      }
+      worker->lock            = slock_new();
+      worker->thread          = NULL;
+      worker->active_handler  = NULL;
+      worker->index           = i;
+      worker->picks           = 0;
+   }
 
    slock_lock(running_lock);
-   worker_continue = true;
+   worker_continue    = true;
+   worker_generation  = 0;
+   task_workers_next  = 0;
+
+   /* Hand over tasks that were queued while running unthreaded */
+   for (task = tasks_running.front; task; task = task->next)
+      count++;
+   task_deque_reserve(&tasks_global, count);
+   for (task = tasks_running.front; task; task = task->next)
+      task_worker_push(&task_workers[
+            task_workers_next++ % task_workers_count], task);
    slock_unlock(running_lock);
 
-   worker_thread   = sthread_create(threaded_worker, NULL);
+   for (i = 0; i < task_workers_count; i++)
+      task_workers[i].thread = sthread_create(threaded_worker,
+            &task_workers[i]);
 }
 
 static void retro_task_threaded_deinit(void)
 {
+   unsigned i;
+
    slock_lock(running_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
+   scond_broadcast(worker_cond);
    slock_unlock(running_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < task_workers_count; i++)
+   {
+      task_worker_t *worker = &task_workers[i];
+      unsigned prio;
+
+      sthread_join(worker->thread);
+
+      /* Tasks stay in 'tasks_running' and will be
+       * picked up again by the next implementation */
+      for (prio = 0; prio < TASK_PRIORITY_COUNT; prio++)
+         task_deque_free(&worker->deques[prio]);
+      slock_free(worker->lock);
+
+      worker->thread = NULL;
+      worker->lock   = NULL;
+   }
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
    slock_free(queue_lock);
-
-   worker_thread   = NULL;
-   worker_cond     = NULL;
-   running_lock    = NULL;
-   finished_lock   = NULL;
-   property_lock   = NULL;
-   queue_lock      = NULL;
+   slock_free(handler_lock);
+   task_deque_free(&tasks_global);
+   slock_free(global_lock);
+
+   task_workers_count = 0;
+   worker_cond        = NULL;
+   running_lock       = NULL;
+   finished_lock      = NULL;
+   property_lock      = NULL;
+   queue_lock         = NULL;
+   handler_lock       = NULL;
+   global_lock        = NULL;
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -646,6 +1023,20 @@ bool task_queue_is_threaded(void)
    return task_threaded_enable;
 }
 
+void task_queue_set_num_workers(unsigned num)
+{
+   task_num_workers = num;
+}
+
+unsigned task_queue_get_num_workers(void)
+{
+#ifdef HAVE_THREADS
+   return task_queue_resolve_num_workers();
+#else
+   return 1;
+#endif
+}
+
 bool task_queue_find(task_finder_data_t *find_data)
 {
    return impl_current->find(find_data->func, find_data->userdata);
@@ -664,6 +1055,9 @@ void task_queue_check(void)
 
    if (want_threaded != current_threaded)
       task_queue_deinit();
+   else if (current_threaded
+         && task_workers_count != task_queue_resolve_num_workers())
+      task_queue_deinit();
 
    if (!impl_current)
       task_queue_init(want_threaded, msg_push_bak);
@@ -674,6 +1068,9 @@ void task_queue_check(void)
 
 bool task_queue_push(retro_task_t *task)
 {
+   if ((unsigned)task->priority >= TASK_PRIORITY_COUNT)
+      task->priority = TASK_PRIORITY_IO;
+
    /* Ignore this task if a related one is already running */
    if (task->type == TASK_TYPE_BLOCKING)
    {
@@ -705,9 +1102,7 @@ bool task_queue_push(retro_task_t *task)
 
    /* The lack of NULL checks in the following functions
     * is proposital to ensure correct control flow by the users. */
-   impl_current->push_running(task);
-
-   return true;
+   return impl_current->push_running(task);
 }
 
 void task_queue_wait(retro_task_condition_fn_t cond, void* data)
@@ -981,6 +1376,7 @@ retro_task_t *task_init(void)
    task->title             = NULL;
    task->type              = TASK_TYPE_NONE;
    task->style             = TASK_STYLE_NONE;
+   task->priority          = TASK_PRIORITY_IO;
    task->ident             = task_count++;
    task->frontend_userdata = NULL;
    task->alternative_look  = false;
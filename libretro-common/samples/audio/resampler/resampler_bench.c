@@ -0,0 +1,292 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (resampler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Throughput of every sinc resampler and sample conversion
+ * kernel this CPU can run, checked against the C versions.
+ *
+ * Usage: resampler_bench [seconds of audio] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <features/features_cpu.h>
+#include <retro_miscellaneous.h>
+
+/* Included directly to reach every kernel,
+ * not just the ones picked for this CPU */
+#include "../../../audio/resampler/drivers/sinc_resampler.c"
+#include "../../../audio/conversion/float_to_s16.c"
+#include "../../../audio/conversion/s16_to_float.c"
+
+#define INPUT_RATE  32040.0
+#define OUTPUT_RATE 48000.0
+#define CHUNK       1024
+
+typedef void (*sinc_process_t)(void *re, struct resampler_data *data);
+
+typedef struct
+{
+   const char *name;
+   sinc_process_t process;
+   sinc_process_t process_kaiser;
+   bool available;
+} sinc_variant_t;
+
+static float *bench_input;
+static size_t bench_frames;
+
+static double bench_seconds(retro_time_t start)
+{
+   return (double)(cpu_features_get_time_usec() - start) / 1000000.0;
+}
+
+/* Resamples the whole input, returns the output frame count
+ * and the time it took in *secs */
+static size_t bench_sinc(sinc_process_t process,
+      enum resampler_quality quality, float *out, double *secs)
+{
+   size_t pos      = 0;
+   size_t produced = 0;
+   retro_time_t start;
+   void *re        = resampler_sinc_new(NULL, OUTPUT_RATE / INPUT_RATE,
+         quality, (resampler_simd_mask_t)cpu_features_get());
+
+   *secs           = 0;
+   if (!re)
+      return 0;
+
+   start           = cpu_features_get_time_usec();
+   while (pos < bench_frames)
+   {
+      struct resampler_data data;
+      size_t frames       = MIN(CHUNK, bench_frames - pos);
+
+      data.data_in        = bench_input + pos * 2;
+      data.data_out       = out + produced * 2;
+      data.input_frames   = frames;
+      data.output_frames  = 0;
+      data.ratio          = OUTPUT_RATE / INPUT_RATE;
+
+      process(re, &data);
+
+      produced           += data.output_frames;
+      pos                += frames;
+   }
+   *secs           = bench_seconds(start);
+
+   resampler_sinc_free(re);
+   return produced;
+}
+
+static void bench_quality(const char *label,
+      enum resampler_quality quality, bool kaiser,
+      const sinc_variant_t *variants, size_t count)
+{
+   size_t i, j;
+   size_t cap        = (size_t)(bench_frames * OUTPUT_RATE / INPUT_RATE)
+      + CHUNK * 2;
+   float *reference  = (float*)calloc(cap * 2, sizeof(float));
+   float *out        = (float*)calloc(cap * 2, sizeof(float));
+   size_t ref_frames = 0;
+
+   printf("%s:\n", label);
+
+   for (i = 0; i < count; i++)
+   {
+      double secs;
+      float max_err        = 0.0f;
+      size_t frames;
+      sinc_process_t process = kaiser
+         ? variants[i].process_kaiser : variants[i].process;
+
+      if (!variants[i].available || !process)
+         continue;
+
+      frames = bench_sinc(process, quality, i ? out : reference, &secs);
+      if (!i)
+         ref_frames = frames;
+      else
+      {
+         for (j = 0; j < MIN(frames, ref_frames) * 2; j++)
+         {
+            float err = (float)fabs(out[j] - reference[j]);
+            if (err > max_err)
+               max_err = err;
+         }
+      }
+
+      printf("  %-6s %12.0f frames/s  (max error %g%s)\n",
+            variants[i].name, secs > 0 ? frames / secs : 0,
+            max_err, frames != ref_frames ? ", LENGTH MISMATCH" : "");
+   }
+
+   free(reference);
+   free(out);
+}
+
+#if (defined(__SSE2__) || defined(HAVE_FLOAT_TO_S16_AVX2)) && \
+    (defined(__SSE2__) || defined(HAVE_S16_TO_FLOAT_AVX2))
+static void bench_conversion(void)
+{
+   size_t i, samples = bench_frames * 2;
+   int16_t *s16      = (int16_t*)malloc(samples * sizeof(int16_t));
+   float *f32        = (float*)malloc(samples * sizeof(float));
+   struct
+   {
+      const char *name;
+      float_to_s16_simd_t to_s16;
+      s16_to_float_simd_t to_float;
+      bool available;
+   } variants[3];
+   uint64_t cpu      = cpu_features_get();
+
+   variants[0].name      = "c";
+   variants[0].to_s16    = NULL;
+   variants[0].to_float  = NULL;
+   variants[0].available = true;
+   variants[1].name      = "sse2";
+#if defined(__SSE2__)
+   variants[1].to_s16    = convert_float_to_s16_sse2;
+   variants[1].to_float  = convert_s16_to_float_sse2;
+   variants[1].available = true;
+#else
+   variants[1].available = false;
+#endif
+   variants[2].name      = "avx2";
+#if defined(HAVE_FLOAT_TO_S16_AVX2) && defined(HAVE_S16_TO_FLOAT_AVX2)
+   variants[2].to_s16    = convert_float_to_s16_avx2;
+   variants[2].to_float  = convert_s16_to_float_avx2;
+   variants[2].available = (cpu & RETRO_SIMD_AVX) && (cpu & RETRO_SIMD_AVX2);
+#else
+   variants[2].available = false;
+#endif
+
+   printf("Conversion:\n");
+   for (i = 0; i < ARRAY_SIZE(variants); i++)
+   {
+      unsigned round;
+      double to_s16, to_float;
+      retro_time_t start;
+
+      if (!variants[i].available)
+         continue;
+
+      float_to_s16_simd = variants[i].to_s16;
+      s16_to_float_simd = variants[i].to_float;
+
+      start    = cpu_features_get_time_usec();
+      for (round = 0; round < 16; round++)
+         convert_float_to_s16(s16, bench_input, samples);
+      to_s16   = bench_seconds(start);
+
+      start    = cpu_features_get_time_usec();
+      for (round = 0; round < 16; round++)
+         convert_s16_to_float(f32, s16, samples, 1.0f);
+      to_float = bench_seconds(start);
+
+      printf("  %-6s float->s16 %12.0f samples/s, "
+            "s16->float %12.0f samples/s\n", variants[i].name,
+            to_s16   > 0 ? samples * 16 / to_s16   : 0,
+            to_float > 0 ? samples * 16 / to_float : 0);
+   }
+
+   free(s16);
+   free(f32);
+}
+#else
+static void bench_conversion(void) { }
+#endif
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   char features[256];
+   double seconds  = 10.0;
+   uint64_t cpu    = cpu_features_get();
+   sinc_variant_t variants[4];
+
+   if (argc > 1)
+      seconds = atof(argv[1]);
+   if (seconds <= 0.0)
+      return 1;
+
+   bench_frames = (size_t)(seconds * INPUT_RATE);
+   bench_input  = (float*)malloc(bench_frames * 2 * sizeof(float));
+   srand(1234);
+   for (i = 0; i < bench_frames; i++)
+   {
+      /* A tone plus some noise, so nothing is trivially zero */
+      float noise            = (float)rand() / RAND_MAX - 0.5f;
+      bench_input[i * 2 + 0] = 0.5f * (float)sin(i * 0.05) + 0.1f * noise;
+      bench_input[i * 2 + 1] = 0.5f * (float)cos(i * 0.03) - 0.1f * noise;
+   }
+
+   features[0] = '\0';
+   cpu_features_get_model_name(features, sizeof(features));
+   printf("CPU: %s\n", features);
+   printf("Resampling %.1f s of audio from %.0f to %.0f Hz\n\n",
+         seconds, INPUT_RATE, OUTPUT_RATE);
+
+   memset(variants, 0, sizeof(variants));
+   variants[0].name           = "c";
+   variants[0].process        = resampler_sinc_process_c;
+   variants[0].process_kaiser = resampler_sinc_process_c_kaiser;
+   variants[0].available      = true;
+#ifdef HAVE_SINC_SSE
+   variants[1].name           = "sse";
+   variants[1].process        = resampler_sinc_process_sse;
+   variants[1].process_kaiser = resampler_sinc_process_sse_kaiser;
+   variants[1].available      = (cpu & RETRO_SIMD_SSE) != 0;
+#endif
+#ifdef HAVE_SINC_AVX
+   variants[2].name           = "avx";
+   variants[2].process        = resampler_sinc_process_avx;
+   variants[2].process_kaiser = resampler_sinc_process_avx_kaiser;
+   variants[2].available      = (cpu & RETRO_SIMD_AVX) != 0;
+#endif
+#ifdef HAVE_SINC_FMA
+   variants[3].name           = "fma";
+   variants[3].process        = resampler_sinc_process_fma;
+   variants[3].process_kaiser = resampler_sinc_process_fma_kaiser;
+   variants[3].available      = (cpu & RETRO_SIMD_AVX)
+      && (cpu & RETRO_SIMD_AVX2) && resampler_sinc_has_fma();
+#endif
+
+   /* The AVX kernels need the tap count of the qualities
+    * resampler_sinc_new() enables them for */
+   bench_quality("Lower (lanczos)", RESAMPLER_QUALITY_LOWER, false,
+         variants, 2);
+   bench_quality("Normal (kaiser)", RESAMPLER_QUALITY_NORMAL, true,
+         variants, 2);
+   bench_quality("Higher (kaiser)", RESAMPLER_QUALITY_HIGHER, true,
+         variants, ARRAY_SIZE(variants));
+   bench_quality("Highest (kaiser)", RESAMPLER_QUALITY_HIGHEST, true,
+         variants, ARRAY_SIZE(variants));
+
+   printf("\n");
+   bench_conversion();
+
+   free(bench_input);
+   return 0;
+}
@@ -0,0 +1,191 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (net_http_pool_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Fetches <url>0 to <url><files - 1>, first opening a new
+ * connection for every request and then through the
+ * connection pool, and prints how long each took.
+ *
+ * Usage: http_pool_bench <url> [files] [concurrent]
+ *
+ * Defaults to 1000 files, 4 requests in flight at once.
+ * To serve small files locally:
+ *
+ *    mkdir www && cd www
+ *    for i in $(seq 0 999); do echo "file $i" > $i; done
+ *    python3 -c "import http.server as h; \
+ *       r = h.SimpleHTTPRequestHandler; \
+ *       r.protocol_version = 'HTTP/1.1'; \
+ *       r.disable_nagle_algorithm = True; \
+ *       h.ThreadingHTTPServer(('127.0.0.1', 8080), r).serve_forever()"
+ *    http_pool_bench http://127.0.0.1:8080/
+ *
+ * The server has to disable Nagle's algorithm like most
+ * do, or the body it writes after the headers waits on
+ * the delayed ACK of a kept-alive connection.
+ *
+ * Exits with 1 if a request failed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <net/net_http.h>
+#include <net/net_compat.h>
+#include <net/net_socket.h>
+#include <lists/string_list.h>
+#include <retro_miscellaneous.h>
+
+#define BENCH_MAX_CONCURRENT 64
+
+static double bench_time(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static struct http_t *bench_request(const char *prefix, unsigned i)
+{
+   char url[1024];
+   struct http_t *http;
+   struct http_connection_t *conn;
+
+   snprintf(url, sizeof(url), "%s%u", prefix, i);
+   if (!(conn = net_http_connection_new(url, "GET", NULL)))
+      return NULL;
+
+   while (!net_http_connection_iterate(conn)) { }
+
+   http = net_http_connection_done(conn) ? net_http_new(conn) : NULL;
+   net_http_connection_free(conn);
+   return http;
+}
+
+/* Returns false if a request failed */
+static bool bench_finish(struct http_t *http)
+{
+   size_t len;
+   uint8_t *data = net_http_data(http, &len, true);
+   bool ok       = !net_http_error(http) && data && len;
+
+   free(data);
+   string_list_free(net_http_headers(http));
+   net_http_delete(http);
+   return ok;
+}
+
+static bool bench_run(const char *prefix, unsigned files,
+      unsigned concurrent, bool pool)
+{
+   unsigned i;
+   double start;
+   struct http_t *slots[BENCH_MAX_CONCURRENT];
+   unsigned next   = 0;
+   unsigned done   = 0;
+   unsigned failed = 0;
+
+   if (pool)
+      net_http_pool_init();
+
+   memset(slots, 0, sizeof(slots));
+   start = bench_time();
+
+   while (done < files)
+   {
+      fd_set fds;
+      struct timeval tv;
+      int max_fd = -1;
+
+      for (i = 0; i < concurrent; i++)
+      {
+         if (!slots[i] && next < files)
+         {
+            if (!(slots[i] = bench_request(prefix, next++)))
+            {
+               failed++;
+               done++;
+               continue;
+            }
+         }
+
+         if (slots[i] && net_http_update(slots[i], NULL, NULL))
+         {
+            if (!bench_finish(slots[i]))
+               failed++;
+            slots[i] = NULL;
+            done++;
+         }
+      }
+
+      /* Sleep until one of the requests can go on */
+      FD_ZERO(&fds);
+      for (i = 0; i < concurrent; i++)
+      {
+         if (slots[i])
+         {
+            int fd = net_http_fd(slots[i]);
+            FD_SET(fd, &fds);
+            max_fd = MAX(max_fd, fd);
+         }
+      }
+      if (max_fd >= 0)
+      {
+         tv.tv_sec  = 0;
+         tv.tv_usec = 10000;
+         socket_select(max_fd + 1, &fds, NULL, NULL, &tv);
+      }
+   }
+
+   printf("%-7s %u files in %8.3f s, %u failed\n",
+         pool ? "pool" : "no pool", files, bench_time() - start, failed);
+
+   if (pool)
+      net_http_pool_deinit();
+
+   return !failed;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned files, concurrent;
+   bool ok = true;
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: %s <url> [files] [concurrent]\n", argv[0]);
+      return 1;
+   }
+
+   files      = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 1000;
+   concurrent = argc > 3 ? (unsigned)strtoul(argv[3], NULL, 0) : 4;
+   concurrent = MIN(MAX(concurrent, 1), BENCH_MAX_CONCURRENT);
+
+   if (!network_init())
+      return 1;
+
+   printf("%u requests in flight\n", concurrent);
+   ok = bench_run(argv[1], files, concurrent, false) && ok;
+   ok = bench_run(argv[1], files, concurrent, true)  && ok;
+
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Contention benchmark for the audio sample queues.
+ *
+ * A "core" thread keeps pushing audio-sized chunks while an
+ * "audio" thread drains period-sized ones, both as fast as they
+ * can, first through a fifo_buffer_t guarded by a lock (as the
+ * threaded audio drivers used to) and then through spsc_queue_t.
+ * Reports the throughput and how long single writes took on the
+ * core thread, which is where waiting on the lock hurts.
+ *
+ * Usage: spsc_queue_bench [seconds per run] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
+#include <retro_miscellaneous.h>
+#include <rthreads/rthreads.h>
+
+#define QUEUE_SIZE  (16 * 1024)
+#define WRITE_CHUNK 1068 /* ~267 stereo frames, one 60 Hz frame at 32 kHz */
+#define READ_CHUNK  1024 /* One 256 frame period */
+
+typedef struct
+{
+   fifo_buffer_t *fifo;
+   slock_t *lock;
+   spsc_queue_t *spsc;
+   volatile bool stop;
+   unsigned long long read_bytes;
+} bench_state_t;
+
+static size_t bench_write(bench_state_t *state, const uint8_t *buf, size_t size)
+{
+   size_t written;
+
+   if (state->spsc)
+      return spsc_queue_write(state->spsc, buf, size);
+
+   slock_lock(state->lock);
+   written = MIN(FIFO_WRITE_AVAIL(state->fifo), size);
+   fifo_write(state->fifo, buf, written);
+   slock_unlock(state->lock);
+   return written;
+}
+
+static size_t bench_read(bench_state_t *state, uint8_t *buf, size_t size)
+{
+   size_t read;
+
+   if (state->spsc)
+      return spsc_queue_read(state->spsc, buf, size);
+
+   slock_lock(state->lock);
+   read = MIN(FIFO_READ_AVAIL(state->fifo), size);
+   fifo_read(state->fifo, buf, read);
+   slock_unlock(state->lock);
+   return read;
+}
+
+static void audio_thread(void *data)
+{
+   uint8_t buf[READ_CHUNK];
+   bench_state_t *state = (bench_state_t*)data;
+
+   while (!state->stop)
+      state->read_bytes += bench_read(state, buf, sizeof(buf));
+}
+
+static void bench_run(const char *label, bench_state_t *state,
+      double seconds)
+{
+   uint8_t buf[WRITE_CHUNK];
+   sthread_t *thread;
+   retro_time_t start, end;
+   unsigned long long writes = 0;
+   unsigned long long slow   = 0;
+   retro_time_t total        = 0;
+   retro_time_t worst        = 0;
+
+   memset(buf, 0x55, sizeof(buf));
+   state->stop       = false;
+   state->read_bytes = 0;
+   thread            = sthread_create(audio_thread, state);
+
+   start             = cpu_features_get_time_usec();
+   end               = start + (retro_time_t)(seconds * 1000000.0);
+   for (;;)
+   {
+      retro_time_t before = cpu_features_get_time_usec();
+      retro_time_t took;
+
+      if (before >= end)
+         break;
+
+      bench_write(state, buf, sizeof(buf));
+      took   = cpu_features_get_time_usec() - before;
+      total += took;
+      if (took > worst)
+         worst = took;
+      if (took > 100)
+         slow++;
+      writes++;
+   }
+
+   state->stop = true;
+   sthread_join(thread);
+
+   printf("%-12s %10.1f MB/s read, %12llu writes, "
+         "avg %6.3f us, worst %6lld us, %llu over 100 us\n",
+         label, state->read_bytes / seconds / 1e6, writes,
+         writes ? (double)total / writes : 0.0,
+         (long long)worst, slow);
+}
+
+int main(int argc, char *argv[])
+{
+   bench_state_t state;
+   double seconds = 3.0;
+
+   if (argc > 1)
+      seconds = atof(argv[1]);
+   if (seconds <= 0.0)
+      return 1;
+
+   memset(&state, 0, sizeof(state));
+   state.fifo = fifo_new(QUEUE_SIZE);
+   state.lock = slock_new();
+   bench_run("fifo + lock", &state, seconds);
+   fifo_free(state.fifo);
+   slock_free(state.lock);
+
+   memset(&state, 0, sizeof(state));
+   state.spsc = spsc_queue_new(QUEUE_SIZE);
+   bench_run("spsc", &state, seconds);
+   spsc_queue_free(state.spsc);
+
+   return 0;
+}
@@ -0,0 +1,224 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (task_queue_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Stress benchmark for the threaded task queue.
+ *
+ * Keeps two CPU bound background tasks (a "scan" and a
+ * "thumbnail download") and a few I/O bound tasks busy,
+ * while the main loop pushes short interactive tasks
+ * (a "savestate") at a fixed rate and measures how long
+ * they wait before starting and until their callback fires.
+ *
+ * Usage: task_queue_bench [workers] [seconds]
+ * (workers = 0 picks the default for this machine) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/task_queue.h>
+#include <features/features_cpu.h>
+#include <retro_timers.h>
+
+#define MAX_SAMPLES       4096
+#define NUM_IO_TASKS      4
+#define PROBE_INTERVAL_US 20000
+
+typedef struct
+{
+   retro_time_t pushed;
+   retro_time_t started;
+} probe_state_t;
+
+static volatile bool bench_stop       = false;
+static retro_time_t start_latency[MAX_SAMPLES];
+static retro_time_t done_latency[MAX_SAMPLES];
+static unsigned num_samples           = 0;
+/* Tasks sharing a handler never run concurrently,
+ * so each counter only has a single writer at a time */
+static unsigned long scan_calls       = 0;
+static unsigned long thumbnail_calls  = 0;
+static unsigned long io_calls         = 0;
+
+static void spin_usec(retro_time_t usec)
+{
+   retro_time_t end = cpu_features_get_time_usec() + usec;
+   while (cpu_features_get_time_usec() < end);
+}
+
+static void scan_handler(retro_task_t *task)
+{
+   /* Hashing a chunk of a file */
+   spin_usec(2000);
+   scan_calls++;
+   if (bench_stop)
+      task_set_finished(task, true);
+}
+
+static void thumbnail_handler(retro_task_t *task)
+{
+   /* Decoding a downloaded image */
+   spin_usec(1500);
+   thumbnail_calls++;
+   if (bench_stop)
+      task_set_finished(task, true);
+}
+
+static void io_handler(retro_task_t *task)
+{
+   /* Waiting on a socket or a disk */
+   retro_sleep(1);
+   io_calls++;
+   if (bench_stop)
+      task_set_finished(task, true);
+}
+
+static void probe_handler(retro_task_t *task)
+{
+   probe_state_t *state = (probe_state_t*)task->state;
+
+   state->started = cpu_features_get_time_usec();
+   /* Serializing and writing a small savestate */
+   spin_usec(500);
+   task_set_finished(task, true);
+}
+
+static void probe_callback(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   probe_state_t *state = (probe_state_t*)task->state;
+
+   if (num_samples < MAX_SAMPLES)
+   {
+      start_latency[num_samples] = state->started - state->pushed;
+      done_latency[num_samples]  = cpu_features_get_time_usec()
+         - state->pushed;
+      num_samples++;
+   }
+
+   free(state);
+}
+
+static void push_task(retro_task_handler_t handler,
+      enum task_priority priority)
+{
+   retro_task_t *task = task_init();
+
+   task->handler      = handler;
+   task->priority     = priority;
+   task->mute         = true;
+   task_queue_push(task);
+}
+
+static void push_probe(void)
+{
+   retro_task_t *task   = task_init();
+   probe_state_t *state = (probe_state_t*)calloc(1, sizeof(*state));
+
+   state->pushed        = cpu_features_get_time_usec();
+   task->handler        = probe_handler;
+   task->callback       = probe_callback;
+   task->state          = state;
+   task->priority       = TASK_PRIORITY_INTERACTIVE;
+   task->type           = TASK_TYPE_BLOCKING;
+   task->mute           = true;
+
+   if (!task_queue_push(task))
+   {
+      free(state);
+      free(task);
+   }
+}
+
+static int compare_time(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+static void print_stats(const char *label, retro_time_t *samples)
+{
+   unsigned i;
+   retro_time_t sum = 0;
+
+   if (!num_samples)
+      return;
+
+   qsort(samples, num_samples, sizeof(*samples), compare_time);
+   for (i = 0; i < num_samples; i++)
+      sum += samples[i];
+
+   printf("%-16s avg %8.3f ms  p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",
+         label,
+         (double)sum / num_samples / 1000.0,
+         samples[num_samples / 2] / 1000.0,
+         samples[(num_samples * 99) / 100] / 1000.0,
+         samples[num_samples - 1] / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   retro_time_t end, next_probe;
+   unsigned workers = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 10) : 0;
+   unsigned seconds = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 5;
+
+   task_queue_set_num_workers(workers);
+   task_queue_init(true, NULL);
+
+   printf("Workers: %u, duration: %u s\n",
+         task_queue_get_num_workers(), seconds);
+
+   push_task(scan_handler,      TASK_PRIORITY_BACKGROUND);
+   push_task(thumbnail_handler, TASK_PRIORITY_BACKGROUND);
+   for (i = 0; i < NUM_IO_TASKS; i++)
+      push_task(io_handler, TASK_PRIORITY_IO);
+
+   next_probe = cpu_features_get_time_usec();
+   end        = next_probe + (retro_time_t)seconds * 1000000;
+
+   while (cpu_features_get_time_usec() < end)
+   {
+      if (cpu_features_get_time_usec() >= next_probe)
+      {
+         push_probe();
+         next_probe += PROBE_INTERVAL_US;
+      }
+
+      task_queue_check();
+      retro_sleep(1);
+   }
+
+   bench_stop = true;
+   task_queue_wait(NULL, NULL);
+   task_queue_check();
+   task_queue_deinit();
+
+   printf("Interactive tasks: %u, scan calls: %lu, "
+         "thumbnail calls: %lu, I/O calls: %lu\n",
+         num_samples, scan_calls, thumbnail_calls, io_calls);
+   print_stats("Start latency", start_latency);
+   print_stats("Completion", done_latency);
+
+   return 0;
+}
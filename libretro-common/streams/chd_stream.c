@@ -31,23 +31,65 @@
 #include <libchdr/chd.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Number of decoded hunks kept per stream */
+#define CHDSTREAM_CACHE_HUNKS 8
+/* Number of hunks decoded ahead of a sequential reader */
+#define CHDSTREAM_PREFETCH_HUNKS 4
+
+struct chdstream_hunk
+{
+   uint8_t *mem;
+   /* Hunk held by this slot, or -1 */
+   int32_t hunknum;
+   /* Last use, for LRU eviction */
+   uint32_t age;
+   /* Being decoded, not to be read or evicted */
+   bool loading;
+};
+
 struct chdstream
 {
    chd_file *chd;
-   /* Loaded hunk */
-   uint8_t *hunkmem;
+   /* Decoded hunks */
+   struct chdstream_hunk hunks[CHDSTREAM_CACHE_HUNKS];
+#ifdef HAVE_THREADS
+   /* Prefetch thread, started on the first sequential read */
+   sthread_t *thread;
+   /* Guards the hunk slots and the prefetch window */
+   slock_t *lock;
+   /* Serialises chd_read() and metadata reads on the chd_file */
+   slock_t *chd_lock;
+   /* Signalled when a hunk is decoded or prefetch is wanted */
+   scond_t *cond;
+   /* Next hunk to prefetch, and the end of the window */
+   uint32_t prefetch_next;
+   uint32_t prefetch_end;
+   bool quit;
+#endif
+   /* LRU clock */
+   uint32_t clock;
+   /* Last hunk read from, to detect sequential access */
+   int32_t last_hunk;
    /* Byte offset where track data starts (after pregap) */
    size_t track_start;
    /* Byte offset where track data ends */
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
-   int32_t hunknum;
    /* Size of frame taken from each hunk */
    uint32_t frame_size;
    /* Offset of data within frame */
@@ -205,9 +247,9 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
+   unsigned i;
    metadata_t meta;
    uint32_t pregap         = 0;
-   uint8_t *hunkmem        = NULL;
    const chd_header *hd    = NULL;
    chdstream_t *stream     = NULL;
    chd_file *chd           = NULL;
@@ -219,7 +261,7 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!chdstream_find_track(chd, track, &meta))
       goto error;
 
-   stream                  = (chdstream_t*)malloc(sizeof(*stream));
+   stream                  = (chdstream_t*)calloc(1, sizeof(*stream));
    if (!stream)
       goto error;
 
@@ -232,15 +274,26 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->track_start     = 0;
    stream->track_end       = 0;
    stream->offset          = 0;
-   stream->hunkmem         = NULL;
-   stream->hunknum         = -1;
+   stream->clock           = 0;
+   stream->last_hunk       = -1;
 
    hd                      = chd_get_header(chd);
-   hunkmem                 = (uint8_t*)malloc(hd->hunkbytes);
-   if (!hunkmem)
-      goto error;
 
-   stream->hunkmem         = hunkmem;
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      stream->hunks[i].mem     = (uint8_t*)malloc(hd->hunkbytes);
+      stream->hunks[i].hunknum = -1;
+      if (!stream->hunks[i].mem)
+         goto error;
+   }
+
+#ifdef HAVE_THREADS
+   stream->lock            = slock_new();
+   stream->chd_lock        = slock_new();
+   stream->cond            = scond_new();
+   if (!stream->lock || !stream->chd_lock || !stream->cond)
+      goto error;
+#endif
 
    if (string_is_equal(meta.type, "MODE1_RAW"))
       stream->frame_size   = SECTOR_SIZE;
@@ -279,38 +332,253 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   unsigned i;
+
    if (!stream)
       return;
 
-   if (stream->hunkmem)
-      free(stream->hunkmem);
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_broadcast(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->thread);
+   }
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->chd_lock)
+      slock_free(stream->chd_lock);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (stream->hunks[i].mem)
+         free(stream->hunks[i].mem);
    if (stream->chd)
       chd_close(stream->chd);
    free(stream);
 }
 
-static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+/* Swaps the bytes of every 16-bit word in @data,
+ * which holds @count words. */
+static void chdstream_swab16(uint8_t *data, size_t count)
 {
+   size_t i       = 0;
    uint16_t *array;
+#if defined(__SSE2__)
+   for (; i + 8 <= count; i += 8)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(data + i * 2));
+      v         = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128((__m128i*)(data + i * 2), v);
+   }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+   for (; i + 8 <= count; i += 8)
+      vst1q_u8(data + i * 2, vrev16q_u8(vld1q_u8(data + i * 2)));
+#endif
+   array          = (uint16_t*)data;
+   for (; i < count; ++i)
+      array[i]    = SWAP16(array[i]);
+}
 
-   if ((int)hunknum == stream->hunknum)
-      return true;
+static void chdstream_lock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+#endif
+}
+
+static void chdstream_unlock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+}
+
+/* The chd_file is shared with the prefetch thread,
+ * so every access to it goes through these. */
+static chd_error chdstream_chd_read(chdstream_t *stream,
+      uint32_t hunknum, uint8_t *mem)
+{
+   chd_error err;
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   err = chd_read(stream->chd, hunknum, mem);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
+   return err;
+}
+
+static bool chdstream_get_stream_meta(chdstream_t *stream,
+      int idx, metadata_t *md)
+{
+   bool ret;
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   ret = chdstream_get_meta(stream->chd, idx, md);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
+   return ret;
+}
+
+/* The functions below are called with the stream lock held. */
+
+static struct chdstream_hunk *
+chdstream_find_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   unsigned i;
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      if (stream->hunks[i].hunknum == (int32_t)hunknum)
+         return &stream->hunks[i];
+   return NULL;
+}
+
+/* Returns the least recently used slot that isn't
+ * being decoded, or NULL if there is none. */
+static struct chdstream_hunk *chdstream_evict_hunk(chdstream_t *stream)
+{
+   unsigned i;
+   struct chdstream_hunk *slot = NULL;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      struct chdstream_hunk *hunk = &stream->hunks[i];
+      if (hunk->loading)
+         continue;
+      if (hunk->hunknum < 0)
+         return hunk;
+      if (!slot || (int32_t)(hunk->age - slot->age) < 0)
+         slot = hunk;
+   }
+
+   return slot;
+}
 
-   if (chd_read(stream->chd, hunknum, stream->hunkmem) != CHDERR_NONE)
-      return false;
+/* Decodes @hunknum into @slot. The stream lock is released
+ * while decoding, the slot being marked as loading meanwhile. */
+static bool chdstream_decode_hunk(chdstream_t *stream,
+      struct chdstream_hunk *slot, uint32_t hunknum)
+{
+   bool ok;
+
+   slot->hunknum = hunknum;
+   slot->loading = true;
+   chdstream_unlock(stream);
+
+   ok = chdstream_chd_read(stream, hunknum, slot->mem) == CHDERR_NONE;
+   if (ok && stream->swab)
+      chdstream_swab16(slot->mem,
+            chd_get_header(stream->chd)->hunkbytes / 2);
+
+   chdstream_lock(stream);
+   slot->loading = false;
+   slot->age     = ++stream->clock;
+   if (!ok)
+      slot->hunknum = -1;
+#ifdef HAVE_THREADS
+   scond_broadcast(stream->cond);
+#endif
+   return ok;
+}
 
-   if (stream->swab)
+#ifdef HAVE_THREADS
+static void chdstream_prefetch_thread(void *data)
+{
+   chdstream_t *stream  = (chdstream_t*)data;
+   uint32_t totalhunks  = chd_get_header(stream->chd)->totalhunks;
+
+   slock_lock(stream->lock);
+
+   for (;;)
    {
-      uint32_t i;
-      uint32_t count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array          = (uint16_t*)stream->hunkmem;
-      for (i = 0; i < count; ++i)
-         array[i] = SWAP16(array[i]);
+      uint32_t hunknum;
+      struct chdstream_hunk *slot;
+
+      while (!stream->quit && stream->prefetch_next >= stream->prefetch_end)
+         scond_wait(stream->cond, stream->lock);
+
+      if (stream->quit)
+         break;
+
+      hunknum = stream->prefetch_next++;
+
+      if (hunknum >= totalhunks)
+      {
+         stream->prefetch_end = stream->prefetch_next;
+         continue;
+      }
+
+      if (chdstream_find_hunk(stream, hunknum))
+         continue;
+
+      if ((slot = chdstream_evict_hunk(stream)))
+         chdstream_decode_hunk(stream, slot, hunknum);
    }
 
-   stream->hunknum = hunknum;
-   return true;
+   slock_unlock(stream->lock);
+}
+
+/* Moves the prefetch window along when @hunknum follows
+ * the last hunk read, and drops it on a seek elsewhere. */
+static void chdstream_prefetch(chdstream_t *stream, uint32_t hunknum)
+{
+   if (stream->last_hunk >= 0 && hunknum == (uint32_t)stream->last_hunk + 1)
+   {
+      if (     stream->prefetch_next <= hunknum
+            || stream->prefetch_next > hunknum + CHDSTREAM_PREFETCH_HUNKS)
+         stream->prefetch_next = hunknum + 1;
+      stream->prefetch_end     = hunknum + 1 + CHDSTREAM_PREFETCH_HUNKS;
+
+      if (!stream->thread)
+         stream->thread = sthread_create(chdstream_prefetch_thread, stream);
+      scond_broadcast(stream->cond);
+   }
+   else
+      stream->prefetch_end     = stream->prefetch_next;
+}
+#endif
+
+static struct chdstream_hunk *
+chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   struct chdstream_hunk *slot;
+
+   if ((int32_t)hunknum != stream->last_hunk)
+   {
+#ifdef HAVE_THREADS
+      chdstream_prefetch(stream, hunknum);
+#endif
+      stream->last_hunk = hunknum;
+   }
+
+   /* Wait for the prefetch thread if it's decoding this hunk */
+   while ((slot = chdstream_find_hunk(stream, hunknum)) && slot->loading)
+   {
+#ifdef HAVE_THREADS
+      scond_wait(stream->cond, stream->lock);
+#endif
+   }
+
+   if (slot)
+   {
+      slot->age = ++stream->clock;
+      return slot;
+   }
+
+   if (!(slot = chdstream_evict_hunk(stream)))
+      return NULL;
+
+   if (!chdstream_decode_hunk(stream, slot, hunknum))
+      return NULL;
+
+   return slot;
 }
 
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
@@ -325,6 +593,8 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
 
    end                  = stream->offset + bytes;
 
+   chdstream_lock(stream);
+
    while (stream->offset < end)
    {
       uint32_t frame_offset = stream->offset % stream->frame_size;
@@ -338,17 +608,21 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
          memset(out + data_offset, 0, amount);
       else
       {
+         struct chdstream_hunk *slot;
          uint32_t chd_frame   = (uint32_t)(stream->track_frame +
             (stream->offset - stream->track_start) / stream->frame_size);
          uint32_t hunk        = chd_frame / stream->frames_per_hunk;
          uint32_t hunk_offset = (chd_frame % stream->frames_per_hunk) 
             * hd->unitbytes;
 
-         if (!chdstream_load_hunk(stream, hunk))
+         if (!(slot = chdstream_load_hunk(stream, hunk)))
+         {
+            chdstream_unlock(stream);
             return -1;
+         }
 
          memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
+                slot->mem + frame_offset
                 + hunk_offset + stream->frame_offset, amount);
       }
 
@@ -356,6 +630,8 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
       stream->offset += amount;
    }
 
+   chdstream_unlock(stream);
+
    return bytes;
 }
 
@@ -434,7 +710,7 @@ uint32_t chdstream_get_track_start(chdstream_t *stream)
    metadata_t meta;
    uint32_t frame_offset = 0;
 
-   for (i = 0; chdstream_get_meta(stream->chd, i, &meta); ++i)
+   for (i = 0; chdstream_get_stream_meta(stream, i, &meta); ++i)
    {
       if (stream->track_frame == frame_offset)
          return meta.pregap * stream->frame_size;
@@ -457,7 +733,7 @@ uint32_t chdstream_get_first_track_sector(chdstream_t* stream)
    uint32_t frame_offset = 0;
    uint32_t sector_offset = 0;
 
-   for (i = 0; chdstream_get_meta(stream->chd, i, &meta); ++i)
+   for (i = 0; chdstream_get_stream_meta(stream, i, &meta); ++i)
    {
       if (stream->track_frame == frame_offset)
          return sector_offset;
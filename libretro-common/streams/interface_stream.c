@@ -33,6 +33,8 @@
 #endif
 #include <encodings/crc32.h>
 
+#define INTFSTREAM_CRC_BUFFER_SIZE (128 * 1024)
+
 struct intfstream_internal
 {
    struct
@@ -61,6 +63,7 @@ struct intfstream_internal
    struct
    {
       rzipstream_t *fp;
+      enum rzip_codec codec;
    } rzip;
 #endif
    enum intfstream_type type;
@@ -151,7 +154,8 @@ bool intfstream_open(intfstream_internal_t *intf, const char *path,
 #endif
       case INTFSTREAM_RZIP:
 #if defined(HAVE_ZLIB)
-         intf->rzip.fp = rzipstream_open(path, mode);
+         intf->rzip.fp = rzipstream_open_codec(path, mode,
+               intf->rzip.codec);
          if (!intf->rzip.fp)
             return false;
          break;
@@ -237,6 +241,7 @@ void *intfstream_init(intfstream_info_t *info)
 #endif
 #ifdef HAVE_ZLIB
    intf->rzip.fp         = NULL;
+   intf->rzip.codec      = RZIP_CODEC_ZLIB;
 #endif
 
    switch (intf->type)
@@ -256,6 +261,9 @@ void *intfstream_init(intfstream_info_t *info)
          goto error;
 #endif
       case INTFSTREAM_RZIP:
+#ifdef HAVE_ZLIB
+         intf->rzip.codec = (enum rzip_codec)info->rzip.codec;
+#endif
          break;
    }
 
@@ -645,17 +653,25 @@ bool intfstream_get_crc(intfstream_internal_t *intf, uint32_t *crc)
 {
    int64_t data_read    = 0;
    uint32_t accumulator = 0;
-   uint8_t buffer[4096];
+   uint8_t *buffer      = NULL;
 
    if (!intf || !crc)
       return false;
 
+   /* Large reads keep the number of calls down
+    * when hashing whole discs */
+   if (!(buffer = (uint8_t*)malloc(INTFSTREAM_CRC_BUFFER_SIZE)))
+      return false;
+
    /* Ensure we start at the beginning of the file */
    intfstream_rewind(intf);
 
-   while ((data_read = intfstream_read(intf, buffer, sizeof(buffer))) > 0)
+   while ((data_read = intfstream_read(intf, buffer,
+               INTFSTREAM_CRC_BUFFER_SIZE)) > 0)
       accumulator = encoding_crc32(accumulator, buffer, (size_t)data_read);
 
+   free(buffer);
+
    if (data_read < 0)
       return false;
 
@@ -781,11 +797,18 @@ error:
 
 intfstream_t* intfstream_open_rzip_file(const char *path,
       unsigned mode)
+{
+   return intfstream_open_rzip_file_codec(path, mode, 0 /* zlib */);
+}
+
+intfstream_t* intfstream_open_rzip_file_codec(const char *path,
+      unsigned mode, unsigned codec)
 {
    intfstream_info_t info;
    intfstream_t *fd = NULL;
 
    info.type        = INTFSTREAM_RZIP;
+   info.rzip.codec  = codec;
    fd               = (intfstream_t*)intfstream_init(&info);
 
    if (!fd)
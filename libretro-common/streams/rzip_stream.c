@@ -28,22 +28,55 @@
 
 #include <streams/rzip_stream.h>
 
-/* Current RZIP file format version */
+#ifdef HAVE_THREADS
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
+
+/* Current RZIP file format version
+ * > Files with zlib chunks are still written as
+ *   version 1, so older builds can read them */
 #define RZIP_VERSION 1
+/* Version that adds a codec field to the header */
+#define RZIP_VERSION_CODEC 2
 
 /* Compression level
  * > zlib default of 6 provides the best
  *   balance between file size and
  *   compression speed */
 #define RZIP_COMPRESSION_LEVEL 6
+/* > zstd default of 3 compresses about as
+ *   well, several times faster */
+#define RZIP_ZSTD_COMPRESSION_LEVEL 3
 
 /* Default chunk size: 128kb */
 #define RZIP_DEFAULT_CHUNK_SIZE 131072
 
 /* Header sizes (in bytes) */
 #define RZIP_HEADER_SIZE 20
+#define RZIP_CODEC_HEADER_SIZE 24
 #define RZIP_CHUNK_HEADER_SIZE 4
 
+/* Maximum number of chunks compressed at once */
+#define RZIP_MAX_JOBS 8
+
+/* A chunk waiting to be compressed. Each has its own
+ * buffers and transform stream, so that several can
+ * be compressed at once */
+typedef struct rzipstream_chunk
+{
+   rzipstream_t *stream;
+   const struct trans_stream_backend *deflate_backend;
+   void *deflate_stream;
+   uint8_t *in_buf;
+   uint8_t *out_buf;
+   uint32_t in_size;
+   uint32_t out_buf_size;
+   uint32_t out_size;
+   bool ok;
+} rzipstream_chunk_t;
+
 /* Holds all metadata for an RZIP file stream */
 struct rzipstream
 {
@@ -53,11 +86,31 @@ struct rzipstream
    uint64_t virtual_ptr;
    RFILE* file;
    const struct trans_stream_backend *deflate_backend;
-   void *deflate_stream;
    const struct trans_stream_backend *inflate_backend;
    void *inflate_stream;
+   /* Chunks filled before compressing them all
+    * > When writing, in_buf is that of the chunk
+    *   currently being filled */
+   rzipstream_chunk_t chunks[RZIP_MAX_JOBS];
    uint8_t *in_buf;
    uint8_t *out_buf;
+#ifdef HAVE_THREADS
+   /* Jobs of this stream still running on the
+    * shared pool */
+   slock_t *jobs_lock;
+   scond_t *jobs_cond;
+   unsigned jobs_pending;
+   /* Next chunk, decoded while the current
+    * one is being read */
+   uint8_t *next_buf;
+   uint32_t next_buf_occupancy;
+   bool prefetch_pending;
+   bool prefetch_ok;
+#endif
+   enum rzip_codec codec;
+   unsigned num_jobs;
+   unsigned chunk_index;
+   uint32_t header_size;
    uint32_t in_buf_size;
    uint32_t in_buf_ptr;
    uint32_t out_buf_size;
@@ -68,6 +121,126 @@ struct rzipstream
    bool is_writing;
 };
 
+#ifdef HAVE_THREADS
+/* Pool shared by all streams, see rzipstream_init_pool()
+ * > Only changed while no stream is open */
+static tpool_t *rzipstream_pool      = NULL;
+static unsigned rzipstream_pool_jobs = 1;
+
+/* Runs 'func' for 'stream' on the shared pool
+ * Returns false if it couldn't be queued */
+static bool rzipstream_add_job(rzipstream_t *stream,
+      thread_func_t func, void *arg)
+{
+   if (!rzipstream_pool)
+      return false;
+
+   if (!stream->jobs_lock)
+   {
+      if (!(stream->jobs_lock = slock_new()))
+         return false;
+      if (!(stream->jobs_cond = scond_new()))
+      {
+         slock_free(stream->jobs_lock);
+         stream->jobs_lock = NULL;
+         return false;
+      }
+   }
+
+   slock_lock(stream->jobs_lock);
+   stream->jobs_pending++;
+   slock_unlock(stream->jobs_lock);
+
+   if (tpool_add_work(rzipstream_pool, func, arg))
+      return true;
+
+   slock_lock(stream->jobs_lock);
+   stream->jobs_pending--;
+   slock_unlock(stream->jobs_lock);
+   return false;
+}
+
+/* Called by each job of 'stream' once it is done */
+static void rzipstream_job_done(rzipstream_t *stream)
+{
+   slock_lock(stream->jobs_lock);
+   if (--stream->jobs_pending == 0)
+      scond_signal(stream->jobs_cond);
+   slock_unlock(stream->jobs_lock);
+}
+
+/* Waits for all jobs of 'stream' */
+static void rzipstream_wait_jobs(rzipstream_t *stream)
+{
+   if (!stream->jobs_lock)
+      return;
+
+   slock_lock(stream->jobs_lock);
+   while (stream->jobs_pending)
+      scond_wait(stream->jobs_cond, stream->jobs_lock);
+   slock_unlock(stream->jobs_lock);
+}
+#endif
+
+/* Creates the threads that streams compress (or
+ * decode ahead) on, one less than there are cores
+ * > Without it, streams do everything on the
+ *   calling thread */
+void rzipstream_init_pool(void)
+{
+#ifdef HAVE_THREADS
+   unsigned num_jobs = cpu_features_get_core_amount();
+
+   if (rzipstream_pool)
+      return;
+
+   if (num_jobs > RZIP_MAX_JOBS)
+      num_jobs = RZIP_MAX_JOBS;
+   if (num_jobs < 2)
+      return;
+
+   /* The calling thread takes one chunk itself */
+   if ((rzipstream_pool = tpool_create(num_jobs - 1)))
+      rzipstream_pool_jobs = num_jobs;
+#endif
+}
+
+/* Stops the threads created by rzipstream_init_pool() */
+void rzipstream_deinit_pool(void)
+{
+#ifdef HAVE_THREADS
+   if (!rzipstream_pool)
+      return;
+
+   tpool_wait(rzipstream_pool);
+   tpool_destroy(rzipstream_pool);
+   rzipstream_pool      = NULL;
+   rzipstream_pool_jobs = 1;
+#endif
+}
+
+/* Returns the transform backend compressing (or,
+ * if reading, decompressing) chunks of 'codec' */
+static const struct trans_stream_backend *rzipstream_get_backend(
+      enum rzip_codec codec, bool is_writing)
+{
+   switch (codec)
+   {
+      case RZIP_CODEC_ZLIB:
+         return is_writing
+            ? trans_stream_get_zlib_deflate_backend()
+            : trans_stream_get_zlib_inflate_backend();
+      case RZIP_CODEC_ZSTD:
+         return is_writing
+            ? trans_stream_get_zstd_compress_backend()
+            : trans_stream_get_zstd_decompress_backend();
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
 /* Header Functions */
 
 /* Reads header information from RZIP file
@@ -104,7 +277,8 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
        (header_bytes[3] !=           73) || /* I */
        (header_bytes[4] !=           80) || /* P */
        (header_bytes[5] !=          118) || /* v */
-       (header_bytes[6] != RZIP_VERSION) || /* file format version number */
+       ((header_bytes[6] != RZIP_VERSION) &&
+        (header_bytes[6] != RZIP_VERSION_CODEC)) || /* file format version number */
        (header_bytes[7] !=           35))   /* # */
    {
       /* Reset file to start */
@@ -133,6 +307,23 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
                    (uint64_t)header_bytes[12]) == 0)
       return false;
 
+   /* Get chunk codec - next 4 bytes, if present */
+   if (header_bytes[6] == RZIP_VERSION_CODEC)
+   {
+      uint8_t codec_bytes[RZIP_CODEC_HEADER_SIZE - RZIP_HEADER_SIZE];
+
+      if (filestream_read(stream->file, codec_bytes, sizeof(codec_bytes))
+            != sizeof(codec_bytes))
+         return false;
+
+      stream->codec       = (enum rzip_codec)(
+                            ((uint32_t)codec_bytes[3] << 24) |
+                            ((uint32_t)codec_bytes[2] << 16) |
+                            ((uint32_t)codec_bytes[1] <<  8) |
+                             (uint32_t)codec_bytes[0]);
+      stream->header_size = RZIP_CODEC_HEADER_SIZE;
+   }
+
    stream->is_compressed = true;
    return true;
 }
@@ -143,13 +334,13 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
 static bool rzipstream_write_file_header(rzipstream_t *stream)
 {
    unsigned i;
-   uint8_t header_bytes[RZIP_HEADER_SIZE];
+   uint8_t header_bytes[RZIP_CODEC_HEADER_SIZE];
 
    if (!stream)
       return false;
 
    /* Populate header array */
-   for (i = 0; i < RZIP_HEADER_SIZE; i++)
+   for (i = 0; i < RZIP_CODEC_HEADER_SIZE; i++)
       header_bytes[i] = 0;
 
    /* > 'Magic numbers' - first 8 bytes */
@@ -159,7 +350,9 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
    header_bytes[3]    =        73;    /* I */
    header_bytes[4]    =        80;    /* P */
    header_bytes[5]    =       118;    /* v */
-   header_bytes[6]    = RZIP_VERSION; /* file format version number */
+   header_bytes[6]    = (stream->header_size == RZIP_CODEC_HEADER_SIZE)
+         ? RZIP_VERSION_CODEC
+         : RZIP_VERSION;              /* file format version number */
    header_bytes[7]    =        35;    /* # */
 
    /* > Uncompressed chunk size - next 4 bytes */
@@ -178,12 +371,59 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
    header_bytes[13]   = (stream->size >>  8) & 0xFF;
    header_bytes[12]   =  stream->size        & 0xFF;
 
+   /* > Chunk codec - next 4 bytes, version 2 only */
+   header_bytes[23]   = (stream->codec >> 24) & 0xFF;
+   header_bytes[22]   = (stream->codec >> 16) & 0xFF;
+   header_bytes[21]   = (stream->codec >>  8) & 0xFF;
+   header_bytes[20]   =  stream->codec        & 0xFF;
+
    /* Reset file to start */
    filestream_seek(stream->file, 0, SEEK_SET);
 
    /* Write header bytes */
    return (filestream_write(stream->file,
-         header_bytes, sizeof(header_bytes)) == RZIP_HEADER_SIZE);
+         header_bytes, stream->header_size) == stream->header_size);
+}
+
+static void rzipstream_free_chunk(rzipstream_chunk_t *chunk)
+{
+   if (chunk->deflate_stream && chunk->deflate_backend)
+      chunk->deflate_backend->stream_free(chunk->deflate_stream);
+   chunk->deflate_stream = NULL;
+
+   if (chunk->in_buf)
+      free(chunk->in_buf);
+   chunk->in_buf = NULL;
+
+   if (chunk->out_buf)
+      free(chunk->out_buf);
+   chunk->out_buf = NULL;
+}
+
+/* Allocates the buffers and transform stream of
+ * a chunk to be compressed, if not done already */
+static bool rzipstream_alloc_chunk(rzipstream_t *stream,
+      rzipstream_chunk_t *chunk)
+{
+   if (chunk->deflate_stream)
+      return true;
+
+   chunk->stream          = stream;
+   chunk->deflate_backend = stream->deflate_backend;
+   chunk->out_buf_size    = stream->out_buf_size;
+
+   if (     (chunk->in_buf  = (uint8_t *)malloc(stream->in_buf_size))
+         && (chunk->out_buf = (uint8_t *)malloc(stream->out_buf_size))
+         && (chunk->deflate_stream = chunk->deflate_backend->stream_new())
+         /* Set compression level */
+         && chunk->deflate_backend->define(chunk->deflate_stream, "level",
+               (stream->codec == RZIP_CODEC_ZSTD)
+               ? RZIP_ZSTD_COMPRESSION_LEVEL
+               : RZIP_COMPRESSION_LEVEL))
+      return true;
+
+   rzipstream_free_chunk(chunk);
+   return false;
 }
 
 /* Stream Initialisation/De-initialisation */
@@ -191,7 +431,8 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
 /* Initialises all members of an rzipstream_t struct,
  * reading config from existing file header if available */
 static bool rzipstream_init_stream(
-      rzipstream_t *stream, const char *path, bool is_writing)
+      rzipstream_t *stream, const char *path, bool is_writing,
+      enum rzip_codec codec)
 {
    unsigned file_mode;
 
@@ -202,8 +443,11 @@ static bool rzipstream_init_stream(
    stream->size              = 0;
    stream->chunk_size        = RZIP_DEFAULT_CHUNK_SIZE;
    stream->file              = NULL;
+   stream->codec             = RZIP_CODEC_ZLIB;
+   stream->header_size       = RZIP_HEADER_SIZE;
+   stream->num_jobs          = 1;
+   stream->chunk_index       = 0;
    stream->deflate_backend   = NULL;
-   stream->deflate_stream    = NULL;
    stream->inflate_backend   = NULL;
    stream->inflate_stream    = NULL;
    stream->in_buf            = NULL;
@@ -214,6 +458,11 @@ static bool rzipstream_init_stream(
    stream->out_buf_ptr       = 0;
    stream->out_buf_occupancy = 0;
 
+#ifdef HAVE_THREADS
+   /* Compress (or decode ahead) on the shared pool */
+   stream->num_jobs          = rzipstream_pool_jobs;
+#endif
+
    /* Check whether this is a read or write stream */
    stream->is_writing = is_writing;
    if (stream->is_writing)
@@ -221,6 +470,12 @@ static bool rzipstream_init_stream(
       /* Written files are always compressed */
       stream->is_compressed = true;
       file_mode             = RETRO_VFS_FILE_ACCESS_WRITE;
+
+      /* Only files using another codec than zlib
+       * need the version 2 header */
+      stream->codec         = codec;
+      if (codec != RZIP_CODEC_ZLIB)
+         stream->header_size = RZIP_CODEC_HEADER_SIZE;
    }
    /* For read files, must get compression status
     * from file itself... */
@@ -253,15 +508,8 @@ static bool rzipstream_init_stream(
    if (stream->is_writing)
    {
       /* Compression */
-      if (!(stream->deflate_backend = trans_stream_get_zlib_deflate_backend()))
-         return false;
-
-      if (!(stream->deflate_stream = stream->deflate_backend->stream_new()))
-         return false;
-
-      /* Set compression level */
-      if (!stream->deflate_backend->define(
-            stream->deflate_stream, "level", RZIP_COMPRESSION_LEVEL))
+      if (!(stream->deflate_backend = rzipstream_get_backend(
+            stream->codec, true)))
          return false;
 
       /* Buffers
@@ -280,13 +528,23 @@ static bool rzipstream_init_stream(
       if (   (stream->in_buf_size  == 0)
           || (stream->out_buf_size == 0))
          return false;
+
+      /* Buffers and transform stream of the first
+       * chunk; the others are only allocated once
+       * the data needs them */
+      if (!rzipstream_alloc_chunk(stream, &stream->chunks[0]))
+         return false;
+
+      stream->in_buf       = stream->chunks[0].in_buf;
+      return true;
    }
    /* When reading, don't need an inflate transform
     * stream (or buffers) if source file is uncompressed */
    else if (stream->is_compressed)
    {
       /* Decompression */
-      if (!(stream->inflate_backend = trans_stream_get_zlib_inflate_backend()))
+      if (!(stream->inflate_backend = rzipstream_get_backend(
+            stream->codec, false)))
          return false;
 
       if (!(stream->inflate_stream = stream->inflate_backend->stream_new()))
@@ -331,16 +589,32 @@ static bool rzipstream_init_stream(
  * > Also closes associated file, if currently open */
 static int rzipstream_free_stream(rzipstream_t *stream)
 {
+   unsigned i;
    int ret = 0;
 
    if (!stream)
       return -1;
 
+#ifdef HAVE_THREADS
+   /* Wait for any chunk being decoded ahead */
+   rzipstream_wait_jobs(stream);
+
+   if (stream->jobs_cond)
+      scond_free(stream->jobs_cond);
+   if (stream->jobs_lock)
+      slock_free(stream->jobs_lock);
+   stream->jobs_cond = NULL;
+   stream->jobs_lock = NULL;
+
+   if (stream->next_buf)
+      free(stream->next_buf);
+   stream->next_buf = NULL;
+#endif
+
    /* Free transform streams */
-   if (stream->deflate_stream && stream->deflate_backend)
-      stream->deflate_backend->stream_free(stream->deflate_stream);
+   for (i = 0; i < RZIP_MAX_JOBS; i++)
+      rzipstream_free_chunk(&stream->chunks[i]);
 
-   stream->deflate_stream  = NULL;
    stream->deflate_backend = NULL;
 
    if (stream->inflate_stream && stream->inflate_backend)
@@ -349,8 +623,9 @@ static int rzipstream_free_stream(rzipstream_t *stream)
    stream->inflate_stream  = NULL;
    stream->inflate_backend = NULL;
 
-   /* Free buffers */
-   if (stream->in_buf)
+   /* Free buffers
+    * > When writing, in_buf belongs to a chunk */
+   if (stream->in_buf && !stream->is_writing)
       free(stream->in_buf);
    stream->in_buf = NULL;
 
@@ -379,6 +654,19 @@ static int rzipstream_free_stream(rzipstream_t *stream)
  * Returns NULL if arguments are invalid, file
  * is invalid or an IO error occurs */
 rzipstream_t* rzipstream_open(const char *path, unsigned mode)
+{
+   return rzipstream_open_codec(path, mode, RZIP_CODEC_ZLIB);
+}
+
+/* Opens a new or existing RZIP file, writing
+ * chunks compressed with 'codec'
+ * > When reading, 'codec' is ignored: it is
+ *   taken from the file header
+ * Returns NULL if arguments are invalid, file
+ * is invalid, the codec isn't available or an
+ * IO error occurs */
+rzipstream_t* rzipstream_open_codec(const char *path, unsigned mode,
+      enum rzip_codec codec)
 {
    rzipstream_t *stream = NULL;
 
@@ -396,7 +684,7 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
       return NULL;
 
    /* Allocate stream object */
-   if (!(stream = (rzipstream_t*)malloc(sizeof(*stream))))
+   if (!(stream = (rzipstream_t*)calloc(1, sizeof(*stream))))
       return NULL;
 
    stream->is_compressed   = false;
@@ -406,7 +694,6 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    stream->virtual_ptr     = 0;
    stream->file            = NULL;
    stream->deflate_backend = NULL;
-   stream->deflate_stream  = NULL;
    stream->inflate_backend = NULL;
    stream->inflate_stream  = NULL;
    stream->in_buf          = NULL;
@@ -420,7 +707,7 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    /* Initialise stream */
    if (!rzipstream_init_stream(
          stream, path,
-         (mode == RETRO_VFS_FILE_ACCESS_WRITE)))
+         (mode == RETRO_VFS_FILE_ACCESS_WRITE), codec))
    {
       rzipstream_free_stream(stream);
       return NULL;
@@ -432,8 +719,10 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
 /* File Read */
 
 /* Reads and decompresses the next chunk of data
- * in the RZIP file */
-static bool rzipstream_read_chunk(rzipstream_t *stream)
+ * in the RZIP file into 'out_buf', setting its
+ * occupancy */
+static bool rzipstream_decode_chunk(rzipstream_t *stream,
+      uint8_t *out_buf, uint32_t *out_buf_occupancy)
 {
    unsigned i;
    uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
@@ -491,7 +780,7 @@ static bool rzipstream_read_chunk(rzipstream_t *stream)
 
    stream->inflate_backend->set_out(
          stream->inflate_stream,
-         stream->out_buf, stream->out_buf_size);
+         out_buf, stream->out_buf_size);
 
    /* Note: We have to set 'flush == true' here, otherwise we
     * can't guarantee that the entire chunk will be written
@@ -510,10 +799,83 @@ static bool rzipstream_read_chunk(rzipstream_t *stream)
        (inflate_written > stream->out_buf_size))
       return false;
 
-   /* Record current output buffer occupancy
-    * and reset pointer */
-   stream->out_buf_occupancy = inflate_written;
-   stream->out_buf_ptr       = 0;
+   /* Record output buffer occupancy */
+   *out_buf_occupancy = inflate_written;
+
+   return true;
+}
+
+#ifdef HAVE_THREADS
+static void rzipstream_prefetch_chunk(void *data)
+{
+   rzipstream_t *stream = (rzipstream_t*)data;
+   stream->prefetch_ok  = rzipstream_decode_chunk(stream,
+         stream->next_buf, &stream->next_buf_occupancy);
+   rzipstream_job_done(stream);
+}
+
+/* Starts decoding the chunk after the current
+ * one on the shared pool, if there is one
+ * > The pool thread is then the only user of the
+ *   file and inflate stream until the next call
+ *   to rzipstream_wait_prefetch() */
+static void rzipstream_start_prefetch(rzipstream_t *stream)
+{
+   if (     (stream->num_jobs < 2)
+         || (stream->virtual_ptr + stream->out_buf_occupancy
+            >= stream->size))
+      return;
+
+   if (!stream->next_buf)
+      if (!(stream->next_buf = (uint8_t *)malloc(stream->out_buf_size)))
+         return;
+
+   stream->prefetch_pending = rzipstream_add_job(stream,
+         rzipstream_prefetch_chunk, stream);
+}
+
+/* Waits for the chunk being decoded ahead, if any.
+ * Returns false if decoding it failed */
+static bool rzipstream_wait_prefetch(rzipstream_t *stream)
+{
+   if (!stream->prefetch_pending)
+      return true;
+
+   rzipstream_wait_jobs(stream);
+   stream->prefetch_pending = false;
+   return stream->prefetch_ok;
+}
+#endif
+
+/* Makes the next chunk of data the current one,
+ * taking it from the read ahead if possible */
+static bool rzipstream_read_chunk(rzipstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->prefetch_pending)
+   {
+      uint8_t *buf;
+
+      if (!rzipstream_wait_prefetch(stream))
+         return false;
+
+      buf                       = stream->out_buf;
+      stream->out_buf           = stream->next_buf;
+      stream->next_buf          = buf;
+      stream->out_buf_occupancy = stream->next_buf_occupancy;
+   }
+   else
+#endif
+   if (!rzipstream_decode_chunk(stream,
+            stream->out_buf, &stream->out_buf_occupancy))
+      return false;
+
+   /* Reset pointer */
+   stream->out_buf_ptr = 0;
+
+#ifdef HAVE_THREADS
+   rzipstream_start_prefetch(stream);
+#endif
 
    return true;
 }
@@ -716,65 +1078,130 @@ error:
 
 /* File Write */
 
-/* Compresses currently cached data and writes it
- * as the next RZIP file chunk */
-static bool rzipstream_write_chunk(rzipstream_t *stream)
+/* Compresses the data cached in a chunk */
+static void rzipstream_compress_chunk(void *data)
 {
-   unsigned i;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t deflate_read;
-   uint32_t deflate_written;
+   rzipstream_chunk_t *chunk = (rzipstream_chunk_t*)data;
+   uint32_t deflate_read     = 0;
+   uint32_t deflate_written  = 0;
 
-   if (!stream || !stream->deflate_backend || !stream->deflate_stream)
-      return false;
+   chunk->deflate_backend->set_in(
+         chunk->deflate_stream,
+         chunk->in_buf, chunk->in_size);
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Compress data currently held in input buffer */
-   stream->deflate_backend->set_in(
-         stream->deflate_stream,
-         stream->in_buf, stream->in_buf_ptr);
-
-   stream->deflate_backend->set_out(
-         stream->deflate_stream,
-         stream->out_buf, stream->out_buf_size);
+   chunk->deflate_backend->set_out(
+         chunk->deflate_stream,
+         chunk->out_buf, chunk->out_buf_size);
 
    /* Note: We have to set 'flush == true' here, otherwise we
     * can't guarantee that the entire chunk will be written
     * to the output buffer - this is inefficient, but not
     * much we can do... */
-   if (!stream->deflate_backend->trans(
-         stream->deflate_stream, true,
-         &deflate_read, &deflate_written, NULL))
-      return false;
+   chunk->ok       = chunk->deflate_backend->trans(
+         chunk->deflate_stream, true,
+         &deflate_read, &deflate_written, NULL);
 
    /* Error checking */
-   if (deflate_read != stream->in_buf_ptr)
-      return false;
+   if (deflate_read != chunk->in_size)
+      chunk->ok    = false;
 
    if ((deflate_written == 0) ||
-       (deflate_written > stream->out_buf_size))
-      return false;
+       (deflate_written > chunk->out_buf_size))
+      chunk->ok    = false;
 
-   /* Write compressed chunk size to file */
-   chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
-   chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
-   chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
-   chunk_header_bytes[0] =  deflate_written        & 0xFF;
+   chunk->out_size = deflate_written;
+}
 
-   if (filestream_write(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
-      return false;
+#ifdef HAVE_THREADS
+static void rzipstream_compress_chunk_job(void *data)
+{
+   rzipstream_chunk_t *chunk = (rzipstream_chunk_t*)data;
+   rzipstream_compress_chunk(chunk);
+   rzipstream_job_done(chunk->stream);
+}
+#endif
+
+/* Compresses all cached chunks, the one currently
+ * being filled last, and writes them in order as
+ * the next RZIP file chunks
+ * > Each chunk is compressed independently, so
+ *   with threads they are compressed at once */
+static bool rzipstream_write_chunks(rzipstream_t *stream)
+{
+   unsigned i;
+   unsigned num_chunks;
 
-   /* Write compressed data to file */
-   if (filestream_write(
-         stream->file, stream->out_buf, deflate_written) != deflate_written)
+   if (!stream || !stream->deflate_backend)
       return false;
 
+   num_chunks = stream->chunk_index;
+   if (stream->in_buf_ptr > 0)
+      stream->chunks[num_chunks++].in_size = stream->in_buf_ptr;
+
+#ifdef HAVE_THREADS
+   if (num_chunks > 1)
+   {
+      /* The calling thread takes the first chunk */
+      for (i = 1; i < num_chunks; i++)
+         if (!rzipstream_add_job(stream,
+                  rzipstream_compress_chunk_job, &stream->chunks[i]))
+            rzipstream_compress_chunk(&stream->chunks[i]);
+      rzipstream_compress_chunk(&stream->chunks[0]);
+      rzipstream_wait_jobs(stream);
+   }
+   else
+#endif
+   if (num_chunks > 0)
+      rzipstream_compress_chunk(&stream->chunks[0]);
+
+   for (i = 0; i < num_chunks; i++)
+   {
+      rzipstream_chunk_t *chunk = &stream->chunks[i];
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+
+      if (!chunk->ok)
+         return false;
+
+      /* Write compressed chunk size to file */
+      chunk_header_bytes[3] = (chunk->out_size >> 24) & 0xFF;
+      chunk_header_bytes[2] = (chunk->out_size >> 16) & 0xFF;
+      chunk_header_bytes[1] = (chunk->out_size >>  8) & 0xFF;
+      chunk_header_bytes[0] =  chunk->out_size        & 0xFF;
+
+      if (filestream_write(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
+            RZIP_CHUNK_HEADER_SIZE)
+         return false;
+
+      /* Write compressed data to file */
+      if (filestream_write(
+            stream->file, chunk->out_buf, chunk->out_size) != chunk->out_size)
+         return false;
+   }
+
    /* Reset input buffer pointer */
-   stream->in_buf_ptr = 0;
+   stream->chunk_index = 0;
+   stream->in_buf      = stream->chunks[0].in_buf;
+   stream->in_buf_ptr  = 0;
+
+   return true;
+}
+
+/* Moves on to the next chunk once the current one
+ * is full, compressing all cached chunks first if
+ * there's no other one left */
+static bool rzipstream_next_chunk(rzipstream_t *stream)
+{
+   unsigned next = stream->chunk_index + 1;
+
+   if (     (next >= stream->num_jobs)
+         || !rzipstream_alloc_chunk(stream, &stream->chunks[next]))
+      return rzipstream_write_chunks(stream);
+
+   stream->chunks[stream->chunk_index].in_size = stream->in_buf_ptr;
+   stream->chunk_index = next;
+   stream->in_buf      = stream->chunks[next].in_buf;
+   stream->in_buf_ptr  = 0;
 
    return true;
 }
@@ -795,9 +1222,11 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
    {
       int64_t cache_size = 0;
 
-      /* If input buffer is full, compress and write to disk */
+      /* If input buffer is full, move on to the next
+       * chunk (compressing and writing to disk once
+       * there are enough of them) */
       if (stream->in_buf_ptr >= stream->in_buf_size)
-         if (!rzipstream_write_chunk(stream))
+         if (!rzipstream_next_chunk(stream))
             return -1;
 
       /* Get amount of data to cache during this loop
@@ -820,7 +1249,7 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
    }
 
    /* We always write the specified number of bytes
-    * (unless rzipstream_write_chunk() fails, in
+    * (unless rzipstream_write_chunks() fails, in
     * which we register a complete failure...) */
    return len;
 }
@@ -941,12 +1370,14 @@ void rzipstream_rewind(rzipstream_t *stream)
    if (stream->is_writing)
    {
       /* Reset file position to first chunk location */
-      filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
+      filestream_seek(stream->file, stream->header_size, SEEK_SET);
       if (filestream_error(stream->file))
          return;
 
-      /* Reset pointers */
+      /* Reset pointers, dropping any cached chunks */
       stream->virtual_ptr = 0;
+      stream->chunk_index = 0;
+      stream->in_buf      = stream->chunks[0].in_buf;
       stream->in_buf_ptr  = 0;
 
       /* Reset file size */
@@ -969,18 +1400,23 @@ void rzipstream_rewind(rzipstream_t *stream)
          /* It isn't: Have to re-read the first chunk
           * from disk... */
 
+#ifdef HAVE_THREADS
+         /* > Whichever chunk is being decoded
+          *   ahead is no use now */
+         rzipstream_wait_prefetch(stream);
+#endif
+
          /* Reset file position to first chunk location */
-         filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
+         filestream_seek(stream->file, stream->header_size, SEEK_SET);
          if (filestream_error(stream->file))
             return;
 
+         /* Reset pointers */
+         stream->virtual_ptr = 0;
+
          /* Read chunk */
          if (!rzipstream_read_chunk(stream))
             return;
-
-         /* Reset pointers */
-         stream->virtual_ptr = 0;
-         stream->out_buf_ptr = 0;
       }
    }
 }
@@ -1050,8 +1486,8 @@ int rzipstream_close(rzipstream_t *stream)
     * disk and update file header */
    if (stream->is_writing)
    {
-      if (stream->in_buf_ptr > 0)
-         if (!rzipstream_write_chunk(stream))
+      if ((stream->in_buf_ptr > 0) || (stream->chunk_index > 0))
+         if (!rzipstream_write_chunks(stream))
             goto error;
 
       if (!rzipstream_write_file_header(stream))
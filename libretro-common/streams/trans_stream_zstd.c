@@ -0,0 +1,249 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (trans_stream_zstd.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstd.h>
+#include <string/stdstring.h>
+#include <streams/trans_stream.h>
+
+/* Default compression level: zstd's own default,
+ * which compresses about as well as zlib level 6
+ * several times faster */
+#define ZSTD_TRANS_DEFAULT_LEVEL 3
+
+struct zstd_trans_stream
+{
+   ZSTD_CCtx *cctx;
+   ZSTD_DCtx *dctx;
+   ZSTD_inBuffer in;
+   ZSTD_outBuffer out;
+};
+
+static void *zstd_compress_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   if (!(ret->cctx = ZSTD_createCCtx()))
+   {
+      free(ret);
+      return NULL;
+   }
+   ZSTD_CCtx_setParameter(ret->cctx,
+         ZSTD_c_compressionLevel, ZSTD_TRANS_DEFAULT_LEVEL);
+   return (void *)ret;
+}
+
+static void *zstd_decompress_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   if (!(ret->dctx = ZSTD_createDCtx()))
+   {
+      free(ret);
+      return NULL;
+   }
+   return (void *)ret;
+}
+
+static void zstd_compress_stream_free(void *data)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (!z)
+      return;
+   ZSTD_freeCCtx(z->cctx);
+   free(z);
+}
+
+static void zstd_decompress_stream_free(void *data)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (!z)
+      return;
+   ZSTD_freeDCtx(z->dctx);
+   free(z);
+}
+
+static bool zstd_compress_define(void *data, const char *prop, uint32_t val)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (string_is_equal(prop, "level"))
+   {
+      if (z)
+         ZSTD_CCtx_setParameter(z->cctx, ZSTD_c_compressionLevel, (int)val);
+      return true;
+   }
+   return false;
+}
+
+static bool zstd_decompress_define(void *data, const char *prop, uint32_t val)
+{
+   return false;
+}
+
+static void zstd_set_in(void *data, const uint8_t *in, uint32_t in_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->in.src  = in;
+   z->in.size = in_size;
+   z->in.pos  = 0;
+}
+
+static void zstd_set_out(void *data, uint8_t *out, uint32_t out_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->out.dst  = out;
+   z->out.size = out_size;
+   z->out.pos  = 0;
+}
+
+/* Shared tail of both transcodings: reports progress,
+ * and an error if the output buffer filled up with
+ * input left over */
+static bool zstd_trans_result(struct zstd_trans_stream *z,
+      size_t zret, size_t pre_in_pos, size_t pre_out_pos,
+      uint32_t *rd, uint32_t *wn,
+      enum trans_stream_error *error)
+{
+   bool ret = true;
+
+   if (error)
+      *error = (zret == 0)
+         ? TRANS_STREAM_ERROR_NONE
+         : TRANS_STREAM_ERROR_AGAIN;
+
+   if (z->out.pos == z->out.size && z->in.pos != z->in.size)
+   {
+      ret = false;
+      if (error)
+         *error = TRANS_STREAM_ERROR_BUFFER_FULL;
+   }
+
+   *rd = (uint32_t)(z->in.pos  - pre_in_pos);
+   *wn = (uint32_t)(z->out.pos - pre_out_pos);
+
+   return ret;
+}
+
+static bool zstd_compress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *error)
+{
+   size_t zret;
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   size_t pre_in_pos           = z->in.pos;
+   size_t pre_out_pos          = z->out.pos;
+
+   zret = ZSTD_compressStream2(z->cctx, &z->out, &z->in,
+         flush ? ZSTD_e_end : ZSTD_e_continue);
+
+   if (ZSTD_isError(zret))
+   {
+      ZSTD_CCtx_reset(z->cctx, ZSTD_reset_session_only);
+      if (error)
+         *error = TRANS_STREAM_ERROR_OTHER;
+      return false;
+   }
+
+   /* Like a zlib Z_FINISH, a flush that couldn't
+    * complete the frame needs a larger buffer */
+   if (flush && zret != 0)
+   {
+      ZSTD_CCtx_reset(z->cctx, ZSTD_reset_session_only);
+      if (error)
+         *error = TRANS_STREAM_ERROR_BUFFER_FULL;
+      return false;
+   }
+
+   return zstd_trans_result(z, zret, pre_in_pos, pre_out_pos,
+         rd, wn, error);
+}
+
+static bool zstd_decompress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *error)
+{
+   size_t zret;
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   size_t pre_in_pos           = z->in.pos;
+   size_t pre_out_pos          = z->out.pos;
+
+   zret = ZSTD_decompressStream(z->dctx, &z->out, &z->in);
+
+   if (ZSTD_isError(zret))
+   {
+      ZSTD_DCtx_reset(z->dctx, ZSTD_reset_session_only);
+      if (error)
+         *error = TRANS_STREAM_ERROR_OTHER;
+      return false;
+   }
+
+   /* All input consumed on a flush, yet the
+    * frame isn't complete: it was truncated */
+   if (flush && zret != 0 && z->in.pos == z->in.size)
+   {
+      ZSTD_DCtx_reset(z->dctx, ZSTD_reset_session_only);
+      if (error)
+         *error = TRANS_STREAM_ERROR_OTHER;
+      return false;
+   }
+
+   return zstd_trans_result(z, zret, pre_in_pos, pre_out_pos,
+         rd, wn, error);
+}
+
+const struct trans_stream_backend zstd_compress_backend = {
+   "zstd_compress",
+   &zstd_decompress_backend,
+   zstd_compress_stream_new,
+   zstd_compress_stream_free,
+   zstd_compress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_compress_trans
+};
+
+const struct trans_stream_backend zstd_decompress_backend = {
+   "zstd_decompress",
+   &zstd_compress_backend,
+   zstd_decompress_stream_new,
+   zstd_decompress_stream_free,
+   zstd_decompress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_decompress_trans
+};
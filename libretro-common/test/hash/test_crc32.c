@@ -0,0 +1,201 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_crc32.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Included directly to test every implementation,
+ * not just the one picked for this CPU */
+#include "../../encodings/encoding_crc32.c"
+
+#define SUITE_NAME "crc32"
+
+#define MAX_LEN        1024
+#define BENCH_BUF_SIZE (4 * 1024 * 1024)
+#define BENCH_ROUNDS   16
+
+/* Byte-at-a-time reference, as encoding_crc32 used to be */
+static uint32_t reference_crc32(uint32_t crc, const uint8_t *buf, size_t len)
+{
+   size_t i;
+   int j;
+   uint32_t table[256];
+
+   for (i = 0; i < 256; i++)
+   {
+      uint32_t c = (uint32_t)i;
+      for (j = 0; j < 8; j++)
+         c = (c >> 1) ^ ((c & 1) ? 0xedb88320 : 0);
+      table[i] = c;
+   }
+
+   crc = ~crc;
+   while (len--)
+      crc = table[(crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
+   return ~crc;
+}
+
+static uint8_t *random_buffer(size_t len)
+{
+   size_t i;
+   uint8_t *buf = (uint8_t*)malloc(len);
+   srand(1234);
+   for (i = 0; i < len; i++)
+      buf[i] = (uint8_t)rand();
+   return buf;
+}
+
+/* Every length up to MAX_LEN at every alignment,
+ * chained from a non-zero CRC */
+static void check_impl(const char *label,
+      uint32_t (*impl)(uint32_t, const uint8_t*, size_t))
+{
+   size_t len, offset;
+   uint8_t *buf = random_buffer(MAX_LEN + 16);
+
+   for (offset = 0; offset < 16; offset++)
+   {
+      for (len = 0; len <= MAX_LEN; len++)
+      {
+         uint32_t expected = reference_crc32(0xdeadbeef,
+               buf + offset, len);
+         uint32_t actual   = impl
+            ? ~impl(~0xdeadbeefu, buf + offset, len)
+            : encoding_crc32(0xdeadbeef, buf + offset, len);
+         ck_assert_msg(expected == actual,
+               "%s: offset %u, length %u: expected %08x, got %08x",
+               label, (unsigned)offset, (unsigned)len,
+               (unsigned)expected, (unsigned)actual);
+      }
+   }
+
+   free(buf);
+}
+
+static void bench_impl(const char *label,
+      uint32_t (*impl)(uint32_t, const uint8_t*, size_t))
+{
+   unsigned i;
+   clock_t start;
+   double secs;
+   uint32_t crc = 0;
+   uint8_t *buf = random_buffer(BENCH_BUF_SIZE);
+
+   start = clock();
+   for (i = 0; i < BENCH_ROUNDS; i++)
+      crc = impl(crc, buf, BENCH_BUF_SIZE);
+   secs  = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   printf("%-10s %10.1f MB/s (%08x)\n", label,
+         secs > 0 ? (double)BENCH_BUF_SIZE * BENCH_ROUNDS / secs / 1e6 : 0,
+         (unsigned)crc);
+   free(buf);
+}
+
+START_TEST (test_crc32_known)
+{
+   ck_assert_uint_eq(encoding_crc32(0, (const uint8_t*)"", 0), 0);
+   ck_assert_uint_eq(encoding_crc32(0,
+            (const uint8_t*)"123456789", 9), 0xcbf43926);
+   ck_assert_uint_eq(encoding_crc32(encoding_crc32(0,
+            (const uint8_t*)"1234", 4), (const uint8_t*)"56789", 5),
+         0xcbf43926);
+}
+END_TEST
+
+START_TEST (test_crc32_dispatch)
+{
+   check_impl("dispatch", NULL);
+}
+END_TEST
+
+#if !__ARM_FEATURE_CRC32
+START_TEST (test_crc32_slice16)
+{
+   check_impl("slice16", encoding_crc32_slice16);
+}
+END_TEST
+
+#ifdef HAVE_CRC32_PCLMUL
+START_TEST (test_crc32_pclmul)
+{
+   if (!encoding_crc32_has_pclmul())
+      return;
+   check_impl("pclmul", encoding_crc32_pclmul);
+}
+END_TEST
+#endif
+#endif
+
+/* Not a correctness test, prints the throughput
+ * of every implementation this CPU can run */
+START_TEST (test_crc32_throughput)
+{
+   bench_impl("reference", reference_crc32);
+#if !__ARM_FEATURE_CRC32
+   bench_impl("slice16", encoding_crc32_slice16);
+#ifdef HAVE_CRC32_PCLMUL
+   if (encoding_crc32_has_pclmul())
+      bench_impl("pclmul", encoding_crc32_pclmul);
+#endif
+#endif
+   bench_impl("dispatch", encoding_crc32);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core  = tcase_create("Core");
+   TCase *tc_bench = tcase_create("Throughput");
+
+   tcase_add_test(tc_core, test_crc32_known);
+   tcase_add_test(tc_core, test_crc32_dispatch);
+#if !__ARM_FEATURE_CRC32
+   tcase_add_test(tc_core, test_crc32_slice16);
+#ifdef HAVE_CRC32_PCLMUL
+   tcase_add_test(tc_core, test_crc32_pclmul);
+#endif
+#endif
+   suite_add_tcase(s, tc_core);
+
+   tcase_set_timeout(tc_bench, 60);
+   tcase_add_test(tc_bench, test_crc32_throughput);
+   suite_add_tcase(s, tc_bench);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
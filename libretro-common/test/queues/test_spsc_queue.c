@@ -0,0 +1,164 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <queues/spsc_queue.h>
+#include <rthreads/rthreads.h>
+
+#define SUITE_NAME "SPSC Queue"
+
+#define STRESS_BYTES (16 * 1024 * 1024)
+
+START_TEST (test_spsc_queue_create)
+{
+   ck_assert_ptr_null(spsc_queue_new(0));
+   spsc_queue_free(spsc_queue_new(1));
+   spsc_queue_free(NULL);
+}
+END_TEST
+
+START_TEST (test_spsc_queue_capacity)
+{
+   uint8_t buf[200];
+   spsc_queue_t *queue = spsc_queue_new(100);
+
+   memset(buf, 0xaa, sizeof(buf));
+   ck_assert_ptr_nonnull(queue);
+   ck_assert_uint_eq(spsc_queue_write_avail(queue), 100);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 0);
+   ck_assert_uint_eq(spsc_queue_read(queue, buf, sizeof(buf)), 0);
+
+   /* Never holds more than what was asked for,
+    * even though the storage is rounded up */
+   ck_assert_uint_eq(spsc_queue_write(queue, buf, sizeof(buf)), 100);
+   ck_assert_uint_eq(spsc_queue_write_avail(queue), 0);
+   ck_assert_uint_eq(spsc_queue_write(queue, buf, 1), 0);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 100);
+
+   ck_assert_uint_eq(spsc_queue_read(queue, buf, 30), 30);
+   ck_assert_uint_eq(spsc_queue_write_avail(queue), 30);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 70);
+
+   spsc_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_spsc_queue_wrap)
+{
+   unsigned i, round;
+   uint8_t in[37], out[37];
+   uint8_t next_in     = 0;
+   uint8_t next_out    = 0;
+   spsc_queue_t *queue = spsc_queue_new(50);
+
+   /* Odd sizes, so reads and writes keep straddling
+    * the end of the storage */
+   for (round = 0; round < 1000; round++)
+   {
+      size_t written, read;
+
+      for (i = 0; i < sizeof(in); i++)
+         in[i] = next_in + i;
+      written  = spsc_queue_write(queue, in, sizeof(in));
+      next_in += written;
+
+      read     = spsc_queue_read(queue, out, (round % 3) ? 23 : 37);
+      for (i = 0; i < read; i++)
+         ck_assert_uint_eq(out[i], (uint8_t)(next_out + i));
+      next_out += read;
+   }
+
+   spsc_queue_free(queue);
+}
+END_TEST
+
+static void stress_producer(void *data)
+{
+   uint8_t chunk[333];
+   size_t i;
+   size_t sent         = 0;
+   spsc_queue_t *queue = (spsc_queue_t*)data;
+
+   while (sent < STRESS_BYTES)
+   {
+      size_t len = MIN(sizeof(chunk), STRESS_BYTES - sent);
+      for (i = 0; i < len; i++)
+         chunk[i] = (uint8_t)((sent + i) * 7);
+      sent += spsc_queue_write(queue, chunk, len);
+   }
+}
+
+START_TEST (test_spsc_queue_threads)
+{
+   uint8_t chunk[256];
+   size_t i;
+   size_t received     = 0;
+   size_t errors       = 0;
+   spsc_queue_t *queue = spsc_queue_new(4096);
+   sthread_t *producer = sthread_create(stress_producer, queue);
+
+   ck_assert_ptr_nonnull(producer);
+
+   while (received < STRESS_BYTES)
+   {
+      size_t read = spsc_queue_read(queue, chunk, sizeof(chunk));
+      for (i = 0; i < read; i++)
+         if (chunk[i] != (uint8_t)((received + i) * 7))
+            errors++;
+      received   += read;
+   }
+
+   sthread_join(producer);
+   ck_assert_uint_eq(errors, 0);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 0);
+   spsc_queue_free(queue);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_set_timeout(tc_core, 60);
+   tcase_add_test(tc_core, test_spsc_queue_create);
+   tcase_add_test(tc_core, test_spsc_queue_capacity);
+   tcase_add_test(tc_core, test_spsc_queue_wrap);
+   tcase_add_test(tc_core, test_spsc_queue_threads);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,644 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rdb_index.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "libretrodb.h"
+#include "rdb_index.h"
+
+/* "RDBI" */
+#define RDB_INDEX_MAGIC   0x49424452
+#define RDB_INDEX_VERSION 1
+
+enum rdb_index_key
+{
+   RDB_INDEX_KEY_CRC = 0,
+   RDB_INDEX_KEY_SERIAL,
+   RDB_INDEX_KEY_MD5,
+   RDB_INDEX_KEY_COUNT
+};
+
+struct rdb_index
+{
+   rdb_index_entry_t *entries;
+   char *strings;
+   /* Open addressing tables with linear probing.
+    * Slots hold an entry position + 1, 0 marks an empty slot.
+    * Entries are inserted in database order, so probing
+    * returns duplicates in database order too. */
+   uint32_t *tables[RDB_INDEX_KEY_COUNT];
+   size_t count;
+   size_t capacity;
+   size_t strings_size;
+   size_t strings_capacity;
+   size_t mask;
+};
+
+/* Sidecar file layout (native endianness, rebuilt on mismatch):
+ * header, 'count' entries, 'strings_size' bytes of strings */
+typedef struct rdb_index_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t rdb_crc;
+   uint32_t count;
+   uint64_t rdb_size;
+   uint64_t strings_size;
+} rdb_index_header_t;
+
+static uint32_t rdb_index_hash_crc(uint32_t crc)
+{
+   crc ^= crc >> 16;
+   crc *= 0x45d9f3b;
+   crc ^= crc >> 16;
+   return crc;
+}
+
+static uint32_t rdb_index_hash_serial(const char *serial)
+{
+   uint32_t hash = 5381;
+   while (*serial)
+      hash = (hash << 5) + hash + (uint8_t)*serial++;
+   return hash;
+}
+
+static uint32_t rdb_index_hash_md5(const uint8_t *md5)
+{
+   return   (uint32_t)md5[0]
+         | ((uint32_t)md5[1] <<  8)
+         | ((uint32_t)md5[2] << 16)
+         | ((uint32_t)md5[3] << 24);
+}
+
+static bool rdb_index_md5_is_empty(const uint8_t *md5)
+{
+   unsigned i;
+   for (i = 0; i < 16; i++)
+      if (md5[i])
+         return false;
+   return true;
+}
+
+static uint32_t rdb_index_add_string(rdb_index_t *index,
+      const char *s, size_t len)
+{
+   uint32_t offset;
+
+   if (!s || !len)
+      return 0;
+
+   if (index->strings_size + len + 1 > index->strings_capacity)
+   {
+      size_t capacity = index->strings_capacity * 2;
+      char *strings   = NULL;
+
+      while (capacity < index->strings_size + len + 1)
+         capacity    *= 2;
+
+      if (!(strings = (char*)realloc(index->strings, capacity)))
+         return 0;
+
+      index->strings          = strings;
+      index->strings_capacity = capacity;
+   }
+
+   offset = (uint32_t)index->strings_size;
+   memcpy(index->strings + offset, s, len);
+   index->strings[offset + len] = '\0';
+   index->strings_size         += len + 1;
+
+   return offset;
+}
+
+static rdb_index_entry_t *rdb_index_add_entry(rdb_index_t *index)
+{
+   rdb_index_entry_t *entry = NULL;
+
+   if (index->count == index->capacity)
+   {
+      size_t capacity            = index->capacity ? index->capacity * 2 : 1024;
+      rdb_index_entry_t *entries = (rdb_index_entry_t*)
+         realloc(index->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return NULL;
+
+      index->entries  = entries;
+      index->capacity = capacity;
+   }
+
+   entry = &index->entries[index->count++];
+   memset(entry, 0, sizeof(*entry));
+   return entry;
+}
+
+static rdb_index_t *rdb_index_alloc(void)
+{
+   rdb_index_t *index = (rdb_index_t*)calloc(1, sizeof(*index));
+
+   if (!index)
+      return NULL;
+
+   /* Offset 0 is reserved for 'no string' */
+   if (!(index->strings = (char*)malloc(4096)))
+   {
+      free(index);
+      return NULL;
+   }
+
+   index->strings[0]       = '\0';
+   index->strings_size     = 1;
+   index->strings_capacity = 4096;
+
+   return index;
+}
+
+static void rdb_index_insert(rdb_index_t *index,
+      enum rdb_index_key key, uint32_t hash, size_t i)
+{
+   uint32_t *table = index->tables[key];
+
+   while (table[hash & index->mask])
+      hash++;
+
+   table[hash & index->mask] = (uint32_t)(i + 1);
+}
+
+static bool rdb_index_build_tables(rdb_index_t *index)
+{
+   size_t i;
+   unsigned key;
+   size_t size = 16;
+
+   /* Keep the load factor at or below 50% */
+   while (size < index->count * 2)
+      size    <<= 1;
+
+   index->mask = size - 1;
+
+   for (key = 0; key < RDB_INDEX_KEY_COUNT; key++)
+   {
+      free(index->tables[key]);
+      if (!(index->tables[key] = (uint32_t*)calloc(size, sizeof(uint32_t))))
+         return false;
+   }
+
+   for (i = 0; i < index->count; i++)
+   {
+      const rdb_index_entry_t *entry = &index->entries[i];
+
+      if (entry->crc32)
+         rdb_index_insert(index, RDB_INDEX_KEY_CRC,
+               rdb_index_hash_crc(entry->crc32), i);
+      if (entry->serial)
+         rdb_index_insert(index, RDB_INDEX_KEY_SERIAL,
+               rdb_index_hash_serial(index->strings + entry->serial), i);
+      if (!rdb_index_md5_is_empty(entry->md5))
+         rdb_index_insert(index, RDB_INDEX_KEY_MD5,
+               rdb_index_hash_md5(entry->md5), i);
+   }
+
+   return true;
+}
+
+static bool rdb_index_file_checksum(const char *path,
+      uint64_t *size, uint32_t *crc)
+{
+   int64_t len;
+   uint8_t *buf = NULL;
+   RFILE *fd    = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+      return false;
+
+   if (!(buf = (uint8_t*)malloc(64 * 1024)))
+   {
+      filestream_close(fd);
+      return false;
+   }
+
+   *size = 0;
+   *crc  = 0;
+
+   while ((len = filestream_read(fd, buf, 64 * 1024)) > 0)
+   {
+      *crc   = encoding_crc32(*crc, buf, (size_t)len);
+      *size += (uint64_t)len;
+   }
+
+   free(buf);
+   filestream_close(fd);
+   return true;
+}
+
+static bool rdb_index_read_rdb(rdb_index_t *index, const char *rdb_path)
+{
+   struct rmsgpack_dom_value item;
+   bool ret                 = false;
+   libretrodb_t *db         = libretrodb_new();
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+   if (!db || !cur)
+      goto end;
+
+   if (libretrodb_open(rdb_path, db, false) != 0)
+      goto end;
+
+   if (libretrodb_cursor_open(db, cur, NULL) != 0)
+      goto end;
+
+   while (libretrodb_cursor_read_item(cur, &item) == 0)
+   {
+      unsigned i;
+      rdb_index_entry_t *entry = NULL;
+
+      if (item.type != RDT_MAP)
+      {
+         rmsgpack_dom_value_free(&item);
+         continue;
+      }
+
+      if (!(entry = rdb_index_add_entry(index)))
+      {
+         rmsgpack_dom_value_free(&item);
+         goto end;
+      }
+
+      for (i = 0; i < item.val.map.len; i++)
+      {
+         struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
+         struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
+         const char *str                = key->val.string.buff;
+
+         if (key->type != RDT_STRING || !str)
+            continue;
+
+         if (string_is_equal(str, "crc"))
+         {
+            if (val->type != RDT_BINARY)
+               continue;
+            switch (val->val.binary.len)
+            {
+               case 1:
+                  entry->crc32 = *(uint8_t*)val->val.binary.buff;
+                  break;
+               case 2:
+                  entry->crc32 = swap_if_little16(
+                        *(uint16_t*)val->val.binary.buff);
+                  break;
+               case 4:
+                  entry->crc32 = swap_if_little32(
+                        *(uint32_t*)val->val.binary.buff);
+                  break;
+               default:
+                  break;
+            }
+         }
+         else if (string_is_equal(str, "name"))
+         {
+            if (val->type == RDT_STRING)
+               entry->name   = rdb_index_add_string(index,
+                     val->val.string.buff, val->val.string.len);
+         }
+         else if (string_is_equal(str, "serial"))
+         {
+            /* Serials are stored as strings or binary blobs */
+            if (val->type == RDT_STRING || val->type == RDT_BINARY)
+            {
+               const char *serial = val->val.string.buff;
+               size_t len         = 0;
+               while (len < val->val.string.len && serial[len])
+                  len++;
+               entry->serial      = rdb_index_add_string(index, serial, len);
+            }
+         }
+         else if (string_is_equal(str, "md5"))
+         {
+            if (val->type == RDT_BINARY && val->val.binary.len == 16)
+               memcpy(entry->md5, val->val.binary.buff, 16);
+         }
+      }
+
+      rmsgpack_dom_value_free(&item);
+   }
+
+   ret = true;
+
+end:
+   if (cur)
+   {
+      libretrodb_cursor_close(cur);
+      libretrodb_cursor_free(cur);
+   }
+   if (db)
+   {
+      libretrodb_close(db);
+      libretrodb_free(db);
+   }
+   return ret;
+}
+
+static bool rdb_index_load_file(rdb_index_t *index, const char *path,
+      uint64_t rdb_size, uint32_t rdb_crc)
+{
+   rdb_index_header_t header;
+   size_t entries_size;
+   bool ret  = false;
+   RFILE *fd = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+      return false;
+
+   if (filestream_read(fd, &header, sizeof(header)) != sizeof(header))
+      goto end;
+
+   if (     header.magic    != RDB_INDEX_MAGIC
+         || header.version  != RDB_INDEX_VERSION
+         || header.rdb_size != rdb_size
+         || header.rdb_crc  != rdb_crc
+         || header.strings_size < 1
+         || header.strings_size > UINT32_MAX)
+      goto end;
+
+   entries_size = header.count * sizeof(rdb_index_entry_t);
+
+   if (filestream_get_size(fd) != (int64_t)(sizeof(header)
+            + entries_size + header.strings_size))
+      goto end;
+
+   free(index->entries);
+   free(index->strings);
+   index->entries          = (rdb_index_entry_t*)malloc(
+         entries_size ? entries_size : 1);
+   index->strings          = (char*)malloc((size_t)header.strings_size);
+   index->count            = 0;
+   index->capacity         = 0;
+   index->strings_size     = 0;
+   index->strings_capacity = 0;
+
+   if (!index->entries || !index->strings)
+      goto end;
+
+   if (filestream_read(fd, index->entries, entries_size)
+         != (int64_t)entries_size)
+      goto end;
+   if (filestream_read(fd, index->strings, header.strings_size)
+         != (int64_t)header.strings_size)
+      goto end;
+
+   index->count            = header.count;
+   index->capacity         = header.count;
+   index->strings_size     = (size_t)header.strings_size;
+   index->strings_capacity = (size_t)header.strings_size;
+
+   /* Reject string offsets pointing outside of the pool */
+   if (index->strings[index->strings_size - 1] != '\0')
+      goto end;
+   {
+      size_t i;
+      for (i = 0; i < index->count; i++)
+      {
+         if (     index->entries[i].name   >= index->strings_size
+               || index->entries[i].serial >= index->strings_size)
+            goto end;
+      }
+   }
+
+   ret = true;
+
+end:
+   filestream_close(fd);
+   return ret;
+}
+
+static void rdb_index_save_file(const rdb_index_t *index, const char *path,
+      uint64_t rdb_size, uint32_t rdb_crc)
+{
+   rdb_index_header_t header;
+   bool ok   = true;
+   RFILE *fd = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   /* Database directory may well be read-only */
+   if (!fd)
+      return;
+
+   header.magic        = RDB_INDEX_MAGIC;
+   header.version      = RDB_INDEX_VERSION;
+   header.rdb_crc      = rdb_crc;
+   header.count        = (uint32_t)index->count;
+   header.rdb_size     = rdb_size;
+   header.strings_size = index->strings_size;
+
+   if (filestream_write(fd, &header, sizeof(header)) != sizeof(header))
+      ok = false;
+   else if (filestream_write(fd, index->entries,
+            index->count * sizeof(rdb_index_entry_t))
+         != (int64_t)(index->count * sizeof(rdb_index_entry_t)))
+      ok = false;
+   else if (filestream_write(fd, index->strings, index->strings_size)
+         != (int64_t)index->strings_size)
+      ok = false;
+
+   filestream_close(fd);
+
+   if (!ok)
+      filestream_delete(path);
+}
+
+rdb_index_t *rdb_index_new(const char *rdb_path, bool persist)
+{
+   char idx_path[PATH_MAX_LENGTH];
+   uint64_t rdb_size  = 0;
+   uint32_t rdb_crc   = 0;
+   bool loaded        = false;
+   rdb_index_t *index = NULL;
+
+   if (string_is_empty(rdb_path))
+      return NULL;
+
+   if (!(index = rdb_index_alloc()))
+      return NULL;
+
+   idx_path[0] = '\0';
+
+   if (persist)
+   {
+      fill_pathname(idx_path, rdb_path, ".idx", sizeof(idx_path));
+
+      if (     rdb_index_file_checksum(rdb_path, &rdb_size, &rdb_crc)
+            && path_is_valid(idx_path))
+      {
+         if (!(loaded = rdb_index_load_file(index, idx_path,
+                     rdb_size, rdb_crc)))
+         {
+            /* Stale or corrupt - start over */
+            rdb_index_free(index);
+            if (!(index = rdb_index_alloc()))
+               return NULL;
+         }
+      }
+   }
+
+   if (!loaded)
+   {
+      if (!rdb_index_read_rdb(index, rdb_path))
+      {
+         rdb_index_free(index);
+         return NULL;
+      }
+
+      if (persist && rdb_size)
+         rdb_index_save_file(index, idx_path, rdb_size, rdb_crc);
+   }
+
+   if (!rdb_index_build_tables(index))
+   {
+      rdb_index_free(index);
+      return NULL;
+   }
+
+   return index;
+}
+
+void rdb_index_free(rdb_index_t *index)
+{
+   unsigned key;
+
+   if (!index)
+      return;
+
+   for (key = 0; key < RDB_INDEX_KEY_COUNT; key++)
+      free(index->tables[key]);
+   free(index->entries);
+   free(index->strings);
+   free(index);
+}
+
+size_t rdb_index_count(const rdb_index_t *index)
+{
+   return index ? index->count : 0;
+}
+
+static bool rdb_index_entry_matches(const rdb_index_t *index,
+      const rdb_index_entry_t *entry, enum rdb_index_key key,
+      const void *value)
+{
+   switch (key)
+   {
+      case RDB_INDEX_KEY_CRC:
+         return entry->crc32 == *(const uint32_t*)value;
+      case RDB_INDEX_KEY_SERIAL:
+         return entry->serial && string_is_equal(
+               index->strings + entry->serial, (const char*)value);
+      case RDB_INDEX_KEY_MD5:
+         return !memcmp(entry->md5, value, 16);
+      default:
+         break;
+   }
+
+   return false;
+}
+
+static int64_t rdb_index_find(const rdb_index_t *index,
+      enum rdb_index_key key, uint32_t hash, const void *value,
+      size_t *pos)
+{
+   const uint32_t *table = NULL;
+
+   if (!index || !(table = index->tables[key]))
+      return -1;
+
+   while (*pos <= index->mask)
+   {
+      uint32_t slot = table[(hash + *pos) & index->mask];
+
+      if (!slot)
+         break;
+
+      (*pos)++;
+
+      if (rdb_index_entry_matches(index,
+               &index->entries[slot - 1], key, value))
+         return slot - 1;
+   }
+
+   *pos = index->mask + 1;
+   return -1;
+}
+
+int64_t rdb_index_find_crc(const rdb_index_t *index,
+      uint32_t crc, size_t *pos)
+{
+   if (!crc)
+      return -1;
+   return rdb_index_find(index, RDB_INDEX_KEY_CRC,
+         rdb_index_hash_crc(crc), &crc, pos);
+}
+
+int64_t rdb_index_find_serial(const rdb_index_t *index,
+      const char *serial, size_t *pos)
+{
+   if (string_is_empty(serial))
+      return -1;
+   return rdb_index_find(index, RDB_INDEX_KEY_SERIAL,
+         rdb_index_hash_serial(serial), serial, pos);
+}
+
+int64_t rdb_index_find_md5(const rdb_index_t *index,
+      const uint8_t *md5, size_t *pos)
+{
+   if (!md5 || rdb_index_md5_is_empty(md5))
+      return -1;
+   return rdb_index_find(index, RDB_INDEX_KEY_MD5,
+         rdb_index_hash_md5(md5), md5, pos);
+}
+
+const rdb_index_entry_t *rdb_index_get_entry(const rdb_index_t *index,
+      size_t i)
+{
+   if (!index || i >= index->count)
+      return NULL;
+   return &index->entries[i];
+}
+
+const char *rdb_index_get_string(const rdb_index_t *index,
+      uint32_t offset)
+{
+   if (!index || !offset || offset >= index->strings_size)
+      return NULL;
+   return index->strings + offset;
+}
@@ -0,0 +1,103 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rdb_index.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __RDB_INDEX_H__
+#define __RDB_INDEX_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* In-memory lookup table over the crc, serial and md5
+ * fields of a libretro database.
+ *
+ * Built once per database (or loaded from a sidecar file
+ * written next to the .rdb) so that content scanners can
+ * match files in constant time instead of running a query
+ * over the whole database for every file. */
+
+typedef struct rdb_index_entry
+{
+   uint32_t crc32;
+   uint32_t name;   /* Offset into the string pool, 0 if none */
+   uint32_t serial; /* Offset into the string pool, 0 if none */
+   uint8_t  md5[16];
+} rdb_index_entry_t;
+
+typedef struct rdb_index rdb_index_t;
+
+/**
+ * rdb_index_new:
+ * @rdb_path            : Path to the .rdb file.
+ * @persist             : Whether to load/store the index from/to
+ *                        a sidecar file next to @rdb_path.
+ *
+ * Loads the index of @rdb_path from its sidecar file if it
+ * is still valid, otherwise builds it by reading the database
+ * (and writes a new sidecar file if @persist is set).
+ *
+ * Returns: the index, or NULL on error.
+ **/
+rdb_index_t *rdb_index_new(const char *rdb_path, bool persist);
+
+void rdb_index_free(rdb_index_t *index);
+
+size_t rdb_index_count(const rdb_index_t *index);
+
+/**
+ * rdb_index_find_crc:
+ * @index               : The index.
+ * @crc                 : CRC32 to look for.
+ * @pos                 : Iteration state, must be set to 0
+ *                        before the first call.
+ *
+ * Returns the next entry whose crc matches @crc, in database order.
+ *
+ * Returns: position of the entry in the database, or -1 when
+ * there are no more matches.
+ **/
+int64_t rdb_index_find_crc(const rdb_index_t *index,
+      uint32_t crc, size_t *pos);
+
+/* Same as rdb_index_find_crc(), matching the serial field */
+int64_t rdb_index_find_serial(const rdb_index_t *index,
+      const char *serial, size_t *pos);
+
+/* Same as rdb_index_find_crc(), matching the (binary) md5 field */
+int64_t rdb_index_find_md5(const rdb_index_t *index,
+      const uint8_t *md5, size_t *pos);
+
+const rdb_index_entry_t *rdb_index_get_entry(const rdb_index_t *index,
+      size_t i);
+
+/* Returns the string stored at @offset in the string pool,
+ * or NULL if @offset is 0 */
+const char *rdb_index_get_string(const rdb_index_t *index,
+      uint32_t offset);
+
+RETRO_END_DECLS
+
+#endif
@@ -0,0 +1,302 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rdb_index_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Compares CRC matching through rdb_index against running
+ * a query over the database for every scanned file, which
+ * is what the content scanner used to do.
+ *
+ * Usage: rdb_index_bench <database.rdb> [entries] [files]
+ *
+ * If <database.rdb> does not exist, a synthetic database with
+ * [entries] games (default 50000) is written there first.
+ * [files] (default 20000) CRCs are then looked up, half of
+ * them present in the database. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <file/file_path.h>
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+
+#include "libretrodb.h"
+#include "rdb_index.h"
+#include "rmsgpack_dom.h"
+
+/* Files looked up through database queries,
+ * the rest of the timing is extrapolated */
+#define LEGACY_FILES 200
+
+typedef struct
+{
+   unsigned count;
+   unsigned total;
+} synth_state_t;
+
+static uint32_t bench_rand_state = 0x12345678;
+
+static uint32_t bench_rand(void)
+{
+   /* xorshift32 */
+   bench_rand_state ^= bench_rand_state << 13;
+   bench_rand_state ^= bench_rand_state >> 17;
+   bench_rand_state ^= bench_rand_state << 5;
+   return bench_rand_state;
+}
+
+static double bench_seconds(clock_t start)
+{
+   return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void synth_set_string(struct rmsgpack_dom_value *key,
+      struct rmsgpack_dom_value *value, const char *k, const char *v)
+{
+   key->type                = RDT_STRING;
+   key->val.string.len      = (uint32_t)strlen(k);
+   key->val.string.buff     = strdup(k);
+   value->type              = RDT_STRING;
+   value->val.string.len    = (uint32_t)strlen(v);
+   value->val.string.buff   = strdup(v);
+}
+
+static void synth_set_binary(struct rmsgpack_dom_value *key,
+      struct rmsgpack_dom_value *value, const char *k,
+      const void *data, uint32_t len)
+{
+   key->type                = RDT_STRING;
+   key->val.string.len      = (uint32_t)strlen(k);
+   key->val.string.buff     = strdup(k);
+   value->type              = RDT_BINARY;
+   value->val.binary.len    = len;
+   value->val.binary.buff   = (char*)malloc(len);
+   memcpy(value->val.binary.buff, data, len);
+}
+
+/* All synthetic CRCs are odd, so even ones are always misses */
+static uint32_t synth_crc(unsigned i)
+{
+   return (uint32_t)(i * 2654435761u) | 1;
+}
+
+static int synth_value_provider(void *ctx, struct rmsgpack_dom_value *out)
+{
+   char buf[64];
+   unsigned i;
+   uint8_t md5[16];
+   uint32_t crc;
+   synth_state_t *state = (synth_state_t*)ctx;
+
+   if (state->count >= state->total)
+      return 1;
+
+   crc                  = swap_if_little32(synth_crc(state->count));
+   for (i = 0; i < sizeof(md5); i++)
+      md5[i]            = (uint8_t)bench_rand();
+
+   out->type            = RDT_MAP;
+   out->val.map.len     = 4;
+   out->val.map.items   = (struct rmsgpack_dom_pair*)
+      calloc(4, sizeof(struct rmsgpack_dom_pair));
+
+   snprintf(buf, sizeof(buf), "Synthetic Game %u (World)", state->count);
+   synth_set_string(&out->val.map.items[0].key,
+         &out->val.map.items[0].value, "name", buf);
+   snprintf(buf, sizeof(buf), "SYN-%05u", state->count);
+   synth_set_string(&out->val.map.items[1].key,
+         &out->val.map.items[1].value, "serial", buf);
+   synth_set_binary(&out->val.map.items[2].key,
+         &out->val.map.items[2].value, "crc", &crc, sizeof(crc));
+   synth_set_binary(&out->val.map.items[3].key,
+         &out->val.map.items[3].value, "md5", md5, sizeof(md5));
+
+   state->count++;
+   return 0;
+}
+
+static bool synth_create(const char *path, unsigned entries)
+{
+   synth_state_t state;
+   RFILE *fd = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+      return false;
+
+   state.count = 0;
+   state.total = entries;
+   libretrodb_create(fd, synth_value_provider, &state);
+   filestream_close(fd);
+   return true;
+}
+
+/* Same query the scanner used to run for every file
+ * against every database, see database_info_list_new() */
+static int64_t legacy_find_crc(const char *path, uint32_t crc)
+{
+   char query[50];
+   struct rmsgpack_dom_value item;
+   const char *error        = NULL;
+   int64_t found            = -1;
+   libretrodb_query_t *q    = NULL;
+   libretrodb_t *db         = libretrodb_new();
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+   snprintf(query, sizeof(query),
+         "{crc:or(b\"%08lX\",b\"%08lX\")}",
+         (unsigned long)crc, (unsigned long)0);
+
+   if (libretrodb_open(path, db, false) != 0)
+      goto end;
+
+   q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
+         strlen(query), &error);
+   if (error || libretrodb_cursor_open(db, cur, q) != 0)
+      goto end;
+
+   while (libretrodb_cursor_read_item(cur, &item) == 0)
+   {
+      if (found < 0)
+         found = 0;
+      rmsgpack_dom_value_free(&item);
+   }
+
+end:
+   if (q)
+      libretrodb_query_free(q);
+   libretrodb_cursor_close(cur);
+   libretrodb_cursor_free(cur);
+   libretrodb_close(db);
+   libretrodb_free(db);
+   return found;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   clock_t start;
+   double cold, warm, lookup, legacy;
+   char idx_path[PATH_MAX_LENGTH];
+   unsigned legacy_files;
+   unsigned hits         = 0;
+   unsigned mismatches   = 0;
+   uint32_t *crcs        = NULL;
+   rdb_index_t *index    = NULL;
+   const char *rdb_path  = NULL;
+   unsigned entries      = 50000;
+   unsigned files        = 20000;
+
+   if (argc < 2)
+   {
+      printf("Usage: %s <database.rdb> [entries] [files]\n", argv[0]);
+      return 1;
+   }
+
+   rdb_path = argv[1];
+   if (argc > 2)
+      entries = (unsigned)strtoul(argv[2], NULL, 10);
+   if (argc > 3)
+      files   = (unsigned)strtoul(argv[3], NULL, 10);
+   if (!entries || !files)
+      return 1;
+
+   if (!path_is_valid(rdb_path))
+   {
+      printf("Writing synthetic database with %u entries...\n", entries);
+      if (!synth_create(rdb_path, entries))
+      {
+         printf("Could not create '%s'\n", rdb_path);
+         return 1;
+      }
+   }
+
+   fill_pathname(idx_path, rdb_path, ".idx", sizeof(idx_path));
+   filestream_delete(idx_path);
+
+   start = clock();
+   index = rdb_index_new(rdb_path, false);
+   cold  = bench_seconds(start);
+   if (!index || !rdb_index_count(index))
+   {
+      printf("Could not index '%s'\n", rdb_path);
+      return 1;
+   }
+   rdb_index_free(index);
+
+   /* Writes the sidecar file */
+   rdb_index_free(rdb_index_new(rdb_path, true));
+
+   start = clock();
+   index = rdb_index_new(rdb_path, true);
+   warm  = bench_seconds(start);
+
+   /* Half hits sampled from the database, half misses */
+   crcs  = (uint32_t*)malloc(files * sizeof(*crcs));
+   for (i = 0; i < files; i++)
+   {
+      const rdb_index_entry_t *entry = rdb_index_get_entry(index,
+            bench_rand() % rdb_index_count(index));
+      crcs[i] = (i & 1) ? bench_rand() & ~1u : entry->crc32;
+   }
+
+   start = clock();
+   for (i = 0; i < files; i++)
+   {
+      size_t pos = 0;
+      if (rdb_index_find_crc(index, crcs[i], &pos) >= 0)
+         hits++;
+   }
+   lookup = bench_seconds(start);
+
+   legacy_files = (files < LEGACY_FILES) ? files : LEGACY_FILES;
+   start        = clock();
+   for (i = 0; i < legacy_files; i++)
+   {
+      size_t pos = 0;
+      bool found = legacy_find_crc(rdb_path, crcs[i]) >= 0;
+      if (found != (rdb_index_find_crc(index, crcs[i], &pos) >= 0))
+         mismatches++;
+   }
+   legacy = bench_seconds(start) / legacy_files * files;
+
+   printf("Database: %s (%u entries)\n", rdb_path,
+         (unsigned)rdb_index_count(index));
+   printf("Index build (cold):      %10.3f ms\n", cold * 1000.0);
+   printf("Index load (sidecar):    %10.3f ms\n", warm * 1000.0);
+   printf("Lookup of %u files:   %10.3f ms (%u hits)\n",
+         files, lookup * 1000.0, hits);
+   printf("Query of %u files:    %10.3f ms (extrapolated from %u)\n",
+         files, legacy * 1000.0, legacy_files);
+   printf("Speedup (cold):          %10.1fx\n",
+         legacy / (cold + lookup));
+   if (mismatches)
+      printf("MISMATCH: %u lookups disagree with the query results\n",
+            mismatches);
+
+   free(crcs);
+   rdb_index_free(index);
+   return mismatches ? 1 : 0;
+}
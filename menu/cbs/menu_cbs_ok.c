@@ -2655,6 +2655,7 @@ static int action_ok_playlist_entry_collection(const char *path,
    playlist_config.old_format             = settings->bools.playlist_use_old_format;
    playlist_config.compress               = settings->bools.playlist_compression;
    playlist_config.fuzzy_archive_match    = settings->bools.playlist_fuzzy_archive_match;
+   playlist_config.binary_cache           = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 
    content_path[0]  = '\0';
@@ -8012,6 +8013,7 @@ static int action_ok_manual_content_scan_start(const char *path,
    playlist_config.old_format          = settings->bools.playlist_use_old_format;
    playlist_config.compress            = settings->bools.playlist_compression;
    playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+   playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&playlist_config,
          settings->bools.playlist_portable_paths ?
                settings->paths.directory_menu_content : NULL);
@@ -8397,6 +8399,7 @@ static int action_ok_delete_playlist(const char *path,
    path = playlist_get_conf_path(playlist);
 
    filestream_delete(path);
+   playlist_delete_cache_file(path);
 
    if (menu_st->driver_ctx->environ_cb)
       menu_st->driver_ctx->environ_cb(MENU_ENVIRON_RESET_HORIZONTAL_LIST,
@@ -8421,6 +8424,7 @@ static int action_ok_pl_content_thumbnails(const char *path,
       playlist_config.old_format          = settings->bools.playlist_use_old_format;
       playlist_config.compress            = settings->bools.playlist_compression;
       playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+      playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
 
       if (!string_is_empty(path_dir_playlist))
       {
@@ -8602,6 +8606,7 @@ static int action_ok_playlist_refresh(const char *path,
    playlist_config->old_format          = settings->bools.playlist_use_old_format;
    playlist_config->compress            = settings->bools.playlist_compression;
    playlist_config->fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+   playlist_config->binary_cache        = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(playlist_config,
          settings->bools.playlist_portable_paths ?
                settings->paths.directory_menu_content : NULL);
@@ -473,6 +473,8 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
    libretro_vfs_implementation_dir *dir           = NULL;
+   settings_t *settings                           = config_get_ptr();
+   bool binary_cache                              = settings->bools.playlist_binary_cache;
 
    explore_state_t *state = (explore_state_t*)calloc(1, sizeof(*state));
 
@@ -499,6 +501,7 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       playlist_config.compress                  = false;
       playlist_config.fuzzy_archive_match       = false;
       playlist_config.autofix_paths             = false;
+      playlist_config.binary_cache              = binary_cache;
 
       if (!retro_vfs_readdir_impl(dir))
       {
@@ -8666,6 +8666,9 @@ static void general_write_handler(rarch_setting_t *setting)
          }
          retroarch_override_setting_unset(RARCH_OVERRIDE_SETTING_LOG_TO_FILE, NULL);
          break;
+      case MENU_ENUM_LABEL_LOG_ASYNC:
+         verbosity_set_async(settings->bools.log_async);
+         break;
       case MENU_ENUM_LABEL_LOG_DIR:
       case MENU_ENUM_LABEL_LOG_TO_FILE_TIMESTAMP:
          if (verbosity_is_enabled() && is_logging_to_file())
@@ -11448,6 +11451,23 @@ static bool setting_append_list(
                   general_read_handler,
                   SD_FLAG_NONE);
 
+#ifdef HAVE_THREADS
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.log_async,
+                  MENU_ENUM_LABEL_LOG_ASYNC,
+                  MENU_ENUM_LABEL_VALUE_LOG_ASYNC,
+                  DEFAULT_LOG_ASYNC,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+
             END_SUB_GROUP(list, list_info, parent_group);
 
             START_SUB_GROUP(list, list_info, "Performance Counters", &group_info, &subgroup_info,
@@ -11747,6 +11767,23 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_NONE);
+
+#ifdef HAVE_ZSTD
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.savestate_file_compression_zstd,
+                  MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION_ZSTD,
+                  MENU_ENUM_LABEL_VALUE_SAVESTATE_FILE_COMPRESSION_ZSTD,
+                  DEFAULT_SAVESTATE_FILE_COMPRESSION_ZSTD,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
 #endif
 
             /* TODO/FIXME: This is in the wrong group... */
@@ -12034,6 +12071,21 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_compress_history,
+                  MENU_ENUM_LABEL_REWIND_COMPRESS_HISTORY,
+                  MENU_ENUM_LABEL_VALUE_REWIND_COMPRESS_HISTORY,
+                  DEFAULT_REWIND_COMPRESS_HISTORY,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -21578,6 +21630,22 @@ static bool setting_append_list(
                );
 #endif
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.playlist_binary_cache,
+               MENU_ENUM_LABEL_PLAYLIST_BINARY_CACHE,
+               MENU_ENUM_LABEL_VALUE_PLAYLIST_BINARY_CACHE,
+               DEFAULT_PLAYLIST_BINARY_CACHE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.playlist_show_sublabels,
@@ -22926,6 +22994,22 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_NONE);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.network_concurrent_thumbnail_downloads,
+                  MENU_ENUM_LABEL_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS,
+                  MENU_ENUM_LABEL_VALUE_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS,
+                  DEFAULT_NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].ui_type   = ST_UI_TYPE_UINT_COMBOBOX;
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            (*list)[list_info->index - 1].offset_by = 1;
+            menu_settings_list_current_add_range(list, list_info, (*list)[list_info->index - 1].offset_by, 8, 1, true, true);
 #endif
          }
          END_SUB_GROUP(list, list_info, parent_group);
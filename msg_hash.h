@@ -2358,6 +2358,7 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_COMPRESS_HISTORY),
    /* TODO/FIXME: INPUT_META_REWIND is incorrectly defined;
     * the LABEL/SUBLABEL enums should be entered 'manually',
     * like all the other hotkeys. Moreover, the resultant
@@ -2446,6 +2447,7 @@ enum msg_hash_enums
    MENU_LABEL(SAVESTATE_THUMBNAIL_ENABLE),
    MENU_LABEL(SAVE_FILE_COMPRESSION),
    MENU_LABEL(SAVESTATE_FILE_COMPRESSION),
+   MENU_LABEL(SAVESTATE_FILE_COMPRESSION_ZSTD),
 
    MENU_LBL_H(SUSPEND_SCREENSAVER_ENABLE),
    MENU_ENUM_LABEL_VOLUME_UP,
@@ -2458,6 +2460,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_LOG_VERBOSITY_ERROR,
    MENU_LABEL(LOG_TO_FILE),
    MENU_LABEL(LOG_TO_FILE_TIMESTAMP),
+   MENU_LABEL(LOG_ASYNC),
 
    MENU_ENUM_LABEL_OVERLAY_NEXT,
 
@@ -2973,6 +2976,7 @@ enum msg_hash_enums
    MENU_LABEL(NETWORK_REMOTE_ENABLE),
    MENU_LABEL(NETWORK_REMOTE_PORT),
    MENU_LABEL(NETWORK_ON_DEMAND_THUMBNAILS),
+   MENU_LABEL(NETWORK_CONCURRENT_THUMBNAIL_DOWNLOADS),
 
    MENU_ENUM_LABEL_NETWORK_REMOTE_USER_1_ENABLE,
 
@@ -4104,6 +4108,7 @@ enum msg_hash_enums
 
    MENU_LABEL(PLAYLIST_USE_OLD_FORMAT),
    MENU_LABEL(PLAYLIST_COMPRESSION),
+   MENU_LABEL(PLAYLIST_BINARY_CACHE),
    MENU_LABEL(MENU_SOUNDS),
    MENU_LABEL(MENU_SOUND_OK),
    MENU_LABEL(MENU_SOUND_CANCEL),
@@ -91,13 +91,20 @@ void logger_send(const char *__format,...)
 void logger_send_v(const char *__format, va_list args)
 {
    static char sendbuf[4096];
-   int len;
+
+   /* With asynchronous logging, the writer thread
+    * sends the message through logger_write() */
+   if (verbosity_async_log_v(NULL, __format, args))
+      return;
 
    vsnprintf(sendbuf,4000,__format, args);
-   len = strlen(sendbuf);
+   logger_write(sendbuf, strlen(sendbuf));
+}
 
+void logger_write(const char *buf, size_t len)
+{
    sendto(g_sid,
-         sendbuf,
+         buf,
          len,
          MSG_DONTWAIT,
          (struct sockaddr*)&target,
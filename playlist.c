@@ -19,17 +19,32 @@
 #include <string.h>
 #include <ctype.h>
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <time.h>
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <memmap.h>
+#endif
+
 #include <libretro.h>
 #include <boolean.h>
 #include <retro_miscellaneous.h>
+#include <retro_endianness.h>
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
 #include <file/file_path.h>
 #include <file/archive_file.h>
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -61,6 +76,17 @@ typedef struct
    bool overwrite_playlist;
 } playlist_manual_scan_record_t;
 
+/* Number of entries each path hash can match,
+ * see playlist_path_matches_entry() */
+typedef struct
+{
+   /* One of the entries with this real path hash, if known */
+   const playlist_path_id_t *path_id;
+   unsigned paths;           /* Real path */
+   unsigned archives;        /* Archive file itself */
+   unsigned archive_members; /* File inside the archive */
+} playlist_path_index_t;
+
 struct content_playlist
 {
    char *default_core_path;
@@ -68,6 +94,16 @@ struct content_playlist
    char *base_content_directory;
 
    struct playlist_entry *entries;
+   /* Hashmap of playlist_path_index_t, keyed by path hash.
+    * Only tells whether a path may be in the playlist,
+    * so that adding new content does not need a full scan */
+   playlist_path_index_t *path_index;
+   size_t path_index_empty;   /* Entries without a path */
+   size_t bulk_start;         /* First entry added in bulk */
+   /* Binary cache the entries were read from,
+    * their strings point into it */
+   void *cache_data;
+   size_t cache_size;
 
    playlist_manual_scan_record_t scan_record; /* ptr alignment */
    playlist_config_t config;                  /* size_t alignment */
@@ -82,6 +118,9 @@ struct content_playlist
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool path_index_built;
+   bool bulk_push;
+   bool cache_mapped;
 };
 
 typedef struct
@@ -173,6 +212,7 @@ bool playlist_config_copy(const playlist_config_t *src,
    dst->compress            = src->compress;
    dst->fuzzy_archive_match = src->fuzzy_archive_match;
    dst->autofix_paths       = src->autofix_paths;
+   dst->binary_cache        = src->binary_cache;
 
    return true;
 }
@@ -483,6 +523,201 @@ static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
    return false;
 }
 
+static void playlist_path_index_free(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->path_index);
+   playlist->path_index_empty = 0;
+   playlist->path_index_built = false;
+}
+
+static const playlist_path_index_t *playlist_path_index_get(
+      playlist_t *playlist, uint32_t hash)
+{
+   ptrdiff_t idx = RHMAP_IDX(playlist->path_index, hash);
+   return (idx < 0) ? NULL : &playlist->path_index[idx];
+}
+
+static bool playlist_path_index_update(playlist_t *playlist,
+      uint32_t hash, const playlist_path_id_t *path_id,
+      int paths, int archives, int archive_members)
+{
+   playlist_path_index_t *counts = NULL;
+   ptrdiff_t idx                 = RHMAP_IDX(playlist->path_index, hash);
+
+   if (idx < 0)
+   {
+      playlist_path_index_t zero = {0};
+
+      if (paths < 0 || archives < 0 || archive_members < 0)
+         return false;
+      if (!RHMAP_TRYFIT(playlist->path_index,
+               RHMAP_LEN(playlist->path_index) + 1))
+         return false;
+
+      RHMAP_SET(playlist->path_index, hash, zero);
+      idx = RHMAP_IDX(playlist->path_index, hash);
+   }
+
+   counts                   = &playlist->path_index[idx];
+   counts->paths           += paths;
+   counts->archives        += archives;
+   counts->archive_members += archive_members;
+
+   /* The entry is gone, another one will take its place */
+   if (paths < 0 && counts->path_id == path_id)
+      counts->path_id       = NULL;
+   else if (paths > 0 && !counts->path_id)
+      counts->path_id       = path_id;
+
+   if (     !counts->paths
+         && !counts->archives
+         && !counts->archive_members)
+      (void)RHMAP_DEL(playlist->path_index, hash);
+
+   return true;
+}
+
+/**
+ * playlist_path_index_add:
+ * @playlist          : Playlist handle.
+ * @entry             : Entry being added (@delta 1)
+ *                      or removed (@delta -1).
+ *
+ * Keeps the path index in sync with the entries. If the
+ * index cannot be updated it is dropped, to be rebuilt by
+ * the next lookup.
+ **/
+static void playlist_path_index_add(playlist_t *playlist,
+      struct playlist_entry *entry, int delta)
+{
+   playlist_path_id_t *path_id = NULL;
+   bool ok                     = true;
+
+   if (!playlist->path_index_built)
+      return;
+
+   if (!entry->path_id)
+   {
+      if (!(entry->path_id = playlist_path_id_init(entry->path)))
+      {
+         playlist_path_index_free(playlist);
+         return;
+      }
+   }
+   path_id = entry->path_id;
+
+   if (string_is_empty(path_id->real_path))
+   {
+      playlist->path_index_empty += delta;
+      return;
+   }
+
+   ok = playlist_path_index_update(playlist,
+         path_id->real_path_hash, path_id, delta, 0, 0);
+
+   if (ok && !string_is_empty(path_id->archive_path))
+   {
+      if (path_id->is_in_archive)
+         ok = playlist_path_index_update(playlist,
+               path_id->archive_path_hash, NULL, 0, 0, delta);
+      else if (path_id->is_archive)
+         ok = playlist_path_index_update(playlist,
+               path_id->archive_path_hash, NULL, 0, delta, 0);
+   }
+
+   if (!ok)
+      playlist_path_index_free(playlist);
+}
+
+/**
+ * playlist_path_index_may_match:
+ * @playlist          : Playlist handle.
+ * @path_id           : Path identity to search for.
+ *
+ * Builds the path index on first use.
+ *
+ * Returns 'false' if no entry of the playlist can
+ * match 'path_id', in which case there is no need to
+ * call playlist_path_matches_entry() for each of them.
+ **/
+static bool playlist_path_index_may_match(playlist_t *playlist,
+      const playlist_path_id_t *path_id)
+{
+   const playlist_path_index_t *counts = NULL;
+
+   if (!playlist->path_index_built)
+   {
+      size_t i;
+      size_t len                 = RBUF_LEN(playlist->entries);
+
+      playlist->path_index_built = true;
+      if (!RHMAP_TRYFIT(playlist->path_index, len))
+         playlist_path_index_free(playlist);
+
+      for (i = 0; i < len && playlist->path_index_built; i++)
+         playlist_path_index_add(playlist, &playlist->entries[i], 1);
+
+      /* Without an index, every entry is a candidate */
+      if (!playlist->path_index_built)
+         return true;
+   }
+
+   if (string_is_empty(path_id->real_path))
+      return playlist->path_index_empty > 0;
+
+   if (     (counts = playlist_path_index_get(playlist,
+               path_id->real_path_hash))
+         && counts->paths)
+      return true;
+
+   /* Fuzzy archive matching: [archive_path] against
+    * [archive_path][delimiter][rom_file], or vice versa */
+   if (     !string_is_empty(path_id->archive_path)
+         && (counts = playlist_path_index_get(playlist,
+               path_id->archive_path_hash)))
+   {
+      if (path_id->is_in_archive)
+         return counts->archives > 0;
+      if (path_id->is_archive)
+         return counts->archive_members > 0;
+   }
+
+   return false;
+}
+
+/**
+ * playlist_path_index_has:
+ * @playlist          : Playlist handle.
+ * @path_id           : Path identity to search for.
+ *
+ * Must follow a call to playlist_path_index_may_match().
+ *
+ * Returns 'true' if an entry of the playlist has the
+ * same real path as 'path_id'. A 'false' return means
+ * the entries still have to be searched.
+ **/
+static bool playlist_path_index_has(playlist_t *playlist,
+      const playlist_path_id_t *path_id)
+{
+   const playlist_path_index_t *counts = NULL;
+
+   if (     !playlist->path_index_built
+         || string_is_empty(path_id->real_path)
+         || !(counts = playlist_path_index_get(playlist,
+               path_id->real_path_hash))
+         || !counts->path_id)
+      return false;
+
+#ifdef _WIN32
+   /* Handle case-insensitive operating systems*/
+   return string_is_equal_noncase(path_id->real_path,
+         counts->path_id->real_path);
+#else
+   return string_is_equal(path_id->real_path,
+         counts->path_id->real_path);
+#endif
+}
+
 /**
  * playlist_core_path_equal:
  * @real_core_path  : 'Real' search path, generated by path_resolve_realpath()
@@ -562,33 +797,46 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Strings read from the binary cache are
+ * not allocated, see playlist_read_cache_file() */
+static void playlist_free_string(playlist_t *playlist, char *s)
+{
+   if (     playlist->cache_data
+         && s >= (char*)playlist->cache_data
+         && s <  (char*)playlist->cache_data + playlist->cache_size)
+      return;
+   free(s);
+}
+
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
    if (entry->path)
-      free(entry->path);
+      playlist_free_string(playlist, entry->path);
    if (entry->label)
-      free(entry->label);
+      playlist_free_string(playlist, entry->label);
    if (entry->core_path)
-      free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
    if (entry->core_name)
-      free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
    if (entry->db_name)
-      free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
    if (entry->crc32)
-      free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
    if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
+      playlist_free_string(playlist, entry->subsystem_ident);
    if (entry->subsystem_name)
-      free(entry->subsystem_name);
+      playlist_free_string(playlist, entry->subsystem_name);
    if (entry->runtime_str)
       free(entry->runtime_str);
    if (entry->last_played_str)
@@ -646,7 +894,13 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+   {
+      playlist_path_index_add(playlist, entry_to_delete, -1);
+      playlist_free_entry(playlist, entry_to_delete);
+   }
+
+   if (playlist->bulk_push && idx < playlist->bulk_start)
+      playlist->bulk_start--;
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -677,6 +931,9 @@ void playlist_delete_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
+   if (!playlist_path_index_may_match(playlist, path_id))
+      i = RBUF_LEN(playlist->entries);
+
    while (i < RBUF_LEN(playlist->entries))
    {
       if (!playlist_path_matches_entry(path_id,
@@ -709,7 +966,10 @@ void playlist_get_index_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   len = playlist_path_index_may_match(playlist, path_id)
+      ? RBUF_LEN(playlist->entries) : 0;
+
+   for (i = 0; i < len; i++)
    {
       if (!playlist_path_matches_entry(path_id,
             &playlist->entries[i], &playlist->config))
@@ -734,7 +994,16 @@ bool playlist_entry_exists(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(path)))
       return false;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   len = playlist_path_index_may_match(playlist, path_id)
+      ? RBUF_LEN(playlist->entries) : 0;
+
+   if (len && playlist_path_index_has(playlist, path_id))
+   {
+      playlist_path_id_free(path_id);
+      return true;
+   }
+
+   for (i = 0; i < len; i++)
    {
       if (playlist_path_matches_entry(path_id,
             &playlist->entries[i], &playlist->config))
@@ -760,8 +1029,10 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
+      playlist_path_index_add(playlist, entry, -1);
+
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -770,13 +1041,15 @@ void playlist_update(playlist_t *playlist, size_t idx,
          entry->path_id  = NULL;
       }
 
+      playlist_path_index_add(playlist, entry, 1);
+
       playlist->modified = true;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
       if (entry->label)
-         free(entry->label);
+         playlist_free_string(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
       playlist->modified = true;
    }
@@ -784,7 +1057,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = true;
@@ -793,7 +1066,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
       if (entry->core_name)
-         free(entry->core_name);
+         playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
       playlist->modified = true;
    }
@@ -801,7 +1074,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
       if (entry->db_name)
-         free(entry->db_name);
+         playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
       playlist->modified = true;
    }
@@ -809,7 +1082,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
       if (entry->crc32)
-         free(entry->crc32);
+         playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->modified = true;
    }
@@ -828,8 +1101,10 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
+      playlist_path_index_add(playlist, entry, -1);
+
       if (entry->path)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -838,13 +1113,15 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
          entry->path_id  = NULL;
       }
 
+      playlist_path_index_add(playlist, entry, 1);
+
       playlist->modified = playlist->modified || register_update;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
       if (entry->core_path)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
@@ -962,8 +1239,10 @@ bool playlist_push_runtime(playlist_t *playlist,
       goto error;
    }
 
+   /* Only look for a duplicate if there can be one */
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   i   = playlist_path_index_may_match(playlist, path_id) ? 0 : len;
+   for (; i < len; i++)
    {
       struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path)
@@ -1000,7 +1279,8 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_path_index_add(playlist, last_entry, -1);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1023,6 +1303,7 @@ bool playlist_push_runtime(playlist_t *playlist,
          playlist->entries[0].path            = strdup(path_id->real_path);
       playlist->entries[0].path_id            = path_id;
       path_id                                 = NULL;
+      playlist_path_index_add(playlist, &playlist->entries[0], 1);
 
       if (!string_is_empty(real_core_path))
          playlist->entries[0].core_path       = strdup(real_core_path);
@@ -1270,6 +1551,87 @@ bool playlist_content_path_is_valid(const char *path)
    return path_is_valid(path);
 }
 
+/* Index of the top entry. While pushing in bulk, the
+ * new entries are kept at the end, the latest last */
+static size_t playlist_top_index(playlist_t *playlist)
+{
+   size_t len = RBUF_LEN(playlist->entries);
+   if (playlist->bulk_push && len > playlist->bulk_start)
+      return len - 1;
+   return 0;
+}
+
+static void playlist_move_to_top(playlist_t *playlist, size_t idx)
+{
+   struct playlist_entry tmp = playlist->entries[idx];
+   size_t len                = RBUF_LEN(playlist->entries);
+
+   if (playlist->bulk_push)
+   {
+      memmove(playlist->entries + idx, playlist->entries + idx + 1,
+            (len - 1 - idx) * sizeof(struct playlist_entry));
+      playlist->entries[len - 1] = tmp;
+
+      if (idx < playlist->bulk_start)
+         playlist->bulk_start--;
+   }
+   else
+   {
+      memmove(playlist->entries + 1, playlist->entries,
+            idx * sizeof(struct playlist_entry));
+      playlist->entries[0] = tmp;
+   }
+}
+
+static void playlist_reverse_entries(struct playlist_entry *entries,
+      size_t len)
+{
+   size_t i;
+   for (i = 0; i < len / 2; i++)
+   {
+      struct playlist_entry tmp = entries[i];
+      entries[i]                = entries[len - 1 - i];
+      entries[len - 1 - i]      = tmp;
+   }
+}
+
+void playlist_push_bulk_begin(playlist_t *playlist)
+{
+   if (!playlist || playlist->bulk_push)
+      return;
+
+   playlist->bulk_push  = true;
+   playlist->bulk_start = RBUF_LEN(playlist->entries);
+}
+
+void playlist_push_bulk_end(playlist_t *playlist)
+{
+   size_t len, count;
+
+   if (!playlist || !playlist->bulk_push)
+      return;
+
+   playlist->bulk_push = false;
+   len                 = RBUF_LEN(playlist->entries);
+   count               = len - playlist->bulk_start;
+
+   /* [old][new, latest last] -> [new, latest first][old] */
+   playlist_reverse_entries(playlist->entries, len);
+   playlist_reverse_entries(playlist->entries + count, len - count);
+
+   /* Evict what the pushes would have evicted one by one */
+   if (len > playlist->config.capacity)
+   {
+      while (len > playlist->config.capacity)
+      {
+         struct playlist_entry *last_entry = &playlist->entries[--len];
+         playlist_path_index_add(playlist, last_entry, -1);
+         playlist_free_entry(playlist, last_entry);
+      }
+      RBUF_RESIZE(playlist->entries, len);
+   }
+}
+
 /**
  * playlist_push:
  * @playlist           : Playlist handle.
@@ -1326,10 +1688,11 @@ bool playlist_push(playlist_t *playlist,
       }
    }
 
+   /* Only look for a duplicate if there can be one */
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   i   = playlist_path_index_may_match(playlist, path_id) ? 0 : len;
+   for (; i < len; i++)
    {
-      struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path)
                        && string_is_empty(playlist->entries[i].path));
 
@@ -1434,7 +1797,7 @@ bool playlist_push(playlist_t *playlist,
 
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
-      if (i == 0)
+      if (i == playlist_top_index(playlist))
       {
          if (entry_updated)
             goto success;
@@ -1443,10 +1806,7 @@ bool playlist_push(playlist_t *playlist,
       }
 
       /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+      playlist_move_to_top(playlist, i);
 
       goto success;
    }
@@ -1454,10 +1814,19 @@ bool playlist_push(playlist_t *playlist,
    if (playlist->config.capacity == 0)
       goto error;
 
-   if (len == playlist->config.capacity)
+   if (playlist->bulk_push)
+   {
+      /* Added at the end for now, without evicting
+       * anything, see playlist_push_bulk_end() */
+      if (!RBUF_TRYFIT(playlist->entries, len + 1))
+         goto error; /* out of memory */
+      RBUF_RESIZE(playlist->entries, len + 1);
+   }
+   else if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_path_index_add(playlist, last_entry, -1);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1470,63 +1839,71 @@ bool playlist_push(playlist_t *playlist,
 
    if (playlist->entries)
    {
-      memmove(playlist->entries + 1, playlist->entries,
-            len * sizeof(struct playlist_entry));
+      struct playlist_entry *new_entry = &playlist->entries[len];
 
-      playlist->entries[0].path               = NULL;
-      playlist->entries[0].label              = NULL;
-      playlist->entries[0].core_path          = NULL;
-      playlist->entries[0].core_name          = NULL;
-      playlist->entries[0].db_name            = NULL;
-      playlist->entries[0].crc32              = NULL;
-      playlist->entries[0].subsystem_ident    = NULL;
-      playlist->entries[0].subsystem_name     = NULL;
-      playlist->entries[0].runtime_str        = NULL;
-      playlist->entries[0].last_played_str    = NULL;
-      playlist->entries[0].subsystem_roms     = NULL;
-      playlist->entries[0].path_id            = NULL;
-      playlist->entries[0].runtime_status     = PLAYLIST_RUNTIME_UNKNOWN;
-      playlist->entries[0].runtime_hours      = 0;
-      playlist->entries[0].runtime_minutes    = 0;
-      playlist->entries[0].runtime_seconds    = 0;
-      playlist->entries[0].last_played_year   = 0;
-      playlist->entries[0].last_played_month  = 0;
-      playlist->entries[0].last_played_day    = 0;
-      playlist->entries[0].last_played_hour   = 0;
-      playlist->entries[0].last_played_minute = 0;
-      playlist->entries[0].last_played_second = 0;
+      if (!playlist->bulk_push)
+      {
+         memmove(playlist->entries + 1, playlist->entries,
+               len * sizeof(struct playlist_entry));
+         new_entry = &playlist->entries[0];
+      }
+
+      new_entry->path               = NULL;
+      new_entry->label              = NULL;
+      new_entry->core_path          = NULL;
+      new_entry->core_name          = NULL;
+      new_entry->db_name            = NULL;
+      new_entry->crc32              = NULL;
+      new_entry->subsystem_ident    = NULL;
+      new_entry->subsystem_name     = NULL;
+      new_entry->runtime_str        = NULL;
+      new_entry->last_played_str    = NULL;
+      new_entry->subsystem_roms     = NULL;
+      new_entry->path_id            = NULL;
+      new_entry->runtime_status     = PLAYLIST_RUNTIME_UNKNOWN;
+      new_entry->runtime_hours      = 0;
+      new_entry->runtime_minutes    = 0;
+      new_entry->runtime_seconds    = 0;
+      new_entry->last_played_year   = 0;
+      new_entry->last_played_month  = 0;
+      new_entry->last_played_day    = 0;
+      new_entry->last_played_hour   = 0;
+      new_entry->last_played_minute = 0;
+      new_entry->last_played_second = 0;
 
       if (!string_is_empty(path_id->real_path))
-         playlist->entries[0].path            = strdup(path_id->real_path);
-      playlist->entries[0].path_id            = path_id;
-      path_id                                 = NULL;
+         new_entry->path            = strdup(path_id->real_path);
+      new_entry->path_id            = path_id;
+      path_id                       = NULL;
 
-      playlist->entries[0].entry_slot         = entry->entry_slot;
+      new_entry->entry_slot         = entry->entry_slot;
 
       if (!string_is_empty(entry->label))
-         playlist->entries[0].label           = strdup(entry->label);
+         new_entry->label           = strdup(entry->label);
       if (!string_is_empty(real_core_path))
-         playlist->entries[0].core_path       = strdup(real_core_path);
+         new_entry->core_path       = strdup(real_core_path);
       if (!string_is_empty(core_name))
-         playlist->entries[0].core_name       = strdup(core_name);
+         new_entry->core_name       = strdup(core_name);
       if (!string_is_empty(entry->db_name))
-         playlist->entries[0].db_name         = strdup(entry->db_name);
+         new_entry->db_name         = strdup(entry->db_name);
       if (!string_is_empty(entry->crc32))
-         playlist->entries[0].crc32           = strdup(entry->crc32);
+         new_entry->crc32           = strdup(entry->crc32);
       if (!string_is_empty(entry->subsystem_ident))
-         playlist->entries[0].subsystem_ident = strdup(entry->subsystem_ident);
+         new_entry->subsystem_ident = strdup(entry->subsystem_ident);
       if (!string_is_empty(entry->subsystem_name))
-         playlist->entries[0].subsystem_name  = strdup(entry->subsystem_name);
+         new_entry->subsystem_name  = strdup(entry->subsystem_name);
 
       if (entry->subsystem_roms)
       {
          union string_list_elem_attr attributes = {0};
 
-         playlist->entries[0].subsystem_roms    = string_list_new();
+         new_entry->subsystem_roms     = string_list_new();
 
          for (i = 0; i < entry->subsystem_roms->size; i++)
-            string_list_append(playlist->entries[0].subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
+            string_list_append(new_entry->subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
       }
+
+      playlist_path_index_add(playlist, new_entry, 1);
    }
 
 success:
@@ -1541,11 +1918,630 @@ error:
    return false;
 }
 
+/* Binary playlist cache
+ * ---------------------
+ * When enabled, a copy of the playlist is kept next to it
+ * (FILE_PATH_LPL_CACHE_EXTENSION appended to its path):
+ *
+ *   playlist_cache_header_t
+ *   playlist_cache_entry_t[entry_count]
+ *   string table of 'strings_size' bytes
+ *
+ * All values are little endian. Strings are stored once,
+ * as offsets into the string table, offset 0 being an
+ * empty string, i.e. NULL. The subsystem ROMs of an entry
+ * follow each other in the table.
+ *
+ * The cache records the size and CRC32 of the playlist
+ * file it was made from, and is ignored and rebuilt as soon
+ * as that file changes. The file is mapped where possible,
+ * and entry strings point directly into it, so they are not
+ * read from disk before being used. */
+
+#define PLAYLIST_CACHE_MAGIC   0x43504C52 /* "RLPC" */
+#define PLAYLIST_CACHE_VERSION 2
+
+#define PLAYLIST_CACHE_OLD_FORMAT              (1 << 0)
+#define PLAYLIST_CACHE_COMPRESSED              (1 << 1)
+#define PLAYLIST_CACHE_SCAN_SEARCH_RECURSIVELY (1 << 2)
+#define PLAYLIST_CACHE_SCAN_SEARCH_ARCHIVES    (1 << 3)
+#define PLAYLIST_CACHE_SCAN_FILTER_DAT_CONTENT (1 << 4)
+#define PLAYLIST_CACHE_SCAN_OVERWRITE_PLAYLIST (1 << 5)
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t entry_size;
+   uint32_t entry_count;
+   uint32_t strings_size;
+   uint32_t file_size_lo;
+   uint32_t file_size_hi;
+   uint32_t file_mtime_lo;
+   uint32_t file_mtime_hi;
+   uint32_t cache_time_lo;
+   uint32_t cache_time_hi;
+   uint32_t flags;
+   uint32_t default_core_path;
+   uint32_t default_core_name;
+   uint32_t base_content_directory;
+   uint32_t scan_content_dir;
+   uint32_t scan_file_exts;
+   uint32_t scan_dat_file_path;
+   uint32_t label_display_mode;
+   uint32_t right_thumbnail_mode;
+   uint32_t left_thumbnail_mode;
+   uint32_t thumbnail_match_mode;
+   uint32_t sort_mode;
+} playlist_cache_header_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t label;
+   uint32_t core_path;
+   uint32_t core_name;
+   uint32_t db_name;
+   uint32_t crc32;
+   uint32_t subsystem_ident;
+   uint32_t subsystem_name;
+   uint32_t subsystem_roms;
+   uint32_t subsystem_rom_count;
+   uint32_t entry_slot;
+   uint32_t runtime_hours;
+   uint32_t runtime_minutes;
+   uint32_t runtime_seconds;
+   uint32_t last_played_year;
+   uint32_t last_played_month;
+   uint32_t last_played_day;
+   uint32_t last_played_hour;
+   uint32_t last_played_minute;
+   uint32_t last_played_second;
+} playlist_cache_entry_t;
+
+typedef struct
+{
+   char *strings;      /* RBUF */
+   uint32_t *offsets;  /* RHMAP, keyed by string */
+   bool out_of_memory;
+} playlist_cache_writer_t;
+
+static void playlist_get_cache_path(const char *playlist_path,
+      char *s, size_t len)
+{
+   size_t _len = strlcpy(s, playlist_path, len);
+   strlcpy(s + _len, FILE_PATH_LPL_CACHE_EXTENSION, len - _len);
+}
+
+/* Size and modification time of the playlist file,
+ * without reading it */
+static bool playlist_get_file_stat(const playlist_t *playlist,
+      int64_t *size, int64_t *mtime)
+{
+   int32_t file_size = path_get_size(playlist->config.path);
+
+   if (file_size < 0)
+      return false;
+
+   *size  = file_size;
+   *mtime = path_get_mtime(playlist->config.path);
+   return true;
+}
+
+static uint32_t playlist_cache_add_string(playlist_cache_writer_t *writer,
+      const char *s)
+{
+   uint32_t offset;
+   size_t len;
+   ptrdiff_t idx;
+
+   if (string_is_empty(s))
+      return 0;
+
+   /* Cores, databases and the like are shared by most entries */
+   if ((idx = RHMAP_IDX_STR(writer->offsets, s)) >= 0)
+      return writer->offsets[idx];
+
+   offset = (uint32_t)RBUF_LEN(writer->strings);
+   len    = strlen(s) + 1;
+
+   if (     !RBUF_TRYFIT(writer->strings, offset + len)
+         || !RHMAP_TRYFIT(writer->offsets,
+               RHMAP_LEN(writer->offsets) + 1))
+   {
+      writer->out_of_memory = true;
+      return 0;
+   }
+
+   RBUF_RESIZE(writer->strings, offset + len);
+   memcpy(writer->strings + offset, s, len);
+   RHMAP_SET_STR(writer->offsets, s, offset);
+   return offset;
+}
+
+/* Unlike other strings, subsystem ROMs are not shared:
+ * they must follow each other in the string table */
+static uint32_t playlist_cache_add_string_list(
+      playlist_cache_writer_t *writer, const struct string_list *list)
+{
+   size_t i;
+   uint32_t first = (uint32_t)RBUF_LEN(writer->strings);
+
+   for (i = 0; i < list->size; i++)
+   {
+      size_t offset = RBUF_LEN(writer->strings);
+      size_t len    = strlen(list->elems[i].data) + 1;
+
+      if (!RBUF_TRYFIT(writer->strings, offset + len))
+      {
+         writer->out_of_memory = true;
+         return 0;
+      }
+
+      RBUF_RESIZE(writer->strings, offset + len);
+      memcpy(writer->strings + offset, list->elems[i].data, len);
+   }
+
+   return first;
+}
+
+/**
+ * playlist_write_cache_file:
+ * @playlist            : Playlist handle.
+ * @file_size           : Size of the playlist file.
+ * @file_mtime          : Modification time of the playlist file.
+ *
+ * Writes the binary cache of the playlist, as it
+ * is in the playlist file described by @file_size
+ * and @file_mtime.
+ **/
+static void playlist_write_cache_file(playlist_t *playlist,
+      int64_t file_size, int64_t file_mtime)
+{
+   size_t i;
+   size_t size;
+   uint64_t now                   = (uint64_t)time(NULL);
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   playlist_cache_header_t header;
+   playlist_cache_writer_t writer;
+   uint8_t *data                  = NULL;
+   playlist_cache_entry_t *out    = NULL;
+   size_t len                     = RBUF_LEN(playlist->entries);
+
+   writer.strings       = NULL;
+   writer.offsets       = NULL;
+   writer.out_of_memory = false;
+
+   /* Offset 0 is the empty string */
+   if (!RBUF_TRYFIT(writer.strings, 1))
+      goto end;
+   RBUF_RESIZE(writer.strings, 1);
+   writer.strings[0] = '\0';
+
+   if (!(out = (playlist_cache_entry_t*)malloc(
+               (len ? len : 1) * sizeof(*out))))
+      goto end;
+
+   for (i = 0; i < len; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      playlist_cache_entry_t *rec        = &out[i];
+      const struct string_list *roms     = entry->subsystem_roms;
+
+      rec->path                = playlist_cache_add_string(&writer, entry->path);
+      rec->label               = playlist_cache_add_string(&writer, entry->label);
+      rec->core_path           = playlist_cache_add_string(&writer, entry->core_path);
+      rec->core_name           = playlist_cache_add_string(&writer, entry->core_name);
+      rec->db_name             = playlist_cache_add_string(&writer, entry->db_name);
+      rec->crc32               = playlist_cache_add_string(&writer, entry->crc32);
+      rec->subsystem_ident     = playlist_cache_add_string(&writer, entry->subsystem_ident);
+      rec->subsystem_name      = playlist_cache_add_string(&writer, entry->subsystem_name);
+      rec->subsystem_roms      = (roms && roms->size)
+         ? playlist_cache_add_string_list(&writer, roms) : 0;
+      rec->subsystem_rom_count = roms ? (uint32_t)roms->size : 0;
+      rec->entry_slot          = entry->entry_slot;
+      rec->runtime_hours       = entry->runtime_hours;
+      rec->runtime_minutes     = entry->runtime_minutes;
+      rec->runtime_seconds     = entry->runtime_seconds;
+      rec->last_played_year    = entry->last_played_year;
+      rec->last_played_month   = entry->last_played_month;
+      rec->last_played_day     = entry->last_played_day;
+      rec->last_played_hour    = entry->last_played_hour;
+      rec->last_played_minute  = entry->last_played_minute;
+      rec->last_played_second  = entry->last_played_second;
+   }
+
+   header.magic                  = PLAYLIST_CACHE_MAGIC;
+   header.version                = PLAYLIST_CACHE_VERSION;
+   header.entry_size             = sizeof(playlist_cache_entry_t);
+   header.entry_count            = (uint32_t)len;
+   header.file_size_lo           = (uint32_t)((uint64_t)file_size);
+   header.file_size_hi           = (uint32_t)((uint64_t)file_size >> 32);
+   header.file_mtime_lo          = (uint32_t)((uint64_t)file_mtime);
+   header.file_mtime_hi          = (uint32_t)((uint64_t)file_mtime >> 32);
+   header.cache_time_lo          = (uint32_t)now;
+   header.cache_time_hi          = (uint32_t)(now >> 32);
+   header.flags                  = 0;
+   if (playlist->old_format)
+      header.flags              |= PLAYLIST_CACHE_OLD_FORMAT;
+   if (playlist->compressed)
+      header.flags              |= PLAYLIST_CACHE_COMPRESSED;
+   if (playlist->scan_record.search_recursively)
+      header.flags              |= PLAYLIST_CACHE_SCAN_SEARCH_RECURSIVELY;
+   if (playlist->scan_record.search_archives)
+      header.flags              |= PLAYLIST_CACHE_SCAN_SEARCH_ARCHIVES;
+   if (playlist->scan_record.filter_dat_content)
+      header.flags              |= PLAYLIST_CACHE_SCAN_FILTER_DAT_CONTENT;
+   if (playlist->scan_record.overwrite_playlist)
+      header.flags              |= PLAYLIST_CACHE_SCAN_OVERWRITE_PLAYLIST;
+   header.default_core_path      = playlist_cache_add_string(&writer,
+         playlist->default_core_path);
+   header.default_core_name      = playlist_cache_add_string(&writer,
+         playlist->default_core_name);
+   header.base_content_directory = playlist_cache_add_string(&writer,
+         playlist->base_content_directory);
+   header.scan_content_dir       = playlist_cache_add_string(&writer,
+         playlist->scan_record.content_dir);
+   header.scan_file_exts         = playlist_cache_add_string(&writer,
+         playlist->scan_record.file_exts);
+   header.scan_dat_file_path     = playlist_cache_add_string(&writer,
+         playlist->scan_record.dat_file_path);
+   header.label_display_mode     = playlist->label_display_mode;
+   header.right_thumbnail_mode   = playlist->right_thumbnail_mode;
+   header.left_thumbnail_mode    = playlist->left_thumbnail_mode;
+   header.thumbnail_match_mode   = playlist->thumbnail_match_mode;
+   header.sort_mode              = playlist->sort_mode;
+   header.strings_size           = (uint32_t)RBUF_LEN(writer.strings);
+
+   if (writer.out_of_memory || !writer.strings)
+      goto end;
+
+   size = sizeof(header) + len * sizeof(*out) + header.strings_size;
+   if (!(data = (uint8_t*)malloc(size)))
+      goto end;
+
+   /* Both structures are made of uint32_t only */
+   memcpy(data, &header, sizeof(header));
+   memcpy(data + sizeof(header), out, len * sizeof(*out));
+#ifdef MSB_FIRST
+   {
+      uint32_t *words = (uint32_t*)data;
+      for (i = 0; i < (sizeof(header) + len * sizeof(*out)) / 4; i++)
+         words[i] = retro_cpu_to_le32(words[i]);
+   }
+#endif
+   memcpy(data + sizeof(header) + len * sizeof(*out),
+         writer.strings, header.strings_size);
+
+   /* The current cache may be mapped by a playlist,
+    * replace it rather than writing over it */
+   playlist_get_cache_path(playlist->config.path, path, sizeof(path));
+   fill_pathname_join_delim(tmp_path, path, "tmp", '.', sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, data, size))
+   {
+      filestream_delete(path);
+      if (filestream_rename(tmp_path, path))
+         filestream_delete(tmp_path);
+   }
+
+end:
+   free(data);
+   free(out);
+   RBUF_FREE(writer.strings);
+   RHMAP_FREE(writer.offsets);
+}
+
+/* Entries loaded from the cache point into its data,
+ * which must not be released while they exist */
+static void playlist_release_cache(playlist_t *playlist)
+{
+   if (!playlist->cache_data)
+      return;
+
+#ifdef HAVE_MMAP
+   if (playlist->cache_mapped)
+      munmap(playlist->cache_data, playlist->cache_size);
+   else
+#endif
+      free(playlist->cache_data);
+
+   playlist->cache_data   = NULL;
+   playlist->cache_size   = 0;
+   playlist->cache_mapped = false;
+}
+
+static bool playlist_map_cache(playlist_t *playlist, const char *path)
+{
+#ifdef HAVE_MMAP
+   void *data;
+   off_t size;
+   int fd = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   size = lseek(fd, 0, SEEK_END);
+
+   /* Private and writable, so that the file can
+    * change without affecting the strings */
+   if (     size <= 0
+         || (data = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+   {
+      close(fd);
+      return false;
+   }
+   close(fd);
+
+   playlist->cache_data   = data;
+   playlist->cache_size   = (size_t)size;
+   playlist->cache_mapped = true;
+   return true;
+#else
+   void *data   = NULL;
+   int64_t size = 0;
+
+   if (!filestream_read_file(path, &data, &size))
+      return false;
+
+   playlist->cache_data   = data;
+   playlist->cache_size   = (size_t)size;
+   playlist->cache_mapped = false;
+   return true;
+#endif
+}
+
+/* Offsets must point inside the string table,
+ * which ends with a null character */
+static bool playlist_cache_check_string(uint32_t offset,
+      uint32_t strings_size)
+{
+   return offset < strings_size;
+}
+
+static bool playlist_cache_check_string_list(const char *strings,
+      uint32_t strings_size, uint32_t offset, uint32_t count)
+{
+   uint32_t i;
+
+   for (i = 0; i < count; i++)
+   {
+      if (!offset || offset >= strings_size)
+         return false;
+      offset += (uint32_t)strlen(strings + offset) + 1;
+   }
+
+   return true;
+}
+
+static char *playlist_cache_strdup(const char *strings, uint32_t offset)
+{
+   return offset ? strdup(strings + offset) : NULL;
+}
+
+/**
+ * playlist_read_cache_file:
+ * @playlist            : Playlist handle.
+ * @file_size           : Size of the playlist file.
+ * @file_mtime          : Modification time of the playlist file.
+ *
+ * Loads the playlist from its binary cache, if the
+ * cache exists and was made from the playlist file
+ * described by @file_size and @file_mtime.
+ *
+ * Returns: true if the playlist was loaded.
+ **/
+static bool playlist_read_cache_file(playlist_t *playlist,
+      int64_t file_size, int64_t file_mtime)
+{
+   size_t i, count;
+   uint64_t cache_time;
+   char path[PATH_MAX_LENGTH];
+   playlist_cache_header_t header;
+   playlist_cache_entry_t *in = NULL;
+   const char *strings        = NULL;
+
+   playlist_get_cache_path(playlist->config.path, path, sizeof(path));
+
+   if (!playlist_map_cache(playlist, path))
+      return false;
+
+   if (playlist->cache_size < sizeof(header))
+      goto error;
+
+   /* Both structures are made of uint32_t only, and
+    * the mapping is private: swap them in place */
+#ifdef MSB_FIRST
+   {
+      uint32_t *words = (uint32_t*)playlist->cache_data;
+      size_t len      = sizeof(header) / 4;
+      size_t max      = (playlist->cache_size - sizeof(header))
+         / sizeof(playlist_cache_entry_t);
+
+      if (     retro_le_to_cpu32(words[0]) != PLAYLIST_CACHE_MAGIC
+            || retro_le_to_cpu32(words[3]) > max)
+         goto error;
+
+      len += (size_t)retro_le_to_cpu32(words[3])
+         * sizeof(playlist_cache_entry_t) / 4;
+      for (i = 0; i < len; i++)
+         words[i] = retro_le_to_cpu32(words[i]);
+   }
+#endif
+   memcpy(&header, playlist->cache_data, sizeof(header));
+
+   if (     header.magic         != PLAYLIST_CACHE_MAGIC
+         || header.version       != PLAYLIST_CACHE_VERSION
+         || header.entry_size    != sizeof(playlist_cache_entry_t)
+         || header.file_size_lo  != (uint32_t)((uint64_t)file_size)
+         || header.file_size_hi  != (uint32_t)((uint64_t)file_size >> 32)
+         || header.file_mtime_lo != (uint32_t)((uint64_t)file_mtime)
+         || header.file_mtime_hi != (uint32_t)((uint64_t)file_mtime >> 32)
+         || !header.strings_size
+         || header.entry_count > (playlist->cache_size - sizeof(header))
+               / sizeof(playlist_cache_entry_t)
+         || playlist->cache_size != sizeof(header)
+               + (size_t)header.entry_count * sizeof(playlist_cache_entry_t)
+               + header.strings_size)
+      goto error;
+
+   /* A playlist file written in the second the cache was
+    * made could be written again with the same size and
+    * time: only trust caches made after that second */
+   cache_time = ((uint64_t)header.cache_time_hi << 32)
+      | header.cache_time_lo;
+   if (!file_mtime || (uint64_t)file_mtime + 1 >= cache_time)
+      goto error;
+
+   in      = (playlist_cache_entry_t*)(
+         (uint8_t*)playlist->cache_data + sizeof(header));
+   strings = (const char*)(in + header.entry_count);
+
+   /* Check everything before using anything */
+   if (     strings[0]
+         || strings[header.strings_size - 1]
+         || !playlist_cache_check_string(header.default_core_path,      header.strings_size)
+         || !playlist_cache_check_string(header.default_core_name,      header.strings_size)
+         || !playlist_cache_check_string(header.base_content_directory, header.strings_size)
+         || !playlist_cache_check_string(header.scan_content_dir,       header.strings_size)
+         || !playlist_cache_check_string(header.scan_file_exts,         header.strings_size)
+         || !playlist_cache_check_string(header.scan_dat_file_path,     header.strings_size))
+      goto error;
+
+   for (i = 0; i < header.entry_count; i++)
+   {
+      if (     !playlist_cache_check_string(in[i].path,            header.strings_size)
+            || !playlist_cache_check_string(in[i].label,           header.strings_size)
+            || !playlist_cache_check_string(in[i].core_path,       header.strings_size)
+            || !playlist_cache_check_string(in[i].core_name,       header.strings_size)
+            || !playlist_cache_check_string(in[i].db_name,         header.strings_size)
+            || !playlist_cache_check_string(in[i].crc32,           header.strings_size)
+            || !playlist_cache_check_string(in[i].subsystem_ident, header.strings_size)
+            || !playlist_cache_check_string(in[i].subsystem_name,  header.strings_size)
+            || !playlist_cache_check_string_list(strings, header.strings_size,
+                  in[i].subsystem_roms, in[i].subsystem_rom_count))
+      {
+         RARCH_WARN("[Playlist]: Invalid cache file: \"%s\".\n", path);
+         goto error;
+      }
+   }
+
+   count = header.entry_count;
+   if (count > playlist->config.capacity)
+   {
+      /* As when reading the playlist file, entries
+       * beyond capacity are dropped */
+      count              = playlist->config.capacity;
+      playlist->modified = true;
+   }
+
+   if (!RBUF_TRYFIT(playlist->entries, count))
+      goto error;
+   RBUF_RESIZE(playlist->entries, count);
+   memset(playlist->entries, 0, count * sizeof(*playlist->entries));
+
+   for (i = 0; i < count; i++)
+   {
+      const playlist_cache_entry_t *rec = &in[i];
+      struct playlist_entry *entry      = &playlist->entries[i];
+
+      entry->path               = rec->path            ? (char*)strings + rec->path            : NULL;
+      entry->label              = rec->label           ? (char*)strings + rec->label           : NULL;
+      entry->core_path          = rec->core_path       ? (char*)strings + rec->core_path       : NULL;
+      entry->core_name          = rec->core_name       ? (char*)strings + rec->core_name       : NULL;
+      entry->db_name            = rec->db_name         ? (char*)strings + rec->db_name         : NULL;
+      entry->crc32              = rec->crc32           ? (char*)strings + rec->crc32           : NULL;
+      entry->subsystem_ident    = rec->subsystem_ident ? (char*)strings + rec->subsystem_ident : NULL;
+      entry->subsystem_name     = rec->subsystem_name  ? (char*)strings + rec->subsystem_name  : NULL;
+      entry->entry_slot         = rec->entry_slot;
+      entry->runtime_hours      = rec->runtime_hours;
+      entry->runtime_minutes    = rec->runtime_minutes;
+      entry->runtime_seconds    = rec->runtime_seconds;
+      entry->last_played_year   = rec->last_played_year;
+      entry->last_played_month  = rec->last_played_month;
+      entry->last_played_day    = rec->last_played_day;
+      entry->last_played_hour   = rec->last_played_hour;
+      entry->last_played_minute = rec->last_played_minute;
+      entry->last_played_second = rec->last_played_second;
+
+      if (     rec->subsystem_rom_count
+            && (entry->subsystem_roms = string_list_new()))
+      {
+         uint32_t j;
+         union string_list_elem_attr attr = {0};
+         uint32_t offset                  = rec->subsystem_roms;
+
+         for (j = 0; j < rec->subsystem_rom_count; j++)
+         {
+            string_list_append(entry->subsystem_roms,
+                  strings + offset, attr);
+            offset += (uint32_t)strlen(strings + offset) + 1;
+         }
+      }
+   }
+
+   playlist->default_core_path              = playlist_cache_strdup(strings, header.default_core_path);
+   playlist->default_core_name              = playlist_cache_strdup(strings, header.default_core_name);
+   playlist->base_content_directory         = playlist_cache_strdup(strings, header.base_content_directory);
+   playlist->scan_record.content_dir        = playlist_cache_strdup(strings, header.scan_content_dir);
+   playlist->scan_record.file_exts          = playlist_cache_strdup(strings, header.scan_file_exts);
+   playlist->scan_record.dat_file_path      = playlist_cache_strdup(strings, header.scan_dat_file_path);
+   playlist->scan_record.search_recursively = (header.flags & PLAYLIST_CACHE_SCAN_SEARCH_RECURSIVELY) != 0;
+   playlist->scan_record.search_archives    = (header.flags & PLAYLIST_CACHE_SCAN_SEARCH_ARCHIVES)    != 0;
+   playlist->scan_record.filter_dat_content = (header.flags & PLAYLIST_CACHE_SCAN_FILTER_DAT_CONTENT) != 0;
+   playlist->scan_record.overwrite_playlist = (header.flags & PLAYLIST_CACHE_SCAN_OVERWRITE_PLAYLIST) != 0;
+   playlist->old_format                     = (header.flags & PLAYLIST_CACHE_OLD_FORMAT)              != 0;
+   playlist->compressed                     = (header.flags & PLAYLIST_CACHE_COMPRESSED)              != 0;
+   playlist->label_display_mode             = (enum playlist_label_display_mode)header.label_display_mode;
+   playlist->right_thumbnail_mode           = (enum playlist_thumbnail_mode)header.right_thumbnail_mode;
+   playlist->left_thumbnail_mode            = (enum playlist_thumbnail_mode)header.left_thumbnail_mode;
+   playlist->thumbnail_match_mode           = (enum playlist_thumbnail_match_mode)header.thumbnail_match_mode;
+   playlist->sort_mode                      = (enum playlist_sort_mode)header.sort_mode;
+
+   return true;
+
+error:
+   playlist_release_cache(playlist);
+   return false;
+}
+
+/* Updates the binary cache of the playlist after
+ * the playlist file was written */
+static void playlist_update_cache_file(playlist_t *playlist)
+{
+   int64_t file_size;
+   int64_t file_mtime;
+
+   if (     playlist->config.binary_cache
+         && playlist_get_file_stat(playlist, &file_size, &file_mtime))
+      playlist_write_cache_file(playlist, file_size, file_mtime);
+}
+
+/**
+ * playlist_delete_cache_file:
+ * @path                : Path of the playlist file.
+ *
+ * Deletes the binary cache of a playlist, if any.
+ **/
+void playlist_delete_cache_file(const char *path)
+{
+   char cache_path[PATH_MAX_LENGTH];
+
+   if (string_is_empty(path))
+      return;
+
+   playlist_get_cache_path(path, cache_path, sizeof(cache_path));
+   filestream_delete(cache_path);
+}
+
 void playlist_write_runtime_file(playlist_t *playlist)
 {
    size_t i, len;
    intfstream_t *file  = NULL;
    rjsonwriter_t* writer;
+   bool written        = false;
 
    if (!playlist || !playlist->modified)
       return;
@@ -1691,11 +2687,15 @@ void playlist_write_runtime_file(playlist_t *playlist)
    playlist->modified        = false;
    playlist->old_format      = false;
    playlist->compressed      = false;
+   written                   = true;
 
    RARCH_LOG("[Playlist]: Written to playlist file: \"%s\".\n", playlist->config.path);
 end:
    intfstream_close(file);
    free(file);
+
+   if (written)
+      playlist_update_cache_file(playlist);
 }
 
 void playlist_write_file(playlist_t *playlist)
@@ -1703,6 +2703,7 @@ void playlist_write_file(playlist_t *playlist)
    size_t i, len;
    intfstream_t *file = NULL;
    bool compressed    = false;
+   bool written       = false;
 
    /* Playlist will be written if any of the
     * following are true:
@@ -2088,11 +3089,15 @@ void playlist_write_file(playlist_t *playlist)
 
    playlist->modified   = false;
    playlist->compressed = compressed;
+   written              = true;
 
    RARCH_LOG("[Playlist]: Written to playlist file: \"%s\".\n", playlist->config.path);
 end:
    intfstream_close(file);
    free(file);
+
+   if (written)
+      playlist_update_cache_file(playlist);
 }
 
 /**
@@ -2139,12 +3144,14 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   playlist_path_index_free(playlist);
+   playlist_release_cache(playlist);
    free(playlist);
 }
 
@@ -2165,9 +3172,12 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_path_index_free(playlist);
+   playlist_release_cache(playlist);
+   playlist->bulk_start = 0;
 }
 
 /**
@@ -2567,16 +3577,29 @@ static bool playlist_read_file(playlist_t *playlist)
 {
    unsigned i;
    int test_char;
+   int64_t file_size    = 0;
+   int64_t file_mtime   = 0;
    bool res             = true;
+   bool update_cache    = false;
+   intfstream_t *file   = NULL;
+
+   if (     playlist->config.binary_cache
+         && playlist_get_file_stat(playlist, &file_size, &file_mtime))
+   {
+      if (playlist_read_cache_file(playlist, file_size, file_mtime))
+         return true;
+      update_cache = true;
+   }
+
 #if defined(HAVE_ZLIB)
-      /* Always use RZIP interface when reading playlists
-       * > this will automatically handle uncompressed
-       *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   /* Always use RZIP interface when reading playlists
+    * > this will automatically handle uncompressed
+    *   data */
+   file = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -2651,6 +3674,10 @@ static bool playlist_read_file(playlist_t *playlist)
          }
       }
       rjson_free(parser);
+
+      /* Entries beyond capacity were left out */
+      if (context.capacity_exceeded)
+         update_cache = false;
    }
    else
    {
@@ -2842,11 +3869,19 @@ static bool playlist_read_file(playlist_t *playlist)
             break;
          }
       }
+
+      /* Entries beyond capacity may have been left out */
+      if (RBUF_LEN(playlist->entries) >= playlist->config.capacity)
+         update_cache = false;
    }
 
 end:
    intfstream_close(file);
    free(file);
+
+   if (update_cache && res)
+      playlist_write_cache_file(playlist, file_size, file_mtime);
+
    return res;
 }
 
@@ -2907,6 +3942,14 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
    playlist->entries                = NULL;
+   playlist->path_index             = NULL;
+   playlist->cache_data             = NULL;
+   playlist->cache_size             = 0;
+   playlist->path_index_empty       = 0;
+   playlist->bulk_start             = 0;
+   playlist->path_index_built       = false;
+   playlist->bulk_push              = false;
+   playlist->cache_mapped           = false;
    playlist->label_display_mode     = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode   = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode    = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2953,7 +3996,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
                   playlist->base_content_directory, playlist->config.base_content_directory,
                   sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_string(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
             /* Fix subsystem roms paths*/
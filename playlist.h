@@ -150,6 +150,9 @@ typedef struct
    bool compress;
    bool fuzzy_archive_match;
    bool autofix_paths;   
+   /* Keep a binary copy of the playlist next to it,
+    * to load it faster next time */
+   bool binary_cache;
    char path[PATH_MAX_LENGTH];
    char base_content_directory[PATH_MAX_LENGTH];
 } playlist_config_t;
@@ -286,6 +289,29 @@ bool playlist_content_path_is_valid(const char *path);
 bool playlist_push(playlist_t *playlist,
       const struct playlist_entry *entry);
 
+/**
+ * playlist_push_bulk_begin:
+ * @playlist        	   : Playlist handle.
+ *
+ * Starts adding many entries at once, e.g. when scanning
+ * content. Until playlist_push_bulk_end(), playlist_push()
+ * adds new entries without moving the existing ones, so
+ * entry indices are not in playlist order in the meantime.
+ * Only push, look up and delete entries until then.
+ **/
+void playlist_push_bulk_begin(playlist_t *playlist);
+
+/**
+ * playlist_push_bulk_end:
+ * @playlist        	   : Playlist handle.
+ *
+ * Puts the entries pushed since playlist_push_bulk_begin()
+ * at the top of the playlist, in the order separate calls
+ * to playlist_push() would have, and trims the playlist
+ * to its capacity.
+ **/
+void playlist_push_bulk_end(playlist_t *playlist);
+
 bool playlist_push_runtime(playlist_t *playlist,
       const struct playlist_entry *entry);
 
@@ -321,6 +347,11 @@ void playlist_write_file(playlist_t *playlist);
 
 void playlist_write_runtime_file(playlist_t *playlist);
 
+/* Deletes the binary cache of the playlist
+ * file at 'path', if any (see 'binary_cache'
+ * in playlist_config_t) */
+void playlist_delete_cache_file(const char *path);
+
 void playlist_qsort(playlist_t *playlist);
 
 void playlist_free_cached(void);
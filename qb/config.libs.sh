@@ -442,6 +442,7 @@ check_enabled 'OPENGL OPENGLES OPENGLES3' GLSL GLSL \
 check_enabled ZLIB BUILTINZLIB 'builtin zlib' 'zlib is' true
 
 check_val '' ZLIB '-lz' '' zlib '' '' false
+check_val '' ZSTD -lzstd '' libzstd '' '' false
 check_val '' MPV -lmpv '' mpv '' '' false
 
 check_header '' DRMINGW exchndl.h
@@ -705,6 +706,8 @@ if [ "$HAVE_DEBUG" = 'yes' ]; then
 fi
 
 check_enabled 'ZLIB BUILTINZLIB' RPNG RPNG 'zlib is' false
+check_enabled 'ZLIB BUILTINZLIB' NETWORK_VIDEO_STREAM 'network video stream' 'zlib is' false
+check_enabled NETWORK_VIDEO NETWORK_VIDEO_STREAM 'network video stream' 'The network video driver is' true
 check_enabled V4L2 VIDEOPROCESSOR 'video processor' 'Video4linux2 is' true
 
 if [ "$HAVE_CXX11" = 'yes' ]; then
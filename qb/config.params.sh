@@ -111,6 +111,7 @@ HAVE_CG=auto               # Cg shader support
 HAVE_HLSL=no               # HLSL9 shader support (for Direct3D9)
 HAVE_BUILTINZLIB=auto      # Bake in zlib
 HAVE_ZLIB=auto             # zlib support (ZIP extract, PNG decoding/encoding)
+HAVE_ZSTD=auto             # zstd support (RZIP compression)
 HAVE_ALSA=auto             # ALSA support
 C89_ALSA=no
 HAVE_RPILED=auto           # RPI led support
@@ -193,6 +194,7 @@ C89_SPIRV_CROSS=no
 HAVE_METAL=no              # Metal support (macOS-only)
 C89_METAL=no
 HAVE_NETWORK_VIDEO=no
+HAVE_NETWORK_VIDEO_STREAM=auto # Deflated network video stream (requires zlib)
 HAVE_STEAM=no              # Enable Steam build
 HAVE_MIST=no               # Enable Steam build w/ mist
 HAVE_ODROIDGO2=no          # ODROID-GO Advance rotation support (requires librga)
@@ -131,11 +131,16 @@
 
 #ifdef HAVE_NETWORKING
 #include <net/net_compat.h>
+#include <net/net_http.h>
 #include <net/net_socket.h>
 #endif
 
 #include <audio/audio_resampler.h>
 
+#ifdef HAVE_ZLIB
+#include <streams/rzip_stream.h>
+#endif
+
 #include "audio/audio_driver.h"
 
 #ifdef HAVE_GFX_WIDGETS
@@ -3787,6 +3792,7 @@ bool command_event(enum event_command cmd, void *data)
          {
             bool rewind_enable        = settings->bools.rewind_enable;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
+            bool rewind_compress      = settings->bools.rewind_compress_history;
             bool core_type_is_dummy   = runloop_st->current_core_type == CORE_TYPE_DUMMY;
 
             if (core_type_is_dummy)
@@ -3809,7 +3815,7 @@ bool command_event(enum event_command cmd, void *data)
 #endif
                {
                   state_manager_event_init(&runloop_st->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size, rewind_compress);
                }
             }
          }
@@ -4093,6 +4099,7 @@ bool command_event(enum event_command cmd, void *data)
             playlist_config.old_format             = settings->bools.playlist_use_old_format;
             playlist_config.compress               = settings->bools.playlist_compression;
             playlist_config.fuzzy_archive_match    = settings->bools.playlist_fuzzy_archive_match;
+            playlist_config.binary_cache           = settings->bools.playlist_binary_cache;
             /* don't use relative paths for content, music, video, and image histories */
             playlist_config_set_base_content_directory(&playlist_config, NULL);
 
@@ -4486,6 +4493,7 @@ bool command_event(enum event_command cmd, void *data)
                   playlist_config.old_format          = settings->bools.playlist_use_old_format;
                   playlist_config.compress            = settings->bools.playlist_compression;
                   playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+                  playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
                   playlist_config_set_base_content_directory(&playlist_config,
                         settings->bools.playlist_portable_paths
                         ? settings->paths.directory_menu_content
@@ -5799,6 +5807,12 @@ void main_exit(void *args)
    retroarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+#ifdef HAVE_NETWORKING
+   net_http_pool_deinit();
+#endif
+#ifdef HAVE_ZLIB
+   rzipstream_deinit_pool();
+#endif
 
    ui_companion_driver_deinit();
    retroarch_config_deinit();
@@ -6928,6 +6942,7 @@ static bool retroarch_parse_input_and_config(
             settings->bools.log_to_file,
             settings->bools.log_to_file_timestamp,
             settings->paths.log_dir);
+   verbosity_set_async(settings->bools.log_async);
 
    /* Second pass: All other arguments override the config file */
    optind = 1;
@@ -7569,6 +7584,12 @@ bool retroarch_main_init(int argc, char *argv[])
 
    retroarch_validate_cpu_features();
    retroarch_init_task_queue();
+#ifdef HAVE_NETWORKING
+   net_http_pool_init();
+#endif
+#ifdef HAVE_ZLIB
+   rzipstream_init_pool();
+#endif
 
    {
       const char    *fullpath  = path_get(RARCH_PATH_CONTENT);
@@ -8394,6 +8415,7 @@ void retroarch_favorites_init(void)
    playlist_config.old_format          = settings ? settings->bools.playlist_use_old_format : false;
    playlist_config.compress            = settings ? settings->bools.playlist_compression : false;
    playlist_config.fuzzy_archive_match = settings ? settings->bools.playlist_fuzzy_archive_match : false;
+   playlist_config.binary_cache        = settings ? settings->bools.playlist_binary_cache : false;
    playlist_config_set_base_content_directory(&playlist_config, NULL);
 
    if (!settings)
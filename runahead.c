@@ -17,12 +17,14 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
 #include <encodings/utf.h>
+#include <retro_miscellaneous.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <time/rtime.h>
@@ -34,9 +36,20 @@
 #include "audio/audio_driver.h"
 #include "gfx/video_driver.h"
 #include "paths.h"
+#include "performance_counters.h"
 #include "runloop.h"
 #include "verbosity.h"
 
+/* Granularity of the dirty page statistics */
+#define RUNAHEAD_PAGE_SIZE 4096
+
+/* Only registered when performance counters are enabled */
+static struct retro_perf_counter runahead_save_perf  = {0};
+static struct retro_perf_counter runahead_load_perf  = {0};
+
+/* Only counted while the statistics are shown */
+static runahead_state_stats_t runahead_state_stats;
+
 static int16_t input_state_get_last(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
@@ -1046,11 +1059,84 @@ static bool runahead_create(runloop_state_t *runloop_st)
    runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
    if (runloop_st->runahead_save_state_list)
       mylist_resize(runloop_st->runahead_save_state_list, 1, true);
+
+   runahead_state_stats.dirty_bytes = 0;
+   runahead_state_stats.total_bytes = 0;
+   runahead_state_stats.frames      = 0;
+
+   performance_counter_init(runahead_save_perf,  "runahead_save_state");
+   performance_counter_init(runahead_load_perf,  "runahead_load_state");
+   return true;
+}
+
+/* Compares the state just saved with the previous one in
+ * pages. Clean pages are the bytes a page-granular snapshot
+ * would not have had to copy. The previous state is kept
+ * as a second entry of the save state list. */
+static void runahead_count_dirty_pages(runloop_state_t *runloop_st)
+{
+   size_t i;
+   size_t dirty                     = 0;
+   bool first                       = false;
+   const retro_ctx_serialize_info_t *cur;
+   retro_ctx_serialize_info_t *prev;
+   const uint8_t *cur_data;
+   uint8_t *prev_data;
+
+   /* Nothing to compare against yet */
+   if (runloop_st->runahead_save_state_list->size < 2)
+   {
+      mylist_resize(runloop_st->runahead_save_state_list, 2, true);
+      runahead_state_stats.dirty_bytes = 0;
+      runahead_state_stats.total_bytes = 0;
+      runahead_state_stats.frames      = 0;
+      first                            = true;
+   }
+
+   cur       = (const retro_ctx_serialize_info_t*)
+      runloop_st->runahead_save_state_list->data[0];
+   prev      = (retro_ctx_serialize_info_t*)
+      runloop_st->runahead_save_state_list->data[1];
+   cur_data  = (const uint8_t*)cur->data_const;
+   prev_data = (uint8_t*)prev->data;
+
+   if (!cur_data || !prev_data || cur->size != prev->size)
+      return;
+
+   if (first)
+   {
+      memcpy(prev_data, cur_data, cur->size);
+      return;
+   }
+
+   for (i = 0; i < cur->size; i += RUNAHEAD_PAGE_SIZE)
+   {
+      size_t len = MIN(RUNAHEAD_PAGE_SIZE, cur->size - i);
+
+      if (memcmp(cur_data + i, prev_data + i, len))
+      {
+         memcpy(prev_data + i, cur_data + i, len);
+         dirty += len;
+      }
+   }
+
+   runahead_state_stats.dirty_bytes += dirty;
+   runahead_state_stats.total_bytes += cur->size;
+   runahead_state_stats.frames++;
+}
+
+bool runahead_get_state_stats(runahead_state_stats_t *stats)
+{
+   if (!runahead_state_stats.frames)
+      return false;
+
+   *stats = runahead_state_stats;
    return true;
 }
 
 static bool runahead_save_state(runloop_state_t *runloop_st)
 {
+   bool ret;
    retro_ctx_serialize_info_t *serialize_info;
 
    if (!runloop_st->runahead_save_state_list)
@@ -1059,8 +1145,23 @@ static bool runahead_save_state(runloop_state_t *runloop_st)
    serialize_info                  =
       (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
 
-   if (core_serialize_special(serialize_info))
+   performance_counter_start_plus(runloop_st->perfcnt_enable,
+         runahead_save_perf);
+   ret = core_serialize_special(serialize_info);
+   performance_counter_stop_plus(runloop_st->perfcnt_enable,
+         runahead_save_perf);
+
+   if (ret)
+   {
+      settings_t *settings = config_get_ptr();
+
+      if (settings->bools.video_statistics_show)
+         runahead_count_dirty_pages(runloop_st);
+      /* Start over once shown again */
+      else if (runloop_st->runahead_save_state_list->size > 1)
+         mylist_resize(runloop_st->runahead_save_state_list, 1, true);
       return true;
+   }
 
    runahead_error(runloop_st);
    return false;
@@ -1072,7 +1173,13 @@ static bool runahead_load_state(runloop_state_t *runloop_st)
       (retro_ctx_serialize_info_t*)
       runloop_st->runahead_save_state_list->data[0];
    bool last_dirty                            = (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY) ? true : false;
-   bool ret                                   = core_unserialize_special(serialize_info);
+   bool ret;
+
+   performance_counter_start_plus(runloop_st->perfcnt_enable,
+         runahead_load_perf);
+   ret                                        = core_unserialize_special(serialize_info);
+   performance_counter_stop_plus(runloop_st->perfcnt_enable,
+         runahead_load_perf);
    if (last_dirty)
       runloop_st->flags                      |=  RUNLOOP_FLAG_INPUT_IS_DIRTY;
    else
@@ -1087,12 +1194,19 @@ static bool runahead_load_state(runloop_state_t *runloop_st)
 #if HAVE_DYNAMIC
 static bool runahead_load_state_secondary(runloop_state_t *runloop_st, settings_t *settings)
 {
+   bool ret;
    retro_ctx_serialize_info_t *serialize_info =
       (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
 
-   if (!secondary_core_deserialize(runloop_st,
+   performance_counter_start_plus(runloop_st->perfcnt_enable,
+         runahead_load_perf);
+   ret = secondary_core_deserialize(runloop_st,
             settings, serialize_info->data_const,
-            serialize_info->size))
+            serialize_info->size);
+   performance_counter_stop_plus(runloop_st->perfcnt_enable,
+         runahead_load_perf);
+
+   if (!ret)
    {
       runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
       runahead_error(runloop_st);
@@ -64,6 +64,15 @@ typedef struct preemptive_frames_data
    uint8_t frames;
 } preempt_t;
 
+/* Run-ahead save state bytes that changed between frames,
+ * counted in whole pages, while the statistics are shown */
+typedef struct runahead_state_stats
+{
+   uint64_t dirty_bytes;
+   uint64_t total_bytes;
+   uint64_t frames;
+} runahead_state_stats_t;
+
 RETRO_BEGIN_DECLS
 
 typedef bool(*runahead_load_state_function)(const void*, size_t);
@@ -86,6 +95,14 @@ void runahead_set_load_content_info(
 
 void runahead_secondary_core_destroy(void *data);
 
+/**
+ * runahead_get_state_stats:
+ * @stats                : output statistics.
+ *
+ * Returns: true if any save state was compared yet.
+ **/
+bool runahead_get_state_stats(runahead_state_stats_t *stats);
+
 bool preempt_init(void *data);
 void preempt_deinit(void *data);
 
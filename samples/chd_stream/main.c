@@ -0,0 +1,370 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures sequential read throughput of CD tracks in a CHD,
+ * with the single hunk, synchronous loop chd_stream used before
+ * and with chdstream_read().
+ *
+ * Usage: chd_stream_bench [file.chd] [frames]
+ *
+ * Unless the file exists already, a v4 zlib CHD is written to
+ * it first (default /tmp/chd_stream_bench.chd, 20000 frames)
+ * with a MODE1_RAW data track and an AUDIO track of a fifth
+ * of its length, filled with pseudo random, compressible data.
+ * Each track is read sector by sector, once as is and once with
+ * a CRC32 of every sector, as database scanning does.
+ *
+ * Exits with 1 if a generated CHD reads back wrong. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <retro_common_api.h>
+#include <retro_endianness.h>
+#include <features/features_cpu.h>
+#include <streams/chd_stream.h>
+#include <libchdr/chd.h>
+
+#define BENCH_SECTOR_SIZE 2352
+#define BENCH_FRAME_SIZE  (BENCH_SECTOR_SIZE + 96)
+#define BENCH_HUNK_FRAMES 8
+#define BENCH_HUNK_SIZE   (BENCH_FRAME_SIZE * BENCH_HUNK_FRAMES)
+#define BENCH_MAP_ENTRY   16
+
+RETRO_BEGIN_DECLS
+void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap) { }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+RETRO_END_DECLS
+
+/* Data of frame @frame, so it can be checked without a copy */
+static void bench_fill_frame(uint8_t *data, uint32_t frame)
+{
+   unsigned i;
+   uint32_t state = frame * 2654435761u + 1;
+
+   for (i = 0; i < BENCH_FRAME_SIZE; i++)
+   {
+      state   = state * 1103515245 + 12345;
+      data[i] = (uint8_t)((state >> 16) & 0x3f);
+   }
+}
+
+static void bench_put32(uint8_t *p, uint32_t v)
+{
+   p[0] = (uint8_t)(v >> 24);
+   p[1] = (uint8_t)(v >> 16);
+   p[2] = (uint8_t)(v >> 8);
+   p[3] = (uint8_t)v;
+}
+
+static void bench_put64(uint8_t *p, uint64_t v)
+{
+   bench_put32(p,     (uint32_t)(v >> 32));
+   bench_put32(p + 4, (uint32_t)v);
+}
+
+static uint32_t bench_pad(uint32_t frames)
+{
+   return ((frames + 3) & ~3u) - frames;
+}
+
+static bool bench_write_chd(const char *path, uint32_t data_frames,
+      uint32_t audio_frames)
+{
+   static const char *types[] = { "MODE1_RAW", "AUDIO" };
+   uint8_t header[CHD_V4_HEADER_SIZE];
+   uint8_t hunk[BENCH_HUNK_SIZE];
+   uint8_t packed[BENCH_HUNK_SIZE];
+   uint32_t frames[2];
+   uint32_t total_frames, hunks, h, t;
+   uint64_t offset, metaoffset;
+   uint8_t *map;
+   FILE *fp;
+
+   frames[0]    = data_frames;
+   frames[1]    = audio_frames;
+   total_frames = frames[0] + bench_pad(frames[0])
+                + frames[1] + bench_pad(frames[1]);
+   hunks        = (total_frames + BENCH_HUNK_FRAMES - 1) / BENCH_HUNK_FRAMES;
+
+   if (!(fp = fopen(path, "wb")))
+      return false;
+
+   map        = (uint8_t*)calloc(hunks + 1, BENCH_MAP_ENTRY);
+   metaoffset = CHD_V4_HEADER_SIZE + (uint64_t)(hunks + 1) * BENCH_MAP_ENTRY;
+   offset     = metaoffset;
+
+   /* Track metadata, one chained entry per track */
+   fseek(fp, (long)metaoffset, SEEK_SET);
+   for (t = 0; t < 2; t++)
+   {
+      char meta[256];
+      uint8_t entry[16];
+      uint32_t len = (uint32_t)snprintf(meta, sizeof(meta),
+            CDROM_TRACK_METADATA2_FORMAT, t + 1, types[t], "NONE",
+            frames[t], 0, t ? "AUDIO" : "MODE1", "NONE", 0) + 1;
+
+      bench_put32(entry,     CDROM_TRACK_METADATA2_TAG);
+      bench_put32(entry + 4, len | (CHD_MDFLAGS_CHECKSUM << 24));
+      bench_put64(entry + 8, t ? 0 : offset + sizeof(entry) + len);
+      fwrite(entry, 1, sizeof(entry), fp);
+      fwrite(meta, 1, len, fp);
+      offset += sizeof(entry) + len;
+   }
+
+   /* Hunks, deflated unless that doesn't make them smaller */
+   for (h = 0; h < hunks; h++)
+   {
+      unsigned i;
+      z_stream z;
+      uint8_t *entry = map + (size_t)h * BENCH_MAP_ENTRY;
+      uint32_t len;
+
+      for (i = 0; i < BENCH_HUNK_FRAMES; i++)
+         bench_fill_frame(hunk + i * BENCH_FRAME_SIZE,
+               h * BENCH_HUNK_FRAMES + i);
+
+      memset(&z, 0, sizeof(z));
+      deflateInit2(&z, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+      z.next_in   = hunk;
+      z.avail_in  = sizeof(hunk);
+      z.next_out  = packed;
+      z.avail_out = sizeof(packed);
+
+      if (deflate(&z, Z_FINISH) == Z_STREAM_END && z.total_out < sizeof(hunk))
+      {
+         len       = (uint32_t)z.total_out;
+         fwrite(packed, 1, len, fp);
+         entry[15] = 0x10 | 1; /* no CRC, compressed */
+      }
+      else
+      {
+         len       = sizeof(hunk);
+         fwrite(hunk, 1, len, fp);
+         entry[15] = 0x10 | 2; /* no CRC, uncompressed */
+      }
+      deflateEnd(&z);
+
+      bench_put64(entry, offset);
+      entry[12] = (uint8_t)(len >> 8);
+      entry[13] = (uint8_t)len;
+      entry[14] = (uint8_t)(len >> 16);
+      offset   += len;
+   }
+   memcpy(map + (size_t)hunks * BENCH_MAP_ENTRY, "EndOfListCookie", 16);
+
+   memset(header, 0, sizeof(header));
+   memcpy(header, "MComprHD", 8);
+   bench_put32(header + 8,  CHD_V4_HEADER_SIZE);
+   bench_put32(header + 12, 4);
+   bench_put32(header + 20, CHDCOMPRESSION_ZLIB);
+   bench_put32(header + 24, hunks);
+   bench_put64(header + 28, (uint64_t)hunks * BENCH_HUNK_SIZE);
+   bench_put64(header + 36, metaoffset);
+   bench_put32(header + 44, BENCH_HUNK_SIZE);
+
+   fseek(fp, 0, SEEK_SET);
+   fwrite(header, 1, sizeof(header), fp);
+   fwrite(map, BENCH_MAP_ENTRY, hunks + 1, fp);
+   free(map);
+
+   return fclose(fp) == 0;
+}
+
+/* The read loop chd_stream had before: one hunk,
+ * decoded on the reading thread, swapped a word at a time.
+ * Only handles tracks without pregap, as generated here. */
+static uint32_t bench_read_old(const char *path, uint32_t first_frame,
+      uint32_t frames, bool swab, bool crc, uint8_t *out)
+{
+   uint8_t hunk[BENCH_HUNK_SIZE];
+   uint32_t f;
+   int32_t hunknum = -1;
+   uint32_t sum    = 0;
+   chd_file *chd   = NULL;
+
+   if (chd_open(path, CHD_OPEN_READ, NULL, &chd) != CHDERR_NONE)
+      return 0;
+
+   for (f = 0; f < frames; f++)
+   {
+      uint32_t frame = first_frame + f;
+      uint8_t *dst   = out + (size_t)f * BENCH_SECTOR_SIZE;
+
+      if ((int32_t)(frame / BENCH_HUNK_FRAMES) != hunknum)
+      {
+         hunknum = frame / BENCH_HUNK_FRAMES;
+         chd_read(chd, hunknum, hunk);
+         if (swab)
+         {
+            uint32_t i;
+            uint16_t *array = (uint16_t*)hunk;
+            for (i = 0; i < BENCH_HUNK_SIZE / 2; i++)
+               array[i] = SWAP16(array[i]);
+         }
+      }
+
+      memcpy(dst, hunk + (frame % BENCH_HUNK_FRAMES) * BENCH_FRAME_SIZE,
+            BENCH_SECTOR_SIZE);
+      if (crc)
+         sum = (uint32_t)crc32(sum, dst, BENCH_SECTOR_SIZE);
+   }
+
+   chd_close(chd);
+   return sum;
+}
+
+static uint32_t bench_read_new(const char *path, int32_t track,
+      uint32_t frames, bool crc, uint8_t *out)
+{
+   uint32_t f;
+   uint32_t sum        = 0;
+   chdstream_t *stream = chdstream_open(path, track);
+
+   if (!stream)
+      return 0;
+
+   for (f = 0; f < frames; f++)
+   {
+      uint8_t *dst = out + (size_t)f * BENCH_SECTOR_SIZE;
+      if (chdstream_read(stream, dst, BENCH_SECTOR_SIZE) != BENCH_SECTOR_SIZE)
+         break;
+      if (crc)
+         sum = (uint32_t)crc32(sum, dst, BENCH_SECTOR_SIZE);
+   }
+
+   chdstream_close(stream);
+   return sum;
+}
+
+static bool bench_verify(const uint8_t *out, uint32_t first_frame,
+      uint32_t frames, bool swab)
+{
+   uint8_t frame[BENCH_FRAME_SIZE];
+   uint32_t f;
+
+   for (f = 0; f < frames; f++)
+   {
+      bench_fill_frame(frame, first_frame + f);
+      if (swab)
+      {
+         unsigned i;
+         for (i = 0; i < BENCH_SECTOR_SIZE; i += 2)
+         {
+            uint8_t tmp  = frame[i];
+            frame[i]     = frame[i + 1];
+            frame[i + 1] = tmp;
+         }
+      }
+      if (memcmp(out + (size_t)f * BENCH_SECTOR_SIZE, frame,
+               BENCH_SECTOR_SIZE))
+         return false;
+   }
+
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned t;
+   uint32_t frames[2];
+   bool generated   = false;
+   bool ok          = true;
+   const char *path = argc > 1 ? argv[1] : "/tmp/chd_stream_bench.chd";
+   uint32_t length  = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 20000;
+   FILE *fp         = fopen(path, "rb");
+
+   if (fp)
+      fclose(fp);
+   else
+   {
+      printf("Writing %s...\n", path);
+      if (!bench_write_chd(path, length, length / 5))
+      {
+         fprintf(stderr, "Could not write %s.\n", path);
+         return 1;
+      }
+      generated = true;
+   }
+
+   frames[0] = length;
+   frames[1] = length / 5;
+
+   for (t = 0; t < 2; t++)
+   {
+      unsigned crc;
+      chdstream_t *stream = chdstream_open(path, t + 1);
+      uint32_t first_frame;
+      uint8_t *out;
+      bool swab;
+
+      if (!stream)
+      {
+         fprintf(stderr, "Could not open track %u of %s.\n", t + 1, path);
+         return 1;
+      }
+      frames[t]   = (uint32_t)(chdstream_get_size(stream) / BENCH_SECTOR_SIZE);
+      swab        = chdstream_get_frame_size(stream) == BENCH_SECTOR_SIZE
+                  && t == 1;
+      chdstream_close(stream);
+
+      first_frame = t ? frames[0] + bench_pad(frames[0]) : 0;
+      out         = (uint8_t*)malloc((size_t)frames[t] * BENCH_SECTOR_SIZE);
+
+      for (crc = 0; crc < 2; crc++)
+      {
+         retro_time_t start;
+         double old_secs, new_secs;
+         uint32_t old_sum, new_sum;
+         double mb = (double)frames[t] * BENCH_SECTOR_SIZE / (1024 * 1024);
+
+         start    = cpu_features_get_time_usec();
+         old_sum  = bench_read_old(path, first_frame, frames[t], swab,
+               crc != 0, out);
+         old_secs = (cpu_features_get_time_usec() - start) / 1000000.0;
+         if (generated && !bench_verify(out, first_frame, frames[t], swab))
+            ok    = false;
+
+         memset(out, 0, (size_t)frames[t] * BENCH_SECTOR_SIZE);
+
+         start    = cpu_features_get_time_usec();
+         new_sum  = bench_read_new(path, t + 1, frames[t], crc != 0, out);
+         new_secs = (cpu_features_get_time_usec() - start) / 1000000.0;
+         if (generated && !bench_verify(out, first_frame, frames[t], swab))
+            ok    = false;
+         if (old_sum != new_sum)
+            ok    = false;
+
+         printf("track %u %-9s %s: %7.1f MB/s before, %7.1f MB/s after (%.2fx)\n",
+               t + 1, t ? "AUDIO" : "MODE1_RAW", crc ? "read+crc" : "read    ",
+               mb / old_secs, mb / new_secs, old_secs / new_secs);
+      }
+
+      free(out);
+   }
+
+   if (!ok)
+   {
+      fprintf(stderr, "Read back data doesn't match.\n");
+      return 1;
+   }
+
+   return 0;
+}
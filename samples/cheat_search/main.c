@@ -0,0 +1,394 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs cheat searches over synthetic memory with the search
+ * loop the cheat manager used before (one item at a time,
+ * one byte of matches per item) and with cheat_search_refine().
+ *
+ * Usage: cheat_search_bench [megabytes]
+ *
+ * The memory (default 32 MB) is split in three regions of odd
+ * sizes, so some items straddle two of them. Every item size,
+ * search type and byte order is run for three steps, changing
+ * part of the memory between steps, and the candidates of both
+ * are compared after each step.
+ *
+ * Exits with 1 if the two ever disagree. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+
+#include "../../cheat_search.h"
+
+#define BENCH_REGIONS 3
+#define BENCH_STEPS   3
+
+typedef struct bench_memory
+{
+   uint8_t *data;                  /* All regions, back to back */
+   uint8_t *prev;
+   uint8_t *bufs[BENCH_REGIONS];
+   unsigned sizes[BENCH_REGIONS];
+   unsigned total;
+} bench_memory_t;
+
+static const char *type_names[] = {
+   "EXACT", "LT", "LTE", "GT", "GTE", "EQ", "NEQ", "EQPLUS", "EQMINUS"
+};
+
+static uint32_t bench_rand_state = 12345;
+
+static uint32_t bench_rand(void)
+{
+   bench_rand_state = bench_rand_state * 1103515245 + 12345;
+   return bench_rand_state >> 8;
+}
+
+static void bench_setup_meta(unsigned bit_size, unsigned *bytes_per_item,
+      unsigned *mask, unsigned *bits)
+{
+   *bytes_per_item = (bit_size == 5) ? 4 : (bit_size == 4) ? 2 : 1;
+   *bits           = (bit_size < 3) ? (1 << bit_size) : 8;
+   *mask           = (bit_size == 5) ? 0xFFFFFFFF
+                   : (bit_size == 4) ? 0xFFFF
+                   : (bit_size == 3) ? 0xFF : (1U << *bits) - 1;
+}
+
+static unsigned bench_translate_address(const bench_memory_t *mem,
+      unsigned address, unsigned char **curr)
+{
+   unsigned i;
+   unsigned offset = 0;
+
+   for (i = 0; i < BENCH_REGIONS; i++)
+   {
+      if (address >= offset && address < offset + mem->sizes[i])
+      {
+         *curr = mem->bufs[i];
+         break;
+      }
+      offset += mem->sizes[i];
+   }
+
+   return offset;
+}
+
+/* The search loop from cheat_manager.c before
+ * cheat_search_refine(), as it was */
+static unsigned bench_reference_search(const bench_memory_t *mem,
+      uint8_t *matches, unsigned num_matches, unsigned bit_size,
+      bool big_endian, enum cheat_search_type search_type, unsigned value)
+{
+   unsigned idx, mask, bytes_per_item, bits;
+   unsigned char *curr = mem->bufs[0];
+   unsigned char *prev = mem->prev;
+
+   bench_setup_meta(bit_size, &bytes_per_item, &mask, &bits);
+
+   for (idx = 0; idx < mem->total; idx = idx + bytes_per_item)
+   {
+      unsigned byte_part;
+      unsigned curr_val, prev_val;
+      unsigned offset = bench_translate_address(mem, idx, &curr);
+
+      switch (bytes_per_item)
+      {
+         case 2:
+            curr_val = big_endian ?
+               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
+               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
+            prev_val = big_endian ?
+               (*(prev + idx) * 256) + *(prev + idx + 1) :
+               *(prev + idx) + (*(prev + idx + 1) * 256);
+            break;
+         case 4:
+            curr_val = big_endian ?
+               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
+               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
+            prev_val = big_endian ?
+               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
+               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
+            break;
+         default:
+            curr_val = *(curr - offset + idx);
+            prev_val = *(prev + idx);
+            break;
+      }
+
+      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      {
+         unsigned curr_subval = (curr_val >> (byte_part * bits)) & mask;
+         unsigned prev_subval = (prev_val >> (byte_part * bits)) & mask;
+         unsigned prev_match  = (bits < 8)
+            ? matches[idx] & (mask << (byte_part * bits))
+            : matches[idx];
+
+         if (prev_match > 0)
+         {
+            bool match = false;
+            switch (search_type)
+            {
+               case CHEAT_SEARCH_TYPE_EXACT:
+                  match = (curr_subval == value);
+                  break;
+               case CHEAT_SEARCH_TYPE_LT:
+                  match = (curr_subval < prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_GT:
+                  match = (curr_subval > prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_LTE:
+                  match = (curr_subval <= prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_GTE:
+                  match = (curr_subval >= prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_EQ:
+                  match = (curr_subval == prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_NEQ:
+                  match = (curr_subval != prev_subval);
+                  break;
+               case CHEAT_SEARCH_TYPE_EQPLUS:
+                  match = (curr_subval == prev_subval + value);
+                  break;
+               case CHEAT_SEARCH_TYPE_EQMINUS:
+                  match = (curr_subval == prev_subval - value);
+                  break;
+            }
+
+            if (!match)
+            {
+               if (bits < 8)
+                  matches[idx] = matches[idx] &
+                     ((~(mask << (byte_part * bits))) & 0xFF);
+               else
+                  memset(matches + idx, 0, bytes_per_item);
+               if (num_matches > 0)
+                  num_matches--;
+            }
+         }
+      }
+   }
+
+   return num_matches;
+}
+
+/* Changes a few items the way a running game would:
+ * counters going up and down, the odd new value */
+static void bench_step(bench_memory_t *mem)
+{
+   unsigned i;
+   unsigned changes = mem->total / 64;
+
+   memcpy(mem->prev, mem->data, mem->total);
+
+   for (i = 0; i < changes; i++)
+   {
+      unsigned addr = bench_rand() % mem->total;
+      switch (bench_rand() % 4)
+      {
+         case 0:
+            mem->data[addr]++;
+            break;
+         case 1:
+            mem->data[addr]--;
+            break;
+         case 2:
+            mem->data[addr] += 0x10;
+            break;
+         default:
+            mem->data[addr] = (uint8_t)bench_rand();
+            break;
+      }
+   }
+}
+
+/* Compares the byte-per-item matches of the old loop
+ * with the candidate set, item by item */
+static bool bench_compare(const uint8_t *old_matches, const uint8_t *matches,
+      size_t num_items, unsigned bit_size)
+{
+   size_t item;
+   unsigned mask, bytes_per_item, bits;
+
+   bench_setup_meta(bit_size, &bytes_per_item, &mask, &bits);
+
+   for (item = 0; item < num_items; item++)
+   {
+      unsigned per_byte  = 8 / bits;
+      size_t idx         = (item / per_byte) * bytes_per_item;
+      unsigned byte_part = (unsigned)(item % per_byte);
+      bool old_match     = (bits < 8)
+         ? (old_matches[idx] & (mask << (byte_part * bits))) != 0
+         : old_matches[idx] != 0;
+      bool match         = (matches[item / 8] >> (item & 7)) & 1;
+
+      if (old_match != match)
+      {
+         printf("  item %u (address 0x%X) differs: was %d, now %d\n",
+               (unsigned)item, (unsigned)idx, old_match, match);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static unsigned bench_value(const bench_memory_t *mem,
+      unsigned bit_size, enum cheat_search_type type)
+{
+   unsigned mask, bytes_per_item, bits;
+
+   bench_setup_meta(bit_size, &bytes_per_item, &mask, &bits);
+
+   switch (type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         /* Something that is in memory */
+         return mem->data[bench_rand() % mem->total] & mask;
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         return (bits == 1) ? 1 : (bench_rand() % 2) ? 1 : 0x10 & mask;
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned bit_size, type, step;
+   bench_memory_t mem;
+   uint8_t *old_matches, *matches, *data_copy;
+   double old_time   = 0.0;
+   double new_time   = 0.0;
+   unsigned failures = 0;
+   unsigned mb       = 32;
+
+   if (argc > 1)
+      mb = (unsigned)strtoul(argv[1], NULL, 10);
+   if (!mb)
+      return 1;
+
+   mem.total    = mb * 1024 * 1024;
+   mem.sizes[0] = mem.total / 2 + 1;
+   mem.sizes[1] = mem.total / 4 + 2;
+   mem.sizes[2] = mem.total - mem.sizes[0] - mem.sizes[1];
+   /* Padding for the old loop reading past the last item */
+   mem.data     = (uint8_t*)calloc(mem.total + 4, 1);
+   mem.prev     = (uint8_t*)calloc(mem.total + 4, 1);
+   data_copy    = (uint8_t*)malloc(mem.total);
+   old_matches  = (uint8_t*)malloc(mem.total + 4);
+   matches      = (uint8_t*)malloc(cheat_search_matches_size(
+            cheat_search_num_items(mem.total, 0)));
+
+   if (!mem.data || !mem.prev || !data_copy || !old_matches || !matches)
+      return 1;
+
+   mem.bufs[0]  = mem.data;
+   mem.bufs[1]  = mem.data + mem.sizes[0];
+   mem.bufs[2]  = mem.bufs[1] + mem.sizes[1];
+
+   /* Mostly zeroes and small values, like game RAM */
+   for (step = 0; step < mem.total; step++)
+      mem.data[step] = (bench_rand() % 3) ? 0 : (uint8_t)(bench_rand() % 8);
+   memcpy(data_copy, mem.data, mem.total);
+
+   printf("Searching %u MB, %u cores\n\n", mb,
+         cpu_features_get_core_amount());
+   printf("%-8s %-7s %-3s %12s %12s %8s\n",
+         "Items", "Type", "BE", "Old (ms)", "New (ms)", "Matches");
+
+   for (bit_size = 0; bit_size <= 5; bit_size++)
+   {
+      unsigned big_endian;
+      size_t num_items = cheat_search_num_items(mem.total, bit_size);
+
+      for (big_endian = 0; big_endian < ((bit_size >= 4) ? 2U : 1U); big_endian++)
+      {
+         for (type = CHEAT_SEARCH_TYPE_EXACT; type <= CHEAT_SEARCH_TYPE_EQMINUS; type++)
+         {
+            double old_ms    = 0.0;
+            double new_ms    = 0.0;
+            unsigned old_num = (unsigned)num_items;
+            size_t num       = num_items;
+            bool ok          = true;
+
+            memcpy(mem.data, data_copy, mem.total);
+            memset(old_matches, 0xFF, mem.total);
+            cheat_search_reset(matches, num_items);
+
+            for (step = 0; step < BENCH_STEPS; step++)
+            {
+               retro_time_t t;
+               unsigned value = bench_value(&mem, bit_size,
+                     (enum cheat_search_type)type);
+
+               bench_step(&mem);
+
+               t        = cpu_features_get_time_usec();
+               old_num  = bench_reference_search(&mem, old_matches,
+                     old_num, bit_size, big_endian != 0,
+                     (enum cheat_search_type)type, value);
+               old_ms  += (cpu_features_get_time_usec() - t) / 1000.0;
+
+               t        = cpu_features_get_time_usec();
+               num      = cheat_search_refine(matches, mem.bufs, mem.sizes,
+                     BENCH_REGIONS, mem.prev, bit_size, big_endian != 0,
+                     (enum cheat_search_type)type, value);
+               new_ms  += (cpu_features_get_time_usec() - t) / 1000.0;
+
+               if (     num != old_num
+                     || !bench_compare(old_matches, matches,
+                        num_items, bit_size))
+               {
+                  printf("  step %u: %u matches, was %u\n",
+                        step, (unsigned)num, old_num);
+                  ok = false;
+                  break;
+               }
+            }
+
+            printf("%2u bit%s   %-7s %-3s %12.2f %12.2f %8u%s\n",
+                  1 << bit_size, bit_size ? "s" : " ", type_names[type],
+                  big_endian ? "yes" : "no", old_ms, new_ms,
+                  (unsigned)num, ok ? "" : "  MISMATCH");
+            old_time += old_ms;
+            new_time += new_ms;
+            if (!ok)
+               failures++;
+         }
+      }
+   }
+
+   printf("\nTotal: %.0f ms before, %.0f ms now (%.1fx)\n",
+         old_time, new_time, new_time > 0 ? old_time / new_time : 0.0);
+   if (failures)
+      printf("MISMATCH: %u searches differ\n", failures);
+
+   free(mem.data);
+   free(mem.prev);
+   free(data_copy);
+   free(old_matches);
+   free(matches);
+
+   return failures ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Logs from several threads at once to a file, first
+ * writing on the calling threads and then through the
+ * asynchronous writer thread, and prints how long the
+ * logging calls took.
+ *
+ * Usage: log_bench [threads] [messages per thread]
+ *
+ * Defaults to 4 threads of 20000 messages each.
+ *
+ * Exits with 1 if, with asynchronous logging, a message
+ * is neither in the file nor counted as dropped, or if
+ * the messages of a thread are out of order. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+
+#include "../../verbosity.h"
+
+#define BENCH_LOG_PATH    "log_bench.log"
+#define BENCH_MAX_THREADS 64
+
+struct bench_thread
+{
+   sthread_t *thread;
+   unsigned index;
+   unsigned count;
+   retro_time_t total;
+   retro_time_t worst;
+};
+
+static void bench_thread(void *data)
+{
+   unsigned i;
+   struct bench_thread *t = (struct bench_thread*)data;
+
+   for (i = 0; i < t->count; i++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      retro_time_t time;
+
+      RARCH_LOG("[Bench] Thread %u message %u, with some padding "
+            "to make it about as long as a real one.\n", t->index, i);
+
+      time     = cpu_features_get_time_usec() - start;
+      t->total += time;
+      if (time > t->worst)
+         t->worst = time;
+   }
+}
+
+/* Counts the messages in the log. Returns false if
+ * those of a thread are out of order. */
+static bool bench_check(unsigned threads, unsigned *found,
+      unsigned *dropped)
+{
+   char line[256];
+   unsigned next[BENCH_MAX_THREADS];
+   bool ok  = true;
+   FILE *fp = fopen(BENCH_LOG_PATH, "r");
+
+   *found   = 0;
+   *dropped = 0;
+   memset(next, 0, sizeof(next));
+
+   if (!fp)
+      return false;
+
+   while (fgets(line, sizeof(line), fp))
+   {
+      unsigned index, i;
+
+      if (sscanf(line, "[INFO] [Bench] Thread %u message %u", &index, &i) == 2)
+      {
+         if (index >= threads || i < next[index])
+            ok = false;
+         else
+            next[index] = i + 1;
+         (*found)++;
+      }
+      else if (sscanf(line, "[WARN] Log queue full, dropped %u", &i) == 1)
+         *dropped += i;
+   }
+
+   fclose(fp);
+   return ok;
+}
+
+static bool bench_run(unsigned threads, unsigned count, bool async)
+{
+   unsigned i, found, dropped;
+   struct bench_thread t[BENCH_MAX_THREADS];
+   retro_time_t total = 0;
+   retro_time_t worst = 0;
+   retro_time_t start;
+   bool ok            = true;
+
+   retro_main_log_file_init(BENCH_LOG_PATH, false);
+   verbosity_set_async(async);
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < threads; i++)
+   {
+      t[i].index  = i;
+      t[i].count  = count;
+      t[i].total  = 0;
+      t[i].worst  = 0;
+      t[i].thread = sthread_create(bench_thread, &t[i]);
+   }
+   for (i = 0; i < threads; i++)
+   {
+      sthread_join(t[i].thread);
+      total += t[i].total;
+      if (t[i].worst > worst)
+         worst = t[i].worst;
+   }
+
+   verbosity_set_async(false);
+   retro_main_log_file_deinit();
+
+   printf("%-5s %8.3f us per message, worst %6u us, %7.1f ms in all",
+         async ? "async" : "sync",
+         (double)total / (threads * count), (unsigned)worst,
+         (cpu_features_get_time_usec() - start) / 1000.0);
+
+   /* Lines can get mixed up when several threads
+    * write at once, so only the queue is checked */
+   if (async)
+   {
+      ok = bench_check(threads, &found, &dropped);
+      printf(", %u written, %u dropped", found, dropped);
+      if (found + dropped != threads * count)
+         ok = false;
+   }
+   printf("\n");
+
+   remove(BENCH_LOG_PATH);
+   return ok;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned threads = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 4;
+   unsigned count   = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 20000;
+   bool ok          = true;
+
+   threads          = MIN(MAX(threads, 1), BENCH_MAX_THREADS);
+
+   verbosity_enable();
+   verbosity_set_log_level(0);
+
+   printf("%u threads, %u messages each\n", threads, count);
+   ok = bench_run(threads, count, false) && ok;
+   ok = bench_run(threads, count, true)  && ok;
+
+   if (!ok)
+   {
+      fprintf(stderr, "Messages are missing or out of order.\n");
+      return 1;
+   }
+
+   return 0;
+}
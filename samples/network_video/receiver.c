@@ -0,0 +1,372 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Reference receiver for the streaming mode of the network
+ * video driver (see gfx/common/network_video_stream.h).
+ *
+ * Usage: network_video_receiver [port] [frame.ppm]
+ *
+ * Waits for the driver to connect on [port] (default 4953),
+ * rebuilds every frame from its tiles and checks it against
+ * the checksum the driver sent. Prints the frame rate and
+ * bandwidth once a second and, when the stream ends, saves
+ * the last frame to [frame.ppm] if given.
+ *
+ * Exits with 1 if any frame did not match its checksum. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <net/net_compat.h>
+#include <net/net_socket.h>
+#include <streams/trans_stream.h>
+
+#include "../../gfx/common/network_video_stream.h"
+
+#define DEFAULT_PORT 4953
+
+typedef struct receiver
+{
+   const struct trans_stream_backend *backend;
+   void *inflate;
+   uint32_t *frame;
+   uint8_t *packed;
+   uint8_t *payload;
+   size_t packed_size;
+   size_t payload_size;
+   unsigned width;
+   unsigned height;
+   unsigned frames;
+   unsigned keyframes;
+   unsigned mismatches;
+   unsigned dropped;
+   unsigned last_number;
+   uint64_t bytes;
+   uint64_t raw_bytes;
+   uint64_t tiles;
+} receiver_t;
+
+static uint16_t read_u16(const uint8_t *s)
+{
+   uint16_t v;
+   memcpy(&v, s, sizeof(v));
+   return retro_le_to_cpu16(v);
+}
+
+static uint32_t read_u32(const uint8_t *s)
+{
+   uint32_t v;
+   memcpy(&v, s, sizeof(v));
+   return retro_le_to_cpu32(v);
+}
+
+static bool reserve(uint8_t **buf, size_t *size, size_t needed)
+{
+   uint8_t *tmp;
+   if (*size >= needed)
+      return true;
+   if (!(tmp = (uint8_t*)realloc(*buf, needed)))
+      return false;
+   *buf  = tmp;
+   *size = needed;
+   return true;
+}
+
+static int listen_for_sender(uint16_t port)
+{
+   int fd, client;
+   struct addrinfo *addr = NULL;
+
+   if ((fd = socket_init((void**)&addr, port, NULL,
+               SOCKET_TYPE_STREAM, AF_INET)) < 0)
+      return -1;
+
+   if (!socket_bind(fd, addr) || listen(fd, 1) < 0)
+   {
+      freeaddrinfo_retro(addr);
+      socket_close(fd);
+      return -1;
+   }
+   freeaddrinfo_retro(addr);
+
+   printf("Listening on port %u...\n", (unsigned)port);
+   fflush(stdout);
+
+   client = accept(fd, NULL, NULL);
+   socket_close(fd);
+   return client;
+}
+
+static bool apply_tiles(receiver_t *rx, unsigned tile_size,
+      uint32_t tiles, size_t len)
+{
+   uint32_t i;
+   unsigned tiles_x  = (rx->width  + tile_size - 1) / tile_size;
+   unsigned tiles_y  = (rx->height + tile_size - 1) / tile_size;
+   const uint8_t *in = rx->payload;
+   const uint8_t *end = rx->payload + len;
+
+   for (i = 0; i < tiles; i++)
+   {
+      unsigned y, x0, y0, tw, th;
+      uint32_t index;
+
+      if (end - in < 4)
+         return false;
+      index = read_u32(in);
+      in   += 4;
+
+      if (index >= tiles_x * tiles_y)
+         return false;
+
+      x0 = (index % tiles_x) * tile_size;
+      y0 = (index / tiles_x) * tile_size;
+      tw = MIN(tile_size, rx->width  - x0);
+      th = MIN(tile_size, rx->height - y0);
+
+      if ((size_t)(end - in) < (size_t)tw * th * 4)
+         return false;
+
+      for (y = 0; y < th; y++)
+      {
+         unsigned x;
+         uint32_t *dst = rx->frame + (size_t)(y0 + y) * rx->width + x0;
+         for (x = 0; x < tw; x++, in += 4)
+            dst[x] = read_u32(in);
+      }
+   }
+
+   return in == end;
+}
+
+static uint32_t frame_crc32(const receiver_t *rx)
+{
+#ifdef MSB_FIRST
+   size_t i;
+   uint32_t crc = 0;
+   for (i = 0; i < (size_t)rx->width * rx->height; i++)
+   {
+      uint32_t px = retro_cpu_to_le32(rx->frame[i]);
+      crc         = encoding_crc32(crc, (const uint8_t*)&px, 4);
+   }
+   return crc;
+#else
+   return encoding_crc32(0, (const uint8_t*)rx->frame,
+         (size_t)rx->width * rx->height * 4);
+#endif
+}
+
+/* Returns false at the end of the stream or on a protocol error */
+static bool receive_frame(receiver_t *rx, int fd)
+{
+   uint8_t header[NETWORK_VIDEO_STREAM_HEADER_SIZE];
+   uint32_t packed_len, payload_len, tiles, number, crc;
+   unsigned width, height, tile_size, flags;
+
+   if (!socket_receive_all_blocking(fd, header, sizeof(header)))
+      return false;
+
+   packed_len  = read_u32(header +  0);
+   payload_len = read_u32(header +  4);
+   width       = read_u16(header +  8);
+   height      = read_u16(header + 10);
+   tile_size   = read_u16(header + 12);
+   flags       = read_u16(header + 14);
+   tiles       = read_u32(header + 16);
+   number      = read_u32(header + 20);
+   crc         = read_u32(header + 24);
+
+   if (!width || !height || !tile_size)
+   {
+      printf("Invalid frame header\n");
+      return false;
+   }
+
+   if (flags & NETWORK_VIDEO_STREAM_FLAG_KEYFRAME)
+   {
+      if (width != rx->width || height != rx->height)
+      {
+         uint32_t *tmp = (uint32_t*)realloc(rx->frame,
+               (size_t)width * height * 4);
+         if (!tmp)
+            return false;
+         rx->frame  = tmp;
+         rx->width  = width;
+         rx->height = height;
+         printf("Keyframe: %ux%u\n", width, height);
+      }
+      rx->keyframes++;
+   }
+   else if (!rx->frame || width != rx->width || height != rx->height)
+   {
+      printf("Delta frame without a keyframe\n");
+      return false;
+   }
+
+   if (     !reserve(&rx->packed,  &rx->packed_size,  packed_len)
+         || !reserve(&rx->payload, &rx->payload_size, payload_len))
+      return false;
+
+   if (packed_len && !socket_receive_all_blocking(fd,
+            rx->packed, packed_len))
+      return false;
+
+   if (payload_len)
+   {
+      uint32_t rd                 = 0;
+      uint32_t wn                 = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+      rx->backend->set_in(rx->inflate, rx->packed, packed_len);
+      rx->backend->set_out(rx->inflate, rx->payload, payload_len);
+
+      if (     !rx->backend->trans(rx->inflate, true, &rd, &wn, &err)
+            || wn != payload_len)
+      {
+         printf("Frame %u: could not inflate payload\n", number);
+         return false;
+      }
+   }
+
+   if (!apply_tiles(rx, tile_size, tiles, payload_len))
+   {
+      printf("Frame %u: malformed payload\n", number);
+      return false;
+   }
+
+   if (frame_crc32(rx) != crc)
+   {
+      printf("Frame %u: checksum mismatch\n", number);
+      rx->mismatches++;
+   }
+
+   if (rx->frames && number > rx->last_number + 1)
+      rx->dropped += number - rx->last_number - 1;
+   rx->last_number = number;
+   rx->frames++;
+   rx->tiles      += tiles;
+   rx->bytes      += sizeof(header) + packed_len;
+   rx->raw_bytes  += (uint64_t)width * height * 4;
+   return true;
+}
+
+static void save_ppm(const receiver_t *rx, const char *path)
+{
+   size_t i;
+   FILE *file = fopen(path, "wb");
+
+   if (!file)
+      return;
+
+   fprintf(file, "P6\n%u %u\n255\n", rx->width, rx->height);
+   for (i = 0; i < (size_t)rx->width * rx->height; i++)
+   {
+      uint8_t rgb[3];
+      rgb[0] = (uint8_t)(rx->frame[i] >> 16);
+      rgb[1] = (uint8_t)(rx->frame[i] >>  8);
+      rgb[2] = (uint8_t)(rx->frame[i] >>  0);
+      fwrite(rgb, 1, sizeof(rgb), file);
+   }
+   fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+   int fd;
+   uint8_t hello[8];
+   retro_time_t start, last;
+   receiver_t rx;
+   unsigned last_frames = 0;
+   uint64_t last_bytes  = 0;
+   uint16_t port        = DEFAULT_PORT;
+   const char *ppm      = NULL;
+
+   if (argc > 1)
+      port = (uint16_t)strtoul(argv[1], NULL, 10);
+   if (argc > 2)
+      ppm  = argv[2];
+
+   memset(&rx, 0, sizeof(rx));
+   rx.backend = trans_stream_get_zlib_inflate_backend();
+   rx.inflate = rx.backend->stream_new();
+
+   if ((fd = listen_for_sender(port)) < 0)
+   {
+      printf("Could not listen on port %u\n", (unsigned)port);
+      return 1;
+   }
+
+   if (     !socket_receive_all_blocking(fd, hello, sizeof(hello))
+         || memcmp(hello, NETWORK_VIDEO_STREAM_MAGIC, 4)
+         || read_u32(hello + 4) != NETWORK_VIDEO_STREAM_VERSION)
+   {
+      printf("Not a network video stream, or a different version\n");
+      socket_close(fd);
+      return 1;
+   }
+
+   start = last = cpu_features_get_time_usec();
+
+   while (receive_frame(&rx, fd))
+   {
+      retro_time_t now = cpu_features_get_time_usec();
+
+      if (now - last >= 1000000)
+      {
+         double secs = (now - last) / 1000000.0;
+         printf("%6.1f fps, %8.2f MB/s\n",
+               (rx.frames - last_frames) / secs,
+               (rx.bytes  - last_bytes)  / secs / 1000000.0);
+         fflush(stdout);
+         last        = now;
+         last_frames = rx.frames;
+         last_bytes  = rx.bytes;
+      }
+   }
+
+   socket_close(fd);
+
+   {
+      double secs = (cpu_features_get_time_usec() - start) / 1000000.0;
+
+      printf("Frames:            %10u (%u keyframes, %u dropped)\n",
+            rx.frames, rx.keyframes, rx.dropped);
+      printf("Tiles per frame:   %10.1f\n",
+            rx.frames ? (double)rx.tiles / rx.frames : 0.0);
+      printf("Received:          %10.2f MB (%.2f MB raw)\n",
+            rx.bytes / 1000000.0, rx.raw_bytes / 1000000.0);
+      if (secs > 0)
+         printf("Bandwidth:         %10.2f MB/s\n",
+               rx.bytes / secs / 1000000.0);
+      if (rx.mismatches)
+         printf("MISMATCH: %u frames differ from the sent frame\n",
+               rx.mismatches);
+   }
+
+   if (ppm && rx.frame)
+      save_ppm(&rx, ppm);
+
+   rx.backend->stream_free(rx.inflate);
+   free(rx.frame);
+   free(rx.packed);
+   free(rx.payload);
+
+   return rx.mismatches ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Streams synthetic frames to network_video_receiver the way
+ * the network video driver does in its streaming mode.
+ *
+ * Usage: network_video_sender [host] [port] [width] [height] [frames]
+ *
+ * Defaults to 127.0.0.1:4953 and 300 frames of 1920x1080: a
+ * static background with a sprite moving across it and a
+ * resize halfway through. Frames are pushed as fast as the
+ * stream takes them, and the time the caller spends pushing
+ * (what the emulation thread would spend) is reported. */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <net/net_compat.h>
+#include <net/net_socket.h>
+
+#include "../../gfx/common/network_video_stream.h"
+
+#define SPRITE_SIZE 48
+
+/* Stand-ins for the RetroArch logger, the stream logs
+ * its totals when it is freed */
+RETRO_BEGIN_DECLS
+void RARCH_LOG(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vprintf(fmt, ap);
+   va_end(ap);
+}
+
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vprintf(fmt, ap);
+   va_end(ap);
+}
+RETRO_END_DECLS
+
+static void draw_frame(uint32_t *pixels, unsigned width, unsigned height,
+      unsigned frame)
+{
+   unsigned x, y;
+   unsigned sx = (frame * 7) % (width  - SPRITE_SIZE);
+   unsigned sy = (frame * 3) % (height - SPRITE_SIZE);
+
+   for (y = 0; y < height; y++)
+      for (x = 0; x < width; x++)
+         pixels[y * width + x] = 0xFF000000
+            | ((x * 255 / width)  << 16)
+            | ((y * 255 / height) <<  8)
+            | ((x ^ y) & 0x3F);
+
+   for (y = sy; y < sy + SPRITE_SIZE; y++)
+      for (x = sx; x < sx + SPRITE_SIZE; x++)
+         pixels[y * width + x] = 0xFFFFFF00 | (frame & 0xFF);
+}
+
+static int connect_to_receiver(const char *host, uint16_t port)
+{
+   struct addrinfo *addr = NULL;
+   struct addrinfo *next = NULL;
+   int fd                = socket_init((void**)&addr, port, host,
+         SOCKET_TYPE_STREAM, 0);
+
+   for (next = addr; fd >= 0; fd = socket_next((void**)&next))
+   {
+      if (socket_connect_with_timeout(fd, next, 5000))
+         break;
+      socket_close(fd);
+   }
+
+   if (addr)
+      freeaddrinfo_retro(addr);
+   return fd;
+}
+
+int main(int argc, char *argv[])
+{
+   int fd;
+   unsigned i;
+   retro_time_t start, push_time;
+   network_video_stream_t *stream = NULL;
+   uint32_t *pixels               = NULL;
+   const char *host               = "127.0.0.1";
+   uint16_t port                  = 4953;
+   unsigned width                 = 1920;
+   unsigned height                = 1080;
+   unsigned frames                = 300;
+
+   if (argc > 1)
+      host   = argv[1];
+   if (argc > 2)
+      port   = (uint16_t)strtoul(argv[2], NULL, 10);
+   if (argc > 3)
+      width  = (unsigned)strtoul(argv[3], NULL, 10);
+   if (argc > 4)
+      height = (unsigned)strtoul(argv[4], NULL, 10);
+   if (argc > 5)
+      frames = (unsigned)strtoul(argv[5], NULL, 10);
+
+   if (width <= SPRITE_SIZE || height <= SPRITE_SIZE || !frames)
+      return 1;
+
+   if ((fd = connect_to_receiver(host, port)) < 0)
+   {
+      printf("Could not connect to %s:%u\n", host, (unsigned)port);
+      return 1;
+   }
+
+   if (     !(stream = network_video_stream_new(fd))
+         || !(pixels = (uint32_t*)malloc((size_t)width * height * 4)))
+   {
+      printf("Could not start stream\n");
+      return 1;
+   }
+
+   push_time = 0;
+   start     = cpu_features_get_time_usec();
+
+   for (i = 0; i < frames; i++)
+   {
+      retro_time_t t;
+      /* Halfway through, shrink the frame like a core
+       * switching resolution would */
+      unsigned w = (i < frames / 2) ? width  : width  / 2 + SPRITE_SIZE;
+      unsigned h = (i < frames / 2) ? height : height / 2 + SPRITE_SIZE;
+
+      draw_frame(pixels, w, h, i);
+
+      t          = cpu_features_get_time_usec();
+      if (!network_video_stream_push(stream, pixels, w, h))
+      {
+         printf("Connection lost at frame %u\n", i);
+         break;
+      }
+      push_time += cpu_features_get_time_usec() - t;
+   }
+
+   network_video_stream_free(stream);
+   socket_close(fd);
+
+   printf("Frames pushed:     %10u in %.2f s\n", i,
+         (cpu_features_get_time_usec() - start) / 1000000.0);
+   printf("Push time:         %10.3f ms per frame\n",
+         i ? push_time / 1000.0 / i : 0.0);
+
+   free(pixels);
+   return 0;
+}
@@ -0,0 +1,257 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Builds a playlist the way the content scanners do: checks
+ * that each entry is not in the playlist yet and pushes it.
+ *
+ * Usage: playlist_bench [entries] [playlist.lpl]
+ *
+ * Pushes [entries] (default 50000) synthetic entries, one at
+ * a time and in bulk, checks that both give the same playlist,
+ * then pushes every entry again to time duplicate detection.
+ *
+ * The playlist is then saved to [playlist.lpl] (default
+ * playlist_bench.lpl, deleted afterwards), and loaded back
+ * from the JSON file and from its binary cache. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <retro_common_api.h>
+#include <retro_miscellaneous.h>
+#include <retro_timers.h>
+#include <compat/strl.h>
+#include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <file/archive_file.h>
+
+#include "../../playlist.h"
+#include "../../core_info.h"
+
+#define BENCH_PLAYLIST "playlist_bench.lpl"
+
+/* Stubs for the parts of RetroArch the playlist links to */
+RETRO_BEGIN_DECLS
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+bool core_info_find(const char *core_path, core_info_t **core_info)
+{
+   return false;
+}
+bool core_info_core_file_id_is_equal(const char *core_path_a,
+      const char *core_path_b)
+{
+   return false;
+}
+struct string_list *file_archive_get_file_list(const char *path,
+      const char *valid_exts)
+{
+   return NULL;
+}
+RETRO_END_DECLS
+
+static double bench_seconds(clock_t start)
+{
+   return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void bench_entry_path(char *s, size_t len, unsigned i)
+{
+   /* Every fourth entry is a file inside an archive */
+   if (i % 4 == 0)
+      snprintf(s, len, "/roms/System %u/Pack %05u.zip#Game %05u (World).bin",
+            i % 7, i, i);
+   else
+      snprintf(s, len, "/roms/System %u/Game %05u (World).bin", i % 7, i);
+}
+
+/* Pushes 'count' entries, skipping those already present,
+ * like manual_content_scan_add_content_to_playlist() does */
+static double bench_push(playlist_t *playlist, unsigned count, bool bulk,
+      unsigned *added)
+{
+   unsigned i;
+   clock_t start = clock();
+
+   *added = 0;
+
+   if (bulk)
+      playlist_push_bulk_begin(playlist);
+
+   for (i = 0; i < count; i++)
+   {
+      char path[256];
+      char label[64];
+      struct playlist_entry entry = {0};
+
+      bench_entry_path(path, sizeof(path), i);
+      if (playlist_entry_exists(playlist, path))
+         continue;
+
+      snprintf(label, sizeof(label), "Game %05u", i);
+      entry.path      = path;
+      entry.label     = label;
+      entry.core_path = (char*)"DETECT";
+      entry.core_name = (char*)"DETECT";
+      entry.crc32     = (char*)"00000000|crc";
+      entry.db_name   = (char*)"System.lpl";
+
+      if (playlist_push(playlist, &entry))
+         (*added)++;
+   }
+
+   if (bulk)
+      playlist_push_bulk_end(playlist);
+
+   return bench_seconds(start);
+}
+
+static bool strings_equal(const char *a, const char *b)
+{
+   return string_is_equal(a ? a : "", b ? b : "");
+}
+
+static bool playlists_equal(playlist_t *a, playlist_t *b)
+{
+   size_t i;
+
+   if (playlist_size(a) != playlist_size(b))
+      return false;
+
+   for (i = 0; i < playlist_size(a); i++)
+   {
+      const struct playlist_entry *entry_a = NULL;
+      const struct playlist_entry *entry_b = NULL;
+
+      playlist_get_index(a, i, &entry_a);
+      playlist_get_index(b, i, &entry_b);
+
+      if (     !entry_a || !entry_b
+            || !strings_equal(entry_a->path,      entry_b->path)
+            || !strings_equal(entry_a->label,     entry_b->label)
+            || !strings_equal(entry_a->core_path, entry_b->core_path)
+            || !strings_equal(entry_a->core_name, entry_b->core_name)
+            || !strings_equal(entry_a->crc32,     entry_b->crc32)
+            || !strings_equal(entry_a->db_name,   entry_b->db_name))
+         return false;
+   }
+
+   return true;
+}
+
+/* Loads the playlist and reads every label,
+ * as a menu listing it would */
+static double bench_load(const playlist_config_t *config,
+      playlist_t **playlist)
+{
+   size_t i;
+   size_t total   = 0;
+   clock_t start  = clock();
+
+   if (!(*playlist = playlist_init(config)))
+      return 0.0;
+
+   for (i = 0; i < playlist_size(*playlist); i++)
+   {
+      const struct playlist_entry *entry = NULL;
+      playlist_get_index(*playlist, i, &entry);
+      total += strlen(entry->label);
+   }
+
+   return total ? bench_seconds(start) : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+   playlist_config_t config;
+   double single, bulk, again, json, first, cached;
+   char cache_path[PATH_MAX_LENGTH];
+   playlist_t *playlist_json       = NULL;
+   playlist_t *playlist_cached     = NULL;
+   const char *path                = BENCH_PLAYLIST;
+   bool equal_cached               = false;
+   unsigned added_single, added_bulk, added_again;
+   playlist_t *playlist_single = NULL;
+   playlist_t *playlist_bulk   = NULL;
+   unsigned count              = 50000;
+   bool equal                  = false;
+
+   if (argc > 1)
+      count = (unsigned)strtoul(argv[1], NULL, 10);
+   if (argc > 2)
+      path  = argv[2];
+   if (!count)
+      return 1;
+
+   memset(&config, 0, sizeof(config));
+   config.capacity            = count;
+   config.fuzzy_archive_match = true;
+   playlist_config_set_path(&config, path);
+   snprintf(cache_path, sizeof(cache_path), "%s%s", path, ".cache");
+   filestream_delete(path);
+   filestream_delete(cache_path);
+
+   playlist_single = playlist_init(&config);
+   playlist_bulk   = playlist_init(&config);
+
+   if (!playlist_single || !playlist_bulk)
+   {
+      printf("Could not create playlists\n");
+      return 1;
+   }
+
+   single = bench_push(playlist_single, count, false, &added_single);
+   bulk   = bench_push(playlist_bulk,   count, true,  &added_bulk);
+   equal  = playlists_equal(playlist_single, playlist_bulk);
+   again  = bench_push(playlist_bulk,   count, false, &added_again);
+
+   /* Save it, then load it back. Caches made in the
+    * second the playlist was written are not trusted. */
+   playlist_write_file(playlist_bulk);
+   retro_sleep(2000);
+
+   json                = bench_load(&config, &playlist_json);
+   config.binary_cache = true;
+   first               = bench_load(&config, &playlist_cached);
+   playlist_free(playlist_cached);
+   cached              = bench_load(&config, &playlist_cached);
+   equal_cached        = playlist_json && playlist_cached
+      && playlists_equal(playlist_json, playlist_cached);
+
+   printf("Entries:           %10u\n", count);
+   printf("One at a time:     %10.3f s (%u added)\n", single, added_single);
+   printf("In bulk:           %10.3f s (%u added)\n", bulk,   added_bulk);
+   printf("Pushed again:      %10.3f s (%u added)\n", again,  added_again);
+   printf("Load from JSON:    %10.3f s\n", json);
+   printf("  + write cache:   %10.3f s\n", first);
+   printf("Load from cache:   %10.3f s\n", cached);
+   if (!equal)
+      printf("MISMATCH: bulk and single pushes differ\n");
+   if (!equal_cached)
+      printf("MISMATCH: JSON and cached playlists differ\n");
+
+   playlist_free(playlist_single);
+   playlist_free(playlist_bulk);
+   playlist_free(playlist_json);
+   playlist_free(playlist_cached);
+   filestream_delete(path);
+   filestream_delete(cache_path);
+
+   return (equal && equal_cached && added_single == count && !added_again)
+      ? 0 : 1;
+}
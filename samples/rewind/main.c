@@ -0,0 +1,277 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Replays a session through the rewind state manager, once keeping
+ * only the patch ring and once with the compressed history, and
+ * reports how far back each one can rewind with the same buffer.
+ *
+ * Usage: rewind_bench [session] [state size] [buffer MB]
+ *
+ * [session] is a file of consecutive savestates, all [state size]
+ * bytes long. Without it, a synthetic session of 36000 frames
+ * (10 minutes at 60 fps) is generated, where the state is mostly
+ * static with some RAM churn every frame and bursts of changes
+ * every few seconds. Every state is rewound to and checked. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+
+/* Included directly, the state manager internals
+ * are not exported */
+#include "../../state_manager.c"
+
+#define SYNTH_FRAMES     36000
+#define SYNTH_STATE_SIZE (512 * 1024)
+
+/* Stubs for the parts of RetroArch state_manager.c links to */
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+bool core_info_get_current_core(core_info_t **core) { return false; }
+bool core_info_current_supports_rewind(void) { return false; }
+bool audio_driver_has_callback(void) { return false; }
+void audio_driver_setup_rewind(void) { }
+void audio_driver_frame_is_reverse(void) { }
+void audio_driver_sample(int16_t left, int16_t right) { }
+void audio_driver_sample_rewind(int16_t left, int16_t right) { }
+size_t audio_driver_sample_batch(const int16_t *data, size_t frames) { return frames; }
+size_t audio_driver_sample_batch_rewind(const int16_t *data, size_t frames) { return frames; }
+size_t content_get_serialized_size_rewind(void) { return 0; }
+bool content_serialize_state_rewind(void *buffer, size_t buffer_size) { return false; }
+bool content_deserialize_state(const void *serialized_data, size_t serialized_size) { return false; }
+bool retroarch_ctl(enum rarch_ctl_state state, void *data) { return false; }
+void runloop_msg_queue_push(const char *msg, unsigned prio, unsigned duration,
+      bool flush, char *title, enum message_queue_icon icon,
+      enum message_queue_category category) { }
+
+typedef struct
+{
+   FILE *file;
+   uint8_t *state;
+   size_t state_size;
+   unsigned frame;
+   unsigned frames;
+   uint32_t rand_state;
+} bench_session_t;
+
+static uint32_t bench_rand(bench_session_t *session)
+{
+   /* xorshift32 */
+   session->rand_state ^= session->rand_state << 13;
+   session->rand_state ^= session->rand_state >> 17;
+   session->rand_state ^= session->rand_state << 5;
+   return session->rand_state;
+}
+
+static void bench_session_rewind(bench_session_t *session)
+{
+   size_t i;
+
+   session->frame      = 0;
+   session->rand_state = 0x12345678;
+
+   if (session->file)
+   {
+      fseek(session->file, 0, SEEK_SET);
+      return;
+   }
+
+   /* Low entropy RAM, then a mix of random and blank data */
+   for (i = 0; i < session->state_size; i++)
+      session->state[i] = (i < session->state_size / 8)
+         ? (uint8_t)(bench_rand(session) & 0x0f)
+         : ((i & 0x3ff) < 0x100 ? (uint8_t)bench_rand(session) : 0);
+}
+
+/* Advances to the next state of the session */
+static bool bench_session_next(bench_session_t *session)
+{
+   unsigned i;
+   size_t ram = session->state_size / 8;
+
+   if (session->frame >= session->frames)
+      return false;
+   session->frame++;
+
+   if (session->file)
+      return fread(session->state, 1, session->state_size,
+            session->file) == session->state_size;
+
+   /* Frame counters, input and a few hundred RAM writes,
+    * mostly small values to object tables */
+   memcpy(session->state, &session->frame, sizeof(session->frame));
+   for (i = 0; i < 64; i++)
+   {
+      uint8_t *obj = session->state + (bench_rand(session) % (ram / 16)) * 16;
+      obj[0]++;
+      obj[1] = (uint8_t)(bench_rand(session) & 0x07);
+      obj[2] = (uint8_t)(bench_rand(session) & 0x07);
+      obj[4]^= 1;
+   }
+
+   /* Scene changes rewrite a slice of the video memory */
+   if (!(session->frame % 240))
+   {
+      size_t start = ram + bench_rand(session) % (session->state_size - ram * 2);
+      for (i = 0; i < ram; i++)
+         session->state[start + i] = (uint8_t)(bench_rand(session) & 0x0f);
+   }
+
+   return true;
+}
+
+static bool bench_run(bench_session_t *session, size_t buffer_size,
+      bool compress_history)
+{
+   state_manager_stats_t stats;
+   struct state_manager_rewind_state rewind_st;
+   retro_time_t start, push_time, pop_time;
+   unsigned entries;
+   unsigned mismatches = 0;
+   unsigned popped     = 0;
+   uint32_t *crcs      = (uint32_t*)malloc(session->frames * sizeof(*crcs));
+   state_manager_t *state = state_manager_new(session->state_size,
+         buffer_size, compress_history);
+
+   if (!crcs || !state)
+      return false;
+
+   memset(&rewind_st, 0, sizeof(rewind_st));
+   rewind_st.state = state;
+   rewind_st.size  = session->state_size;
+
+   bench_session_rewind(session);
+   push_time       = 0;
+
+   while (bench_session_next(session))
+   {
+      void *data = NULL;
+
+      crcs[session->frame - 1] = encoding_crc32(0,
+            session->state, session->state_size);
+
+      start      = cpu_features_get_time_usec();
+      state_manager_push_where(state, &data);
+      memcpy(data, session->state, session->state_size);
+      state_manager_push_do(state);
+      push_time += cpu_features_get_time_usec() - start;
+   }
+
+   state_manager_wait(state);
+   state_manager_get_stats(&rewind_st, &stats);
+   entries  = state->entries;
+
+   start    = cpu_features_get_time_usec();
+   for (;;)
+   {
+      const void *data = NULL;
+      unsigned frame   = session->frame - 1 - popped;
+
+      if (!state_manager_pop(state, &data))
+         break;
+      if (encoding_crc32(0, (const uint8_t*)data,
+               session->state_size) != crcs[frame])
+         mismatches++;
+      if (++popped == session->frame)
+         break;
+   }
+   pop_time = cpu_features_get_time_usec() - start;
+
+   printf("%s:\n", compress_history
+         ? "Compressed history" : "Patch ring only");
+   printf("  Push:             %8.1f us/frame\n",
+         (double)push_time / session->frame);
+   printf("  Rewind:           %8.1f us/frame\n",
+         popped ? (double)pop_time / popped : 0.0);
+   printf("  History:          %8u frames (%.1f s at 60 fps)\n",
+         entries, entries / 60.0);
+   printf("  Ring:             %8.2f / %.2f MB\n",
+         stats.hot_size / (1024.0 * 1024.0),
+         stats.hot_capacity / (1024.0 * 1024.0));
+   if (stats.cold_capacity)
+      printf("  Compressed:       %8.2f / %.2f MB, %u frames, %.2fx\n",
+            stats.cold_size / (1024.0 * 1024.0),
+            stats.cold_capacity / (1024.0 * 1024.0),
+            stats.cold_entries,
+            stats.cold_size
+            ? (double)stats.cold_raw_size / stats.cold_size : 0.0);
+   if (popped != entries || mismatches)
+      printf("  MISMATCH: rewound %u of %u frames, %u differ\n",
+            popped, entries, mismatches);
+
+   state_manager_free(state);
+   free(state);
+   free(crcs);
+   return popped == entries && !mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+   bench_session_t session;
+   bool ok            = true;
+   size_t buffer_size = 20 << 20;
+
+   memset(&session, 0, sizeof(session));
+   session.state_size = SYNTH_STATE_SIZE;
+   session.frames     = SYNTH_FRAMES;
+
+   if (argc > 2)
+      session.state_size = strtoul(argv[2], NULL, 10);
+   if (argc > 3)
+      buffer_size        = (size_t)strtoul(argv[3], NULL, 10) << 20;
+
+   if (argc > 1 && strcmp(argv[1], "-"))
+   {
+      long size;
+
+      if (argc < 3 || !session.state_size)
+      {
+         printf("Usage: %s [session] [state size] [buffer MB]\n", argv[0]);
+         return 1;
+      }
+      if (!(session.file = fopen(argv[1], "rb")))
+      {
+         printf("Could not open '%s'\n", argv[1]);
+         return 1;
+      }
+      fseek(session.file, 0, SEEK_END);
+      size            = ftell(session.file);
+      session.frames  = (unsigned)(size / session.state_size);
+   }
+
+   if (!session.frames || !session.state_size)
+      return 1;
+
+   session.state = (uint8_t*)malloc(session.state_size);
+   if (!session.state)
+      return 1;
+
+   printf("Session: %u frames of %u bytes, %u MB buffer\n",
+         session.frames, (unsigned)session.state_size,
+         (unsigned)(buffer_size >> 20));
+
+   ok = bench_run(&session, buffer_size, false) && ok;
+   ok = bench_run(&session, buffer_size, true)  && ok;
+
+   if (session.file)
+      fclose(session.file);
+   free(session.state);
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,342 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Writes and reads back RZIP files of savestate-like data,
+ * with the serial chunk loop rzip_stream used before and
+ * with rzipstream_write_file()/rzipstream_read_file(), for
+ * each codec available.
+ *
+ * Usage: rzip_bench [directory]
+ *
+ * Files are written to the directory (default /tmp). Sizes go
+ * from a 64 KB 8-bit console state to a 32 MB 5th generation
+ * one; the data mixes zeroed RAM, repeated tables and noise.
+ * Every file is read back and compared, and zlib files written
+ * by either side are read by the other, to check the format
+ * is unchanged.
+ *
+ * Build with HAVE_ZSTD=1 to include zstd.
+ *
+ * Exits with 1 if any file reads back wrong. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <streams/trans_stream.h>
+#include <streams/rzip_stream.h>
+
+#define BENCH_CHUNK_SIZE 131072
+#define BENCH_RUNS       3
+
+RETRO_BEGIN_DECLS
+void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap) { }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+RETRO_END_DECLS
+
+static const size_t bench_sizes[] = {
+   64 * 1024, 512 * 1024, 4 * 1024 * 1024, 32 * 1024 * 1024
+};
+
+static uint32_t bench_rand_state = 12345;
+
+static uint32_t bench_rand(void)
+{
+   bench_rand_state = bench_rand_state * 1103515245 + 12345;
+   return bench_rand_state >> 8;
+}
+
+/* 4 KB blocks of zeros, of a few repeated tables,
+ * of small values and of noise */
+static void bench_fill(uint8_t *data, size_t size)
+{
+   size_t i, j;
+
+   for (i = 0; i < size; i += 4096)
+   {
+      size_t len = size - i < 4096 ? size - i : 4096;
+
+      switch (bench_rand() % 4)
+      {
+         case 0:
+            memset(data + i, 0, len);
+            break;
+         case 1:
+         {
+            uint32_t table = bench_rand() % 8;
+            for (j = 0; j < len; j++)
+               data[i + j] = (uint8_t)(j * (table + 1) + table);
+            break;
+         }
+         case 2:
+            for (j = 0; j < len; j++)
+               data[i + j] = (uint8_t)(bench_rand() & 0x0f);
+            break;
+         default:
+            for (j = 0; j < len; j++)
+               data[i + j] = (uint8_t)bench_rand();
+            break;
+      }
+   }
+}
+
+static void bench_put(uint8_t *p, uint64_t v, unsigned bytes)
+{
+   unsigned i;
+   for (i = 0; i < bytes; i++)
+      p[i] = (uint8_t)(v >> (i * 8));
+}
+
+static uint64_t bench_get(const uint8_t *p, unsigned bytes)
+{
+   unsigned i;
+   uint64_t v = 0;
+   for (i = 0; i < bytes; i++)
+      v |= (uint64_t)p[i] << (i * 8);
+   return v;
+}
+
+/* The write loop rzip_stream had before: one
+ * 128 KB chunk at a time, deflated at level 6 */
+static bool bench_write_old(const char *path, const uint8_t *data,
+      size_t size)
+{
+   uint8_t header[20] = { '#', 'R', 'Z', 'I', 'P', 'v', 1, '#' };
+   uint8_t *out       = (uint8_t*)malloc(BENCH_CHUNK_SIZE * 2);
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   void *z            = backend->stream_new();
+   RFILE *file        = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   size_t offset;
+   bool ok            = file != NULL;
+
+   backend->define(z, "level", 6);
+   bench_put(header + 8,  BENCH_CHUNK_SIZE, 4);
+   bench_put(header + 12, size, 8);
+   if (ok)
+      ok = filestream_write(file, header, sizeof(header)) == sizeof(header);
+
+   for (offset = 0; ok && offset < size; offset += BENCH_CHUNK_SIZE)
+   {
+      uint8_t chunk_header[4];
+      uint32_t rd, wn;
+      uint32_t len = (uint32_t)(size - offset < BENCH_CHUNK_SIZE
+            ? size - offset : BENCH_CHUNK_SIZE);
+
+      backend->set_in(z, data + offset, len);
+      backend->set_out(z, out, BENCH_CHUNK_SIZE * 2);
+      ok = backend->trans(z, true, &rd, &wn, NULL) && rd == len;
+
+      bench_put(chunk_header, wn, 4);
+      ok = ok
+         && filestream_write(file, chunk_header, 4) == 4
+         && filestream_write(file, out, wn) == wn;
+   }
+
+   if (file)
+      filestream_close(file);
+   backend->stream_free(z);
+   free(out);
+   return ok;
+}
+
+/* The read loop rzip_stream had before, for zlib files */
+static bool bench_read_old(const char *path, uint8_t *data, size_t size)
+{
+   uint8_t header[20];
+   uint8_t *in        = (uint8_t*)malloc(BENCH_CHUNK_SIZE * 2);
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_inflate_backend();
+   void *z            = backend->stream_new();
+   RFILE *file        = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   size_t offset      = 0;
+   bool ok            = file
+      && filestream_read(file, header, sizeof(header)) == sizeof(header)
+      && header[6] == 1
+      && bench_get(header + 12, 8) == size;
+
+   while (ok && offset < size)
+   {
+      uint8_t chunk_header[4];
+      uint32_t rd, wn, len;
+
+      ok  = filestream_read(file, chunk_header, 4) == 4;
+      len = (uint32_t)bench_get(chunk_header, 4);
+      ok  = ok && len <= BENCH_CHUNK_SIZE * 2
+         && filestream_read(file, in, len) == len;
+      if (!ok)
+         break;
+
+      backend->set_in(z, in, len);
+      backend->set_out(z, data + offset, (uint32_t)(size - offset));
+      ok      = backend->trans(z, true, &rd, &wn, NULL) && rd == len;
+      offset += wn;
+   }
+
+   if (file)
+      filestream_close(file);
+   backend->stream_free(z);
+   free(in);
+   return ok && offset == size;
+}
+
+static bool bench_write_new(const char *path, const uint8_t *data,
+      size_t size, enum rzip_codec codec)
+{
+   int64_t written;
+   rzipstream_t *stream = rzipstream_open_codec(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, codec);
+
+   if (!stream)
+      return false;
+
+   written = rzipstream_write(stream, data, size);
+   return (rzipstream_close(stream) == 0) && (written == (int64_t)size);
+}
+
+static bool bench_read_new(const char *path, uint8_t *data, size_t size)
+{
+   void *buf   = NULL;
+   int64_t len = 0;
+   bool ok     = rzipstream_read_file(path, &buf, &len)
+      && len == (int64_t)size;
+
+   if (ok)
+      memcpy(data, buf, size);
+   free(buf);
+   return ok;
+}
+
+static double bench_secs(retro_time_t start)
+{
+   return (cpu_features_get_time_usec() - start) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned s;
+   char old_path[PATH_MAX_LENGTH];
+   char new_path[PATH_MAX_LENGTH];
+   bool ok         = true;
+   const char *dir = argc > 1 ? argv[1] : "/tmp";
+
+   fill_pathname_join(old_path, dir, "rzip_bench_old.rzip", sizeof(old_path));
+   fill_pathname_join(new_path, dir, "rzip_bench_new.rzip", sizeof(new_path));
+
+   printf("%u cores\n", cpu_features_get_core_amount());
+   rzipstream_init_pool();
+
+   for (s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++)
+   {
+      unsigned codec;
+      size_t size   = bench_sizes[s];
+      uint8_t *data = (uint8_t*)malloc(size);
+      uint8_t *back = (uint8_t*)malloc(size);
+      double old_write = 1e9, old_read = 1e9;
+      unsigned run;
+
+      bench_fill(data, size);
+
+      for (run = 0; run < BENCH_RUNS; run++)
+      {
+         retro_time_t start = cpu_features_get_time_usec();
+         double secs;
+
+         ok   = bench_write_old(old_path, data, size) && ok;
+         if ((secs = bench_secs(start)) < old_write)
+            old_write = secs;
+
+         memset(back, 0, size);
+         start = cpu_features_get_time_usec();
+         ok    = bench_read_old(old_path, back, size) && ok;
+         if ((secs = bench_secs(start)) < old_read)
+            old_read = secs;
+         ok    = !memcmp(data, back, size) && ok;
+      }
+
+      printf("%6u KB  before zlib: write %7.2f ms, read %7.2f ms, %5.1f%%\n",
+            (unsigned)(size / 1024), old_write * 1000, old_read * 1000,
+            100.0 * path_get_size(old_path) / size);
+
+      for (codec = RZIP_CODEC_ZLIB; codec <= RZIP_CODEC_ZSTD; codec++)
+      {
+         double new_write = 1e9, new_read = 1e9;
+
+         if (     codec == RZIP_CODEC_ZSTD
+               && !trans_stream_get_zstd_compress_backend())
+            continue;
+
+         for (run = 0; run < BENCH_RUNS; run++)
+         {
+            retro_time_t start = cpu_features_get_time_usec();
+            double secs;
+
+            ok   = bench_write_new(new_path, data, size,
+                  (enum rzip_codec)codec) && ok;
+            if ((secs = bench_secs(start)) < new_write)
+               new_write = secs;
+
+            memset(back, 0, size);
+            start = cpu_features_get_time_usec();
+            ok    = bench_read_new(new_path, back, size) && ok;
+            if ((secs = bench_secs(start)) < new_read)
+               new_read = secs;
+            ok    = !memcmp(data, back, size) && ok;
+         }
+
+         printf("%6u KB  after  %-4s: write %7.2f ms, read %7.2f ms, %5.1f%%"
+               " (%.2fx, %.2fx)\n",
+               (unsigned)(size / 1024),
+               codec == RZIP_CODEC_ZSTD ? "zstd" : "zlib",
+               new_write * 1000, new_read * 1000,
+               100.0 * path_get_size(new_path) / size,
+               old_write / new_write, old_read / new_read);
+
+         /* zlib files must read the same either way */
+         if (codec == RZIP_CODEC_ZLIB)
+         {
+            memset(back, 0, size);
+            ok = bench_read_old(new_path, back, size)
+               && !memcmp(data, back, size) && ok;
+            memset(back, 0, size);
+            ok = bench_read_new(old_path, back, size)
+               && !memcmp(data, back, size) && ok;
+         }
+      }
+
+      free(data);
+      free(back);
+   }
+
+   rzipstream_deinit_pool();
+   filestream_delete(old_path);
+   filestream_delete(new_path);
+
+   if (!ok)
+   {
+      fprintf(stderr, "Read back data doesn't match.\n");
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,291 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compiles every pass of a slang preset to SPIR-V the way the
+ * Vulkan, GL3 and D3D backends do on preset load, without the
+ * SPIR-V cache, with an empty cache and with a warm cache.
+ *
+ * Usage: slang_cache_bench <cache dir> [preset.slangp] [rounds]
+ *
+ * <cache dir> is emptied of SPIR-V first. Without a preset,
+ * a synthetic 8 pass preset is written to <cache dir>. The
+ * warm load is repeated [rounds] times (default 10) and
+ * checked against the SPIR-V glslang produced. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+#include <string>
+
+#include <compat/strl.h>
+#include <file/config_file.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <streams/file_stream.h>
+
+#include "../../configuration.h"
+#include "../../gfx/drivers_shader/glslang_util.h"
+#include "../../gfx/drivers_shader/glslang_util_cxx.h"
+#include "../../gfx/drivers_shader/shader_cache.h"
+
+#define SYNTH_PASSES 8
+
+/* One pass of a typical filter chain, big enough
+ * for glslang to do some actual work */
+static const char synth_shader[] =
+   "#version 450\n"
+   "layout(push_constant) uniform Push\n"
+   "{\n"
+   "   vec4 SourceSize;\n"
+   "   vec4 OutputSize;\n"
+   "   float STRENGTH;\n"
+   "} params;\n"
+   "#pragma parameter STRENGTH \"Strength\" 0.5 0.0 1.0 0.05\n"
+   "layout(std140, set = 0, binding = 0) uniform UBO\n"
+   "{\n"
+   "   mat4 MVP;\n"
+   "} global;\n"
+   "#pragma stage vertex\n"
+   "layout(location = 0) in vec4 Position;\n"
+   "layout(location = 1) in vec2 TexCoord;\n"
+   "layout(location = 0) out vec2 vTexCoord;\n"
+   "void main()\n"
+   "{\n"
+   "   gl_Position = global.MVP * Position;\n"
+   "   vTexCoord = TexCoord;\n"
+   "}\n"
+   "#pragma stage fragment\n"
+   "layout(location = 0) in vec2 vTexCoord;\n"
+   "layout(location = 0) out vec4 FragColor;\n"
+   "layout(set = 0, binding = 2) uniform sampler2D Source;\n"
+   "vec3 gauss(vec2 uv, vec2 dir)\n"
+   "{\n"
+   "   const float w[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);\n"
+   "   vec3 sum = texture(Source, uv).rgb * w[0];\n"
+   "   for (int i = 1; i < 5; i++)\n"
+   "   {\n"
+   "      sum += texture(Source, uv + dir * float(i)).rgb * w[i];\n"
+   "      sum += texture(Source, uv - dir * float(i)).rgb * w[i];\n"
+   "   }\n"
+   "   return sum;\n"
+   "}\n"
+   "void main()\n"
+   "{\n"
+   "   vec2 px = params.SourceSize.zw;\n"
+   "   vec3 blur = 0.5 * (gauss(vTexCoord, vec2(px.x, 0.0))\n"
+   "         + gauss(vTexCoord, vec2(0.0, px.y)));\n"
+   "   vec3 col = texture(Source, vTexCoord).rgb;\n"
+   "   float luma = dot(col, vec3(0.299, 0.587, 0.114));\n"
+   "   col = mix(col, blur, params.STRENGTH * smoothstep(0.1, 0.9, luma));\n"
+   "   col = pow(col, vec3(PASS_GAMMA));\n"
+   "   FragColor = vec4(col, 1.0);\n"
+   "}\n";
+
+static settings_t bench_settings;
+
+/* Stubs for the parts of RetroArch the slang compiler links to */
+RETRO_BEGIN_DECLS
+settings_t *config_get_ptr(void) { return &bench_settings; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_DBG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+RETRO_END_DECLS
+
+static double bench_seconds(clock_t start)
+{
+   return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Only the pass list of the preset matters here */
+static bool load_preset(const char *path, std::vector<std::string> *passes)
+{
+   unsigned i;
+   unsigned shaders   = 0;
+   config_file_t *conf = config_file_new_from_path_to_string(path);
+
+   if (!conf)
+      return false;
+
+   if (!config_get_uint(conf, "shaders", &shaders))
+      shaders = 0;
+
+   for (i = 0; i < shaders; i++)
+   {
+      char key[64];
+      char shader[PATH_MAX_LENGTH];
+      char resolved[PATH_MAX_LENGTH];
+
+      snprintf(key, sizeof(key), "shader%u", i);
+      if (!config_get_path(conf, key, shader, sizeof(shader)))
+         break;
+      fill_pathname_resolve_relative(resolved, path, shader,
+            sizeof(resolved));
+      passes->push_back(resolved);
+   }
+
+   config_file_free(conf);
+   return !passes->empty();
+}
+
+/* Every pass gets its own fragment stage, like in a real
+ * chain, the vertex stage is the same for all of them */
+static bool write_synth_preset(const char *dir, char *path, size_t len,
+      std::vector<std::string> *passes)
+{
+   unsigned i;
+   std::string preset = "shaders = " + std::to_string(SYNTH_PASSES) + "\n";
+
+   for (i = 0; i < SYNTH_PASSES; i++)
+   {
+      char name[32];
+      char shader_path[PATH_MAX_LENGTH];
+      std::string source = synth_shader;
+      std::string gamma  = "1.0" + std::to_string(i);
+
+      source.replace(source.find("PASS_GAMMA"), strlen("PASS_GAMMA"), gamma);
+
+      snprintf(name, sizeof(name), "synth_pass%u.slang", i);
+      fill_pathname_join(shader_path, dir, name, sizeof(shader_path));
+      if (!filestream_write_file(shader_path, source.data(), source.size()))
+         return false;
+
+      preset += "shader" + std::to_string(i) + " = \"" + name + "\"\n";
+      passes->push_back(shader_path);
+   }
+
+   fill_pathname_join(path, dir, "synth.slangp", len);
+   return filestream_write_file(path, preset.data(), preset.size());
+}
+
+static void clear_cache(const char *dir)
+{
+   size_t i;
+   struct string_list *list = dir_list_new(dir, NULL,
+         false, true, false, false);
+
+   if (!list)
+      return;
+   for (i = 0; i < list->size; i++)
+      filestream_delete(list->elems[i].data);
+   string_list_free(list);
+}
+
+static double load_passes(const std::vector<std::string> &passes,
+      std::vector<glslang_output> *outputs)
+{
+   size_t i;
+   clock_t start = clock();
+
+   outputs->clear();
+   outputs->resize(passes.size());
+
+   for (i = 0; i < passes.size(); i++)
+   {
+      if (!glslang_compile_shader(passes[i].c_str(), &(*outputs)[i]))
+      {
+         printf("Failed to compile '%s'\n", passes[i].c_str());
+         exit(1);
+      }
+   }
+
+   return bench_seconds(start);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   double uncached, cold, warm;
+   char preset[PATH_MAX_LENGTH];
+   char spirv_dir[PATH_MAX_LENGTH];
+   std::vector<std::string> passes;
+   std::vector<glslang_output> reference, outputs;
+   unsigned rounds     = 10;
+   unsigned mismatches = 0;
+   const char *dir     = NULL;
+
+   if (argc < 2)
+   {
+      printf("Usage: %s <cache dir> [preset.slangp] [rounds]\n", argv[0]);
+      return 1;
+   }
+
+   dir = argv[1];
+   if (argc > 3)
+      rounds = (unsigned)strtoul(argv[3], NULL, 10);
+   if (!rounds)
+      return 1;
+
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+   {
+      printf("Could not create '%s'\n", dir);
+      return 1;
+   }
+
+   if (argc > 2)
+   {
+      strlcpy(preset, argv[2], sizeof(preset));
+      if (!load_preset(preset, &passes))
+      {
+         printf("Could not load '%s'\n", preset);
+         return 1;
+      }
+   }
+   else if (!write_synth_preset(dir, preset, sizeof(preset), &passes))
+   {
+      printf("Could not write synthetic preset to '%s'\n", dir);
+      return 1;
+   }
+
+   /* Without a cache directory, the cache is disabled */
+   *bench_settings.paths.directory_cache = '\0';
+   uncached = load_passes(passes, &reference);
+
+   strlcpy(bench_settings.paths.directory_cache, dir,
+         sizeof(bench_settings.paths.directory_cache));
+   shader_cache_dir(spirv_dir, sizeof(spirv_dir), dir, "spirv");
+   clear_cache(spirv_dir);
+   cold     = load_passes(passes, &outputs);
+
+   warm     = 0.0;
+   for (i = 0; i < rounds; i++)
+   {
+      size_t j;
+      warm += load_passes(passes, &outputs);
+      for (j = 0; j < passes.size(); j++)
+      {
+         if (     outputs[j].vertex   != reference[j].vertex
+               || outputs[j].fragment != reference[j].fragment)
+            mismatches++;
+      }
+   }
+   warm    /= rounds;
+
+   printf("Preset: %s (%u passes)\n", preset, (unsigned)passes.size());
+   printf("No cache:          %10.3f ms\n", uncached * 1000.0);
+   printf("Cold cache:        %10.3f ms\n", cold     * 1000.0);
+   printf("Warm cache:        %10.3f ms (average of %u)\n",
+         warm * 1000.0, rounds);
+   if (warm > 0.0)
+      printf("Speedup (warm):    %10.1fx\n", uncached / warm);
+   if (mismatches)
+      printf("MISMATCH: %u passes differ from the compiled SPIR-V\n",
+            mismatches);
+
+   return mismatches ? 1 : 0;
+}
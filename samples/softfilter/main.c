@@ -0,0 +1,281 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2020 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs every .filt softfilter preset over synthetic frames,
+ * once on a single thread and once split into row tiles over
+ * the softfilter thread pool, and prints the frame times.
+ *
+ * Usage: softfilter_bench [filter directory] [threads]
+ *
+ * The directory defaults to gfx/video_filters and the thread
+ * count to the number of cores, but at least 2 so tiling gets
+ * checked on any machine. Frames are 256x224, 240x160 and
+ * 320x240 of flat areas, gradients and noise, scrolling from
+ * one frame to the next.
+ *
+ * Exits with 1 if the tiled output of any filter differs
+ * from its single threaded output. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+
+#include "../../gfx/video_filter.h"
+
+#define BENCH_FRAMES     60
+#define BENCH_MAX_WIDTH  320
+#define BENCH_MAX_HEIGHT 240
+/* Rows around each frame, since edge handling
+ * of some filters reads a little outside it */
+#define BENCH_PAD_ROWS   4
+
+RETRO_BEGIN_DECLS
+void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap) { }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+RETRO_END_DECLS
+
+struct bench_size
+{
+   unsigned width;
+   unsigned height;
+};
+
+static const struct bench_size bench_sizes[] = {
+   { 256, 224 }, { 240, 160 }, { 320, 240 }
+};
+
+static uint32_t bench_rand_state = 12345;
+
+static uint32_t bench_rand(void)
+{
+   bench_rand_state = bench_rand_state * 1103515245 + 12345;
+   return bench_rand_state >> 8;
+}
+
+/* 16x16 blocks, like tiles of a 2D game: flat colours
+ * from a small palette, gradients and noise */
+static void bench_fill(uint32_t *frame, unsigned width, unsigned height)
+{
+   unsigned x, y;
+   uint32_t palette[8];
+
+   for (x = 0; x < 8; x++)
+      palette[x] = bench_rand() & 0xffffff;
+
+   for (y = 0; y < height; y += 16)
+   {
+      for (x = 0; x < width; x += 16)
+      {
+         unsigned bx, by;
+         unsigned kind = bench_rand() % 4;
+         uint32_t a    = palette[bench_rand() % 8];
+         uint32_t b    = palette[bench_rand() % 8];
+
+         for (by = y; by < y + 16 && by < height; by++)
+         {
+            for (bx = x; bx < x + 16 && bx < width; bx++)
+            {
+               uint32_t *p = &frame[by * width + bx];
+               switch (kind)
+               {
+                  case 0:
+                     *p = a;
+                     break;
+                  case 1:
+                     *p = ((bx ^ by) & 4) ? a : b;
+                     break;
+                  case 2:
+                     *p = (a & 0xff00ff) | (((by - y) * 16) << 8);
+                     break;
+                  default:
+                     *p = bench_rand() & 0xffffff;
+                     break;
+               }
+            }
+         }
+      }
+   }
+}
+
+static unsigned bench_bpp(enum retro_pixel_format fmt)
+{
+   return fmt == RETRO_PIXEL_FORMAT_RGB565 ? 2 : 4;
+}
+
+/* The frame scrolled by @shift pixels, in @fmt,
+ * with a pitch of BENCH_MAX_WIDTH pixels */
+static void bench_convert(uint8_t *out, const uint32_t *frame,
+      unsigned width, unsigned height, unsigned shift,
+      enum retro_pixel_format fmt)
+{
+   unsigned x, y;
+   size_t pitch = BENCH_MAX_WIDTH * bench_bpp(fmt);
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         uint32_t c = frame[y * width + (x + shift) % width];
+
+         if (fmt == RETRO_PIXEL_FORMAT_RGB565)
+            ((uint16_t*)(out + y * pitch))[x] = (uint16_t)(
+                    ((c >> 8) & 0xf800)
+                  | ((c >> 5) & 0x07e0)
+                  | ((c >> 3) & 0x001f));
+         else
+            ((uint32_t*)(out + y * pitch))[x] = c;
+      }
+   }
+}
+
+/* Runs BENCH_FRAMES frames through @filt, keeping the
+ * output of the last one. Returns ms per frame. */
+static double bench_run(rarch_softfilter_t *filt,
+      uint8_t *const *frames, unsigned width, unsigned height,
+      enum retro_pixel_format fmt, uint8_t *out, size_t out_stride)
+{
+   unsigned i;
+   size_t pitch       = BENCH_MAX_WIDTH * bench_bpp(fmt);
+   retro_time_t start = cpu_features_get_time_usec();
+
+   for (i = 0; i < BENCH_FRAMES; i++)
+      rarch_softfilter_process(filt, out, out_stride,
+            frames[i] + BENCH_PAD_ROWS * pitch, width, height, pitch);
+
+   return (cpu_features_get_time_usec() - start) / 1000.0 / BENCH_FRAMES;
+}
+
+static bool bench_filter(const char *path, unsigned threads,
+      enum retro_pixel_format fmt, uint8_t *const *frames,
+      const uint32_t *frame, const struct bench_size *size)
+{
+   unsigned i, out_w = 0, out_h = 0;
+   size_t out_stride;
+   uint8_t *out_serial, *out_tiled;
+   double ms_serial, ms_tiled;
+   enum retro_pixel_format out_fmt;
+   size_t pitch               = BENCH_MAX_WIDTH * bench_bpp(fmt);
+   bool ok                    = true;
+   rarch_softfilter_t *serial = rarch_softfilter_new(path, 1, fmt,
+         BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT);
+   rarch_softfilter_t *tiled  = rarch_softfilter_new(path, threads, fmt,
+         BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT);
+
+   if (!serial || !tiled)
+   {
+      rarch_softfilter_free(serial);
+      rarch_softfilter_free(tiled);
+      return true;
+   }
+
+   for (i = 0; i < BENCH_FRAMES; i++)
+      bench_convert(frames[i] + BENCH_PAD_ROWS * pitch, frame,
+            size->width, size->height, i, fmt);
+
+   out_fmt    = rarch_softfilter_get_output_format(serial);
+   rarch_softfilter_get_max_output_size(serial, &out_w, &out_h);
+   out_stride = out_w * bench_bpp(out_fmt);
+   out_serial = (uint8_t*)calloc(out_h, out_stride);
+   out_tiled  = (uint8_t*)calloc(out_h, out_stride);
+
+   ms_serial  = bench_run(serial, frames, size->width, size->height,
+         fmt, out_serial, out_stride);
+   ms_tiled   = bench_run(tiled,  frames, size->width, size->height,
+         fmt, out_tiled, out_stride);
+
+   rarch_softfilter_get_output_size(serial, &out_w, &out_h,
+         size->width, size->height);
+   for (i = 0; i < out_h; i++)
+      if (memcmp(out_serial + i * out_stride, out_tiled + i * out_stride,
+               out_w * bench_bpp(out_fmt)))
+         ok = false;
+
+   printf("%-48s %-6s %3ux%-3u %7.3f ms %7.3f ms %5.2fx%s\n",
+         path_basename(path),
+         fmt == RETRO_PIXEL_FORMAT_RGB565 ? "565" : "8888",
+         size->width, size->height, ms_serial, ms_tiled,
+         ms_serial / ms_tiled, ok ? "" : "  MISMATCH");
+
+   free(out_serial);
+   free(out_tiled);
+   rarch_softfilter_free(serial);
+   rarch_softfilter_free(tiled);
+   return ok;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, s;
+   uint8_t *frames[BENCH_FRAMES];
+   uint32_t *frame;
+   struct string_list *list;
+   bool ok          = true;
+   const char *dir  = argc > 1 ? argv[1] : "../../gfx/video_filters";
+   unsigned threads = argc > 2
+      ? (unsigned)strtoul(argv[2], NULL, 0)
+      : MAX(cpu_features_get_core_amount(), 2);
+
+   if (!(list = dir_list_new(dir, "filt", false, false, false, false)))
+   {
+      fprintf(stderr, "No filters in %s.\n", dir);
+      return 1;
+   }
+   dir_list_sort(list, true);
+
+   frame = (uint32_t*)malloc(BENCH_MAX_WIDTH * BENCH_MAX_HEIGHT * 4);
+   for (i = 0; i < BENCH_FRAMES; i++)
+      frames[i] = (uint8_t*)calloc(BENCH_MAX_HEIGHT + BENCH_PAD_ROWS * 2,
+            BENCH_MAX_WIDTH * 4);
+
+   printf("%u cores, %u threads\n", cpu_features_get_core_amount(), threads);
+   printf("%-48s %-6s %-7s %10s %10s\n", "filter", "format", "size",
+         "1 thread", "tiled");
+
+   for (s = 0; s < ARRAY_SIZE(bench_sizes); s++)
+   {
+      bench_fill(frame, bench_sizes[s].width, bench_sizes[s].height);
+
+      for (i = 0; i < list->size; i++)
+      {
+         ok = bench_filter(list->elems[i].data, threads,
+               RETRO_PIXEL_FORMAT_RGB565, frames, frame,
+               &bench_sizes[s]) && ok;
+         ok = bench_filter(list->elems[i].data, threads,
+               RETRO_PIXEL_FORMAT_XRGB8888, frames, frame,
+               &bench_sizes[s]) && ok;
+      }
+   }
+
+   for (i = 0; i < BENCH_FRAMES; i++)
+      free(frames[i]);
+   free(frame);
+   string_list_free(list);
+
+   if (!ok)
+   {
+      fprintf(stderr, "Tiled output doesn't match.\n");
+      return 1;
+   }
+
+   return 0;
+}
@@ -20,6 +20,7 @@
 #include <time.h>
 
 #include <lists/string_list.h>
+#include <encodings/crc32.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
 #include <streams/rzip_stream.h>
@@ -44,6 +45,33 @@
 #include "../cheat_manager.h"
 #endif
 
+/* Autosaves compare and write save RAM in pages of
+ * this size, so a small change doesn't rewrite the
+ * whole file */
+#define SAVE_PAGE_SIZE           4096
+
+/* Pages written in place are first put in a journal
+ * next to the save file, which is replayed on the next
+ * load if RetroArch stopped while writing them. Nothing
+ * is synced to disk, so this protects against crashes of
+ * RetroArch, not of the system. The journal holds, in
+ * little endian:
+ * - "RASJ"
+ * - the page size (32 bits)
+ * - the size of the save file (64 bits)
+ * - the number of pages (32 bits)
+ * - for each page, its index (32 bits) and its data
+ * - the CRC32 of all of the above */
+#define SAVE_JOURNAL_EXT         ".journal"
+#define SAVE_JOURNAL_MAGIC       "RASJ"
+#define SAVE_JOURNAL_HEADER_SIZE 20
+
+/* Whole files are written next to the save file first,
+ * then renamed over it. Where that can't be done in one
+ * step, the save file is moved aside while it is */
+#define SAVE_TMP_EXT             ".tmp"
+#define SAVE_BACKUP_EXT          ".bak"
+
 struct ram_type
 {
    const char *path;
@@ -52,6 +80,164 @@ struct ram_type
 
 static struct string_list *task_save_files = NULL;
 
+static uint32_t save_journal_load32(const uint8_t *in)
+{
+   return  (uint32_t)in[0]
+        | ((uint32_t)in[1] << 8)
+        | ((uint32_t)in[2] << 16)
+        | ((uint32_t)in[3] << 24);
+}
+
+/**
+ * save_file_recover:
+ * @path            : path of the save file
+ *
+ * Puts back the save file if RetroArch stopped while
+ * it was moved aside to be replaced (see SAVE_BACKUP_EXT).
+ * The new file was complete by then, so it is used if
+ * it is there.
+ **/
+static void save_file_recover(const char *path)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   char backup_path[PATH_MAX_LENGTH];
+
+   strlcpy(backup_path, path, sizeof(backup_path));
+   strlcat(backup_path, SAVE_BACKUP_EXT, sizeof(backup_path));
+
+   if (!path_is_valid(backup_path))
+      return;
+
+   if (!path_is_valid(path))
+   {
+      strlcpy(tmp_path, path, sizeof(tmp_path));
+      strlcat(tmp_path, SAVE_TMP_EXT, sizeof(tmp_path));
+
+      if (     (!path_is_valid(tmp_path)
+               || filestream_rename(tmp_path, path) != 0)
+            && filestream_rename(backup_path, path) != 0)
+      {
+         RARCH_ERR("[SRAM]: Failed to restore \"%s\".\n", path);
+         return;
+      }
+
+      RARCH_LOG("[SRAM]: Restored interrupted save of \"%s\".\n",
+            path);
+   }
+
+   filestream_delete(backup_path);
+}
+
+/**
+ * save_journal_replay:
+ * @path            : path of the save file
+ *
+ * Finishes writing the pages in the journal of @path
+ * to it, if an autosave was interrupted, and deletes
+ * the journal. A journal that was not fully written is
+ * discarded, as the save file is still intact then.
+ * The journal is kept if it could not be replayed,
+ * to try again on the next load.
+ **/
+static void save_journal_replay(const char *path)
+{
+   size_t i, pos;
+   char journal_path[PATH_MAX_LENGTH];
+   int64_t len       = 0;
+   void *buf         = NULL;
+   const uint8_t *in = NULL;
+   RFILE *file       = NULL;
+   bool ok           = true;
+   uint32_t page_size, num_pages;
+   uint64_t file_size;
+
+   strlcpy(journal_path, path, sizeof(journal_path));
+   strlcat(journal_path, SAVE_JOURNAL_EXT, sizeof(journal_path));
+
+   if (!path_is_valid(journal_path))
+      return;
+
+   if (!filestream_read_file(journal_path, &buf, &len))
+      goto error;
+
+   if (len < SAVE_JOURNAL_HEADER_SIZE + 4)
+      goto invalid;
+
+   in        = (const uint8_t*)buf;
+   page_size = save_journal_load32(in + 4);
+   file_size = save_journal_load32(in + 8)
+      | ((uint64_t)save_journal_load32(in + 12) << 32);
+   num_pages = save_journal_load32(in + 16);
+
+   if (     memcmp(in, SAVE_JOURNAL_MAGIC, 4)
+         || !page_size
+         || save_journal_load32(in + len - 4)
+            != encoding_crc32(0, in, (size_t)len - 4))
+      goto invalid;
+
+   /* Check that every page lies within the journal
+    * and the file before touching the file */
+   pos = SAVE_JOURNAL_HEADER_SIZE;
+   for (i = 0; i < num_pages; i++)
+   {
+      uint64_t offset;
+
+      if (pos + 4 > (size_t)len - 4)
+         goto invalid;
+      offset = (uint64_t)save_journal_load32(in + pos) * page_size;
+      if (offset >= file_size)
+         goto invalid;
+      pos   += 4 + (size_t)MIN(page_size, file_size - offset);
+   }
+   if (pos != (size_t)len - 4)
+      goto invalid;
+
+   if (!(file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto error;
+
+   /* The journal was made for another file */
+   if (filestream_get_size(file) != (int64_t)file_size)
+   {
+      filestream_close(file);
+      goto invalid;
+   }
+
+   pos = SAVE_JOURNAL_HEADER_SIZE;
+   for (i = 0; ok && i < num_pages; i++)
+   {
+      uint64_t offset = (uint64_t)save_journal_load32(in + pos)
+         * page_size;
+      size_t page_len = (size_t)MIN(page_size, file_size - offset);
+
+      ok   =    filestream_seek(file, (int64_t)offset,
+                  RETRO_VFS_SEEK_POSITION_START) >= 0
+             && filestream_write(file, in + pos + 4, page_len)
+                == (int64_t)page_len;
+      pos += 4 + page_len;
+   }
+
+   if (filestream_close(file) != 0)
+      ok = false;
+
+   if (!ok)
+      goto error;
+
+   RARCH_LOG("[SRAM]: Finished interrupted autosave of \"%s\".\n",
+         path);
+
+invalid:
+   filestream_delete(journal_path);
+   free(buf);
+   return;
+
+error:
+   RARCH_ERR("[SRAM]: Failed to finish interrupted autosave of \"%s\".\n",
+         path);
+   free(buf);
+}
+
 #ifdef HAVE_THREADS
 typedef struct autosave autosave_t;
 
@@ -65,7 +251,10 @@ struct autosave_st
 enum autosave_flags
 {
    AUTOSAVE_FLAG_QUIT           = (1 << 0),
-   AUTOSAVE_FLAG_COMPRESS_FILES = (1 << 1)
+   AUTOSAVE_FLAG_COMPRESS_FILES = (1 << 1),
+   /* The save file was written outside of the autosave
+    * thread, so it no longer matches 'buffer' */
+   AUTOSAVE_FLAG_FILE_CHANGED   = (1 << 2)
 };
 
 struct autosave
@@ -73,17 +262,262 @@ struct autosave
    void *buffer;
    const void *retro_buffer;
    const char *path;
+   size_t *dirty;          /* Indices of the pages changed
+                              since the last save */
    slock_t *lock;
    slock_t *cond_lock;
    scond_t *cond;
    sthread_t *thread;
    size_t bufsize;
+   size_t num_pages;
    unsigned interval;
    uint8_t flags;
 };
 
 static struct autosave_st autosave_state;
 
+static void save_journal_store32(uint8_t *out, uint32_t val)
+{
+   out[0] = (uint8_t)(val);
+   out[1] = (uint8_t)(val >> 8);
+   out[2] = (uint8_t)(val >> 16);
+   out[3] = (uint8_t)(val >> 24);
+}
+
+
+/**
+ * autosave_copy_pages:
+ * @save            : pointer to autosave object
+ *
+ * Copies the pages of save RAM that changed since the
+ * last call to the autosave buffer. Pages are compared
+ * without the autosave lock, which the core waits on,
+ * so it is only taken if some page changed, to compare
+ * and copy those again while the core can't write them.
+ * A page changed during the first compare is copied on
+ * the next call.
+ *
+ * @return Number of changed pages, listed in save->dirty.
+ **/
+static size_t autosave_copy_pages(autosave_t *save)
+{
+   size_t i;
+   size_t num_changed = 0;
+   size_t num_dirty   = 0;
+
+   for (i = 0; i < save->num_pages; i++)
+   {
+      size_t offset = i * SAVE_PAGE_SIZE;
+
+      if (memcmp((const uint8_t*)save->buffer + offset,
+               (const uint8_t*)save->retro_buffer + offset,
+               MIN(SAVE_PAGE_SIZE, save->bufsize - offset)))
+         save->dirty[num_changed++] = i;
+   }
+
+   if (!num_changed)
+      return 0;
+
+   slock_lock(save->lock);
+   for (i = 0; i < num_changed; i++)
+   {
+      size_t offset      = save->dirty[i] * SAVE_PAGE_SIZE;
+      size_t len         = MIN(SAVE_PAGE_SIZE, save->bufsize - offset);
+      uint8_t *dst       = (uint8_t*)save->buffer + offset;
+      const uint8_t *src = (const uint8_t*)save->retro_buffer + offset;
+
+      if (memcmp(dst, src, len))
+      {
+         memcpy(dst, src, len);
+         save->dirty[num_dirty++] = save->dirty[i];
+      }
+   }
+   slock_unlock(save->lock);
+
+   return num_dirty;
+}
+
+static bool autosave_write_journal(autosave_t *save,
+      const char *journal_path, size_t num_dirty)
+{
+   size_t i;
+   uint8_t header[SAVE_JOURNAL_HEADER_SIZE];
+   uint8_t crc_buf[4];
+   uint32_t crc;
+   bool ok     = true;
+   RFILE *file = filestream_open(journal_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   memcpy(header, SAVE_JOURNAL_MAGIC, 4);
+   save_journal_store32(header + 4,  SAVE_PAGE_SIZE);
+   save_journal_store32(header + 8,  (uint32_t)save->bufsize);
+   save_journal_store32(header + 12, (uint32_t)((uint64_t)save->bufsize >> 32));
+   save_journal_store32(header + 16, (uint32_t)num_dirty);
+   ok  = filestream_write(file, header, sizeof(header)) == sizeof(header);
+   crc = encoding_crc32(0, header, sizeof(header));
+
+   for (i = 0; ok && i < num_dirty; i++)
+   {
+      uint8_t index[4];
+      size_t offset     = save->dirty[i] * SAVE_PAGE_SIZE;
+      size_t len        = MIN(SAVE_PAGE_SIZE, save->bufsize - offset);
+      const uint8_t *in = (const uint8_t*)save->buffer + offset;
+
+      save_journal_store32(index, (uint32_t)save->dirty[i]);
+      ok  =    filestream_write(file, index, 4)   == 4
+            && filestream_write(file, in, len)    == (int64_t)len;
+      crc = encoding_crc32(crc, index, 4);
+      crc = encoding_crc32(crc, in, len);
+   }
+
+   save_journal_store32(crc_buf, crc);
+   if (ok)
+      ok = filestream_write(file, crc_buf, 4) == 4;
+
+   if (filestream_close(file) != 0)
+      ok = false;
+
+   return ok;
+}
+
+/**
+ * autosave_write_pages:
+ * @save            : pointer to autosave object
+ * @num_dirty       : number of pages in save->dirty
+ *
+ * Writes the changed pages over the save file in place,
+ * which must hold the rest of the autosave buffer already.
+ * The pages go to the journal first, so the file can be
+ * completed on the next load if this is interrupted.
+ *
+ * @return true if successful. The journal is kept on
+ * failure, as the file may be partially updated.
+ **/
+static bool autosave_write_pages(autosave_t *save, size_t num_dirty)
+{
+   size_t i;
+   char journal_path[PATH_MAX_LENGTH];
+   RFILE *file = NULL;
+   bool ok     = false;
+
+   strlcpy(journal_path, save->path, sizeof(journal_path));
+   strlcat(journal_path, SAVE_JOURNAL_EXT, sizeof(journal_path));
+
+   if (!autosave_write_journal(save, journal_path, num_dirty))
+   {
+      filestream_delete(journal_path);
+      return false;
+   }
+
+   if ((file = filestream_open(save->path,
+         RETRO_VFS_FILE_ACCESS_WRITE | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      ok = filestream_get_size(file) == (int64_t)save->bufsize;
+
+      for (i = 0; ok && i < num_dirty; i++)
+      {
+         size_t offset = save->dirty[i] * SAVE_PAGE_SIZE;
+         size_t len    = MIN(SAVE_PAGE_SIZE, save->bufsize - offset);
+
+         ok =    filestream_seek(file, (int64_t)offset,
+                     RETRO_VFS_SEEK_POSITION_START) >= 0
+              && filestream_write(file,
+                     (const uint8_t*)save->buffer + offset, len)
+                 == (int64_t)len;
+      }
+
+      if (filestream_close(file) != 0)
+         ok = false;
+   }
+
+   if (ok)
+      filestream_delete(journal_path);
+
+   return ok;
+}
+
+/**
+ * autosave_write_file:
+ * @save            : pointer to autosave object
+ *
+ * Writes the whole autosave buffer to a temporary file,
+ * which then replaces the save file, so a crash of
+ * RetroArch never leaves it partially written.
+ *
+ * @return true if successful.
+ **/
+static bool autosave_write_file(autosave_t *save)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   char journal_path[PATH_MAX_LENGTH];
+   intfstream_t *file = NULL;
+   bool ok            = false;
+
+   strlcpy(tmp_path, save->path, sizeof(tmp_path));
+   strlcat(tmp_path, SAVE_TMP_EXT, sizeof(tmp_path));
+
+   if (save->flags & AUTOSAVE_FLAG_COMPRESS_FILES)
+      file = intfstream_open_rzip_file(tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE);
+   else
+      file = intfstream_open_file(tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   ok = intfstream_write(file, save->buffer, save->bufsize)
+      == (int64_t)save->bufsize;
+   intfstream_flush(file);
+   if (intfstream_close(file) != 0)
+      ok = false;
+   free(file);
+
+   if (!ok)
+   {
+      filestream_delete(tmp_path);
+      return false;
+   }
+
+   /* Renaming over an existing file fails on Windows:
+    * move the save file aside meanwhile rather than
+    * deleting it, save_file_recover() puts it back */
+   if (filestream_rename(tmp_path, save->path) != 0)
+   {
+      char backup_path[PATH_MAX_LENGTH];
+
+      strlcpy(backup_path, save->path, sizeof(backup_path));
+      strlcat(backup_path, SAVE_BACKUP_EXT, sizeof(backup_path));
+      filestream_delete(backup_path);
+
+      if (filestream_rename(save->path, backup_path) != 0)
+      {
+         filestream_delete(tmp_path);
+         return false;
+      }
+
+      if (filestream_rename(tmp_path, save->path) != 0)
+      {
+         filestream_rename(backup_path, save->path);
+         filestream_delete(tmp_path);
+         return false;
+      }
+
+      filestream_delete(backup_path);
+   }
+
+   /* A journal left by a failed in-place write
+    * would be replayed over the new file */
+   strlcpy(journal_path, save->path, sizeof(journal_path));
+   strlcat(journal_path, SAVE_JOURNAL_EXT, sizeof(journal_path));
+   filestream_delete(journal_path);
+
+   return true;
+}
 
 /**
  * autosave_thread:
@@ -93,39 +527,28 @@ static struct autosave_st autosave_state;
  **/
 static void autosave_thread(void *data)
 {
-   autosave_t *save = (autosave_t*)data;
+   autosave_t *save  = (autosave_t*)data;
+   /* Whether the save file holds the autosave buffer as
+    * of the last save, so that pages changed since then
+    * can be written in place. Compressed files are always
+    * rewritten. */
+   bool file_current = false;
 
    for (;;)
    {
-      bool differ;
+      size_t num_dirty;
 
-      slock_lock(save->lock);
-      differ = memcmp(save->buffer, save->retro_buffer,
-            save->bufsize) != 0;
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
-      slock_unlock(save->lock);
+      num_dirty = autosave_copy_pages(save);
 
-      if (differ)
-      {
-         intfstream_t *file = NULL;
-
-         /* Should probably deal with this more elegantly. */
-         if (save->flags & AUTOSAVE_FLAG_COMPRESS_FILES)
-            file = intfstream_open_rzip_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE);
-         else
-            file = intfstream_open_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-         if (file)
-         {
-            intfstream_write(file, save->buffer, save->bufsize);
-            intfstream_flush(file);
-            intfstream_close(file);
-            free(file);
-         }
-      }
+      /* In place writes go through the journal, which
+       * doubles their cost, so rewrite the whole file
+       * instead once half of it changed */
+      if (num_dirty && !(
+               file_current
+            && num_dirty <= save->num_pages / 2
+            && autosave_write_pages(save, num_dirty)))
+         file_current = autosave_write_file(save)
+            && !(save->flags & AUTOSAVE_FLAG_COMPRESS_FILES);
 
       slock_lock(save->cond_lock);
 
@@ -144,6 +567,12 @@ static void autosave_thread(void *data)
 #endif
             );
 
+      if (save->flags & AUTOSAVE_FLAG_FILE_CHANGED)
+      {
+         save->flags &= ~AUTOSAVE_FLAG_FILE_CHANGED;
+         file_current = false;
+      }
+
       slock_unlock(save->cond_lock);
    }
 }
@@ -176,6 +605,8 @@ static autosave_t *autosave_new(const char *path,
       handle->flags             |= AUTOSAVE_FLAG_COMPRESS_FILES;
    handle->retro_buffer          = data;
    handle->path                  = path;
+   handle->num_pages             = (size + SAVE_PAGE_SIZE - 1)
+      / SAVE_PAGE_SIZE;
 
    if (!(buf = malloc(size)))
    {
@@ -183,6 +614,14 @@ static autosave_t *autosave_new(const char *path,
       return NULL;
    }
 
+   if (!(handle->dirty = (size_t*)malloc(
+               handle->num_pages * sizeof(size_t))))
+   {
+      free(buf);
+      free(handle);
+      return NULL;
+   }
+
    handle->buffer                = buf;
 
    memcpy(handle->buffer, handle->retro_buffer, handle->bufsize);
@@ -216,6 +655,8 @@ static void autosave_free(autosave_t *handle)
    if (handle->buffer)
       free(handle->buffer);
    handle->buffer = NULL;
+   free(handle->dirty);
+   handle->dirty  = NULL;
 }
 
 bool autosave_init(void)
@@ -292,6 +733,25 @@ void autosave_deinit(void)
    autosave_state.num      = 0;
 }
 
+/**
+ * autosave_file_changed:
+ * @slot            : index of the save file
+ *
+ * Tells the autosave of @slot that its save file was
+ * written elsewhere, so it must not be patched in place.
+ **/
+static void autosave_file_changed(unsigned slot)
+{
+   autosave_t *handle = NULL;
+
+   if (slot >= autosave_state.num || !(handle = autosave_state.list[slot]))
+      return;
+
+   slock_lock(handle->cond_lock);
+   handle->flags |= AUTOSAVE_FLAG_FILE_CHANGED;
+   slock_unlock(handle->cond_lock);
+}
+
 /**
  * autosave_lock:
  *
@@ -359,12 +819,17 @@ static bool content_load_ram_file(unsigned slot)
    if (!content_get_memory(&mem_info, &ram, slot))
       return false;
 
+   if (string_is_empty(ram.path))
+      return false;
+
+   save_file_recover(ram.path);
+   save_journal_replay(ram.path);
+
    /* On first run of content, SRAM file will
     * not exist. This is a common enough occurrence
     * that we should check before attempting to
     * invoke the relevant read_file() function */
-   if (    string_is_empty(ram.path)
-       || !path_is_valid(ram.path))
+   if (!path_is_valid(ram.path))
       return false;
 
 #if defined(HAVE_ZLIB)
@@ -473,6 +938,10 @@ static bool content_save_ram_file(unsigned slot, bool compress)
          msg_hash_to_str(MSG_TO),
          ram.path);
 
+#ifdef HAVE_THREADS
+   autosave_file_changed(slot);
+#endif
+
 #if defined(HAVE_ZLIB)
    if (compress)
    {
@@ -488,6 +957,15 @@ static bool content_save_ram_file(unsigned slot, bool compress)
          goto fail;
    }
 
+   /* A journal left by a failed autosave would be
+    * replayed over the new file */
+   {
+      char journal_path[PATH_MAX_LENGTH];
+      strlcpy(journal_path, ram.path, sizeof(journal_path));
+      strlcat(journal_path, SAVE_JOURNAL_EXT, sizeof(journal_path));
+      filestream_delete(journal_path);
+   }
+
    RARCH_LOG("[SRAM]: %s \"%s\".\n",
          msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
          ram.path);
@@ -24,10 +24,19 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
 
 #include "state_manager.h"
+
+#ifdef HAVE_STATE_MANAGER_COLD
+#include <streams/trans_stream.h>
+#endif
 #include "msg_hash.h"
 #include "core.h"
 #include "core_info.h"
@@ -52,6 +61,20 @@
 #define UINT32_MAX 0xffffffffu
 #endif
 
+/* Uncompressed size of the patch batches
+ * making up the compressed history */
+#define STATE_MANAGER_COLD_BATCH_SIZE (1 << 20)
+/* Batches are compressed during gameplay, favour speed */
+#define STATE_MANAGER_COLD_LEVEL      1
+
+#ifdef HAVE_ZSTD
+#define STATE_MANAGER_COLD_COMPRESS   trans_stream_get_zstd_compress_backend
+#define STATE_MANAGER_COLD_DECOMPRESS trans_stream_get_zstd_decompress_backend
+#else
+#define STATE_MANAGER_COLD_COMPRESS   trans_stream_get_zlib_deflate_backend
+#define STATE_MANAGER_COLD_DECOMPRESS trans_stream_get_zlib_inflate_backend
+#endif
+
 #if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__) || defined(_M_IX86) || defined(_M_AMD64) || defined(_M_X64)
 #define CPU_X86
 #endif
@@ -65,6 +88,20 @@
 #include <emmintrin.h>
 #endif
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_STATE_MANAGER_NEON
+#endif
+
+/* AVX2 kernels are built regardless of compiler flags
+ * and picked at runtime */
+#if defined(CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define HAVE_STATE_MANAGER_AVX2
+#endif
+
+typedef size_t (*state_manager_find_t)(const uint16_t *a, const uint16_t *b);
+
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
@@ -113,6 +150,33 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       a128++;
       b128++;
    }
+#elif defined(HAVE_STATE_MANAGER_NEON)
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      uint64x2_t c = vreinterpretq_u64_u8(
+            vceqq_u8(vld1q_u8(a8), vld1q_u8(b8)));
+      uint64_t lo  = ~vgetq_lane_u64(c, 0);
+      uint64_t hi  = ~vgetq_lane_u64(c, 1);
+
+      if (lo | hi) /* Something has changed, figure out where. */
+      {
+         uint64_t diff = lo ? lo : hi;
+         size_t ret    = (a8 - (const uint8_t*)a) + (lo ? 0 : 8);
+
+         if ((uint32_t)diff)
+            ret       += compat_ctz((uint32_t)diff) >> 3;
+         else
+            ret       += 4 + (compat_ctz((uint32_t)(diff >> 32)) >> 3);
+
+         return (ret >> 1);
+      }
+
+      a8 += 16;
+      b8 += 16;
+   }
 #else
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -148,6 +212,39 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
 static size_t find_same(const uint16_t *a, const uint16_t *b)
 {
    const uint16_t *a_org = a;
+#if __SSE2__
+   /* Same as the generic version below,
+    * testing four words at a time */
+   const uint8_t *a8     = (const uint8_t*)a;
+   const uint8_t *b8     = (const uint8_t*)b;
+
+   for (;;)
+   {
+      __m128i c     = _mm_cmpeq_epi32(
+            _mm_loadu_si128((const __m128i*)a8),
+            _mm_loadu_si128((const __m128i*)b8));
+      uint32_t mask = _mm_movemask_ps(_mm_castsi128_ps(c));
+
+      if (mask)
+      {
+         a8 += compat_ctz(mask) * sizeof(uint32_t);
+         b8 += compat_ctz(mask) * sizeof(uint32_t);
+         break;
+      }
+
+      a8 += 16;
+      b8 += 16;
+   }
+
+   a = (const uint16_t*)a8;
+   b = (const uint16_t*)b8;
+
+   if (a != a_org && a[-1] == b[-1])
+   {
+      a--;
+      b--;
+   }
+#else
 #ifdef NO_UNALIGNED_MEM
    if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
    {
@@ -182,9 +279,87 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
          b--;
       }
    }
+#endif
    return a - a_org;
 }
 
+#ifdef HAVE_STATE_MANAGER_AVX2
+__attribute__((target("avx2")))
+static size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i c     = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(a256), _mm256_loadu_si256(b256));
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffff)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+         return (ret >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+__attribute__((target("avx2")))
+static size_t find_same_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+   const uint8_t *a8     = (const uint8_t*)a;
+   const uint8_t *b8     = (const uint8_t*)b;
+
+   for (;;)
+   {
+      __m256i c     = _mm256_cmpeq_epi32(
+            _mm256_loadu_si256((const __m256i*)a8),
+            _mm256_loadu_si256((const __m256i*)b8));
+      uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(c));
+
+      if (mask)
+      {
+         a8 += compat_ctz(mask) * sizeof(uint32_t);
+         b8 += compat_ctz(mask) * sizeof(uint32_t);
+         break;
+      }
+
+      a8 += 32;
+      b8 += 32;
+   }
+
+   a = (const uint16_t*)a8;
+   b = (const uint16_t*)b8;
+
+   if (a != a_org && a[-1] == b[-1])
+   {
+      a--;
+      b--;
+   }
+   return a - a_org;
+}
+#endif
+
+/* Scan kernels for this CPU, see state_manager_init_kernels() */
+static state_manager_find_t state_manager_find_change = find_change;
+static state_manager_find_t state_manager_find_same   = find_same;
+
+static void state_manager_init_kernels(void)
+{
+#ifdef HAVE_STATE_MANAGER_AVX2
+   if (cpu_features_get() & RETRO_SIMD_AVX2)
+   {
+      state_manager_find_change = find_change_avx2;
+      state_manager_find_same   = find_same_avx2;
+   }
+#endif
+}
+
 /* Returns the maximum compressed size of a savestate.
  * It is very likely to compress to far less. */
 static size_t state_manager_raw_maxsize(size_t uncomp)
@@ -206,7 +381,7 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 32, 1);
 
    if (!ret)
       return NULL;
@@ -220,8 +395,8 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
+    * It doesn't make any difference to us, but sacrificing 32 bytes (the
+    * widest vector scan) to get Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
@@ -247,7 +422,7 @@ static size_t state_manager_raw_compress(const void *src,
    while (num16s)
    {
       size_t i, changed;
-      size_t skip = find_change(old16, new16);
+      size_t skip = state_manager_find_change(old16, new16);
 
       if (skip >= num16s)
          break;
@@ -270,7 +445,7 @@ static size_t state_manager_raw_compress(const void *src,
          continue;
       }
 
-      changed         = find_same(old16, new16);
+      changed         = state_manager_find_same(old16, new16);
       if (changed > UINT16_MAX)
          changed = UINT16_MAX;
 
@@ -340,6 +515,30 @@ static void state_manager_raw_decompress(const void *patch,
    }
 }
 
+/* Returns the size of a patch from state_manager_raw_compress(). */
+static size_t state_manager_raw_patch_size(const void *patch)
+{
+   const uint16_t *patch16 = (const uint16_t*)patch;
+
+   for (;;)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+         patch16          += numchanged + 1;
+      else
+      {
+         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
+
+         patch16          += 2;
+         if (!numunchanged)
+            break;
+      }
+   }
+
+   return (const uint8_t*)patch16 - (const uint8_t*)patch;
+}
+
 /* The start offsets point to 'nextstart' of any given compressed frame.
  * Each uint16 is stored native endian; anything that claims any other
  * endianness refers to the endianness of this specific item.
@@ -375,11 +574,298 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+#ifdef HAVE_STATE_MANAGER_COLD
+/* Once the ring is full, the patches leaving it are appended to the
+ * warm buffer instead of being discarded. A full warm buffer is
+ * frozen and compressed into a new cold batch, dropping the oldest
+ * batches when the cold capacity is exceeded.
+ *
+ * Popping past the end of the ring takes the patches back from the
+ * end of the warm buffer, decompressing the newest batch into it once it
+ * runs empty. Any patch in the warm buffer or the batches is older
+ * than the ones in the ring, so the order is kept in both ways. */
+struct state_manager_cold_batch
+{
+   uint8_t *data;
+   size_t size;
+   size_t raw_size;
+   unsigned entries;
+};
+
+static void state_manager_cold_drop_oldest(state_manager_t *state)
+{
+   struct state_manager_cold_batch *batch = &state->cold[0];
+
+   state->cold_size     -= batch->size;
+   state->cold_raw_size -= batch->raw_size;
+   state->cold_entries  -= batch->entries;
+   state->entries       -= batch->entries;
+   free(batch->data);
+
+   state->cold_count--;
+   memmove(state->cold, state->cold + 1,
+         state->cold_count * sizeof(*state->cold));
+}
+
+/* Compresses the frozen buffer, on the worker if there is one */
+static void state_manager_cold_compress(state_manager_t *state)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   const struct trans_stream_backend *backend =
+      STATE_MANAGER_COLD_COMPRESS();
+   void *stream      = NULL;
+   /* Worst case growth of both zstd and deflate */
+   size_t out_size   = state->frozen_size + state->frozen_size / 128 + 64;
+   uint8_t *out      = (uint8_t*)malloc(out_size);
+
+   state->frozen_out_size = 0;
+
+   if (out && (stream = backend->stream_new()))
+   {
+      backend->define(stream, "level", STATE_MANAGER_COLD_LEVEL);
+      backend->set_in(stream, state->frozen, (uint32_t)state->frozen_size);
+      backend->set_out(stream, out, (uint32_t)out_size);
+      if (     backend->trans(stream, true, &rd, &wn, &err)
+            && rd == state->frozen_size)
+         state->frozen_out_size = wn;
+      backend->stream_free(stream);
+   }
+
+   if (!state->frozen_out_size)
+   {
+      free(out);
+      out = NULL;
+   }
+
+   state->frozen_out = out;
+}
+
+/* Files the compressed frozen buffer as the newest batch */
+static void state_manager_cold_commit(state_manager_t *state)
+{
+   if (!state->frozen_entries)
+      return;
+
+   if (state->cold_count == state->cold_slots)
+   {
+      size_t slots   = state->cold_slots ? state->cold_slots * 2 : 16;
+      struct state_manager_cold_batch *cold =
+         (struct state_manager_cold_batch*)realloc(state->cold,
+               slots * sizeof(*cold));
+      if (cold)
+      {
+         state->cold       = cold;
+         state->cold_slots = slots;
+      }
+   }
+
+   if (state->frozen_out && state->cold_count < state->cold_slots)
+   {
+      struct state_manager_cold_batch *batch =
+         &state->cold[state->cold_count++];
+      uint8_t *shrunk      = (uint8_t*)realloc(state->frozen_out,
+            state->frozen_out_size);
+
+      batch->data          = shrunk ? shrunk : state->frozen_out;
+      batch->size          = state->frozen_out_size;
+      batch->raw_size      = state->frozen_size;
+      batch->entries       = state->frozen_entries;
+      state->cold_size    += state->frozen_out_size;
+      state->cold_raw_size+= state->frozen_size;
+
+      while (state->cold_count && state->cold_size > state->cold_capacity)
+         state_manager_cold_drop_oldest(state);
+   }
+   else
+   {
+      /* Out of memory, that history is lost */
+      free(state->frozen_out);
+      state->cold_entries -= state->frozen_entries;
+      state->entries      -= state->frozen_entries;
+   }
+
+   state->frozen_out     = NULL;
+   state->frozen_size    = 0;
+   state->frozen_entries = 0;
+}
+
+/* Hands the warm buffer over to be compressed into a new batch.
+ * With a worker, that happens along with the next patch. */
+static void state_manager_cold_freeze(state_manager_t *state)
+{
+   uint8_t *swap         = state->frozen;
+
+   if (!state->warm_entries)
+      return;
+
+   /* Only one batch can be waiting for the worker */
+   if (state->frozen_entries)
+   {
+      state_manager_cold_compress(state);
+      state_manager_cold_commit(state);
+   }
+
+   state->frozen         = state->warm;
+   state->frozen_size    = state->warm_size;
+   state->frozen_entries = state->warm_entries;
+   state->warm           = swap;
+   state->warm_size      = 0;
+   state->warm_entries   = 0;
+
+#ifdef HAVE_THREADS
+   if (state->pool)
+      return;
+#endif
+
+   state_manager_cold_compress(state);
+   state_manager_cold_commit(state);
+}
+
+/* Moves the newest batch back into the (empty) warm buffer */
+static bool state_manager_cold_thaw(state_manager_t *state)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   struct state_manager_cold_batch *batch     = NULL;
+   const struct trans_stream_backend *backend =
+      STATE_MANAGER_COLD_DECOMPRESS();
+   void *stream = NULL;
+   bool ok      = false;
+
+   if (!state->cold_count)
+      return false;
+
+   batch        = &state->cold[--state->cold_count];
+
+   if ((stream = backend->stream_new()))
+   {
+      backend->set_in(stream, batch->data, (uint32_t)batch->size);
+      backend->set_out(stream, state->warm, (uint32_t)state->warm_capacity);
+      ok = backend->trans(stream, true, &rd, &wn, &err)
+         && wn == batch->raw_size;
+      backend->stream_free(stream);
+   }
+
+   state->cold_size     -= batch->size;
+   state->cold_raw_size -= batch->raw_size;
+   free(batch->data);
+
+   if (!ok)
+   {
+      state->cold_entries -= batch->entries;
+      state->entries      -= batch->entries;
+      return false;
+   }
+
+   state->warm_size      = batch->raw_size;
+   state->warm_entries   = batch->entries;
+   return true;
+}
+
+/* Appends a patch leaving the ring to the warm buffer */
+static void state_manager_cold_push(state_manager_t *state,
+      const uint8_t *patch)
+{
+   size_t size = state_manager_raw_patch_size(patch);
+
+   if (state->warm_size + size + sizeof(size_t) > state->warm_capacity)
+      state_manager_cold_freeze(state);
+
+   memcpy(state->warm + state->warm_size, patch, size);
+   write_size_t(state->warm + state->warm_size + size, size);
+   state->warm_size += size + sizeof(size_t);
+   state->warm_entries++;
+   state->cold_entries++;
+}
+
+/* Takes the newest patch out of the warm buffer or the batches */
+static const uint8_t *state_manager_cold_pop(state_manager_t *state)
+{
+   size_t size;
+
+   if (!state->warm_entries && !state_manager_cold_thaw(state))
+      return NULL;
+
+   size              = read_size_t(state->warm + state->warm_size
+         - sizeof(size_t));
+   state->warm_size -= size + sizeof(size_t);
+   state->warm_entries--;
+   state->cold_entries--;
+
+   return state->warm + state->warm_size;
+}
+#endif
+
+/* Drops the oldest patch out of the ring */
+static void state_manager_drop_tail(state_manager_t *state)
+{
+#ifdef HAVE_STATE_MANAGER_COLD
+   if (state->warm)
+      state_manager_cold_push(state, state->tail + sizeof(size_t));
+   else
+#endif
+      state->entries--;
+
+   state->tail = state->data + read_size_t(state->tail);
+}
+
+/* Copy of the ring usage for state_manager_get_stats(),
+ * taken while the worker is idle since it moves the head */
+static void state_manager_update_usage(state_manager_t *state)
+{
+   size_t headpos   = state->head - state->data;
+   size_t tailpos   = state->tail - state->data;
+
+   state->hot_size  = state->capacity - ((tailpos + state->capacity -
+            sizeof(size_t) - headpos - 1) % state->capacity + 1);
+}
+
+/* Waits for the patch of the previous push to be stored.
+ * The worker only writes that patch at the head and compresses
+ * the frozen batch; everything else, including the entry
+ * counts, belongs to the main thread. */
+static void state_manager_wait(state_manager_t *state)
+{
+#ifdef HAVE_THREADS
+   if (state->pool)
+      tpool_wait(state->pool);
+#endif
+#ifdef HAVE_STATE_MANAGER_COLD
+   state_manager_cold_commit(state);
+#endif
+   state_manager_update_usage(state);
+}
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+   if (state->data)
+      state_manager_wait(state);
+
+#ifdef HAVE_THREADS
+   if (state->pool)
+      tpool_destroy(state->pool);
+   if (state->spareblock)
+      free(state->spareblock);
+   state->pool       = NULL;
+   state->spareblock = NULL;
+#endif
+#ifdef HAVE_STATE_MANAGER_COLD
+   while (state->cold_count)
+      state_manager_cold_drop_oldest(state);
+   if (state->cold)
+      free(state->cold);
+   if (state->warm)
+      free(state->warm);
+   if (state->frozen)
+      free(state->frozen);
+   state->cold       = NULL;
+   state->warm       = NULL;
+   state->frozen     = NULL;
+#endif
    if (state->data)
       free(state->data);
    if (state->thisblock)
@@ -397,7 +883,7 @@ static void state_manager_free(state_manager_t *state)
 }
 
 static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
+      size_t state_size, size_t buffer_size, bool compress_history)
 {
    size_t max_comp_size, block_size;
    uint8_t *next_block    = NULL;
@@ -411,6 +897,28 @@ static state_manager_t *state_manager_new(
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+
+#ifdef HAVE_STATE_MANAGER_COLD
+   /* Half of the budget goes to the compressed history,
+    * as long as the ring can still hold a few patches */
+   if (compress_history && buffer_size / 2 >= max_comp_size * 4)
+   {
+      size_t warm_capacity = MAX(STATE_MANAGER_COLD_BATCH_SIZE,
+            max_comp_size + sizeof(size_t));
+
+      /* The warm buffer and the one being frozen */
+      if (buffer_size / 2 > warm_capacity * 3)
+      {
+         state->warm_capacity = warm_capacity;
+         state->cold_capacity = buffer_size / 2 - warm_capacity * 2;
+         buffer_size         -= buffer_size / 2;
+         if (     !(state->warm   = (uint8_t*)malloc(warm_capacity))
+               || !(state->frozen = (uint8_t*)malloc(warm_capacity)))
+            goto error;
+      }
+   }
+#endif
+
    state_data         = (uint8_t*)malloc(buffer_size);
 
    if (!state_data)
@@ -437,6 +945,27 @@ static state_manager_t *state_manager_new(
    state->debugblock  = (uint8_t*)malloc(state_size);
 #endif
 
+   state_manager_init_kernels();
+
+#ifdef HAVE_THREADS
+   /* Patches are compressed on a worker while the core runs the
+    * next frames, that needs a third block since both current
+    * blocks are in use until the patch is stored.
+    * Any two blocks can end up being compared, so each one
+    * gets its own end marker. */
+   if (cpu_features_get_core_amount() > 1)
+   {
+      state->spareblock = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+      if (state->spareblock)
+         state->pool    = tpool_create(1);
+      if (!state->pool && state->spareblock)
+      {
+         free(state->spareblock);
+         state->spareblock = NULL;
+      }
+   }
+#endif
+
    return state;
 
 error:
@@ -456,6 +985,8 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = NULL;
 
+   state_manager_wait(state);
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid    = false;
@@ -466,7 +997,18 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = state->thisblock;
    if (state->head == state->tail)
+   {
+#ifdef HAVE_STATE_MANAGER_COLD
+      if (state->warm && (compressed = state_manager_cold_pop(state)))
+      {
+         state_manager_raw_decompress(compressed,
+               state->maxcompsize, state->thisblock, state->blocksize);
+         state->entries--;
+         return true;
+      }
+#endif
       return false;
+   }
 
    start                        = read_size_t(state->head - sizeof(size_t));
    state->head                  = state->data + start;
@@ -477,6 +1019,7 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
          state->maxcompsize, out, state->blocksize);
 
    state->entries--;
+   state_manager_update_usage(state);
    return true;
 }
 
@@ -502,54 +1045,114 @@ static void state_manager_push_where(state_manager_t *state, void **data)
 #endif
 }
 
-static void state_manager_push_do(state_manager_t *state)
+/* Makes room at the head for the patch of the next push,
+ * dropping the oldest patches if needed */
+static bool state_manager_reserve(state_manager_t *state)
 {
-   uint8_t *swap = NULL;
+   size_t headpos, tailpos, remaining;
 
-#if STRICT_BUF_SIZE
-   memcpy(state->nextblock, state->debugblock, state->debugsize);
-#endif
+   if (state->capacity < sizeof(size_t) + state->maxcompsize)
+   {
+      RARCH_ERR("State capacity insufficient\n");
+      return false;
+   }
 
-   if (state->thisblock_valid)
+   /* The previous patch left too little room
+    * before the end of the buffer, wrap around */
+   headpos = state->head - state->data;
+   if (headpos - sizeof(size_t) + state->maxcompsize > state->capacity)
    {
-      const uint8_t *oldb, *newb;
-      uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
-      if (state->capacity < sizeof(size_t) + state->maxcompsize) {
-         RARCH_ERR("State capacity insufficient\n");
-         return;
+      size_t start = read_size_t(state->head - sizeof(size_t));
+
+      if (state->head == state->tail)
+         state->tail = state->data + sizeof(size_t);
+      else
+      {
+         if (state->tail == state->data + sizeof(size_t))
+            state_manager_drop_tail(state);
+         write_size_t(state->data, start);
+         write_size_t(state->data + start, sizeof(size_t));
       }
+      state->head = state->data + sizeof(size_t);
+   }
 
-recheckcapacity:;
+   for (;;)
+   {
       headpos   = state->head - state->data;
       tailpos   = state->tail - state->data;
       remaining = (tailpos + state->capacity -
             sizeof(size_t) - headpos - 1) % state->capacity + 1;
 
-      if (remaining <= state->maxcompsize)
-      {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
-      }
+      if (remaining > state->maxcompsize)
+         break;
 
-      oldb              = state->thisblock;
-      newb              = state->nextblock;
-      compressed        = state->head + sizeof(size_t);
+      state_manager_drop_tail(state);
+   }
+
+   return true;
+}
 
-      compressed       += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
+/* Stores the patch turning 'newb' back into 'oldb'.
+ * Room must have been made with state_manager_reserve() */
+static void state_manager_store_patch(state_manager_t *state,
+      const uint8_t *oldb, const uint8_t *newb)
+{
+   uint8_t *compressed = state->head + sizeof(size_t);
+
+   compressed         += state_manager_raw_compress(oldb, newb,
+         state->blocksize, compressed);
+
+   write_size_t(compressed, state->head-state->data);
+   compressed         += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head         = compressed;
+}
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
+#ifdef HAVE_THREADS
+static void state_manager_store_patch_job(void *arg)
+{
+   state_manager_t *state = (state_manager_t*)arg;
+#ifdef HAVE_STATE_MANAGER_COLD
+   if (state->frozen_entries)
+      state_manager_cold_compress(state);
+#endif
+   state_manager_store_patch(state, state->spareblock, state->thisblock);
+}
+#endif
+
+static void state_manager_push_do(state_manager_t *state)
+{
+   uint8_t *swap = NULL;
+
+#if STRICT_BUF_SIZE
+   memcpy(state->nextblock, state->debugblock, state->debugsize);
+#endif
+
+   if (state->thisblock_valid)
+   {
+      state_manager_wait(state);
+
+      if (!state_manager_reserve(state))
+         return;
+
+#ifdef HAVE_THREADS
+      if (state->pool)
       {
-         compressed     = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+         /* The old block is kept aside until the patch is stored,
+          * the core gets to serialize into the spare one meanwhile. */
+         swap              = state->spareblock;
+         state->spareblock = state->thisblock;
+         state->thisblock  = state->nextblock;
+         state->nextblock  = swap;
+         state->entries++;
+
+         tpool_add_work(state->pool, state_manager_store_patch_job, state);
+         return;
       }
-      write_size_t(compressed, state->head-state->data);
-      compressed       += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head       = compressed;
+#endif
+
+      state_manager_store_patch(state, state->thisblock, state->nextblock);
+      state_manager_update_usage(state);
    }
    else
       state->thisblock_valid = true;
@@ -579,9 +1182,38 @@ static void state_manager_capacity(state_manager_t *state,
 }
 #endif
 
+bool state_manager_get_stats(
+      const struct state_manager_rewind_state *rewind_st,
+      state_manager_stats_t *stats)
+{
+   const state_manager_t *state = NULL;
+
+   if (!rewind_st || !(state = rewind_st->state))
+      return false;
+
+   /* Only the head moves on the worker, the ring usage
+    * is the copy taken when it was last idle */
+   stats->hot_capacity    = state->capacity;
+   stats->hot_size        = state->hot_size;
+   stats->entries         = state->entries;
+#ifdef HAVE_STATE_MANAGER_COLD
+   stats->cold_size       = state->cold_size;
+   stats->cold_capacity   = state->cold_capacity;
+   stats->cold_raw_size   = state->cold_raw_size;
+   stats->cold_entries    = state->cold_entries;
+#else
+   stats->cold_size       = 0;
+   stats->cold_capacity   = 0;
+   stats->cold_raw_size   = 0;
+   stats->cold_entries    = 0;
+#endif
+
+   return true;
+}
+
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, bool compress_history)
 {
    core_info_t *core_info = NULL;
    void *state            = NULL;
@@ -634,7 +1266,7 @@ void state_manager_event_init(
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+         rewind_buffer_size, compress_history);
 
    if (!rewind_st->state)
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
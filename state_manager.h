@@ -28,6 +28,15 @@
 
 RETRO_BEGIN_DECLS
 
+struct tpool;
+struct state_manager_cold_batch;
+
+/* Older rewind history is kept compressed
+ * with zstd, or zlib without it */
+#if defined(HAVE_ZSTD) || defined(HAVE_ZLIB)
+#define HAVE_STATE_MANAGER_COLD
+#endif
+
 enum state_manager_rewind_st_flags
 {
    STATE_MGR_REWIND_ST_FLAG_FRAME_IS_REVERSED     = (1 << 0),
@@ -46,6 +55,12 @@ struct state_manager
 
    uint8_t *thisblock;
    uint8_t *nextblock;
+#ifdef HAVE_THREADS
+   /* Compresses the previous patch while the core runs. */
+   struct tpool *pool;
+   /* Block the pending patch is compressed from. */
+   uint8_t *spareblock;
+#endif
 #if STRICT_BUF_SIZE
    uint8_t *debugblock;
    size_t debugsize;
@@ -59,12 +74,57 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+#ifdef HAVE_STATE_MANAGER_COLD
+   /* Patches pushed out of the ring, batch-compressed
+    * (oldest first). */
+   struct state_manager_cold_batch *cold;
+   size_t cold_count;
+   size_t cold_slots;
+   /* Compressed and uncompressed size of all batches. */
+   size_t cold_size;
+   size_t cold_raw_size;
+   size_t cold_capacity;
+   /* Patches waiting to be batched, or thawed from the last
+    * batch; each one is followed by its size. */
+   uint8_t *warm;
+   size_t warm_size;
+   size_t warm_capacity;
+   unsigned warm_entries;
+   /* Full warm buffer waiting to be compressed, and the
+    * resulting batch once done. */
+   uint8_t *frozen;
+   uint8_t *frozen_out;
+   size_t frozen_size;
+   size_t frozen_out_size;
+   unsigned frozen_entries;
+   /* Entries in the batches, the frozen and warm buffers. */
+   unsigned cold_entries;
+#endif
+   /* Bytes used by the ring, as of the last state_manager_wait(). */
+   size_t hot_size;
+
    unsigned entries;
    bool thisblock_valid;
 };
 
 typedef struct state_manager state_manager_t;
 
+typedef struct state_manager_stats
+{
+   /* Bytes used and reserved by the patch ring. */
+   size_t hot_size;
+   size_t hot_capacity;
+   /* Compressed bytes used and reserved by older history. */
+   size_t cold_size;
+   size_t cold_capacity;
+   /* Uncompressed size of the compressed history. */
+   size_t cold_raw_size;
+   /* States that can be rewound to, in total
+    * and out of the compressed history. */
+   unsigned entries;
+   unsigned cold_entries;
+} state_manager_stats_t;
+
 struct state_manager_rewind_state
 {
    /* Rewind support. */
@@ -80,7 +140,18 @@ void state_manager_event_deinit(
       struct retro_core_t *current_core);
 
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, bool compress_history);
+
+/**
+ * state_manager_get_stats:
+ * @rewind_st            : rewind state.
+ * @stats                : output statistics.
+ *
+ * Returns: true if rewind is initialised and @stats was filled.
+ **/
+bool state_manager_get_stats(
+      const struct state_manager_rewind_state *rewind_st,
+      state_manager_stats_t *stats);
 
 /**
  * check_rewind:
@@ -22,6 +22,10 @@
 #include <string/stdstring.h>
 #include <time/rtime.h>
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
 
 #include "../configuration.h"
 #include "../file_path_special.h"
@@ -34,6 +38,13 @@
 
 #define MANIFEST_FILENAME_LOCAL  "manifest.local"
 #define MANIFEST_FILENAME_SERVER "manifest.server"
+/* one "<hash> <size> <mtime> <path>" line per file */
+#define MANIFEST_FILENAME_CACHE  "manifest.cache"
+
+/* files stat'd per handler call, hashed at once */
+#define CS_HASH_BATCH       256
+#define CS_HASH_BUFFER_SIZE (256 * 1024)
+#define CS_HASH_MAX_THREADS 8
 
 #define CS_FILE_HASH(item_file) ((char*)((item_file) ? ((item_file)->userdata) : (NULL)))
 #define CS_FILE_KEY(item_file) ((item_file) ? ((item_file)->alt) : (NULL))
@@ -45,11 +56,19 @@ enum task_cloud_sync_phase
    CLOUD_SYNC_PHASE_FETCH_SERVER_MANIFEST,
    CLOUD_SYNC_PHASE_READ_LOCAL_MANIFEST,
    CLOUD_SYNC_PHASE_BUILD_CURRENT_MANIFEST,
+   CLOUD_SYNC_PHASE_HASH_CURRENT_MANIFEST,
    CLOUD_SYNC_PHASE_DIFF,
    CLOUD_SYNC_PHASE_UPDATE_MANIFESTS,
    CLOUD_SYNC_PHASE_END
 };
 
+/* actiondata of current manifest and hash cache items */
+typedef struct
+{
+   int64_t size;
+   int64_t mtime;
+} task_cloud_sync_stat_t;
+
 typedef struct
 {
    enum task_cloud_sync_phase phase;
@@ -63,6 +82,14 @@ typedef struct
    file_list_t *updated_server_manifest;
    /* local manifest is sometimes different due to conflicts */
    file_list_t *updated_local_manifest;
+   /* hashes of the last sync, keyed on size and mtime */
+   file_list_t *hash_cache;
+   size_t hash_cache_idx;
+   size_t hash_idx;
+   time_t hash_time;
+#ifdef HAVE_THREADS
+   tpool_t *hash_pool;
+#endif
    bool need_manifest_uploaded;
    bool failures;
    bool conflicts;
@@ -350,7 +377,15 @@ static void task_cloud_sync_build_current_manifest(task_cloud_sync_state_t *sync
             dirlist->elems[i].userdata, dirlist->elems[i].data);
 
    file_list_sort_on_alt(sync_state->current_manifest);
-   sync_state->phase = CLOUD_SYNC_PHASE_DIFF;
+   sync_state->hash_time = time(NULL);
+#ifdef HAVE_THREADS
+   {
+      unsigned threads = MIN(cpu_features_get_core_amount(), CS_HASH_MAX_THREADS);
+      if (threads > 1)
+         sync_state->hash_pool = tpool_create(threads);
+   }
+#endif
+   sync_state->phase = CLOUD_SYNC_PHASE_HASH_CURRENT_MANIFEST;
    RARCH_LOG(CSPFX "created in-memory manifest of current disk state\n");
 }
 
@@ -407,25 +442,30 @@ static INLINE int task_cloud_sync_key_cmp(struct item_file *left, struct item_fi
 
 static char *task_cloud_sync_md5_rfile(RFILE *file)
 {
-   MD5_CTX       md5;
-   int           rv;
-   char         *hash = malloc(33);
-   unsigned char buf[4096];
-   unsigned char digest[16];
+   MD5_CTX        md5;
+   int64_t        rv;
+   char          *hash = malloc(33);
+   unsigned char *buf  = malloc(CS_HASH_BUFFER_SIZE);
+   unsigned char  digest[16];
 
-   if (!hash)
+   if (!hash || !buf)
+   {
+      free(hash);
+      free(buf);
       return NULL;
+   }
 
    MD5_Init(&md5);
 
    do
    {
-      rv = (int)filestream_read(file, buf, sizeof(buf));
+      rv = filestream_read(file, buf, CS_HASH_BUFFER_SIZE);
       if (rv > 0)
-         MD5_Update(&md5, buf, rv);
+         MD5_Update(&md5, buf, (unsigned long)rv);
    } while (rv > 0);
 
    MD5_Final(digest, &md5);
+   free(buf);
 
    snprintf(hash, 33, "%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x",
             digest[0], digest[1], digest[2], digest[3], digest[4], digest[5], digest[6], digest[7],
@@ -435,6 +475,195 @@ static char *task_cloud_sync_md5_rfile(RFILE *file)
    return hash;
 }
 
+/* takes an item_file of the current manifest, sets its hash */
+static void task_cloud_sync_hash_file(void *data)
+{
+   struct item_file *item = (struct item_file *)data;
+   RFILE            *file = filestream_open(item->path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return;
+
+   item->userdata = task_cloud_sync_md5_rfile(file);
+   filestream_close(file);
+}
+
+static void task_cloud_sync_hash_cache_filename(char *path, size_t len)
+{
+   settings_t *settings             = config_get_ptr();
+   const char *path_dir_core_assets = settings->paths.directory_core_assets;
+
+   fill_pathname_join_special(path,
+         path_dir_core_assets, MANIFEST_FILENAME_CACHE, len);
+}
+
+static void task_cloud_sync_read_hash_cache(task_cloud_sync_state_t *sync_state)
+{
+   char         path[PATH_MAX_LENGTH];
+   void        *buf  = NULL;
+   int64_t      len  = 0;
+   char        *line = NULL;
+   char        *next = NULL;
+   file_list_t *list = NULL;
+
+   task_cloud_sync_hash_cache_filename(path, sizeof(path));
+
+   if (!path_is_valid(path) || !filestream_read_file(path, &buf, &len))
+      return;
+
+   if (!(list = (file_list_t *)calloc(1, sizeof(file_list_t))))
+   {
+      free(buf);
+      return;
+   }
+
+   for (line = (char *)buf; line < (char *)buf + len; line = next)
+   {
+      char                   *end;
+      unsigned long           size, mtime;
+      task_cloud_sync_stat_t *st;
+      size_t                  idx = list->size;
+
+      if ((next = strchr(line, '\n')))
+         *next++ = '\0';
+      else
+         next    = line + strlen(line) + 1;
+
+      if (strlen(line) < 33 || line[32] != ' ')
+         continue;
+      line[32] = '\0';
+      size     = strtoul(line + 33, &end, 10);
+      if (*end != ' ')
+         continue;
+      mtime    = strtoul(end + 1, &end, 10);
+      if (*end != ' ' || !end[1])
+         continue;
+
+      if (!(st = (task_cloud_sync_stat_t *)malloc(sizeof(*st))))
+         break;
+      st->size  = size;
+      st->mtime = mtime;
+
+      file_list_append(list, NULL, NULL, 0, 0, 0);
+      file_list_set_alt_at_offset(list, idx, end + 1);
+      list->list[idx].userdata   = strdup(line);
+      list->list[idx].actiondata = st;
+   }
+
+   free(buf);
+   file_list_sort_on_alt(list);
+   sync_state->hash_cache = list;
+   RARCH_LOG(CSPFX "read cached hashes of %u files\n", (unsigned)list->size);
+}
+
+static void task_cloud_sync_write_hash_cache(task_cloud_sync_state_t *sync_state)
+{
+   size_t       i;
+   char         path[PATH_MAX_LENGTH];
+   file_list_t *list = sync_state->current_manifest;
+   RFILE       *file = NULL;
+
+   task_cloud_sync_hash_cache_filename(path, sizeof(path));
+
+   if (!(file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   for (i = 0; i < list->size; i++)
+   {
+      struct item_file       *item = &list->list[i];
+      task_cloud_sync_stat_t *st   = (task_cloud_sync_stat_t *)item->actiondata;
+      const char             *hash = CS_FILE_HASH(item);
+      const char             *key  = CS_FILE_KEY(item);
+
+      if (!st || !st->mtime || !hash || strlen(hash) != 32 || strchr(key, '\n'))
+         continue;
+
+      /* a file written in the second it was looked at could
+       * be written again with the same size and time */
+      if (st->mtime >= (int64_t)sync_state->hash_time - 1)
+         continue;
+
+      filestream_printf(file, "%s %lu %lu %s\n", hash,
+            (unsigned long)st->size, (unsigned long)st->mtime, key);
+   }
+
+   filestream_close(file);
+}
+
+/* Hashes the next batch of files on disk, unless their size
+ * and modification time match the hash cache. */
+static void task_cloud_sync_hash_current_manifest(task_cloud_sync_state_t *sync_state)
+{
+   size_t       i;
+   file_list_t *list  = sync_state->current_manifest;
+   file_list_t *cache = sync_state->hash_cache;
+   size_t       end   = MIN(sync_state->hash_idx + CS_HASH_BATCH, list->size);
+
+   if (!sync_state->hash_idx)
+   {
+      task_cloud_sync_read_hash_cache(sync_state);
+      cache = sync_state->hash_cache;
+   }
+
+   for (i = sync_state->hash_idx; i < end; i++)
+   {
+      struct item_file       *item   = &list->list[i];
+      struct item_file       *cached = NULL;
+      task_cloud_sync_stat_t *st     = (task_cloud_sync_stat_t *)malloc(sizeof(*st));
+
+      if (st)
+      {
+         st->size         = path_get_size(item->path);
+         st->mtime        = path_get_mtime(item->path);
+         item->actiondata = st;
+      }
+
+      /* both lists are sorted on the key, walk them together */
+      if (cache)
+      {
+         while (   sync_state->hash_cache_idx < cache->size
+                && task_cloud_sync_key_cmp(
+                      &cache->list[sync_state->hash_cache_idx], item) < 0)
+            sync_state->hash_cache_idx++;
+         if (sync_state->hash_cache_idx < cache->size)
+            cached = &cache->list[sync_state->hash_cache_idx];
+      }
+
+      if (     st
+            && st->mtime
+            && cached
+            && string_is_equal(CS_FILE_KEY(cached), CS_FILE_KEY(item))
+            && ((task_cloud_sync_stat_t *)cached->actiondata)->size  == st->size
+            && ((task_cloud_sync_stat_t *)cached->actiondata)->mtime == st->mtime)
+         item->userdata = strdup((const char *)cached->userdata);
+#ifdef HAVE_THREADS
+      else if (sync_state->hash_pool)
+         tpool_add_work(sync_state->hash_pool, task_cloud_sync_hash_file, item);
+#endif
+      else
+         task_cloud_sync_hash_file(item);
+   }
+
+#ifdef HAVE_THREADS
+   if (sync_state->hash_pool)
+      tpool_wait(sync_state->hash_pool);
+#endif
+
+   sync_state->hash_idx = end;
+   if (end < list->size)
+      return;
+
+#ifdef HAVE_THREADS
+   if (sync_state->hash_pool)
+      tpool_destroy(sync_state->hash_pool);
+   sync_state->hash_pool = NULL;
+#endif
+   sync_state->phase = CLOUD_SYNC_PHASE_DIFF;
+   RARCH_LOG(CSPFX "hashed current disk state\n");
+}
+
 /* don't pass a server/local item_file to this, only current has ->path set */
 static void task_cloud_sync_backup_file(struct item_file *file)
 {
@@ -622,9 +851,11 @@ static void task_cloud_sync_upload_current_file(task_cloud_sync_state_t *sync_st
 
    RARCH_LOG(CSPFX "uploading %s\n", path);
 
-   item->userdata = task_cloud_sync_md5_rfile(file);
-
-   filestream_seek(file, 0, SEEK_SET);
+   if (!item->userdata)
+   {
+      item->userdata = task_cloud_sync_md5_rfile(file);
+      filestream_seek(file, 0, SEEK_SET);
+   }
    sync_state->waiting = true;
    if (!cloud_sync_update(path, file, task_cloud_sync_upload_cb, sync_state))
    {
@@ -661,8 +892,6 @@ static void task_cloud_sync_check_server_current(task_cloud_sync_state_t *sync_s
    struct item_file *server_file  = &sync_state->server_manifest->list[sync_state->server_idx];
    struct item_file *local_file   = NULL;
    struct item_file *current_file = &sync_state->current_manifest->list[sync_state->current_idx];
-   const char       *filename     = current_file->path;
-   RFILE            *file;
 
    if (task_cloud_sync_should_ignore_file(CS_FILE_KEY(server_file)))
    {
@@ -670,14 +899,10 @@ static void task_cloud_sync_check_server_current(task_cloud_sync_state_t *sync_s
       return;
    }
 
-   file = filestream_open(filename,
-         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   if (!file)
+   /* hashed ahead of the diff, unless the file couldn't be read */
+   if (!CS_FILE_HASH(current_file))
       return;
 
-   current_file->userdata = task_cloud_sync_md5_rfile(file);
-   filestream_close(file);
-
    if (string_is_equal(CS_FILE_HASH(server_file), CS_FILE_HASH(current_file)))
    {
       task_cloud_sync_add_to_updated_manifest(sync_state, CS_FILE_KEY(current_file), CS_FILE_HASH(current_file), true);
@@ -966,6 +1191,8 @@ static void task_cloud_sync_update_manifests(task_cloud_sync_state_t *sync_state
    if (file)
       filestream_close(file);
 
+   task_cloud_sync_write_hash_cache(sync_state);
+
    if (sync_state->need_manifest_uploaded)
    {
       RARCH_LOG(CSPFX "uploading updated manifest to server\n");
@@ -1051,6 +1278,11 @@ static void task_cloud_sync_task_handler(retro_task_t *task)
       case CLOUD_SYNC_PHASE_BUILD_CURRENT_MANIFEST:
          task_cloud_sync_build_current_manifest(sync_state);
          break;
+      case CLOUD_SYNC_PHASE_HASH_CURRENT_MANIFEST:
+         task_set_progress(task, (int8_t)((sync_state->hash_idx * 100)
+               / MAX(sync_state->current_manifest->size, 1)));
+         task_cloud_sync_hash_current_manifest(sync_state);
+         break;
       case CLOUD_SYNC_PHASE_DIFF:
          task_cloud_sync_update_progress(task);
          task_cloud_sync_diff_next(sync_state);
@@ -1093,6 +1325,12 @@ static void task_cloud_sync_cb(retro_task_t *task, void *task_data,
       file_list_free(sync_state->updated_server_manifest);
    if (sync_state->updated_local_manifest)
       file_list_free(sync_state->updated_local_manifest);
+   if (sync_state->hash_cache)
+      file_list_free(sync_state->hash_cache);
+#ifdef HAVE_THREADS
+   if (sync_state->hash_pool)
+      tpool_destroy(sync_state->hash_pool);
+#endif
 
    free(sync_state);
 }
@@ -1141,6 +1379,7 @@ void task_push_cloud_sync(void)
    task->state    = sync_state;
    task->title    = strdup(task_title);
    task->handler  = task_cloud_sync_task_handler;
+   task->priority = TASK_PRIORITY_BACKGROUND;
    task->callback = task_cloud_sync_cb;
 
    task_queue_push(task);
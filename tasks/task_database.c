@@ -27,10 +27,16 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#include <features/features_cpu.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
 #include "../database_info.h"
+#include "../libretro-db/rdb_index.h"
 
 #include "../file_path_special.h"
 #include "../msg_hash.h"
@@ -49,6 +55,14 @@ typedef struct database_state_handle
    database_info_list_t *info;
    struct string_list *list;
    uint8_t *buf;
+   /* Lookup indexes of the databases in 'list', loaded on first
+    * use and kept for the whole scan. Keyed by the database path
+    * pointer, which stays valid when 'list' gets reordered.
+    * A NULL index means loading failed, and the database is
+    * queried the slow way instead. */
+   const char **index_paths;
+   rdb_index_t **indexes;
+   size_t index_count;
    size_t list_index;
    size_t entry_index;
    uint32_t crc;
@@ -57,6 +71,52 @@ typedef struct database_state_handle
    char serial[4096];
 } database_state_handle_t;
 
+#ifdef HAVE_THREADS
+#define DATABASE_HASH_MAX_WORKERS     8
+/* Files queued or being hashed per worker */
+#define DATABASE_HASH_JOBS_PER_WORKER 4
+
+enum database_hash_job_state
+{
+   DATABASE_HASH_JOB_FREE = 0,
+   DATABASE_HASH_JOB_QUEUED,
+   DATABASE_HASH_JOB_DONE
+};
+
+struct database_hash_pipeline;
+
+/* Type, serial and CRC of one file of the scan list,
+ * identified by a hashing worker ahead of the matcher */
+typedef struct database_hash_job
+{
+   struct database_hash_pipeline *pipeline;
+   char *path;
+   size_t list_ptr;
+   int ret;
+   uint32_t crc;
+   uint32_t archive_crc;
+   enum database_type type;
+   enum database_hash_job_state state; /* Protected by pipeline->lock */
+   char serial[4096];
+} database_hash_job_t;
+
+/* The scan runs as a pipeline: the directory walk fills the
+ * file list, a pool of workers identifies and hashes the next
+ * files of the list, and the task handler matches them against
+ * the databases and writes the playlists, in list order.
+ * At most 'num_jobs' files are in flight at any time. */
+typedef struct database_hash_pipeline
+{
+   tpool_t *pool;
+   slock_t *lock;
+   scond_t *cond;
+   database_hash_job_t *jobs;
+   size_t num_jobs;
+   size_t next; /* Next list position to queue */
+   bool cancel; /* Protected by lock */
+} database_hash_pipeline_t;
+#endif
+
 enum db_flags_enum
 {
    DB_HANDLE_FLAG_IS_DIRECTORY            = (1 << 0),
@@ -71,6 +131,9 @@ typedef struct db_handle
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+#ifdef HAVE_THREADS
+   database_hash_pipeline_t *pipeline;
+#endif
    database_state_handle_t state;
    playlist_config_t playlist_config; /* size_t alignment */
    unsigned status;
@@ -486,7 +549,7 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 }
 
 static void task_database_cue_prune(database_info_handle_t *db,
-      const char *name)
+      size_t start, const char *name)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -500,7 +563,7 @@ static void task_database_cue_prune(database_info_handle_t *db,
 
    while (cue_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -518,7 +581,8 @@ static void task_database_cue_prune(database_info_handle_t *db,
    free(fd);
 }
 
-static void gdi_prune(database_info_handle_t *db, const char *name)
+static void gdi_prune(database_info_handle_t *db,
+      size_t start, const char *name)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -532,7 +596,7 @@ static void gdi_prune(database_info_handle_t *db, const char *name)
 
    while (gdi_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -595,41 +659,42 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/* Identifies the type of @name and computes its serial
+ * and/or CRC. Only writes to its arguments, so that it
+ * can run on a hashing worker. */
+static int task_database_identify_file(const char *name,
+      enum database_type *type, uint32_t *crc, uint32_t *archive_crc,
+      char *serial, size_t serial_len)
 {
+   serial[0] = '\0';
+
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         db->type = DATABASE_TYPE_CRC_LOOKUP;
+         *type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
          return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
+               0, SIZE_MAX, archive_crc);
 #else
          break;
 #endif
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (task_database_cue_get_serial(name, serial, serial_len))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_cue_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_cue_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_gdi_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (task_database_gdi_get_serial(name, serial, serial_len))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_gdi_get_crc(name, crc);
          }
          break;
       /* Consider WBFS, RVZ and WIA files similar to ISO files. */
@@ -637,32 +702,246 @@ static int task_database_iterate_playlist(
       case FILE_TYPE_RVZ:
       case FILE_TYPE_WIA:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial, sizeof(db_state->serial));
-         db->type            =  DATABASE_TYPE_SERIAL_LOOKUP;
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial, serial_len);
+         *type            =  DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type         = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (task_database_chd_get_serial(name, serial, serial_len))
+            *type         = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type         = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_chd_get_crc(name, &db_state->crc);
+            *type         = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_chd_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         db->type            = DATABASE_TYPE_ITERATE_LUTRO;
+         *type            = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         db_state->serial[0] = '\0';
-         db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         *type            = DATABASE_TYPE_CRC_LOOKUP;
+         return intfstream_file_get_crc(name, 0, SIZE_MAX, crc);
    }
 
    return 1;
 }
 
+/* Removes the track files referenced by cue/gdi sheet @name
+ * from the scan list, starting at position @start */
+static void task_database_prune(database_info_handle_t *db,
+      size_t start, const char *name)
+{
+   switch (extension_to_file_type(path_get_extension(name)))
+   {
+      case FILE_TYPE_CUE:
+         task_database_cue_prune(db, start, name);
+         break;
+      case FILE_TYPE_GDI:
+         gdi_prune(db, start, name);
+         break;
+      default:
+         break;
+   }
+}
+
+#ifdef HAVE_THREADS
+static void task_database_hash_job_run(void *arg)
+{
+   database_hash_job_t *job           = (database_hash_job_t*)arg;
+   database_hash_pipeline_t *pipeline = job->pipeline;
+   bool cancel;
+
+   slock_lock(pipeline->lock);
+   cancel = pipeline->cancel;
+   slock_unlock(pipeline->lock);
+
+   /* The scan is being torn down, don't bother reading the file */
+   if (!cancel)
+      job->ret = task_database_identify_file(job->path, &job->type,
+            &job->crc, &job->archive_crc, job->serial, sizeof(job->serial));
+
+   slock_lock(pipeline->lock);
+   job->state = DATABASE_HASH_JOB_DONE;
+   scond_broadcast(pipeline->cond);
+   slock_unlock(pipeline->lock);
+}
+
+static void task_database_pipeline_free(database_hash_pipeline_t *pipeline)
+{
+   size_t i;
+
+   if (!pipeline)
+      return;
+
+   /* Let the queued jobs run through without hashing,
+    * and wait for all of them before freeing their paths */
+   if (pipeline->pool)
+   {
+      slock_lock(pipeline->lock);
+      pipeline->cancel = true;
+      slock_unlock(pipeline->lock);
+      tpool_wait(pipeline->pool);
+      tpool_destroy(pipeline->pool);
+   }
+   if (pipeline->jobs)
+   {
+      for (i = 0; i < pipeline->num_jobs; i++)
+         if (pipeline->jobs[i].path)
+            free(pipeline->jobs[i].path);
+      free(pipeline->jobs);
+   }
+   if (pipeline->cond)
+      scond_free(pipeline->cond);
+   if (pipeline->lock)
+      slock_free(pipeline->lock);
+   free(pipeline);
+}
+
+static database_hash_pipeline_t *task_database_pipeline_new(void)
+{
+   size_t i;
+   unsigned num_workers               = cpu_features_get_core_amount();
+   database_hash_pipeline_t *pipeline = (database_hash_pipeline_t*)
+      calloc(1, sizeof(*pipeline));
+
+   if (!pipeline)
+      return NULL;
+
+   /* Hashing is as much I/O as CPU bound, so keep at least
+    * one file being read while the matcher runs */
+   if (num_workers < 2)
+      num_workers = 2;
+   else if (num_workers > DATABASE_HASH_MAX_WORKERS)
+      num_workers = DATABASE_HASH_MAX_WORKERS;
+
+   pipeline->num_jobs = num_workers * DATABASE_HASH_JOBS_PER_WORKER;
+   pipeline->jobs     = (database_hash_job_t*)calloc(pipeline->num_jobs,
+         sizeof(*pipeline->jobs));
+   pipeline->lock     = slock_new();
+   pipeline->cond     = scond_new();
+   pipeline->pool     = tpool_create(num_workers);
+
+   if (!pipeline->jobs || !pipeline->lock || !pipeline->cond || !pipeline->pool)
+   {
+      task_database_pipeline_free(pipeline);
+      return NULL;
+   }
+
+   for (i = 0; i < pipeline->num_jobs; i++)
+      pipeline->jobs[i].pipeline = pipeline;
+
+   return pipeline;
+}
+
+/* Queues the files following the current one for hashing */
+static void task_database_pipeline_fill(database_hash_pipeline_t *pipeline,
+      database_info_handle_t *db)
+{
+   if (pipeline->next < db->list_ptr)
+      pipeline->next = db->list_ptr;
+
+   while (     pipeline->next < db->list->size
+            && pipeline->next < db->list_ptr + pipeline->num_jobs)
+   {
+      bool busy;
+      size_t i                 = pipeline->next;
+      const char *name         = db->list->elems[i].data;
+      database_hash_job_t *job = &pipeline->jobs[i % pipeline->num_jobs];
+
+      slock_lock(pipeline->lock);
+      busy = job->state == DATABASE_HASH_JOB_QUEUED;
+      slock_unlock(pipeline->lock);
+
+      /* The previous file using this slot is still being hashed */
+      if (busy)
+         break;
+
+      pipeline->next++;
+
+      /* Pruned tracks, and archive members which are matched
+       * by the CRC stored in the archive */
+      if (string_is_empty(name) || path_contains_compressed_file(name))
+         continue;
+
+      /* Must happen before the pruned files get queued */
+      task_database_prune(db, i, name);
+
+      if (job->path)
+         free(job->path);
+      job->path        = strdup(name);
+      job->list_ptr    = i;
+      job->ret         = 0;
+      job->crc         = 0;
+      job->archive_crc = 0;
+      job->type        = DATABASE_TYPE_ITERATE;
+      job->serial[0]   = '\0';
+
+      slock_lock(pipeline->lock);
+      job->state       = job->path
+         ? DATABASE_HASH_JOB_QUEUED : DATABASE_HASH_JOB_FREE;
+      slock_unlock(pipeline->lock);
+
+      if (job->path && !tpool_add_work(pipeline->pool,
+               task_database_hash_job_run, job))
+      {
+         slock_lock(pipeline->lock);
+         job->state    = DATABASE_HASH_JOB_FREE;
+         slock_unlock(pipeline->lock);
+      }
+   }
+}
+
+/* Returns the hashed file at @list_ptr, waiting for it if
+ * needed, or NULL if it was not queued */
+static database_hash_job_t *task_database_pipeline_wait(
+      database_hash_pipeline_t *pipeline, size_t list_ptr)
+{
+   database_hash_job_t *job = NULL;
+
+   if (!pipeline)
+      return NULL;
+
+   job = &pipeline->jobs[list_ptr % pipeline->num_jobs];
+
+   slock_lock(pipeline->lock);
+   if (job->state == DATABASE_HASH_JOB_FREE || job->list_ptr != list_ptr)
+      job = NULL;
+   else
+      while (job->state != DATABASE_HASH_JOB_DONE)
+         scond_wait(pipeline->cond, pipeline->lock);
+   slock_unlock(pipeline->lock);
+
+   return job;
+}
+#endif
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+#ifdef HAVE_THREADS
+   database_hash_job_t *job = task_database_pipeline_wait(
+         _db->pipeline, db->list_ptr);
+
+   if (job)
+   {
+      db->type              = job->type;
+      db_state->crc         = job->crc;
+      db_state->archive_crc = job->archive_crc;
+      strlcpy(db_state->serial, job->serial, sizeof(db_state->serial));
+      slock_lock(_db->pipeline->lock);
+      job->state            = DATABASE_HASH_JOB_FREE;
+      slock_unlock(_db->pipeline->lock);
+      return job->ret;
+   }
+#endif
+
+   task_database_prune(db, db->list_ptr, name);
+   return task_database_identify_file(name, &db->type,
+         &db_state->crc, &db_state->archive_crc,
+         db_state->serial, sizeof(db_state->serial));
+}
+
 static int database_info_list_iterate_end_no_match(
       database_info_handle_t *db,
       database_state_handle_t *db_state,
@@ -914,6 +1193,130 @@ static int database_info_list_iterate_next(
    return 1;
 }
 
+/* Returns the lookup index of the current database,
+ * loading it on first use */
+static rdb_index_t *task_database_get_index(
+      database_state_handle_t *db_state)
+{
+   size_t i;
+   const char **new_paths    = NULL;
+   rdb_index_t **new_indexes = NULL;
+   const char *db_path       = database_info_get_current_name(db_state);
+
+   if (!db_path)
+      return NULL;
+
+   for (i = 0; i < db_state->index_count; i++)
+      if (db_state->index_paths[i] == db_path)
+         return db_state->indexes[i];
+
+   if (!(new_paths = (const char**)realloc(db_state->index_paths,
+         (db_state->index_count + 1) * sizeof(*new_paths))))
+      return NULL;
+   db_state->index_paths = new_paths;
+
+   if (!(new_indexes = (rdb_index_t**)realloc(db_state->indexes,
+         (db_state->index_count + 1) * sizeof(*new_indexes))))
+      return NULL;
+   db_state->indexes     = new_indexes;
+
+   new_paths[db_state->index_count]   = db_path;
+   new_indexes[db_state->index_count] = rdb_index_new(db_path, true);
+
+   if (!new_indexes[db_state->index_count])
+      RARCH_WARN("[Scanner]: Could not index \"%s\".\n", db_path);
+
+   return new_indexes[db_state->index_count++];
+}
+
+static void task_database_free_indexes(
+      database_state_handle_t *db_state)
+{
+   size_t i;
+
+   for (i = 0; i < db_state->index_count; i++)
+      rdb_index_free(db_state->indexes[i]);
+
+   free(db_state->index_paths);
+   free(db_state->indexes);
+   db_state->index_paths = NULL;
+   db_state->indexes     = NULL;
+   db_state->index_count = 0;
+}
+
+/* Makes entry @i of @index the current database
+ * info entry, for database_info_list_iterate_found_match() */
+static bool task_database_index_set_info(
+      database_state_handle_t *db_state,
+      const rdb_index_t *index, size_t i)
+{
+   const rdb_index_entry_t *entry = rdb_index_get_entry(index, i);
+   const char *name               = rdb_index_get_string(index, entry->name);
+   const char *serial             = rdb_index_get_string(index, entry->serial);
+   database_info_list_t *info     = (database_info_list_t*)
+      calloc(1, sizeof(*info));
+
+   if (!info)
+      return false;
+
+   if (!(info->list = (database_info_t*)calloc(1, sizeof(*info->list))))
+   {
+      free(info);
+      return false;
+   }
+
+   info->count          = 1;
+   info->list->crc32    = entry->crc32;
+   if (name)
+      info->list->name   = strdup(name);
+   if (serial)
+      info->list->serial = strdup(serial);
+
+   if (db_state->info)
+   {
+      database_info_list_free(db_state->info);
+      free(db_state->info);
+   }
+   db_state->info        = info;
+   db_state->entry_index = 0;
+   return true;
+}
+
+static int task_database_index_crc_lookup(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db,
+      const rdb_index_t *index,
+      const char *archive_entry)
+{
+   size_t pos            = 0;
+   int64_t archive_match = -1;
+   int64_t crc_match     = -1;
+
+   if (db_state->archive_crc)
+      archive_match = rdb_index_find_crc(index, db_state->archive_crc, &pos);
+   pos       = 0;
+   crc_match = rdb_index_find_crc(index, db_state->crc, &pos);
+
+   /* Same precedence as walking the query results
+    * in database order */
+   if (     archive_match >= 0
+         && (crc_match < 0 || archive_match <= crc_match))
+   {
+      if (task_database_index_set_info(db_state, index, (size_t)archive_match))
+         return database_info_list_iterate_found_match(
+               _db, db_state, db, NULL);
+   }
+   else if (crc_match >= 0)
+   {
+      if (task_database_index_set_info(db_state, index, (size_t)crc_match))
+         return database_info_list_iterate_found_match(
+               _db, db_state, db, archive_entry);
+   }
+
+   return database_info_list_iterate_next(db_state);
+}
+
 static int task_database_iterate_crc_lookup(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -940,6 +1343,7 @@ static int task_database_iterate_crc_lookup(
    if (db_state->entry_index == 0)
    {
       char query[50];
+      rdb_index_t *index = NULL;
 
       query[0] = '\0';
 
@@ -962,6 +1366,10 @@ static int task_database_iterate_crc_lookup(
          }
       }
 
+      if ((index = task_database_get_index(db_state)))
+         return task_database_index_crc_lookup(_db, db_state, db,
+               index, archive_entry);
+
       snprintf(query, sizeof(query),
             "{crc:or(b\"%08lX\",b\"%08lX\")}",
             (unsigned long)db_state->crc, (unsigned long)db_state->archive_crc);
@@ -1086,6 +1494,36 @@ static bool task_database_check_serial_and_crc(
          "Sony - PlayStation Portable");
 }
 
+static int task_database_index_serial_lookup(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db,
+      const rdb_index_t *index,
+      const char *name)
+{
+   int64_t i;
+   size_t pos     = 0;
+   bool check_crc = task_database_check_serial_and_crc(db_state);
+
+   while ((i = rdb_index_find_serial(index, db_state->serial, &pos)) >= 0)
+   {
+      if (check_crc)
+      {
+         if (db_state->crc == 0)
+            intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         if (db_state->crc != rdb_index_get_entry(index, (size_t)i)->crc32)
+            continue;
+      }
+
+      if (task_database_index_set_info(db_state, index, (size_t)i))
+         return database_info_list_iterate_found_match(_db,
+               db_state, db, NULL);
+      break;
+   }
+
+   return database_info_list_iterate_next(db_state);
+}
+
 static int task_database_iterate_serial_lookup(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -1103,7 +1541,14 @@ static int task_database_iterate_serial_lookup(
    {
       size_t _len;
       char query[50];
-      char *serial_buf = bin_to_hex_alloc(
+      char *serial_buf   = NULL;
+      rdb_index_t *index = task_database_get_index(db_state);
+
+      if (index)
+         return task_database_index_serial_lookup(_db, db_state, db,
+               index, name);
+
+      serial_buf = bin_to_hex_alloc(
             (uint8_t*)db_state->serial,
             strlen(db_state->serial) * sizeof(uint8_t));
 
@@ -1172,7 +1617,7 @@ static int task_database_iterate(
    switch (db->type)
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
 #ifdef HAVE_COMPRESSION
          return task_database_iterate_crc_lookup(
@@ -1305,10 +1750,18 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+#ifdef HAVE_THREADS
+         if (!db->pipeline && dbinfo->list && dbinfo->list->size > 1)
+            db->pipeline = task_database_pipeline_new();
+#endif
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
          name                 = database_info_get_current_element_name(dbinfo);
+#ifdef HAVE_THREADS
+         if (db->pipeline)
+            task_database_pipeline_fill(db->pipeline, dbinfo);
+#endif
          task_database_cleanup_state(dbstate);
          dbstate->list_index  = 0;
          dbstate->entry_index = 0;
@@ -1378,6 +1831,7 @@ task_finished:
 
    if (dbstate)
    {
+      task_database_free_indexes(dbstate);
       if (dbstate->list)
          dir_list_free(dbstate->list);
    }
@@ -1393,6 +1847,9 @@ task_finished:
       if (db->state.buf)
          free(db->state.buf);
 
+#ifdef HAVE_THREADS
+      task_database_pipeline_free(db->pipeline);
+#endif
       if (db->handle)
          database_info_free(db->handle);
       free(db);
@@ -1429,6 +1886,7 @@ bool task_push_dbscan(
       goto error;
 
    t->handler                              = task_database_handler;
+   t->priority                             = TASK_PRIORITY_BACKGROUND;
    t->state                                = db;
    t->callback                             = cb;
    t->title                                = strdup(msg_hash_to_str(
@@ -1443,12 +1901,14 @@ bool task_push_dbscan(
    db->playlist_config.old_format          = settings->bools.playlist_use_old_format;
    db->playlist_config.compress            = settings->bools.playlist_compression;
    db->playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+   db->playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&db->playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 #else
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = false;
    db->playlist_config.compress            = false;
    db->playlist_config.fuzzy_archive_match = false;
+   db->playlist_config.binary_cache        = false;
    playlist_config_set_base_content_directory(&db->playlist_config, NULL);
 #endif
    if (db_dir_show_hidden_files)
@@ -363,6 +363,11 @@ static void task_manual_content_scan_handler(retro_task_t *task)
             int content_type         = manual_scan->content_list->elems[
                   manual_scan->content_list_index].attr.i;
 
+            /* Push content in bulk, so that each new entry
+             * does not have to move every entry before it */
+            if (manual_scan->content_list_index == 0)
+               playlist_push_bulk_begin(manual_scan->playlist);
+
             if (!string_is_empty(content_path))
             {
                size_t _len;
@@ -410,6 +415,8 @@ static void task_manual_content_scan_handler(retro_task_t *task)
             if (manual_scan->content_list_index >=
                   manual_scan->content_list_size)
             {
+               playlist_push_bulk_end(manual_scan->playlist);
+
                /* Check whether we have any M3U files
                 * to process */
                if (manual_scan->m3u_list->size > 0)
@@ -609,6 +616,7 @@ bool task_push_manual_content_scan(
 
    /* > Configure task */
    task->handler                 = task_manual_content_scan_handler;
+   task->priority                = TASK_PRIORITY_BACKGROUND;
    task->state                   = manual_scan;
    task->title                   = strdup(task_title);
    task->alternative_look        = true;
@@ -21,11 +21,17 @@
 #include <string.h>
 #include <ctype.h>
 
+#include <array/rbuf.h>
 #include <string/stdstring.h>
 #include <file/file_path.h>
+#include <features/features_cpu.h>
 #include <net/net_http.h>
 #include <streams/file_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "tasks_internal.h"
 #include "task_file_transfer.h"
 
@@ -45,8 +51,8 @@
 enum pl_thumb_status
 {
    PL_THUMB_BEGIN = 0,
-   PL_THUMB_ITERATE_ENTRY,
    PL_THUMB_ITERATE_TYPE,
+   PL_THUMB_DOWNLOAD,
    PL_THUMB_END
 };
 
@@ -58,6 +64,52 @@ enum pl_thumb_flags
    PL_THUMB_FLAG_HTTP_TASK_COMPLETE = (1 << 3)
 };
 
+/* Maximum number of thumbnails a playlist task
+ * downloads at once */
+#define PL_THUMB_MAX_DOWNLOADS 8
+
+/* Playlist entries are checked for missing thumbnails
+ * ahead of the downloads, until this many are queued
+ * (or this many entries have been checked in one
+ * iteration of the task) */
+#define PL_THUMB_QUEUE_SIZE    32
+
+/* Failed downloads are retried this many times, after
+ * 1, 2, 4... seconds */
+#define PL_THUMB_MAX_RETRIES   3
+#define PL_THUMB_RETRY_DELAY   1000000
+
+/* While there is nothing to do but wait for downloads,
+ * the task only runs every 5 ms */
+#define PL_THUMB_POLL_DELAY    5000
+
+/* Download slot results, other than HTTP status codes */
+#define PL_THUMB_RESULT_PENDING       0
+#define PL_THUMB_RESULT_FAILED       -1
+#define PL_THUMB_RESULT_WRITE_FAILED -2
+
+typedef struct pl_thumb_job
+{
+   char *path;
+   char *url;
+   char *label;
+   size_t entry_idx;
+   retro_time_t retry_time;
+   unsigned retries;
+} pl_thumb_job_t;
+
+/* The http task callbacks run on the main thread, so
+ * 'result' and 'http_task' are protected by the lock of
+ * the handle */
+typedef struct pl_thumb_slot
+{
+   pl_thumb_job_t job;
+   struct pl_thumb_handle *handle;
+   retro_task_t *http_task; /* NULL once its callback ran */
+   int result;              /* Set by the http task callback */
+   bool busy;
+} pl_thumb_slot_t;
+
 typedef struct pl_thumb_handle
 {
    char *system;
@@ -66,12 +118,19 @@ typedef struct pl_thumb_handle
    playlist_t *playlist;
    gfx_thumbnail_path_data_t *thumbnail_path_data;
    retro_task_t *http_task;
+   pl_thumb_job_t *jobs; /* Queued downloads, RBUF */
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
 
    playlist_config_t playlist_config; /* size_t alignment */
+   pl_thumb_slot_t slots[PL_THUMB_MAX_DOWNLOADS];
 
    size_t list_size;
    size_t list_index;
+   size_t title_index;
    unsigned type_idx;
+   unsigned max_downloads;
 
    enum pl_thumb_status status;
    enum playlist_thumbnail_name_flags name_flags;
@@ -79,6 +138,14 @@ typedef struct pl_thumb_handle
    uint8_t flags;
 } pl_thumb_handle_t;
 
+#ifdef HAVE_THREADS
+#define PL_THUMB_LOCK(pl_thumb)   slock_lock((pl_thumb)->lock)
+#define PL_THUMB_UNLOCK(pl_thumb) slock_unlock((pl_thumb)->lock)
+#else
+#define PL_THUMB_LOCK(pl_thumb)
+#define PL_THUMB_UNLOCK(pl_thumb)
+#endif
+
 typedef struct pl_entry_id
 {
    char *playlist_path;
@@ -218,13 +285,34 @@ static bool get_thumbnail_paths(
    return !string_is_empty(url);
 }
 
+/* Writes downloaded thumbnail file to disk, creating
+ * its directory if required.
+ * Returns NULL on success, otherwise an error message */
+static const char *write_pl_thumbnail(const char *path,
+      const void *data, size_t len)
+{
+   char output_dir[PATH_MAX_LENGTH];
+
+   /* Create output directory, if required */
+   strlcpy(output_dir, path, sizeof(output_dir));
+   path_basedir_wrapper(output_dir);
+
+   if (!path_mkdir(output_dir))
+      return msg_hash_to_str(MSG_FAILED_TO_CREATE_THE_DIRECTORY);
+
+   /* Write thumbnail file to disk */
+   if (!filestream_write_file(path, data, len))
+      return "Write failed.";
+
+   return NULL;
+}
+
 /* Thumbnail download http task callback function
  * > Writes thumbnail file to disk */
 void cb_http_task_download_pl_thumbnail(
       retro_task_t *task, void *task_data,
       void *user_data, const char *err)
 {
-   char output_dir[PATH_MAX_LENGTH];
    http_transfer_data_t *data  = (http_transfer_data_t*)task_data;
    file_transfer_t *transf     = (file_transfer_t*)user_data;
    pl_thumb_handle_t *pl_thumb = NULL;
@@ -251,22 +339,7 @@ void cb_http_task_download_pl_thumbnail(
       goto finish;
    }
 
-   /* Create output directory, if required */
-   strlcpy(output_dir, transf->path, sizeof(output_dir));
-   path_basedir_wrapper(output_dir);
-
-   if (!path_mkdir(output_dir))
-   {
-      err = msg_hash_to_str(MSG_FAILED_TO_CREATE_THE_DIRECTORY);
-      goto finish;
-   }
-
-   /* Write thumbnail file to disk */
-   if (!filestream_write_file(transf->path, data->data, data->len))
-   {
-      err = "Write failed.";
-      goto finish;
-   }
+   err = write_pl_thumbnail(transf->path, data->data, data->len);
 
 finish:
 
@@ -323,8 +396,266 @@ static void download_pl_thumbnail(pl_thumb_handle_t *pl_thumb)
    }
 }
 
+static void free_pl_thumb_job(pl_thumb_job_t *job)
+{
+   if (job->path)
+      free(job->path);
+   if (job->url)
+      free(job->url);
+   if (job->label)
+      free(job->label);
+
+   job->path  = NULL;
+   job->url   = NULL;
+   job->label = NULL;
+}
+
+/* Playlist thumbnail download http task callback function
+ * > Writes thumbnail file to disk, then hands the result
+ *   back to the playlist task through its download slot */
+static void cb_http_task_download_pl_thumbnail_slot(
+      retro_task_t *task, void *task_data,
+      void *user_data, const char *err)
+{
+   http_transfer_data_t *data = (http_transfer_data_t*)task_data;
+   pl_thumb_slot_t *slot      = (pl_thumb_slot_t*)user_data;
+   int result                 = PL_THUMB_RESULT_FAILED;
+
+   if (!slot)
+      return;
+
+   if (data && data->data && data->status > 0)
+   {
+      result = data->status;
+
+      if (result == 200 && write_pl_thumbnail(
+               slot->job.path, data->data, data->len))
+         result = PL_THUMB_RESULT_WRITE_FAILED;
+   }
+
+   /* The playlist task may free the job as soon as
+    * the result is set, so this must come last */
+   PL_THUMB_LOCK(slot->handle);
+   slot->result    = result;
+   slot->http_task = NULL;
+   PL_THUMB_UNLOCK(slot->handle);
+}
+
+/* Queues downloads of all missing thumbnails of the
+ * current playlist entry (nothing, if it is broken) */
+static void queue_pl_entry_thumbnails(pl_thumb_handle_t *pl_thumb)
+{
+   static const enum playlist_thumbnail_name_flags name_flags[] =
+   {
+      PLAYLIST_THUMBNAIL_FLAG_FULL_NAME,
+      PLAYLIST_THUMBNAIL_FLAG_STD_NAME,
+      PLAYLIST_THUMBNAIL_FLAG_SHORT_NAME
+   };
+   size_t i, j;
+   const char *label = NULL;
+   size_t first      = RBUF_LEN(pl_thumb->jobs);
+
+   if (!gfx_thumbnail_set_content_playlist(
+            pl_thumb->thumbnail_path_data, pl_thumb->playlist,
+            pl_thumb->list_index))
+      return;
+
+   gfx_thumbnail_get_label(pl_thumb->thumbnail_path_data, &label);
+
+   /* Try all 3 supported naming conventions for
+    * every thumbnail type */
+   for (i = 0; i < ARRAY_SIZE(name_flags); i++)
+   {
+      pl_thumb->name_flags = name_flags[i];
+
+      for (pl_thumb->type_idx = 1; pl_thumb->type_idx <= 3;
+            pl_thumb->type_idx++)
+      {
+         pl_thumb_job_t job;
+         char path[PATH_MAX_LENGTH];
+         char url[2048];
+
+         path[0] = '\0';
+         url[0]  = '\0';
+
+         if (!get_thumbnail_paths(pl_thumb, path, sizeof(path),
+                  url, sizeof(url)))
+            continue;
+
+         /* Only download missing thumbnails */
+         if (     path_is_valid(path)
+               && !(pl_thumb->flags & PL_THUMB_FLAG_OVERWRITE))
+            continue;
+
+         /* Naming conventions often end up with the
+          * same name - only download it once */
+         for (j = first; j < RBUF_LEN(pl_thumb->jobs); j++)
+            if (string_is_equal(pl_thumb->jobs[j].path, path))
+               break;
+
+         if (j < RBUF_LEN(pl_thumb->jobs))
+            continue;
+
+         job.path       = strdup(path);
+         job.url        = strdup(url);
+         job.label      = strdup(label ? label : "");
+         job.entry_idx  = pl_thumb->list_index;
+         job.retry_time = 0;
+         job.retries    = 0;
+
+         RBUF_PUSH(pl_thumb->jobs, job);
+      }
+   }
+}
+
+/* Starts queued downloads that are not waiting for a
+ * retry, until all download slots are busy.
+ * Returns number of downloads started */
+static unsigned dispatch_pl_thumbnails(retro_task_t *task,
+      pl_thumb_handle_t *pl_thumb)
+{
+   unsigned i;
+   unsigned started = 0;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   for (i = 0; i < pl_thumb->max_downloads; i++)
+   {
+      size_t j;
+      void *http_task       = NULL;
+      pl_thumb_slot_t *slot = &pl_thumb->slots[i];
+
+      if (slot->busy)
+         continue;
+
+      for (j = 0; j < RBUF_LEN(pl_thumb->jobs); j++)
+         if (pl_thumb->jobs[j].retry_time <= now)
+            break;
+
+      if (j >= RBUF_LEN(pl_thumb->jobs))
+         break;
+
+      slot->job       = pl_thumb->jobs[j];
+      slot->handle    = pl_thumb;
+      slot->http_task = NULL;
+      slot->result    = PL_THUMB_RESULT_PENDING;
+      slot->busy      = true;
+      RBUF_REMOVE(pl_thumb->jobs, j);
+
+      /* Update progress display */
+      if (slot->job.entry_idx != pl_thumb->title_index)
+      {
+         task_free_title(task);
+         task_set_title(task, strdup(slot->job.label));
+         pl_thumb->title_index = slot->job.entry_idx;
+      }
+
+      /* If the transfer can't even be started, the
+       * download has failed right away. It may also
+       * have finished already, and its task be freed. */
+      http_task = task_push_http_transfer(slot->job.url, true, NULL,
+               cb_http_task_download_pl_thumbnail_slot, slot);
+
+      PL_THUMB_LOCK(pl_thumb);
+      if (!http_task)
+         slot->result    = PL_THUMB_RESULT_FAILED;
+      else if (slot->result == PL_THUMB_RESULT_PENDING)
+         slot->http_task = (retro_task_t*)http_task;
+      PL_THUMB_UNLOCK(pl_thumb);
+
+      started++;
+   }
+
+   return started;
+}
+
+/* Handles finished downloads, queueing another try of
+ * those that failed on the network or server side if
+ * 'retry' is set.
+ * Returns number of downloads still in flight */
+static unsigned collect_pl_thumbnails(pl_thumb_handle_t *pl_thumb,
+      bool retry)
+{
+   unsigned i;
+   unsigned in_flight = 0;
+
+   for (i = 0; i < PL_THUMB_MAX_DOWNLOADS; i++)
+   {
+      int result;
+      pl_thumb_slot_t *slot = &pl_thumb->slots[i];
+
+      if (!slot->busy)
+         continue;
+
+      PL_THUMB_LOCK(pl_thumb);
+      result = slot->result;
+      PL_THUMB_UNLOCK(pl_thumb);
+
+      if (result == PL_THUMB_RESULT_PENDING)
+      {
+         in_flight++;
+         continue;
+      }
+
+      slot->busy = false;
+
+      if (result == 200)
+         RARCH_LOG("[Thumbnail]: Download \"%s\".\n", slot->job.path);
+      else if (retry
+            && slot->job.retries < PL_THUMB_MAX_RETRIES
+            && (   result == PL_THUMB_RESULT_FAILED
+                || result == 429
+                || result >= 500))
+      {
+         retro_time_t delay = (retro_time_t)PL_THUMB_RETRY_DELAY
+               << slot->job.retries;
+
+         RARCH_WARN("[Thumbnail]: Download \"%s\" failed, retrying in %u s.\n",
+               slot->job.path, (unsigned)(delay / 1000000));
+
+         slot->job.retries++;
+         slot->job.retry_time = cpu_features_get_time_usec() + delay;
+         RBUF_PUSH(pl_thumb->jobs, slot->job);
+         continue;
+      }
+      else
+         RARCH_ERR("[Thumbnail]: Download \"%s\" failed: %s\n",
+               slot->job.path,
+                 (result == PL_THUMB_RESULT_WRITE_FAILED)
+               ? "Write failed."
+               : (result == 404)
+               ? "File not found."
+               : "Download failed.");
+
+      free_pl_thumb_job(&slot->job);
+   }
+
+   return in_flight;
+}
+
+/* Cancels the downloads in flight, whose callbacks
+ * still have to run before the handle is freed */
+static void cancel_pl_thumbnails(pl_thumb_handle_t *pl_thumb)
+{
+   unsigned i;
+
+   PL_THUMB_LOCK(pl_thumb);
+   for (i = 0; i < PL_THUMB_MAX_DOWNLOADS; i++)
+   {
+      pl_thumb_slot_t *slot = &pl_thumb->slots[i];
+
+      if (slot->busy && slot->http_task)
+      {
+         task_queue_cancel_task(slot->http_task);
+         slot->http_task = NULL;
+      }
+   }
+   PL_THUMB_UNLOCK(pl_thumb);
+}
+
 static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
 {
+   size_t i;
+
    if (pl_thumb->system)
    {
       free(pl_thumb->system);
@@ -355,6 +686,19 @@ static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
       pl_thumb->thumbnail_path_data = NULL;
    }
 
+   for (i = 0; i < RBUF_LEN(pl_thumb->jobs); i++)
+      free_pl_thumb_job(&pl_thumb->jobs[i]);
+   RBUF_FREE(pl_thumb->jobs);
+
+   for (i = 0; i < PL_THUMB_MAX_DOWNLOADS; i++)
+      if (pl_thumb->slots[i].busy)
+         free_pl_thumb_job(&pl_thumb->slots[i].job);
+
+#ifdef HAVE_THREADS
+   if (pl_thumb->lock)
+      slock_free(pl_thumb->lock);
+#endif
+
    free(pl_thumb);
    pl_thumb = NULL;
 }
@@ -366,7 +710,6 @@ static void free_pl_thumb_handle(pl_thumb_handle_t *pl_thumb)
 static void task_pl_thumbnail_download_handler(retro_task_t *task)
 {
    pl_thumb_handle_t *pl_thumb = NULL;
-   enum playlist_thumbnail_name_flags next_flag = PLAYLIST_THUMBNAIL_FLAG_INVALID;
 
    if (!task)
       goto task_finished;
@@ -375,7 +718,17 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
       goto task_finished;
    
    if (task_get_cancelled(task))
+   {
+      /* Callbacks of downloads in flight still refer
+       * to the handle - cancel them, then wait for them */
+      cancel_pl_thumbnails(pl_thumb);
+      if (collect_pl_thumbnails(pl_thumb, false) > 0)
+      {
+         task->when = cpu_features_get_time_usec() + PL_THUMB_POLL_DELAY;
+         return;
+      }
       goto task_finished;
+   }
    
    switch (pl_thumb->status)
    {
@@ -401,85 +754,63 @@ static void task_pl_thumbnail_download_handler(retro_task_t *task)
                   pl_thumb->system, pl_thumb->playlist))
             goto task_finished;
 
-         /* All good - can start iterating */
-         pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
+         /* All good - can start downloading */
+         pl_thumb->status = PL_THUMB_DOWNLOAD;
          break;
-      case PL_THUMB_ITERATE_ENTRY:
-         /* Set current thumbnail content */
-         if (gfx_thumbnail_set_content_playlist(
-                  pl_thumb->thumbnail_path_data, pl_thumb->playlist, pl_thumb->list_index))
+      case PL_THUMB_DOWNLOAD:
          {
-            const char *label = NULL;
-
-            /* Update progress display */
-            task_free_title(task);
-            if (gfx_thumbnail_get_label(pl_thumb->thumbnail_path_data, &label))
-               task_set_title(task, strdup(label));
-            else
-               task_set_title(task, strdup(""));
-            task_set_progress(task, (pl_thumb->list_index * 100) / pl_thumb->list_size);
-
-            /* Start iterating over thumbnail type */
-            pl_thumb->type_idx  = 1;
-            pl_thumb->status    = PL_THUMB_ITERATE_TYPE;
-            playlist_update_thumbnail_name_flag(pl_thumb->playlist, pl_thumb->list_index, PLAYLIST_THUMBNAIL_FLAG_FULL_NAME);
-            pl_thumb->name_flags = PLAYLIST_THUMBNAIL_FLAG_FULL_NAME;
-         }
-         else
-         {
-            /* Current playlist entry is broken - advance to
-             * the next one */
-            pl_thumb->list_index++;
-            if (pl_thumb->list_index >= pl_thumb->list_size)
-               pl_thumb->status = PL_THUMB_END;
-         }
-         break;
-      case PL_THUMB_ITERATE_TYPE:
-         /* Ensure that we only enqueue one transfer
-          * at a time... */
+            size_t i;
+            size_t progress_index = pl_thumb->list_index;
+            size_t checked        = 0;
+            unsigned in_flight    = collect_pl_thumbnails(pl_thumb, true);
+
+            /* Check the next entries for missing thumbnails */
+            while (   pl_thumb->list_index < pl_thumb->list_size
+                   && RBUF_LEN(pl_thumb->jobs) < PL_THUMB_QUEUE_SIZE
+                   && checked++ < PL_THUMB_QUEUE_SIZE)
+            {
+               queue_pl_entry_thumbnails(pl_thumb);
+               pl_thumb->list_index++;
+            }
 
-         /* > If HTTP task is NULL, then it either finished
-          *   or an error occurred - in either case,
-          *   current task is 'complete' */
-         if (!pl_thumb->http_task)
-            pl_thumb->flags             |= PL_THUMB_FLAG_HTTP_TASK_COMPLETE;
-         /* > Wait for task_push_http_transfer_file()
-          *   callback to trigger */
-         else if (!(pl_thumb->flags & PL_THUMB_FLAG_HTTP_TASK_COMPLETE))
-            break;
+            /* Entries with nothing to download still
+             * show up in the progress display */
+            if (in_flight == 0 && RBUF_LEN(pl_thumb->jobs) == 0)
+            {
+               const char *label = NULL;
 
-         pl_thumb->http_task = NULL;
+               if (pl_thumb->list_index >= pl_thumb->list_size)
+               {
+                  pl_thumb->status = PL_THUMB_END;
+                  break;
+               }
 
-         /* Check whether all thumbnail types have been processed */
-         if (pl_thumb->type_idx > 3)
-         {
-            next_flag = playlist_get_next_thumbnail_name_flag(pl_thumb->playlist,pl_thumb->list_index);
-            if (next_flag == PLAYLIST_THUMBNAIL_FLAG_NONE) {
-               if (pl_thumb->playlist )
-               /* Time to move on to the next entry */
-               pl_thumb->list_index++;
-               if (pl_thumb->list_index < pl_thumb->list_size)
-                  pl_thumb->status = PL_THUMB_ITERATE_ENTRY;
+               task_free_title(task);
+               if (gfx_thumbnail_get_label(pl_thumb->thumbnail_path_data, &label))
+                  task_set_title(task, strdup(label));
                else
-                  pl_thumb->status = PL_THUMB_END;
-               break;
-            } else {
-               /* Increment the name flag to cover the 3 supported naming conventions. 
-                * Side-effect: all combinations will be tried (3x3 requests for 1 playlist entry)
-                * even if some files were already downloaded, but that may be useful if later on
-                * different view priorities are implemented. */
-               pl_thumb->type_idx = 1;
-               playlist_update_thumbnail_name_flag(pl_thumb->playlist, pl_thumb->list_index, next_flag);
-               pl_thumb->name_flags = next_flag;
+                  task_set_title(task, strdup(""));
+               pl_thumb->title_index = pl_thumb->list_index - 1;
             }
-         }
-
-         /* Download current thumbnail */
-         if (pl_thumb)
-            download_pl_thumbnail(pl_thumb);
 
-         /* Increment thumbnail type */
-         pl_thumb->type_idx++;
+            /* Don't spin while waiting for downloads */
+            if (dispatch_pl_thumbnails(task, pl_thumb) > 0 || checked > 0)
+               task->when = 0;
+            else
+               task->when = cpu_features_get_time_usec() + PL_THUMB_POLL_DELAY;
+
+            /* Progress is that of the first entry with
+             * downloads left */
+            for (i = 0; i < RBUF_LEN(pl_thumb->jobs); i++)
+               progress_index = MIN(progress_index,
+                     pl_thumb->jobs[i].entry_idx);
+            for (i = 0; i < PL_THUMB_MAX_DOWNLOADS; i++)
+               if (pl_thumb->slots[i].busy)
+                  progress_index = MIN(progress_index,
+                        pl_thumb->slots[i].job.entry_idx);
+
+            task_set_progress(task, (progress_index * 100) / pl_thumb->list_size);
+         }
          break;
       case PL_THUMB_END:
       default:
@@ -514,6 +845,7 @@ bool task_push_pl_thumbnail_download(
 {
    task_finder_data_t find_data;
    const char *playlist_file     = NULL;
+   settings_t *settings          = config_get_ptr();
    retro_task_t *task            = task_init();
    pl_thumb_handle_t *pl_thumb   = (pl_thumb_handle_t*)calloc(1, sizeof(pl_thumb_handle_t));
    
@@ -564,11 +896,26 @@ bool task_push_pl_thumbnail_download(
    pl_thumb->http_task           = NULL;
    pl_thumb->list_size           = 0;
    pl_thumb->list_index          = 0;
+   pl_thumb->title_index         = (size_t)-1;
    pl_thumb->type_idx            = 1;
+   pl_thumb->max_downloads       = settings
+         ? settings->uints.network_concurrent_thumbnail_downloads : 1;
+   pl_thumb->max_downloads       = MIN(MAX(pl_thumb->max_downloads, 1),
+         PL_THUMB_MAX_DOWNLOADS);
    pl_thumb->status              = PL_THUMB_BEGIN;
    
+#ifdef HAVE_THREADS
+   if (!(pl_thumb->lock = slock_new()))
+   {
+      free_pl_thumb_handle(pl_thumb);
+      pl_thumb = NULL;
+      goto error;
+   }
+#endif
+   
    /* Configure task */
    task->handler                 = task_pl_thumbnail_download_handler;
+   task->priority                = TASK_PRIORITY_BACKGROUND;
    task->state                   = pl_thumb;
    task->title                   = strdup(system);
    task->alternative_look        = true;
@@ -102,7 +102,8 @@ enum save_task_state_flags
    SAVE_TASK_FLAG_MUTE                  = (1 << 4),
    SAVE_TASK_FLAG_THUMBNAIL_ENABLE      = (1 << 5),
    SAVE_TASK_FLAG_HAS_VALID_FB          = (1 << 6),
-   SAVE_TASK_FLAG_COMPRESS_FILES        = (1 << 7)
+   SAVE_TASK_FLAG_COMPRESS_FILES        = (1 << 7),
+   SAVE_TASK_FLAG_COMPRESS_ZSTD         = (1 << 8)
 };
 
 typedef struct
@@ -115,7 +116,7 @@ typedef struct
    ssize_t written;
    ssize_t bytes_read;
    int state_slot;
-   uint8_t flags;
+   uint16_t flags;
    char path[PATH_MAX_LENGTH];
 } save_task_state_t;
 
@@ -506,8 +507,10 @@ static void task_save_handler(retro_task_t *task)
    if (!state->file)
    {
       if (state->flags & SAVE_TASK_FLAG_COMPRESS_FILES)
-         state->file   = intfstream_open_rzip_file(
-               state->path, RETRO_VFS_FILE_ACCESS_WRITE);
+         state->file   = intfstream_open_rzip_file_codec(
+               state->path, RETRO_VFS_FILE_ACCESS_WRITE,
+               (state->flags & SAVE_TASK_FLAG_COMPRESS_ZSTD)
+               ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB);
       else
          state->file   = intfstream_open_file(
                state->path, RETRO_VFS_FILE_ACCESS_WRITE,
@@ -630,11 +633,16 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
 #if defined(HAVE_ZLIB)
    if (settings->bools.savestate_file_compression)
       state->flags              |= SAVE_TASK_FLAG_COMPRESS_FILES;
+#ifdef HAVE_ZSTD
+   if (settings->bools.savestate_file_compression_zstd)
+      state->flags              |= SAVE_TASK_FLAG_COMPRESS_ZSTD;
+#endif
 #endif
    if (!settings->bools.notification_show_save_state)
       state->flags              |= SAVE_TASK_FLAG_MUTE;
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = undo_save_state_cb;
@@ -1198,11 +1206,16 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
 #if defined(HAVE_ZLIB)
    if (settings->bools.savestate_file_compression)
       state->flags              |= SAVE_TASK_FLAG_COMPRESS_FILES;
+#ifdef HAVE_ZSTD
+   if (settings->bools.savestate_file_compression_zstd)
+      state->flags              |= SAVE_TASK_FLAG_COMPRESS_ZSTD;
+#endif
 #endif
    if (!settings->bools.notification_show_save_state)
       state->flags              |= SAVE_TASK_FLAG_MUTE;
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = save_state_cb;
@@ -1304,12 +1317,17 @@ static void task_push_load_and_save_state(const char *path, void *data,
 #if defined(HAVE_ZLIB)
    if (settings->bools.savestate_file_compression)
       state->flags              |= SAVE_TASK_FLAG_COMPRESS_FILES;
+#ifdef HAVE_ZSTD
+   if (settings->bools.savestate_file_compression_zstd)
+      state->flags              |= SAVE_TASK_FLAG_COMPRESS_ZSTD;
+#endif
 #endif
    if (!settings->bools.notification_show_save_state)
       state->flags              |= SAVE_TASK_FLAG_MUTE;
 
    task->state                   = state;
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_INTERACTIVE;
    task->handler                 = task_load_handler;
    task->callback                = content_load_and_save_state_cb;
    task->title                   = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1361,7 +1379,10 @@ bool content_auto_save_state(const char *path)
 
 #if defined(HAVE_ZLIB)
    if (settings->bools.savestate_file_compression)
-      file = intfstream_open_rzip_file(path, RETRO_VFS_FILE_ACCESS_WRITE);
+      file = intfstream_open_rzip_file_codec(path,
+            RETRO_VFS_FILE_ACCESS_WRITE,
+            settings->bools.savestate_file_compression_zstd
+            ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB);
    else
 #endif
       file = intfstream_open_file(path, RETRO_VFS_FILE_ACCESS_WRITE,
@@ -1589,11 +1610,16 @@ bool content_load_state(const char *path,
 #if defined(HAVE_ZLIB)
    if (settings->bools.savestate_file_compression)
       state->flags             |= SAVE_TASK_FLAG_COMPRESS_FILES;
+#ifdef HAVE_ZSTD
+   if (settings->bools.savestate_file_compression_zstd)
+      state->flags             |= SAVE_TASK_FLAG_COMPRESS_ZSTD;
+#endif
 #endif
    if (!settings->bools.notification_show_save_state)
       state->flags             |= SAVE_TASK_FLAG_MUTE;
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->priority               = TASK_PRIORITY_INTERACTIVE;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
@@ -369,6 +369,7 @@ static bool screenshot_dump(
       retro_task_t *task = task_init();
 
       task->type         = TASK_TYPE_BLOCKING;
+      task->priority     = TASK_PRIORITY_INTERACTIVE;
       task->state        = state;
       task->handler      = task_screenshot_handler;
       task->mute         = savestate;
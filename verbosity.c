@@ -72,6 +72,12 @@
 #include "config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <queues/mpsc_queue.h>
+#include <retro_timers.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #include "frontend/frontend_driver.h"
 #endif
@@ -94,6 +100,44 @@
 #define FILE_PATH_PROGRAM_NAME "RetroArch"
 #endif
 
+#ifdef HAVE_THREADS
+/* Memory for messages waiting to be written. When it is
+ * full, new messages are dropped until the writer thread
+ * catches up, and the number dropped is logged. */
+#define VERBOSITY_ASYNC_QUEUE_SIZE (256 * 1024)
+/* Longer messages are cut short */
+#define VERBOSITY_ASYNC_MSG_SIZE   2048
+/* How long the writer thread lets messages pile up
+ * before writing them out in one go, in microseconds */
+#define VERBOSITY_ASYNC_INTERVAL   50000
+/* How long a crash handler waits for the writer thread
+ * to finish a batch, in milliseconds */
+#define VERBOSITY_ASYNC_CRASH_WAIT 100
+
+/* The network logger takes the place of the log file */
+#if defined(HAVE_LOGGER) && !defined(ORBIS)
+#define VERBOSITY_ASYNC_NET_LOGGER
+#endif
+
+/* Logging threads read the async flag without a lock, with
+ * a full barrier, so that a thread which queued a message
+ * and then finds async logging off knows the writer thread
+ * may be gone, and writes the message out itself */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define VERBOSITY_ASYNC_GET(v)    (__atomic_thread_fence(__ATOMIC_SEQ_CST), \
+      __atomic_load_n(&(v)->async, __ATOMIC_SEQ_CST))
+#define VERBOSITY_ASYNC_SET(v, x) __atomic_store_n(&(v)->async, (x), __ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define VERBOSITY_ASYNC_GET(v)    _InterlockedOr(&(v)->async, 0)
+#define VERBOSITY_ASYNC_SET(v, x) _InterlockedExchange(&(v)->async, (x))
+#else
+#define VERBOSITY_ASYNC_LOCKED
+#define VERBOSITY_ASYNC_GET(v)    verbosity_async_get_locked(v)
+#define VERBOSITY_ASYNC_SET(v, x) verbosity_async_set_locked((v), (x))
+#endif
+#endif
+
 typedef struct verbosity_state
 {
 #ifdef HAVE_LIBNX
@@ -104,10 +148,29 @@ typedef struct verbosity_state
    FILE *fp;
    void *buf;
 
+#ifdef HAVE_THREADS
+   /* Asynchronous logging. The queue, lock and condition
+    * are kept once created, as other threads may be
+    * logging at any time. */
+   mpsc_queue_t *async_queue;
+   sthread_t *async_thread;
+   slock_t *async_lock;   /* Held while reading the queue
+                             or using fp */
+   scond_t *async_cond;
+#endif
+
    char override_path[PATH_MAX_LENGTH];
    bool verbosity;
    bool initialized;
    bool override_active;
+#ifdef HAVE_THREADS
+#ifdef _MSC_VER
+   volatile long async;
+#else
+   int async;             /* Use VERBOSITY_ASYNC_GET/SET */
+#endif
+   bool async_quit;
+#endif
 } verbosity_state_t;
 
 /* TODO/FIXME - static public global variables */
@@ -169,6 +232,225 @@ bool *verbosity_get_ptr(void)
    return &g_verbosity->verbosity;
 }
 
+#ifdef HAVE_THREADS
+/* Writes out all queued messages.
+ * Must be called with async_lock held. */
+static void verbosity_async_drain(verbosity_state_t *g_verbosity)
+{
+   char buf[4096];
+   size_t len, dropped;
+   bool wrote = false;
+   FILE   *fp = g_verbosity->fp;
+
+   while ((len = mpsc_queue_read(g_verbosity->async_queue,
+               buf, sizeof(buf))))
+   {
+#ifdef VERBOSITY_ASYNC_NET_LOGGER
+      logger_write(buf, len);
+#else
+      if (fp)
+         fwrite(buf, 1, len, fp);
+#endif
+      wrote = true;
+   }
+
+   if ((dropped = mpsc_queue_take_dropped(g_verbosity->async_queue)))
+   {
+      len = snprintf(buf, sizeof(buf),
+            "%s Log queue full, dropped %u messages.\n",
+            FILE_PATH_LOG_WARN, (unsigned)dropped);
+#ifdef VERBOSITY_ASYNC_NET_LOGGER
+      logger_write(buf, len);
+#else
+      if (fp)
+         fwrite(buf, 1, len, fp);
+#endif
+      wrote = true;
+   }
+
+   if (fp && wrote)
+      fflush(fp);
+}
+
+#ifdef VERBOSITY_ASYNC_LOCKED
+static int verbosity_async_get_locked(verbosity_state_t *g_verbosity)
+{
+   int async;
+   if (!g_verbosity->async_queue)
+      return 0;
+   slock_lock(g_verbosity->async_lock);
+   async = g_verbosity->async;
+   slock_unlock(g_verbosity->async_lock);
+   return async;
+}
+
+static void verbosity_async_set_locked(verbosity_state_t *g_verbosity,
+      int async)
+{
+   slock_lock(g_verbosity->async_lock);
+   g_verbosity->async = async;
+   slock_unlock(g_verbosity->async_lock);
+}
+#endif
+
+static void verbosity_async_flush(verbosity_state_t *g_verbosity)
+{
+   if (!g_verbosity->async_queue)
+      return;
+   slock_lock(g_verbosity->async_lock);
+   verbosity_async_drain(g_verbosity);
+   slock_unlock(g_verbosity->async_lock);
+}
+
+static void verbosity_async_thread(void *data)
+{
+   verbosity_state_t *g_verbosity = (verbosity_state_t*)data;
+
+   slock_lock(g_verbosity->async_lock);
+   while (!g_verbosity->async_quit)
+   {
+      verbosity_async_drain(g_verbosity);
+      scond_wait_timeout(g_verbosity->async_cond,
+            g_verbosity->async_lock, VERBOSITY_ASYNC_INTERVAL);
+   }
+   verbosity_async_drain(g_verbosity);
+   slock_unlock(g_verbosity->async_lock);
+}
+
+static void verbosity_async_write(verbosity_state_t *g_verbosity,
+      const char *tag, const char *fmt, va_list ap)
+{
+   char buffer[VERBOSITY_ASYNC_MSG_SIZE];
+   int len = tag ? snprintf(buffer, sizeof(buffer), "%s ", tag) : 0;
+   int ret = vsnprintf(buffer + len, sizeof(buffer) - len, fmt, ap);
+   bool written;
+
+   if (ret < 0)
+      ret = 0;
+   if (ret >= (int)sizeof(buffer) - len)
+   {
+      len                = sizeof(buffer) - 1;
+      buffer[len - 1]    = '\n';
+   }
+   else
+      len               += ret;
+
+   written = mpsc_queue_write(g_verbosity->async_queue, buffer, len);
+
+   /* Async logging was turned off meanwhile, and
+    * the writer thread may not drain the queue again */
+   if (!VERBOSITY_ASYNC_GET(g_verbosity))
+      verbosity_async_flush(g_verbosity);
+   /* Wake the writer early rather than start dropping */
+   else if (!written || mpsc_queue_half_full(g_verbosity->async_queue))
+      scond_signal(g_verbosity->async_cond);
+   /* Errors often come right before a crash, so
+    * they are written out before returning */
+   if (     written
+         && string_starts_with_size(buffer, FILE_PATH_LOG_ERROR,
+               STRLEN_CONST(FILE_PATH_LOG_ERROR)))
+      verbosity_async_flush(g_verbosity);
+}
+
+static void verbosity_async_exit(void)
+{
+   verbosity_set_async(false);
+}
+#endif
+
+bool verbosity_async_log_v(const char *tag, const char *fmt, va_list ap)
+{
+#ifdef HAVE_THREADS
+   verbosity_state_t *g_verbosity = &main_verbosity_st;
+
+   if (VERBOSITY_ASYNC_GET(g_verbosity))
+   {
+      verbosity_async_write(g_verbosity, tag, fmt, ap);
+      return true;
+   }
+#endif
+   return false;
+}
+
+void verbosity_flush(void)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+   verbosity_state_t *g_verbosity = &main_verbosity_st;
+
+   if (!g_verbosity->async_queue)
+      return;
+
+   /* The writer thread may be in the middle of a batch,
+    * or may have crashed while writing one */
+   for (i = 0; i < VERBOSITY_ASYNC_CRASH_WAIT; i++)
+   {
+      if (slock_try_lock(g_verbosity->async_lock))
+      {
+         verbosity_async_drain(g_verbosity);
+         slock_unlock(g_verbosity->async_lock);
+         return;
+      }
+      retro_sleep(1);
+   }
+#endif
+}
+
+void verbosity_set_async(bool enable)
+{
+#ifdef HAVE_THREADS
+   verbosity_state_t *g_verbosity = &main_verbosity_st;
+
+   if (enable == (VERBOSITY_ASYNC_GET(g_verbosity) != 0))
+      return;
+
+   if (enable)
+   {
+      if (!g_verbosity->async_queue)
+      {
+         mpsc_queue_t *queue = mpsc_queue_new(VERBOSITY_ASYNC_QUEUE_SIZE);
+         slock_t *lock       = slock_new();
+         scond_t *cond       = scond_new();
+
+         if (!queue || !lock || !cond)
+         {
+            mpsc_queue_free(queue);
+            if (lock)
+               slock_free(lock);
+            if (cond)
+               scond_free(cond);
+            return;
+         }
+
+         g_verbosity->async_lock  = lock;
+         g_verbosity->async_cond  = cond;
+         g_verbosity->async_queue = queue;
+         atexit(verbosity_async_exit);
+      }
+
+      g_verbosity->async_quit     = false;
+      if (!(g_verbosity->async_thread = sthread_create(
+                  verbosity_async_thread, g_verbosity)))
+         return;
+      VERBOSITY_ASYNC_SET(g_verbosity, 1);
+   }
+   else
+   {
+      VERBOSITY_ASYNC_SET(g_verbosity, 0);
+
+      slock_lock(g_verbosity->async_lock);
+      g_verbosity->async_quit     = true;
+      scond_signal(g_verbosity->async_cond);
+      slock_unlock(g_verbosity->async_lock);
+
+      sthread_join(g_verbosity->async_thread);
+      g_verbosity->async_thread   = NULL;
+      /* Catch messages queued while the thread stopped */
+      verbosity_async_flush(g_verbosity);
+   }
+#endif
+}
+
 void retro_main_log_file_init(const char *path, bool append)
 {
    FILE *tmp                      = NULL;
@@ -180,30 +462,44 @@ void retro_main_log_file_init(const char *path, bool append)
    mutexInit(&g_verbosity->mtx);
 #endif
 
-   g_verbosity->fp      = stderr;
-   if (!path)
-      return;
-
-   tmp                  = (FILE*)fopen_utf8(path, append ? "ab" : "wb");
+   if (path)
+      tmp               = (FILE*)fopen_utf8(path, append ? "ab" : "wb");
 
-   if (!tmp)
+#ifdef HAVE_THREADS
+   if (g_verbosity->async_queue)
+      slock_lock(g_verbosity->async_lock);
+#endif
+   g_verbosity->fp      = stderr;
+   if (tmp)
    {
-      RARCH_ERR("Failed to open system event log file: %s\n", path);
-      return;
-   }
+      g_verbosity->fp          = tmp;
+      g_verbosity->initialized = true;
 
-   g_verbosity->fp          = tmp;
-   g_verbosity->initialized = true;
+      /* TODO: this is only useful for a few platforms, find which and add ifdef */
+      g_verbosity->buf         = calloc(1, 0x4000);
+      setvbuf(g_verbosity->fp, (char*)g_verbosity->buf, _IOFBF, 0x4000);
+   }
+#ifdef HAVE_THREADS
+   if (g_verbosity->async_queue)
+      slock_unlock(g_verbosity->async_lock);
+#endif
 
-   /* TODO: this is only useful for a few platforms, find which and add ifdef */
-   g_verbosity->buf         = calloc(1, 0x4000);
-   setvbuf(g_verbosity->fp, (char*)g_verbosity->buf, _IOFBF, 0x4000);
+   if (path && !tmp)
+      RARCH_ERR("Failed to open system event log file: %s\n", path);
 }
 
 void retro_main_log_file_deinit(void)
 {
    verbosity_state_t *g_verbosity = &main_verbosity_st;
 
+   /* Messages still queued go to the file they were meant for */
+#ifdef HAVE_THREADS
+   if (g_verbosity->async_queue)
+   {
+      slock_lock(g_verbosity->async_lock);
+      verbosity_async_drain(g_verbosity);
+   }
+#endif
    if (g_verbosity->fp && g_verbosity->initialized)
    {
       fclose(g_verbosity->fp);
@@ -213,6 +509,10 @@ void retro_main_log_file_deinit(void)
       free(g_verbosity->buf);
    g_verbosity->buf         = NULL;
    g_verbosity->initialized = false;
+#ifdef HAVE_THREADS
+   if (g_verbosity->async_queue)
+      slock_unlock(g_verbosity->async_lock);
+#endif
 }
 
 #if !defined(HAVE_LOGGER)
@@ -315,6 +615,8 @@ void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
    asl_free(msg);
 #endif
 #endif
+   if (verbosity_async_log_v(tag_v, fmt, ap))
+      return;
 #if defined(HAVE_LIBNX)
    mutexLock(&g_verbosity->mtx);
 #endif
@@ -47,6 +47,22 @@ void verbosity_set_log_level(unsigned level);
 
 bool *verbosity_get_ptr(void);
 
+/* Hands messages to a writer thread instead of writing
+ * them on the calling thread. Errors are still written
+ * out before RARCH_ERR returns. Does nothing without
+ * thread support. */
+void verbosity_set_async(bool enable);
+
+/* Queues a message for the writer thread if asynchronous
+ * logging is on. @tag, if not NULL, goes before it.
+ * Returns false if the caller must write it instead. */
+bool verbosity_async_log_v(const char *tag, const char *fmt, va_list ap);
+
+/* Writes out queued messages right away, for crash
+ * handlers. Gives up if the writer thread doesn't let
+ * go of them soon. */
+void verbosity_flush(void);
+
 void retro_main_log_file_deinit(void);
 
 void retro_main_log_file_init(const char *path, bool append);
@@ -59,6 +75,7 @@ void logger_init (void);
 void logger_shutdown (void);
 void logger_send (const char *__format,...);
 void logger_send_v(const char *__format, va_list args);
+void logger_write(const char *buf, size_t len);
 
 #ifdef IS_SALAMANDER
 